@@ -9,7 +9,19 @@
 #undef __HAVE_ARCH_STRRCHR
 extern char * strrchr(const char * s, int c);
 
+#if CONFIG_IS_ENABLED(USE_ARCH_STRING)
+#define __HAVE_ARCH_STRCHR
+#define __HAVE_ARCH_STRCMP
+#define __HAVE_ARCH_STRLEN
+#define __HAVE_ARCH_MEMCMP
+#define __HAVE_ARCH_MEMCHR
+extern int strcmp(const char *, const char *);
+extern __kernel_size_t strlen(const char *);
+extern int memcmp(const void *, const void *, __kernel_size_t);
+#else
 #undef __HAVE_ARCH_STRCHR
+#undef __HAVE_ARCH_MEMCHR
+#endif
 extern char * strchr(const char * s, int c);
 
 #if CONFIG_IS_ENABLED(USE_ARCH_MEMCPY)
@@ -24,7 +36,6 @@ extern void * memcpy(void *, const void *, __kernel_size_t);
 #endif
 extern void * memmove(void *, const void *, __kernel_size_t);
 
-#undef __HAVE_ARCH_MEMCHR
 extern void * memchr(const void *, int, __kernel_size_t);
 
 #undef __HAVE_ARCH_MEMZERO
@@ -243,6 +243,15 @@ uint sandbox_spi_get_speed(struct udevice *dev);
  */
 uint sandbox_spi_get_mode(struct udevice *dev);
 
+/**
+ * sandbox_spi_get_dirmap_reads() - Get the number of direct-mapped reads
+ *
+ * @dev: sandbox spi bus to check
+ * Return: number of reads done through a direct mapping since the bus was
+ *	probed
+ */
+uint sandbox_spi_get_dirmap_reads(struct udevice *dev);
+
 /**
  * sandbox_get_pch_spi_protect() - Get the PCI SPI protection status
  *
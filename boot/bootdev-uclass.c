@@ -16,6 +16,7 @@
 #include <malloc.h>
 #include <part.h>
 #include <sort.h>
+#include <time.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
 #include <dm/uclass-internal.h>
@@ -750,6 +751,17 @@ int bootdev_setup_iter(struct bootflow_iter *iter, const char *label,
 			return log_msg_ret("pre", ret);
 	}
 
+	/*
+	 * When scanning all bootdevs, let slow hunters get going while the
+	 * faster bootdevs are scanned
+	 */
+	if (IS_ENABLED(CONFIG_BOOTSTD_HUNT_EARLY) &&
+	    (iter->flags & BOOTFLOWIF_HUNT) && !label) {
+		ret = bootdev_hunt_start(show);
+		if (ret)
+			return log_msg_ret("sta", ret);
+	}
+
 	/* Handle scanning a single device */
 	if (IS_ENABLED(CONFIG_BOOTSTD_FULL) && label) {
 		if (iter->flags & BOOTFLOWIF_HUNT) {
@@ -810,17 +822,31 @@ static int bootdev_hunt_drv(struct bootdev_hunter *info, uint seq, bool show)
 		return log_msg_ret("std", ret);
 
 	if (!(std->hunters_used & BIT(seq))) {
+		struct bootstd_hunt_stats *stats = &std->hunt_stats[seq];
+		ulong start, now;
+
 		if (show)
 			printf("Hunting with: %s\n",
 			       uclass_get_name(info->uclass));
 		log_debug("Hunting with: %s\n", name);
+		start = timer_get_us();
+		if (!(std->hunters_started & BIT(seq))) {
+			stats->begin_us = start;
+			stats->busy_us = 0;
+		}
 		if (info->hunt) {
 			ret = info->hunt(info, show);
 			log_debug("  - hunt result %d\n", ret);
+			now = timer_get_us();
+			stats->busy_us += now - start;
 			if (ret && ret != -ENOENT)
 				return ret;
+		} else {
+			now = timer_get_us();
 		}
+		stats->total_us = now - stats->begin_us;
 		std->hunters_used |= BIT(seq);
+		std->hunters_started &= ~BIT(seq);
 	}
 
 	return 0;
@@ -884,6 +910,9 @@ int bootdev_unhunt(enum uclass_id id)
 			if (!(std->hunters_used & BIT(i)))
 				return -EALREADY;
 			std->hunters_used &= ~BIT(i);
+			std->hunters_started &= ~BIT(i);
+			memset(&std->hunt_stats[i], '\0',
+			       sizeof(std->hunt_stats[i]));
 			return 0;
 		}
 	}
@@ -918,6 +947,94 @@ int bootdev_hunt_prio(enum bootdev_prio_t prio, bool show)
 	return result;
 }
 
+int bootdev_hunt_start(bool show)
+{
+	struct bootdev_hunter *start;
+	struct bootstd_priv *std;
+	int n_ent, i;
+	int ret;
+
+	ret = bootstd_get_priv(&std);
+	if (ret)
+		return log_msg_ret("std", ret);
+
+	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
+	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
+	for (i = 0; i < n_ent && i < BOOTSTD_MAX_HUNTERS; i++) {
+		struct bootdev_hunter *info = start + i;
+		struct bootstd_hunt_stats *stats = &std->hunt_stats[i];
+		ulong begin;
+
+		if (!info->start ||
+		    ((std->hunters_used | std->hunters_started) & BIT(i)))
+			continue;
+		if (show)
+			printf("Starting hunter: %s\n",
+			       uclass_get_name(info->uclass));
+		begin = timer_get_us();
+		ret = info->start(info, show);
+
+		/* any problem is reported when the hunt is completed */
+		log_debug("  - start result %d\n", ret);
+		stats->begin_us = begin;
+		stats->busy_us = timer_get_us() - begin;
+		stats->total_us = 0;
+		std->hunters_started |= BIT(i);
+	}
+
+	return 0;
+}
+
+void bootdev_hunt_stop(void)
+{
+	struct bootdev_hunter *start;
+	struct bootstd_priv *std;
+	int n_ent, i;
+	int ret;
+
+	if (bootstd_get_priv(&std) || !std->hunters_started)
+		return;
+
+	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
+	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
+	for (i = 0; i < n_ent && i < BOOTSTD_MAX_HUNTERS; i++) {
+		struct bootdev_hunter *info = start + i;
+
+		if (!(std->hunters_started & BIT(i)))
+			continue;
+		if (info->stop) {
+			ret = info->stop(info, false);
+			log_debug("Stopped hunter %s: %d\n",
+				  uclass_get_name(info->uclass), ret);
+		}
+		std->hunters_started &= ~BIT(i);
+	}
+}
+
+void bootdev_list_hunt_times(struct bootstd_priv *std, uint mask)
+{
+	struct bootdev_hunter *start;
+	int n_ent, i;
+
+	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
+	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
+	printf("%-15s  %7s  %8s\n", "Hunter", "Busy ms", "Total ms");
+	printf("%-15s  %7s  %8s\n", "---------------", "-------", "--------");
+	for (i = 0; i < n_ent && i < BOOTSTD_MAX_HUNTERS; i++) {
+		struct bootstd_hunt_stats *stats = &std->hunt_stats[i];
+		struct bootdev_hunter *info = start + i;
+
+		if (!(mask & BIT(i)))
+			continue;
+		printf("%-15s  %7lu  ", uclass_get_name(info->uclass),
+		       stats->busy_us / 1000);
+		if (std->hunters_used & BIT(i))
+			printf("%8lu\n", stats->total_us / 1000);
+		else
+			printf("%8s\n", "-");
+	}
+}
+
 void bootdev_list_hunters(struct bootstd_priv *std)
 {
 	struct bootdev_hunter *orig, *start;
@@ -14,6 +14,7 @@
 #include <env_internal.h>
 #include <malloc.h>
 #include <serial.h>
+#include <time.h>
 #include <dm/device-internal.h>
 #include <dm/uclass-internal.h>
 
@@ -92,10 +93,13 @@ void bootflow_iter_init(struct bootflow_iter *iter, int flags)
 
 	/* remember the first bootdevs we see */
 	iter->max_devs = BOOTFLOW_MAX_USED_DEVS;
+	iter->start_time = get_timer(0);
 }
 
 void bootflow_iter_uninit(struct bootflow_iter *iter)
 {
+	if (IS_ENABLED(CONFIG_BOOTSTD_HUNT_EARLY))
+		bootdev_hunt_stop();
 	free(iter->method_order);
 }
 
@@ -521,6 +525,7 @@ int bootflow_boot(struct bootflow *bflow)
 
 int bootflow_run_boot(struct bootflow_iter *iter, struct bootflow *bflow)
 {
+	bool cached = false;
 	int ret;
 
 	printf("** Booting bootflow '%s' with %s\n", bflow->name,
@@ -528,7 +533,17 @@ int bootflow_run_boot(struct bootflow_iter *iter, struct bootflow *bflow)
 	if (IS_ENABLED(CONFIG_OF_HAS_PRIOR_STAGE) &&
 	    (bflow->flags & BOOTFLOWF_USE_PRIOR_FDT))
 		printf("Using prior-stage device tree\n");
+	if (CONFIG_IS_ENABLED(BOOTFLOW_CACHE) &&
+	    bflow->state == BOOTFLOWST_READY)
+		cached = !bootflow_cache_save(bflow, iter ?
+					      get_timer(iter->start_time) : 0);
+	if (IS_ENABLED(CONFIG_BOOTSTD_HUNT_EARLY))
+		bootdev_hunt_stop();
 	ret = bootflow_boot(bflow);
+
+	/* we are still here, so don't try this one first next time */
+	if (cached)
+		bootflow_cache_clear();
 	if (!IS_ENABLED(CONFIG_BOOTSTD_FULL)) {
 		printf("Boot failed (err=%d)\n", ret);
 		return ret;
@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Remember the last bootflow which was booted, so it can be tried first
+ *
+ * The record is kept in an environment variable as a single line:
+ *
+ *    <scan_ms> <hunter> <bootdev> <part> <bootmeth> <size> <fname>
+ *
+ * where scan_ms is the time the full scan took to find the bootflow and hunter
+ * is the uclass of the hunter needed to find the bootdev, or "-" if none.
+ */
+
+#define LOG_CATEGORY UCLASS_BOOTSTD
+
+#include <bootdev.h>
+#include <bootflow.h>
+#include <bootmeth.h>
+#include <bootstage.h>
+#include <dm.h>
+#include <env.h>
+#include <log.h>
+#include <vsprintf.h>
+#include <dm/uclass-internal.h>
+#include <linux/string.h>
+
+#define BOOTFLOW_CACHE_VAR	"bootflow_cache"
+
+/* Maximum length of the record */
+#define BOOTFLOW_CACHE_MAX_LEN	256
+
+/* Maximum number of bootflows to check on the cached partition */
+#define BOOTFLOW_CACHE_MAX_TRIES	20
+
+/**
+ * bootflow_cache_hunter() - Find the hunter needed to create a bootdev
+ *
+ * Bootdevs from USB, SCSI, etc. only exist once their bus is enumerated. This
+ * finds the hunter for the nearest ancestor of @dev which has one
+ *
+ * @dev: Bootdev to check
+ * Return: uclass name of the hunter, or "-" if none
+ */
+static const char *bootflow_cache_hunter(struct udevice *dev)
+{
+	struct bootdev_hunter *start;
+	int n_ent, i;
+
+	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
+	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
+	for (dev = dev_get_parent(dev); dev; dev = dev_get_parent(dev)) {
+		for (i = 0; i < n_ent; i++) {
+			if (start[i].uclass == device_get_uclass_id(dev))
+				return uclass_get_name(start[i].uclass);
+		}
+	}
+
+	return "-";
+}
+
+/* Save the environment, if enabled, after the record has changed */
+static void bootflow_cache_store(void)
+{
+	int ret;
+
+	if (!IS_ENABLED(CONFIG_BOOTFLOW_CACHE_SAVEENV))
+		return;
+
+	ret = env_save();
+	if (ret)
+		log_warning("Cannot save bootflow cache (err=%dE)\n", ret);
+}
+
+int bootflow_cache_save(const struct bootflow *bflow, ulong scan_ms)
+{
+	const struct bootmeth_uc_plat *ucp;
+	char rec[BOOTFLOW_CACHE_MAX_LEN];
+	const char *old;
+	int ret;
+
+	if (!bflow->dev || !bflow->fname || strchr(bflow->fname, '\n'))
+		return log_msg_ret("bfl", -EINVAL);
+	ucp = dev_get_uclass_plat(bflow->method);
+	if (ucp->flags & BOOTMETHF_GLOBAL)
+		return log_msg_ret("glb", -EINVAL);
+
+	ret = snprintf(rec, sizeof(rec), "%lu %s %s %d %s %d %s", scan_ms,
+		       bootflow_cache_hunter(bflow->dev), bflow->dev->name,
+		       bflow->part, bflow->method->name, bflow->size,
+		       bflow->fname);
+	if (ret >= sizeof(rec))
+		return log_msg_ret("len", -E2BIG);
+
+	/*
+	 * Keep the existing record if only the scan time differs, since that
+	 * is the time taken by the full scan, not the cached one
+	 */
+	old = env_get(BOOTFLOW_CACHE_VAR);
+	if (old && !strcmp(strchrnul(old, ' '), strchrnul(rec, ' ')))
+		return 0;
+
+	ret = env_set(BOOTFLOW_CACHE_VAR, rec);
+	if (ret)
+		return log_msg_ret("set", -EIO);
+	log_debug("Cached bootflow '%s'\n", bflow->name);
+	bootflow_cache_store();
+
+	return 0;
+}
+
+void bootflow_cache_clear(void)
+{
+	if (!env_get(BOOTFLOW_CACHE_VAR))
+		return;
+
+	/*
+	 * Save this too, else a bootflow which fails is tried first again
+	 * after every reset
+	 */
+	if (!env_set(BOOTFLOW_CACHE_VAR, NULL))
+		bootflow_cache_store();
+}
+
+int bootflow_cache_find(struct bootflow_iter *iter, struct bootflow *bflow,
+			ulong *scan_msp)
+{
+	char rec[BOOTFLOW_CACHE_MAX_LEN], *ptr, *field[6];
+	const char *hunter, *name, *method, *fname, *val;
+	struct udevice *dev;
+	char label[40];
+	int part, size;
+	ulong scan_ms;
+	int ret, i;
+
+	bootflow_iter_init(iter, 0);
+	val = env_get(BOOTFLOW_CACHE_VAR);
+	if (!val)
+		return -ENOENT;
+	strlcpy(rec, val, sizeof(rec));
+
+	/* the filename is last, since it may contain spaces */
+	ptr = rec;
+	for (i = 0; i < ARRAY_SIZE(field); i++) {
+		field[i] = strsep(&ptr, " ");
+		if (!ptr || !*ptr)
+			return log_msg_ret("fmt", -EINVAL);
+	}
+	scan_ms = simple_strtoul(field[0], NULL, 10);
+	hunter = field[1];
+	name = field[2];
+	part = simple_strtol(field[3], NULL, 10);
+	method = field[4];
+	size = simple_strtol(field[5], NULL, 10);
+	fname = ptr;
+
+	if (strcmp(hunter, "-")) {
+		ret = bootdev_hunt(hunter, false);
+		if (ret)
+			log_debug("Cannot hunt with '%s' (err=%dE)\n", hunter,
+				  ret);
+	}
+
+	/* avoid an error message if the device has gone away */
+	ret = uclass_find_device_by_name(UCLASS_BOOTDEV, name, &dev);
+	if (ret)
+		return log_msg_ret("dev", -ENODEV);
+
+	/* look through the bootflows on the partition for the bootmeth */
+	snprintf(label, sizeof(label), "%s:%d", name, part);
+	for (i = 0, ret = bootflow_scan_first(NULL, label, iter,
+					      BOOTFLOWIF_SKIP_GLOBAL, bflow);
+	     i < BOOTFLOW_CACHE_MAX_TRIES && ret != -ENODEV;
+	     i++, ret = bootflow_scan_next(iter, bflow)) {
+		if (!ret && !strcmp(bflow->method->name, method)) {
+			if (bflow->size == size && bflow->fname &&
+			    !strcmp(bflow->fname, fname)) {
+				if (scan_msp)
+					*scan_msp = scan_ms;
+				return 0;
+			}
+			bootflow_free(bflow);
+			return log_msg_ret("chg", -ESTALE);
+		}
+		bootflow_free(bflow);
+	}
+
+	return log_msg_ret("fnd", -ENOENT);
+}
+
+int bootflow_cache_run(bool show)
+{
+	struct bootflow_iter iter;
+	struct bootflow bflow;
+	ulong scan_ms, used_us;
+	int ret;
+
+	bootstage_start(BOOTSTAGE_ID_ACCUM_BOOTFLOW_CACHE, "bootflow_cache");
+	ret = bootflow_cache_find(&iter, &bflow, &scan_ms);
+	used_us = bootstage_accum(BOOTSTAGE_ID_ACCUM_BOOTFLOW_CACHE);
+	if (ret) {
+		bootflow_iter_uninit(&iter);
+		return ret;
+	}
+
+	/* the full scan is skipped, so record roughly how long that saves */
+	if (scan_ms * 1000 > used_us)
+		bootstage_accum_add(BOOTSTAGE_ID_ACCUM_BOOTFLOW_SAVED,
+				    "bootflow_cache_saved",
+				    scan_ms * 1000 - used_us);
+	if (show)
+		printf("Using cached bootflow '%s'\n", bflow.name);
+	ret = bootflow_run_boot(&iter, &bflow);
+	bootflow_free(&bflow);
+	bootflow_iter_uninit(&iter);
+
+	return ret;
+}
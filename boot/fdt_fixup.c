@@ -0,0 +1,516 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Batched edits to a flat devicetree
+ *
+ * Edits are queued against the offsets of the tree as it was when the session
+ * started. On commit they are sorted by offset, then the tree is rebuilt in
+ * place in a single pass, with the edits applied on the way.
+ */
+
+#define LOG_CATEGORY	LOGC_DT
+
+#include <fdt_fixup.h>
+#include <log.h>
+#include <malloc.h>
+#include <sort.h>
+#include <linux/kernel.h>
+
+/**
+ * enum fdt_fixup_op - Type of edit
+ *
+ * @FIXUPO_NONE: Edit was cancelled
+ * @FIXUPO_SETPROP: Set a property
+ * @FIXUPO_DELPROP: Delete a property
+ * @FIXUPO_DELNODE: Delete a node
+ */
+enum fdt_fixup_op {
+	FIXUPO_NONE,
+	FIXUPO_SETPROP,
+	FIXUPO_DELPROP,
+	FIXUPO_DELNODE,
+};
+
+/**
+ * struct fdt_fixup_edit - A queued edit
+ *
+ * @op: Type of edit
+ * @node: Offset of the node
+ * @prop: Offset of the existing property, or -1 if there is none
+ * @oldlen: Length of the existing property
+ * @seq: Sequence number, used to order new properties
+ * @nameoff: Offset of the name in the new strings block (new properties only)
+ * @len: Length of the new value
+ * @name: Property name, NULL for FIXUPO_DELNODE
+ * @data: Allocated copy of the value, followed by the name
+ */
+struct fdt_fixup_edit {
+	enum fdt_fixup_op op;
+	int node;
+	int prop;
+	int oldlen;
+	int seq;
+	int nameoff;
+	int len;
+	const char *name;
+	char *data;
+};
+
+void fdt_fixup_begin(struct fdt_fixup *fix, void *blob, int bufsize)
+{
+	fix->blob = blob;
+	fix->bufsize = bufsize ?: fdt_totalsize(blob);
+	alist_init_struct(&fix->edits, struct fdt_fixup_edit);
+	fix->seq = 0;
+	fix->err = fdt_check_header(blob);
+}
+
+void fdt_fixup_abort(struct fdt_fixup *fix)
+{
+	struct fdt_fixup_edit *edit;
+
+	alist_for_each(edit, &fix->edits)
+		free(edit->data);
+	alist_uninit(&fix->edits);
+}
+
+static int fixup_fail(struct fdt_fixup *fix, int err)
+{
+	if (!fix->err)
+		fix->err = err;
+
+	return err;
+}
+
+static struct fdt_fixup_edit *fixup_find(struct fdt_fixup *fix, int node,
+					 const char *name)
+{
+	struct fdt_fixup_edit *edit;
+
+	alist_for_each(edit, &fix->edits) {
+		if (edit->op != FIXUPO_NONE && edit->node == node &&
+		    edit->name && !strcmp(edit->name, name))
+			return edit;
+	}
+
+	return NULL;
+}
+
+/* Set up an edit for a property, recording the property if it exists */
+static int fixup_prep(struct fdt_fixup *fix, struct fdt_fixup_edit *new,
+		      enum fdt_fixup_op op, int node, const char *name,
+		      const void *val, int len)
+{
+	const struct fdt_property *prop;
+	int ret;
+
+	if (fix->err)
+		return fix->err;
+	if (len < 0)
+		return fixup_fail(fix, -FDT_ERR_BADVALUE);
+	if (!fdt_get_name(fix->blob, node, &ret))
+		return fixup_fail(fix, ret);
+
+	new->data = malloc(len + strlen(name) + 1);
+	if (!new->data)
+		return fixup_fail(fix, -FDT_ERR_NOSPACE);
+	if (len)
+		memcpy(new->data, val, len);
+	strcpy(new->data + len, name);
+	new->name = new->data + len;
+	new->op = op;
+	new->node = node;
+	new->len = len;
+	new->prop = -1;
+
+	prop = fdt_get_property(fix->blob, node, name, &new->oldlen);
+	if (prop)
+		new->prop = (const char *)prop - (const char *)fix->blob -
+			fdt_off_dt_struct(fix->blob);
+
+	return 0;
+}
+
+/* Queue an edit, replacing any earlier edit to the same property */
+static int fixup_queue(struct fdt_fixup *fix, struct fdt_fixup_edit *new)
+{
+	struct fdt_fixup_edit *edit;
+
+	edit = new->name ? fixup_find(fix, new->node, new->name) : NULL;
+	if (edit) {
+		free(edit->data);
+		new->seq = edit->seq;
+		*edit = *new;
+		return 0;
+	}
+
+	new->seq = fix->seq++;
+	if (!alist_add(&fix->edits, *new)) {
+		free(new->data);
+		return fixup_fail(fix, -FDT_ERR_NOSPACE);
+	}
+
+	return 0;
+}
+
+int fdt_fixup_setprop(struct fdt_fixup *fix, int nodeoffset, const char *name,
+		      const void *val, int len)
+{
+	struct fdt_fixup_edit new = {};
+	int ret;
+
+	ret = fixup_prep(fix, &new, FIXUPO_SETPROP, nodeoffset, name, val,
+			 len);
+	if (ret)
+		return ret;
+
+	return fixup_queue(fix, &new);
+}
+
+int fdt_fixup_delprop(struct fdt_fixup *fix, int nodeoffset,
+		      const char *name)
+{
+	struct fdt_fixup_edit new = {}, *edit;
+	int ret;
+
+	ret = fixup_prep(fix, &new, FIXUPO_DELPROP, nodeoffset, name, NULL, 0);
+	if (ret)
+		return ret;
+
+	if (new.prop >= 0)
+		return fixup_queue(fix, &new);
+
+	/* nothing to delete, but drop any property queued to be added */
+	edit = fixup_find(fix, nodeoffset, name);
+	if (edit)
+		edit->op = FIXUPO_NONE;
+	free(new.data);
+
+	return 0;
+}
+
+int fdt_fixup_del_node(struct fdt_fixup *fix, int nodeoffset)
+{
+	struct fdt_fixup_edit new = {};
+	int ret;
+
+	if (fix->err)
+		return fix->err;
+	if (!nodeoffset)
+		return fixup_fail(fix, -FDT_ERR_BADOFFSET);
+	if (!fdt_get_name(fix->blob, nodeoffset, &ret))
+		return fixup_fail(fix, ret);
+
+	new.op = FIXUPO_DELNODE;
+	new.node = nodeoffset;
+	new.prop = -1;
+
+	return fixup_queue(fix, &new);
+}
+
+/* Edits are applied at the property they replace, or else at their node */
+static int fixup_key(const struct fdt_fixup_edit *edit)
+{
+	return edit->prop >= 0 ? edit->prop : edit->node;
+}
+
+static int fixup_cmp(const void *va, const void *vb)
+{
+	const struct fdt_fixup_edit *a = va, *b = vb;
+
+	if (fixup_key(a) != fixup_key(b))
+		return fixup_key(a) < fixup_key(b) ? -1 : 1;
+	if ((a->op == FIXUPO_DELNODE) != (b->op == FIXUPO_DELNODE))
+		return a->op == FIXUPO_DELNODE ? -1 : 1;
+
+	/* fdt_setprop() puts a new property first, so the latest goes first */
+	return b->seq - a->seq;
+}
+
+static int fixup_put(char **outp, const char *limit, const void *data,
+		     int len)
+{
+	if (*outp + len > limit)
+		return -FDT_ERR_NOSPACE;
+	memmove(*outp, data, len);
+	*outp += len;
+
+	return 0;
+}
+
+static int fixup_put_prop(char **outp, const char *limit, int nameoff,
+			  const struct fdt_fixup_edit *edit)
+{
+	struct fdt_property *prop = (struct fdt_property *)*outp;
+	int size = sizeof(*prop) + ALIGN(edit->len, FDT_TAGSIZE);
+
+	if (*outp + size > limit)
+		return -FDT_ERR_NOSPACE;
+	prop->tag = cpu_to_fdt32(FDT_PROP);
+	prop->len = cpu_to_fdt32(edit->len);
+	prop->nameoff = cpu_to_fdt32(nameoff);
+	memcpy(prop->data, edit->data, edit->len);
+	memset(prop->data + edit->len, '\0', size - sizeof(*prop) - edit->len);
+	*outp += size;
+
+	return 0;
+}
+
+/* Return the offset just after the end of the node at @offset */
+static int fixup_skip_node(const void *blob, int offset)
+{
+	int depth = 0;
+	u32 tag;
+
+	do {
+		tag = fdt_next_tag(blob, offset, &offset);
+		if (offset < 0)
+			return offset;
+		if (tag == FDT_BEGIN_NODE)
+			depth++;
+		else if (tag == FDT_END_NODE)
+			depth--;
+		else if (tag == FDT_END)
+			return -FDT_ERR_BADSTRUCTURE;
+	} while (depth);
+
+	return offset;
+}
+
+/*
+ * Copy the structure block down to @outp, applying the (sorted) edits. The
+ * parts between edits are copied as they are. The output may overlap the
+ * input, but must not overtake it.
+ */
+static int fixup_copy_struct(const void *blob, struct fdt_fixup_edit *edits,
+			     int count, char **outp)
+{
+	const char *in = blob + fdt_off_dt_struct(blob);
+	int size = fdt_size_dt_struct(blob);
+	const struct fdt_property *prop;
+	struct fdt_fixup_edit *edit;
+	int offset = 0, key, next, ret, i = 0;
+
+	while (i < count) {
+		edit = &edits[i];
+		key = fixup_key(edit);
+
+		/* drop any edits in a deleted node */
+		if (key < offset) {
+			i++;
+			continue;
+		}
+		ret = fixup_put(outp, in + key, in + offset, key - offset);
+		if (ret)
+			return ret;
+		offset = key;
+
+		if (edit->op == FIXUPO_DELNODE) {
+			next = fixup_skip_node(blob, offset);
+			if (next < 0)
+				return next;
+			offset = next;
+			i++;
+			continue;
+		}
+
+		fdt_next_tag(blob, offset, &next);
+		if (next < 0)
+			return next;
+		if (edit->prop >= 0) {
+			prop = (const struct fdt_property *)(in + offset);
+			if (edit->op == FIXUPO_SETPROP)
+				ret = fixup_put_prop(outp, in + next,
+						     fdt32_to_cpu(prop->nameoff),
+						     edit);
+			i++;
+		} else {
+			/* new properties go straight after the node's name */
+			ret = fixup_put(outp, in + next, in + offset,
+					next - offset);
+			for (; !ret && i < count && fixup_key(&edits[i]) == key;
+			     i++)
+				ret = fixup_put_prop(outp, in + next,
+						     edits[i].nameoff,
+						     &edits[i]);
+		}
+		if (ret)
+			return ret;
+		offset = next;
+	}
+
+	return fixup_put(outp, in + size, in + offset, size - offset);
+}
+
+/* Find a string in the strings block, returning its offset or -1 */
+static int fixup_find_string(const char *strtab, int strsize,
+			     const char *name)
+{
+	const char *p;
+
+	for (p = strtab; p < strtab + strsize; p += strlen(p) + 1) {
+		if (!strcmp(p, name))
+			return p - strtab;
+	}
+
+	return -1;
+}
+
+/*
+ * The tree is rebuilt in place. The structure and strings blocks are first
+ * moved to the end of the buffer, then the structure block is copied back
+ * down with the edits applied, followed by the strings.
+ */
+static int fixup_rebuild(struct fdt_fixup *fix)
+{
+	void *blob = fix->blob;
+	struct fdt_fixup_edit *edits, *edit, *from, *prev;
+	int count, grow, new_strsize, rsv_size, struct_off, struct_size;
+	int strsize, struct_src, strings_src, strings_off, totalsize, ret;
+	const char *strtab;
+	char *out;
+
+	alist_for_each_filter(edit, from, &fix->edits) {
+		if (edit->op != FIXUPO_NONE)
+			*from++ = *edit;
+		else
+			free(edit->data);
+	}
+	alist_update_end(&fix->edits, from);
+	edits = alist_start(&fix->edits, struct fdt_fixup_edit);
+	count = fix->edits.count;
+	qsort(edits, count, sizeof(*edits), fixup_cmp);
+
+	if (fix->bufsize < fdt_totalsize(blob))
+		return -FDT_ERR_NOSPACE;
+
+	/* put the blocks in the usual order, which is nearly always the case */
+	rsv_size = (fdt_num_mem_rsv(blob) + 1) *
+		sizeof(struct fdt_reserve_entry);
+	if (fdt_version(blob) < 17 ||
+	    fdt_off_mem_rsvmap(blob) + rsv_size > fdt_off_dt_struct(blob) ||
+	    fdt_off_dt_struct(blob) + fdt_size_dt_struct(blob) >
+	    fdt_off_dt_strings(blob)) {
+		ret = fdt_open_into(blob, blob, fix->bufsize);
+		if (ret)
+			return ret;
+	}
+	strtab = blob + fdt_off_dt_strings(blob);
+	strsize = fdt_size_dt_strings(blob);
+	struct_size = fdt_size_dt_struct(blob);
+
+	/*
+	 * Check the tree where it is edited, so that the copy cannot fail
+	 * part-way, and work out the most the tree can grow and the offsets
+	 * of new names
+	 */
+	grow = 0;
+	new_strsize = 0;
+	for (edit = edits; edit < edits + count; edit++) {
+		if (edit->op == FIXUPO_DELNODE)
+			ret = fixup_skip_node(blob, edit->node);
+		else
+			fdt_next_tag(blob, fixup_key(edit), &ret);
+		if (ret < 0)
+			return ret;
+		if (edit->op != FIXUPO_SETPROP)
+			continue;
+		if (edit->prop >= 0) {
+			grow += max(0, (int)ALIGN(edit->len, FDT_TAGSIZE) -
+				    (int)ALIGN(edit->oldlen, FDT_TAGSIZE));
+			continue;
+		}
+		grow += sizeof(struct fdt_property) +
+			ALIGN(edit->len, FDT_TAGSIZE);
+		edit->nameoff = fixup_find_string(strtab, strsize, edit->name);
+		for (prev = edits; edit->nameoff < 0 && prev < edit; prev++) {
+			if (prev->op == FIXUPO_SETPROP && prev->prop < 0 &&
+			    prev->nameoff >= strsize &&
+			    !strcmp(prev->name, edit->name))
+				edit->nameoff = prev->nameoff;
+		}
+		if (edit->nameoff < 0) {
+			edit->nameoff = strsize + new_strsize;
+			new_strsize += strlen(edit->name) + 1;
+		}
+	}
+
+	/*
+	 * The output must not overtake the input, nor the strings run past
+	 * the end of the buffer
+	 */
+	struct_off = fdt_off_mem_rsvmap(blob) + rsv_size;
+	strings_src = fix->bufsize - strsize;
+	struct_src = ALIGN_DOWN(strings_src - struct_size, FDT_TAGSIZE);
+	if (struct_off + grow + new_strsize > struct_src)
+		return -FDT_ERR_NOSPACE;
+
+	memmove(blob + strings_src, strtab, strsize);
+	memmove(blob + struct_src, blob + fdt_off_dt_struct(blob), struct_size);
+	totalsize = fdt_totalsize(blob);
+	fdt_set_totalsize(blob, fix->bufsize);
+	fdt_set_off_dt_struct(blob, struct_src);
+	fdt_set_off_dt_strings(blob, strings_src);
+
+	out = blob + struct_off;
+	ret = fixup_copy_struct(blob, edits, count, &out);
+	if (ret)
+		return ret;
+	struct_size = out - (char *)blob - struct_off;
+
+	strings_off = struct_off + struct_size;
+	memmove(blob + strings_off, blob + strings_src, strsize);
+	for (edit = edits; edit < edits + count; edit++) {
+		if (edit->op == FIXUPO_SETPROP && edit->prop < 0 &&
+		    edit->nameoff >= strsize)
+			strcpy(blob + strings_off + edit->nameoff, edit->name);
+	}
+
+	/* keep any free space */
+	totalsize = max(totalsize, strings_off + strsize + new_strsize);
+	fdt_set_totalsize(blob, totalsize);
+	fdt_set_off_dt_struct(blob, struct_off);
+	fdt_set_off_dt_strings(blob, strings_off);
+	fdt_set_size_dt_strings(blob, strsize + new_strsize);
+	fdt_set_size_dt_struct(blob, struct_size);
+	log_debug("fdt_fixup: %d edits, contents %x bytes\n", count,
+		  strings_off + strsize + new_strsize);
+
+	return 0;
+}
+
+static int fixup_apply(struct fdt_fixup *fix)
+{
+	struct fdt_fixup_edit *edit;
+	int ret;
+
+	alist_for_each(edit, &fix->edits) {
+		if (edit->op != FIXUPO_NONE &&
+		    (edit->op != FIXUPO_SETPROP || edit->prop < 0 ||
+		     edit->len != edit->oldlen))
+			return fixup_rebuild(fix);
+	}
+
+	/* nothing changes size, so just overwrite the values */
+	alist_for_each(edit, &fix->edits) {
+		if (edit->op != FIXUPO_SETPROP)
+			continue;
+		ret = fdt_setprop_inplace(fix->blob, edit->node, edit->name,
+					  edit->data, edit->len);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+int fdt_fixup_commit(struct fdt_fixup *fix)
+{
+	int ret;
+
+	ret = fix->err;
+	if (!ret)
+		ret = fixup_apply(fix);
+	fdt_fixup_abort(fix);
+
+	return ret;
+}
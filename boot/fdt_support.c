@@ -21,6 +21,7 @@
 #include <asm/global_data.h>
 #include <asm/unaligned.h>
 #include <linux/libfdt.h>
+#include <fdt_fixup.h>
 #include <fdt_support.h>
 #include <exports.h>
 #include <fdtdec.h>
@@ -329,6 +330,7 @@ __weak char *board_fdt_chosen_bootargs(void)
 int fdt_chosen(void *fdt)
 {
 	struct abuf buf = {};
+	struct fdt_fixup fix;
 	int   nodeoffset;
 	int   err;
 	char  *str;		/* used to set string properties */
@@ -353,38 +355,34 @@ int fdt_chosen(void *fdt)
 	    !IS_ENABLED(CONFIG_ARMV8_SEC_FIRMWARE_SUPPORT))
 		fdt_kaslrseed(fdt, false);
 
+	/* queue the properties so the tree is only rearranged once */
+	fdt_fixup_begin(&fix, fdt, 0);
 	if (IS_ENABLED(CONFIG_BOARD_RNG_SEED) && !board_rng_seed(&buf)) {
-		err = fdt_setprop(fdt, nodeoffset, "rng-seed",
+		fdt_fixup_setprop(&fix, nodeoffset, "rng-seed",
 				  abuf_data(&buf), abuf_size(&buf));
 		abuf_uninit(&buf);
-		if (err < 0) {
-			printf("WARNING: could not set rng-seed %s.\n",
-			       fdt_strerror(err));
-			return err;
-		}
 	}
 
 	str = board_fdt_chosen_bootargs();
-
-	if (str) {
-		err = fdt_setprop(fdt, nodeoffset, "bootargs", str,
-				  strlen(str) + 1);
-		if (err < 0) {
-			printf("WARNING: could not set bootargs %s.\n",
-			       fdt_strerror(err));
-			return err;
-		}
-	}
+	if (str)
+		fdt_fixup_setprop_string(&fix, nodeoffset, "bootargs", str);
 
 	/* add u-boot version */
-	err = fdt_setprop(fdt, nodeoffset, "u-boot,version", PLAIN_VERSION,
-			  strlen(PLAIN_VERSION) + 1);
+	fdt_fixup_setprop_string(&fix, nodeoffset, "u-boot,version",
+				 PLAIN_VERSION);
+
+	err = fdt_fixup_commit(&fix);
 	if (err < 0) {
-		printf("WARNING: could not set u-boot,version %s.\n",
+		printf("WARNING: could not set /chosen properties %s.\n",
 		       fdt_strerror(err));
 		return err;
 	}
 
+	/* the commit may have moved things around */
+	nodeoffset = fdt_path_offset(fdt, "/chosen");
+	if (nodeoffset < 0)
+		return nodeoffset;
+
 	return fdt_fixup_stdout(fdt, nodeoffset);
 }
 
@@ -616,30 +614,22 @@ void fdt_fixup_ethernet(void *fdt)
 	char mac[16];
 	const char *path;
 	unsigned char mac_addr[ARP_HLEN];
-	int offset;
+	struct fdt_fixup fix;
+	int aliases, nodeoff, err;
 #ifdef FDT_SEQ_MACADDR_FROM_ENV
-	int nodeoff;
 	const struct fdt_property *fdt_prop;
 #endif
 
-	if (fdt_path_offset(fdt, "/aliases") < 0)
+	aliases = fdt_path_offset(fdt, "/aliases");
+	if (aliases < 0)
 		return;
 
-	/* Cycle through all aliases */
-	for (prop = 0; ; prop++) {
+	/* The edits are queued, so the aliases stay put while cycling */
+	fdt_fixup_begin(&fix, fdt, 0);
+	fdt_for_each_property_offset(prop, fdt, aliases) {
 		const char *name;
 
-		/* FDT might have been edited, recompute the offset */
-		offset = fdt_first_property_offset(fdt,
-			fdt_path_offset(fdt, "/aliases"));
-		/* Select property number 'prop' */
-		for (j = 0; j < prop; j++)
-			offset = fdt_next_property_offset(fdt, offset);
-
-		if (offset < 0)
-			break;
-
-		path = fdt_getprop_by_offset(fdt, offset, &name, NULL);
+		path = fdt_getprop_by_offset(fdt, prop, &name, NULL);
 		if (!strncmp(name, "ethernet", 8)) {
 			/* Treat plain "ethernet" same as "ethernet0". */
 			if (!strcmp(name, "ethernet")
@@ -660,8 +650,8 @@ void fdt_fixup_ethernet(void *fdt)
 			} else {
 				continue;
 			}
-#ifdef FDT_SEQ_MACADDR_FROM_ENV
 			nodeoff = fdt_path_offset(fdt, path);
+#ifdef FDT_SEQ_MACADDR_FROM_ENV
 			fdt_prop = fdt_get_property(fdt, nodeoff, "status",
 						    NULL);
 			if (fdt_prop && !strcmp(fdt_prop->data, "disabled"))
@@ -679,12 +669,23 @@ void fdt_fixup_ethernet(void *fdt)
 					tmp = (*end) ? end + 1 : end;
 			}
 
-			do_fixup_by_path(fdt, path, "mac-address",
-					 &mac_addr, 6, 0);
-			do_fixup_by_path(fdt, path, "local-mac-address",
-					 &mac_addr, 6, 1);
+			if (nodeoff < 0) {
+				printf("Unable to update MAC address %s, err=%s\n",
+				       path, fdt_strerror(nodeoff));
+				continue;
+			}
+			if (fdt_getprop(fdt, nodeoff, "mac-address", NULL))
+				fdt_fixup_setprop(&fix, nodeoff, "mac-address",
+						  &mac_addr, 6);
+			fdt_fixup_setprop(&fix, nodeoff, "local-mac-address",
+					  &mac_addr, 6);
 		}
 	}
+
+	err = fdt_fixup_commit(&fix);
+	if (err)
+		printf("Unable to update MAC addresses, err=%s\n",
+		       fdt_strerror(err));
 }
 
 int fdt_record_loadable(void *blob, u32 index, const char *name,
@@ -2156,6 +2157,12 @@ int fdt_fixup_display(void *blob, const char *path, const char *display)
  * in the case of an error
  */
 int fdt_overlay_apply_verbose(void *fdt, void *fdto)
+{
+	return fdt_overlay_batch_apply_verbose(NULL, fdt, fdto);
+}
+
+int fdt_overlay_batch_apply_verbose(struct fdt_overlay_batch *batch,
+				    void *fdt, void *fdto)
 {
 	int err;
 	bool has_symbols;
@@ -2163,7 +2170,10 @@ int fdt_overlay_apply_verbose(void *fdt, void *fdto)
 	err = fdt_path_offset(fdt, "/__symbols__");
 	has_symbols = err >= 0;
 
-	err = fdt_overlay_apply(fdt, fdto);
+	if (batch)
+		err = fdt_overlay_batch_apply(batch, fdt, fdto);
+	else
+		err = fdt_overlay_apply(fdt, fdto);
 	if (err < 0) {
 		printf("failed on fdt_overlay_apply(): %s\n",
 				fdt_strerror(err));
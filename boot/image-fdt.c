@@ -8,6 +8,7 @@
  * Wolfgang Denk, DENX Software Engineering, wd@denx.de.
  */
 
+#include <bootstage.h>
 #include <command.h>
 #include <fdt_support.h>
 #include <fdtdec.h>
@@ -85,6 +86,23 @@ static void boot_fdt_reserve_region(u64 addr, u64 size, enum lmb_flags flags)
 	}
 }
 
+/*
+ * Add a region to the list to be reserved, or reserve it straight away if the
+ * list cannot be expanded
+ */
+static void boot_fdt_add_region(struct alist *rgns, u64 addr, u64 size,
+				enum lmb_flags flags)
+{
+	struct lmb_region rgn = {
+		.base = addr,
+		.size = size,
+		.flags = flags,
+	};
+
+	if (!alist_add(rgns, rgn))
+		boot_fdt_reserve_region(addr, size, flags);
+}
+
 /**
  * boot_fdt_add_mem_rsv_regions - Mark the memreserve and reserved-memory
  * sections as unusable
@@ -93,6 +111,9 @@ static void boot_fdt_reserve_region(u64 addr, u64 size, enum lmb_flags flags)
  * Adds the and reserved-memorymemreserve regions in the dtb to the lmb block.
  * Adding the memreserve regions prevents u-boot from using them to store the
  * initrd or the fdt blob.
+ *
+ * The regions are collected and then reserved together, since there may be
+ * many of them.
  */
 void boot_fdt_add_mem_rsv_regions(void *fdt_blob)
 {
@@ -101,16 +122,20 @@ void boot_fdt_add_mem_rsv_regions(void *fdt_blob)
 	int nodeoffset, subnode;
 	struct fdt_resource res;
 	enum lmb_flags flags;
+	struct lmb_region *rgn;
+	struct alist rgns;
+	long skipped;
 
 	if (fdt_check_header(fdt_blob) != 0)
 		return;
+	alist_init_struct(&rgns, struct lmb_region);
 
 	/* process memreserve sections */
 	total = fdt_num_mem_rsv(fdt_blob);
 	for (i = 0; i < total; i++) {
 		if (fdt_get_mem_rsv(fdt_blob, i, &addr, &size) != 0)
 			continue;
-		boot_fdt_reserve_region(addr, size, LMB_NOOVERWRITE);
+		boot_fdt_add_region(&rgns, addr, size, LMB_NOOVERWRITE);
 	}
 
 	/* process reserved-memory */
@@ -128,12 +153,26 @@ void boot_fdt_add_mem_rsv_regions(void *fdt_blob)
 					flags = LMB_NOMAP;
 				addr = res.start;
 				size = res.end - res.start + 1;
-				boot_fdt_reserve_region(addr, size, flags);
+				boot_fdt_add_region(&rgns, addr, size, flags);
 			}
 
 			subnode = fdt_next_subnode(fdt_blob, subnode);
 		}
 	}
+
+	skipped = lmb_reserve_regions(rgns.data, rgns.count);
+	if (skipped == -ENOMEM || skipped == -E2BIG) {
+		/* Fall back to reserving them one at a time */
+		alist_for_each(rgn, &rgns)
+			boot_fdt_reserve_region(rgn->base, rgn->size,
+						rgn->flags);
+	} else if (skipped < 0) {
+		puts("ERROR: reserving fdt memory regions failed\n");
+	} else {
+		debug("   reserved %u fdt memory regions, %ld already present\n",
+		      rgns.count, skipped);
+	}
+	alist_uninit(&rgns);
 }
 
 /**
@@ -571,6 +610,7 @@ int image_setup_libfdt(struct bootm_headers *images, void *blob, bool lmb)
 	ulong *initrd_end = &images->initrd_end;
 	int ret, fdt_ret, of_size;
 
+	bootstage_start(BOOTSTAGE_ID_ACCUM_FDT_FIXUP, "fdt_fixup");
 	if (IS_ENABLED(CONFIG_OF_ENV_SETUP)) {
 		const char *fdt_fixup;
 
@@ -681,9 +721,11 @@ int image_setup_libfdt(struct bootm_headers *images, void *blob, bool lmb)
 	if (IS_ENABLED(CONFIG_OF_BOARD_SETUP))
 		ft_board_setup_ex(blob, gd->bd);
 #endif
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_FDT_FIXUP);
 
 	return 0;
 err:
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_FDT_FIXUP);
 	printf(" - must RESET the board to recover.\n\n");
 
 	return ret;
@@ -2346,6 +2346,7 @@ int boot_get_fdt_fit(struct bootm_headers *images, ulong addr,
 	const char *uconfig;
 	const char *uname;
 	void *base, *ov, *ovcopy = NULL;
+	struct fdt_overlay_batch batch = {}, *bp = NULL;
 	int i, err, noffset, ov_noffset;
 #endif
 
@@ -2400,6 +2401,13 @@ int boot_get_fdt_fit(struct bootm_headers *images, ulong addr,
 
 	base = map_sysmem(load, len);
 
+	/*
+	 * index the base FDT once, rather than for each overlay; if that
+	 * fails, each overlay is applied on its own
+	 */
+	if (!fdt_overlay_batch_init(&batch, base))
+		bp = &batch;
+
 	/* apply extra configs in FIT first, followed by args */
 	for (i = 1; ; i++) {
 		if (i < count) {
@@ -2468,7 +2476,7 @@ int boot_get_fdt_fit(struct bootm_headers *images, ulong addr,
 		}
 
 		/* the verbose method prints out messages on error */
-		err = fdt_overlay_apply_verbose(base, ovcopy);
+		err = fdt_overlay_batch_apply_verbose(bp, base, ovcopy);
 		if (err < 0) {
 			fdt_noffset = err;
 			goto out;
@@ -2493,6 +2501,7 @@ out:
 
 #ifdef CONFIG_OF_LIBFDT_OVERLAY
 	free(ovcopy);
+	fdt_overlay_batch_uninit(&batch);
 #endif
 	free(fit_uname_config_copy);
 	return fdt_noffset;
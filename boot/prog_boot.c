@@ -38,6 +38,9 @@ int bootstd_prog_boot(void)
 	show_bootmeths();
 	flags = BOOTFLOWIF_HUNT | BOOTFLOWIF_SHOW | BOOTFLOWIF_SKIP_GLOBAL;
 
+	if (CONFIG_IS_ENABLED(BOOTFLOW_CACHE))
+		bootflow_cache_run(true);
+
 	bootstd_clear_glob();
 	for (i = 0, ret = bootflow_scan_first(NULL, NULL, &iter, flags, &bflow);
 	     i < 1000 && ret != -ENODEV;
@@ -357,6 +357,7 @@ static void label_boot_fdtoverlay(struct pxe_context *ctx,
 				  struct pxe_label *label)
 {
 	char *fdtoverlay = label->fdtoverlays;
+	struct fdt_overlay_batch batch = {}, *bp = NULL;
 	struct fdt_header *working_fdt;
 	char *fdtoverlay_addr_env;
 	ulong fdtoverlay_addr;
@@ -379,6 +380,10 @@ static void label_boot_fdtoverlay(struct pxe_context *ctx,
 
 	fdtoverlay_addr = hextoul(fdtoverlay_addr_env, NULL);
 
+	/* Index the main fdt once for all the overlays */
+	if (!fdt_overlay_batch_init(&batch, working_fdt))
+		bp = &batch;
+
 	/* Cycle over the overlay files and apply them in order */
 	do {
 		struct fdt_header *blob;
@@ -422,7 +427,7 @@ static void label_boot_fdtoverlay(struct pxe_context *ctx,
 			goto skip_overlay;
 		}
 
-		err = fdt_overlay_apply_verbose(working_fdt, blob);
+		err = fdt_overlay_batch_apply_verbose(bp, working_fdt, blob);
 		if (err) {
 			printf("Failed to apply overlay %s, skipping\n",
 			       overlayfile);
@@ -433,6 +438,8 @@ skip_overlay:
 		if (end)
 			free(overlayfile);
 	} while ((fdtoverlay = strstr(fdtoverlay, " ")));
+
+	fdt_overlay_batch_uninit(&batch);
 }
 #endif
 
@@ -137,6 +137,7 @@ static int do_bootflow_scan(struct cmd_tbl *cmdtp, int flag, int argc,
 	bool list = false, no_hunter = false, menu = false, text_mode = false;
 	int num_valid = 0;
 	const char *label = NULL;
+	uint hunters_used;
 	bool has_args;
 	int ret, i;
 	int flags;
@@ -183,6 +184,11 @@ static int do_bootflow_scan(struct cmd_tbl *cmdtp, int flag, int argc,
 	if (!no_hunter)
 		flags |= BOOTFLOWIF_HUNT;
 
+	/* Try the bootflow which was booted last time, before scanning */
+	if (CONFIG_IS_ENABLED(BOOTFLOW_CACHE) && boot && !menu && !dev &&
+	    !label)
+		bootflow_cache_run(list);
+
 	/*
 	 * If we have a device, just scan for bootflows attached to that device
 	 */
@@ -200,6 +206,7 @@ static int do_bootflow_scan(struct cmd_tbl *cmdtp, int flag, int argc,
 		bootdev_clear_bootflows(dev);
 	else
 		bootstd_clear_glob();
+	hunters_used = std->hunters_used;
 	for (i = 0,
 	     ret = bootflow_scan_first(dev, label, &iter, flags, &bflow);
 	     i < 1000 && ret != -ENODEV;
@@ -217,9 +224,15 @@ static int do_bootflow_scan(struct cmd_tbl *cmdtp, int flag, int argc,
 		if (!menu && boot && !bflow.err)
 			bootflow_run_boot(&iter, &bflow);
 	}
+	/* show the hunters which ran or were started in this scan */
+	hunters_used = (std->hunters_used & ~hunters_used) |
+		std->hunters_started;
 	bootflow_iter_uninit(&iter);
-	if (list)
+	if (list) {
 		show_footer(i, num_valid);
+		if ((flags & BOOTFLOWIF_HUNT) && hunters_used)
+			bootdev_list_hunt_times(std, hunters_used);
+	}
 
 	if (IS_ENABLED(CONFIG_CMD_BOOTFLOW_FULL) && IS_ENABLED(CONFIG_EXPO)) {
 		if (!num_valid && !list) {
@@ -15,7 +15,8 @@
 
 static LIST_HEAD(extension_list);
 
-static int extension_apply(struct extension *extension)
+static int extension_apply(struct extension *extension,
+			   struct fdt_overlay_batch *batch)
 {
 	char *overlay_cmd;
 	ulong extrasize, overlay_addr;
@@ -54,7 +55,7 @@ static int extension_apply(struct extension *extension)
 		return CMD_RET_FAILURE;
 
 	/* apply method prints messages on error */
-	if (fdt_overlay_apply_verbose(working_fdt, blob))
+	if (fdt_overlay_batch_apply_verbose(batch, working_fdt, blob))
 		return CMD_RET_FAILURE;
 
 	return CMD_RET_SUCCESS;
@@ -121,12 +122,19 @@ static int do_extension_apply(struct cmd_tbl *cmdtp, int flag,
 		return CMD_RET_USAGE;
 
 	if (strcmp(argv[1], "all") == 0) {
+		struct fdt_overlay_batch batch = {}, *bp = NULL;
+
+		/* index the FDT once for all the overlays */
+		if (working_fdt && !fdt_overlay_batch_init(&batch, working_fdt))
+			bp = &batch;
+
 		ret = CMD_RET_FAILURE;
 		list_for_each_entry(extension, &extension_list, list) {
-			ret = extension_apply(extension);
+			ret = extension_apply(extension, bp);
 			if (ret != CMD_RET_SUCCESS)
 				break;
 		}
+		fdt_overlay_batch_uninit(&batch);
 	} else {
 		extension_id = simple_strtol(argv[1], NULL, 10);
 		list_for_each(entry, &extension_list) {
@@ -142,7 +150,7 @@ static int do_extension_apply(struct cmd_tbl *cmdtp, int flag,
 			return CMD_RET_FAILURE;
 		}
 
-		ret = extension_apply(extension);
+		ret = extension_apply(extension, NULL);
 	}
 
 	return ret;
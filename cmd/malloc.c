@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Command-line access to malloc() statistics and trace
+ */
+
+#include <command.h>
+#include <display_options.h>
+#include <malloc.h>
+
+static void malloc_show_size(const char *name, ulong size)
+{
+	printf("%-14s= ", name);
+	print_size(size, "\n");
+}
+
+static int do_malloc_info(struct cmd_tbl *cmdtp, int flag, int argc,
+			  char *const argv[])
+{
+	struct malloc_info info;
+	uint frag = 0;
+
+	if (!IS_ENABLED(CONFIG_MALLOC_STATS)) {
+		printf("Statistics not enabled\n");
+		return CMD_RET_FAILURE;
+	}
+	if (malloc_get_info(&info))
+		return CMD_RET_FAILURE;
+
+	/* proportion of free memory which is not in the largest free chunk */
+	if (info.free_bytes)
+		frag = (u64)(info.free_bytes - info.largest_free) * 100 /
+			info.free_bytes;
+
+	malloc_show_size("total", info.total_bytes);
+	malloc_show_size("heap", info.heap_bytes);
+	malloc_show_size("in use", info.in_use_bytes);
+	malloc_show_size("peak", info.peak_bytes);
+	malloc_show_size("free", info.free_bytes);
+	malloc_show_size("largest free", info.largest_free);
+	printf("%-14s= %lu\n", "free chunks", info.free_chunks);
+	printf("%-14s= %u%%\n", "fragmentation", frag);
+	printf("%-14s= %lu\n", "allocations", info.count);
+	printf("%-14s= %lu\n", "calls", info.calls);
+	printf("%-14s= %lu\n", "frees", info.frees);
+
+	return 0;
+}
+
+static const char *const malloc_trace_ops[] = {
+	[MALLOC_TRACE_MALLOC] = "malloc",
+	[MALLOC_TRACE_CALLOC] = "calloc",
+	[MALLOC_TRACE_REALLOC] = "realloc",
+	[MALLOC_TRACE_MEMALIGN] = "memalign",
+	[MALLOC_TRACE_FREE] = "free",
+};
+
+static void malloc_trace_show(void)
+{
+	const struct malloc_trace_rec *rec;
+	bool enabled;
+	uint i;
+
+	/* Don't record the calls made while showing the trace */
+	enabled = malloc_trace_enable(false);
+	printf("%10s  %-8s  %16s  %16s  %s\n", "Time (us)", "Call", "Caller",
+	       "Pointer", "Size");
+	for (i = 0; (rec = malloc_trace_get(i)); i++) {
+		printf("%10lu  %-8s  %16lx  %16lx  %lu\n", rec->time,
+		       malloc_trace_ops[rec->op], rec->caller, rec->ptr,
+		       rec->size);
+	}
+	printf("%u records, %lu dropped\n", i, malloc_trace_dropped());
+	malloc_trace_enable(enabled);
+}
+
+static int do_malloc_trace(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	if (!IS_ENABLED(CONFIG_MALLOC_TRACE)) {
+		printf("Trace not enabled\n");
+		return CMD_RET_FAILURE;
+	}
+
+	if (argc < 2)
+		malloc_trace_show();
+	else if (!strcmp(argv[1], "on"))
+		malloc_trace_enable(true);
+	else if (!strcmp(argv[1], "off"))
+		malloc_trace_enable(false);
+	else if (!strcmp(argv[1], "clear"))
+		malloc_trace_clear();
+	else
+		return CMD_RET_USAGE;
+
+	return 0;
+}
+
+U_BOOT_LONGHELP(malloc,
+	"info   - show statistics about the malloc() pool\n"
+	"malloc trace [on|off|clear] - show, start, stop or clear the trace of calls");
+
+U_BOOT_CMD_WITH_SUBCMDS(malloc, "malloc() pool", malloc_help_text,
+	U_BOOT_SUBCMD_MKENT(info, 1, 1, do_malloc_info),
+	U_BOOT_SUBCMD_MKENT(trace, 2, 1, do_malloc_trace));
@@ -316,6 +316,7 @@ static int do_spi_flash_read_write(int argc, char *const argv[])
 		ret = spi_flash_update(flash, offset, len, buf);
 	} else if (strncmp(argv[0], "read", 4) == 0 ||
 			strncmp(argv[0], "write", 5) == 0) {
+		ulong start, delta;
 		int read;
 
 		if (CONFIG_IS_ENABLED(LMB)) {
@@ -326,17 +327,20 @@ static int do_spi_flash_read_write(int argc, char *const argv[])
 		}
 
 		read = strncmp(argv[0], "read", 4) == 0;
+		start = get_timer(0);
 		if (read)
 			ret = spi_flash_read(flash, offset, len, buf);
 		else
 			ret = spi_flash_write(flash, offset, len, buf);
+		delta = get_timer(start);
 
 		printf("SF: %zu bytes @ %#x %s: ", (size_t)len, (u32)offset,
 		       read ? "Read" : "Written");
 		if (ret)
 			printf("ERROR %d\n", ret);
 		else
-			printf("OK\n");
+			printf("OK in %lu.%03lus, %lu B/s\n", delta / 1000,
+			       delta % 1000, bytes_per_second(len, start));
 	}
 
 	unmap_physmem(buf, len);
@@ -585,6 +589,45 @@ static int do_spi_flash_test(int argc, char *const argv[])
 	return 0;
 }
 
+static int do_spi_flash_tune(int argc, char *const argv[])
+{
+	struct spi_flash_tune tune;
+	unsigned long offset, len;
+	ulong max_hz = 0;
+	char *endp;
+	int ret;
+
+	if (argc < 3 || argc > 4)
+		return CMD_RET_USAGE;
+	offset = hextoul(argv[1], &endp);
+	if (*argv[1] == 0 || *endp != 0)
+		return CMD_RET_USAGE;
+	len = hextoul(argv[2], &endp);
+	if (*argv[2] == 0 || *endp != 0)
+		return CMD_RET_USAGE;
+	if (argc == 4) {
+		max_hz = dectoul(argv[3], &endp);
+		if (*argv[3] == 0 || *endp != 0)
+			return CMD_RET_USAGE;
+	}
+
+	ret = spi_flash_tune(flash, offset, len, max_hz, &tune);
+	if (ret) {
+		printf("Tuning failed (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+	printf("Using %s at %u Hz, %lu B/s\n", spi_flash_tune_name(tune.hwcap),
+	       tune.hz, tune.rate);
+
+	ret = spi_flash_tune_save(flash, &tune);
+	if (ret) {
+		printf("Cannot record setting (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
 static int do_spi_flash(struct cmd_tbl *cmdtp, int flag, int argc,
 			char *const argv[])
 {
@@ -617,6 +660,8 @@ static int do_spi_flash(struct cmd_tbl *cmdtp, int flag, int argc,
 		ret = do_spi_protect(argc, argv);
 	else if (IS_ENABLED(CONFIG_CMD_SF_TEST) && !strcmp(cmd, "test"))
 		ret = do_spi_flash_test(argc, argv);
+	else if (IS_ENABLED(CONFIG_SPI_FLASH_TUNE) && !strcmp(cmd, "tune"))
+		ret = do_spi_flash_tune(argc, argv);
 	else
 		ret = CMD_RET_USAGE;
 
@@ -644,6 +689,11 @@ U_BOOT_LONGHELP(sf,
 #endif
 #ifdef CONFIG_CMD_SF_TEST
 	"\nsf test offset len		- run a very basic destructive test"
+#endif
+#ifdef CONFIG_SPI_FLASH_TUNE
+	"\nsf tune offset len [hz]		- find the fastest read setting which\n"
+	"					  reads `len' bytes at `offset'\n"
+	"					  correctly and record it"
 #endif
 	);
 
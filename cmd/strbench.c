@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Measure the speed of the memory and string functions
+ */
+
+#include <command.h>
+#include <display_options.h>
+#include <div64.h>
+#include <malloc.h>
+#include <time.h>
+#include <vsprintf.h>
+#include <linux/sizes.h>
+#include <linux/string.h>
+
+#define STRBENCH_SIZE	SZ_1M
+#define STRBENCH_COUNT	16
+
+/* Room after the buffers for the unaligned copy and the string terminator */
+#define STRBENCH_SLACK	8
+
+/*
+ * Each function runs on @size bytes and returns true if the result is as
+ * expected. @src holds a nul-terminated string of @size characters, none of
+ * which is 'z'. The functions run in order, so memcmp() finds @dst equal to
+ * @src after memcpy() has run.
+ */
+static bool strbench_memset(u8 *dst, const u8 *src, ulong size)
+{
+	return memset(dst, 0xa5, size) == dst;
+}
+
+static bool strbench_memcpy_unaligned(u8 *dst, const u8 *src, ulong size)
+{
+	return memcpy(dst, src + 1, size) == dst;
+}
+
+static bool strbench_memmove(u8 *dst, const u8 *src, ulong size)
+{
+	return memmove(dst + 1, dst, size) == dst + 1;
+}
+
+static bool strbench_memcpy(u8 *dst, const u8 *src, ulong size)
+{
+	return memcpy(dst, src, size) == dst;
+}
+
+static bool strbench_memcmp(u8 *dst, const u8 *src, ulong size)
+{
+	return !memcmp(dst, src, size);
+}
+
+static bool strbench_memchr(u8 *dst, const u8 *src, ulong size)
+{
+	return !memchr(src, '\0', size);
+}
+
+static bool strbench_strlen(u8 *dst, const u8 *src, ulong size)
+{
+	return strlen((const char *)src) == size;
+}
+
+static bool strbench_strchr(u8 *dst, const u8 *src, ulong size)
+{
+	return !strchr((const char *)src, 'z');
+}
+
+static const struct {
+	const char *name;
+	bool (*func)(u8 *dst, const u8 *src, ulong size);
+} strbench_funcs[] = {
+	{ "memset", strbench_memset },
+	{ "memcpy unaligned", strbench_memcpy_unaligned },
+	{ "memmove", strbench_memmove },
+	{ "memcpy", strbench_memcpy },
+	{ "memcmp", strbench_memcmp },
+	{ "memchr", strbench_memchr },
+	{ "strlen", strbench_strlen },
+	{ "strchr", strbench_strchr },
+};
+
+static int do_strbench(struct cmd_tbl *cmdtp, int flag, int argc,
+		       char *const argv[])
+{
+	ulong size = STRBENCH_SIZE, count = STRBENCH_COUNT;
+	ulong start, us, i, j;
+	int ret = CMD_RET_FAILURE;
+	u8 *dst, *src;
+	bool ok;
+
+	if (argc > 1)
+		size = hextoul(argv[1], NULL);
+	if (argc > 2)
+		count = dectoul(argv[2], NULL);
+	if (!size || !count)
+		return CMD_RET_USAGE;
+
+	dst = malloc(size + STRBENCH_SLACK);
+	src = malloc(size + STRBENCH_SLACK);
+	if (!dst || !src) {
+		printf("Out of memory\n");
+		goto out;
+	}
+	for (i = 0; i < size + STRBENCH_SLACK; i++)
+		src[i] = 'a' + i % 25;
+	src[size] = '\0';
+
+	printf("%lu bytes, %lu times\n", size, count);
+	for (i = 0; i < ARRAY_SIZE(strbench_funcs); i++) {
+		ok = true;
+		start = timer_get_us();
+		for (j = 0; j < count; j++)
+			ok &= strbench_funcs[i].func(dst, src, size);
+		us = max(timer_get_us() - start, 1UL);
+		if (!ok) {
+			printf("%s: wrong result\n", strbench_funcs[i].name);
+			goto out;
+		}
+		printf("%-17s %8lu us (", strbench_funcs[i].name, us);
+		print_size(lldiv((u64)size * count * 1000000, us), "/s)\n");
+	}
+	ret = 0;
+
+out:
+	free(src);
+	free(dst);
+
+	return ret;
+}
+
+U_BOOT_CMD(
+	strbench,	3,	1,	do_strbench,
+	"measure the speed of memory and string functions",
+	"[size [count]]\n"
+	"    - run each function 'count' times on 'size' bytes (hex)"
+);
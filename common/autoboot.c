@@ -14,6 +14,7 @@
 #include <errno.h>
 #include <fdtdec.h>
 #include <hash.h>
+#include <initcall.h>
 #include <log.h>
 #include <malloc.h>
 #include <memalign.h>
@@ -41,6 +42,13 @@ DECLARE_GLOBAL_DATA_PTR;
 static int stored_bootdelay;
 static int menukey;
 
+/* Wait while polling for a key, running late initcalls if there are any */
+static void autoboot_idle(void)
+{
+	if (!initcall_late_idle())
+		udelay(10000);
+}
+
 #if defined(CONFIG_AUTOBOOT_STOP_STR_CRYPT)
 #define AUTOBOOT_STOP_STR_CRYPT	CONFIG_AUTOBOOT_STOP_STR_CRYPT
 #else
@@ -120,7 +128,7 @@ static int passwd_abort_crypt(uint64_t etime)
 				presskey_len++;
 			}
 		}
-		udelay(10000);
+		autoboot_idle();
 	} while (never_timeout || get_ticks() <= etime);
 
 	return abort;
@@ -215,7 +223,7 @@ static int passwd_abort_sha256(uint64_t etime)
 			if (slow_equals(sha, sha_env, SHA256_SUM_LEN))
 				abort = 1;
 		}
-		udelay(10000);
+		autoboot_idle();
 	} while (!abort && get_ticks() <= etime);
 
 	free(presskey);
@@ -303,7 +311,7 @@ static int passwd_abort_key(uint64_t etime)
 				abort = 1;
 			}
 		}
-		udelay(10000);
+		autoboot_idle();
 	} while (!abort && get_ticks() <= etime);
 
 	return abort;
@@ -402,7 +410,7 @@ static int abortboot_single_key(int bootdelay)
 					menukey = key;
 				break;
 			}
-			udelay(10000);
+			autoboot_idle();
 		} while (!abort && get_timer(ts) < 1000);
 
 		printf("\b\b\b%2d ", bootdelay);
@@ -502,6 +510,7 @@ void autoboot_command(const char *s)
 		if (lock)
 			prev = disable_ctrlc(1); /* disable Ctrl-C checking */
 
+		initcall_late_finish();
 		run_command_list(s, -1, 0);
 
 		if (lock)
@@ -511,7 +520,9 @@ void autoboot_command(const char *s)
 	if (IS_ENABLED(CONFIG_AUTOBOOT_USE_MENUKEY) &&
 	    menukey == AUTOBOOT_MENUKEY) {
 		s = env_get("menucmd");
-		if (s)
+		if (s) {
+			initcall_late_finish();
 			run_command_list(s, -1, 0);
+		}
 	}
 }
@@ -573,6 +573,8 @@ static int dm_announce(void)
 static int run_main_loop(void)
 {
 #ifdef CONFIG_SANDBOX
+	/* commands given on the command line run before main_loop() */
+	initcall_late_finish();
 	sandbox_main_loop_init();
 #endif
 
@@ -726,6 +728,9 @@ static init_fnc_t init_sequence_r[] = {
 	api_init,
 #endif
 	console_init_r,		/* fully init console as a device */
+#if CONFIG_IS_ENABLED(INITCALL_GROUPS)
+	initcall_late_start,
+#endif
 #ifdef CONFIG_DISPLAY_BOARDINFO_LATE
 	console_announce_r,
 	show_board_info,
@@ -753,7 +758,7 @@ static init_fnc_t init_sequence_r[] = {
 #ifdef CONFIG_BITBANGMII
 	bb_miiphy_init,
 #endif
-#ifdef CONFIG_PCI_ENDPOINT
+#if defined(CONFIG_PCI_ENDPOINT) && !CONFIG_IS_ENABLED(INITCALL_GROUPS)
 	pci_ep_init,
 #endif
 #if defined(CONFIG_CMD_NET)
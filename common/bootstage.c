@@ -220,6 +220,40 @@ uint32_t bootstage_accum(enum bootstage_id id)
 	return duration;
 }
 
+void bootstage_accum_add(enum bootstage_id id, const char *name,
+			 uint32_t time_us)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_record *rec = ensure_id(data, id);
+
+	if (!rec)
+		return;
+	if (!rec->start_us)
+		rec->start_us = timer_get_boot_us() ?: 1;
+	rec->name = name;
+	rec->time_us += time_us;
+}
+
+void bootstage_add_duration(const char *name, uint32_t start_us,
+			    uint32_t time_us)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_record *rec;
+
+	if (!data)
+		return;
+	if (data->rec_count >= RECORD_COUNT) {
+		log_debug("Bootstage space exhausted\n");
+		return;
+	}
+	rec = &data->record[data->rec_count++];
+	rec->id = data->next_id++;
+	rec->name = name;
+	rec->flags = BOOTSTAGEF_ALLOC;
+	rec->start_us = start_us ?: 1;
+	rec->time_us = time_us;
+}
+
 /**
  * Get a record name as a printable string
  *
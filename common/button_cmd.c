@@ -7,6 +7,7 @@
 #include <button.h>
 #include <command.h>
 #include <env.h>
+#include <initcall.h>
 #include <log.h>
 #include <stdio.h>
 
@@ -76,6 +77,7 @@ void process_button_cmds(void)
 			continue;
 
 		log_info("BTN '%s'> %s\n", cmd.btn_name, cmd.cmd);
+		initcall_late_finish();
 		run_command(cmd.cmd, CMD_FLAG_ENV);
 		/* Don't run commands for multiple buttons */
 		return;
@@ -18,7 +18,9 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <string.h>
+#include <time.h>
 #include <asm/io.h>
+#include <linux/list.h>
 #include <valgrind/memcheck.h>
 
 #ifdef DEBUG
@@ -33,12 +35,24 @@ void malloc_stats();
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/* The public routines are wrappers, to keep statistics or to use slabs */
+#if CONFIG_IS_ENABLED(MALLOC_STATS) || CONFIG_IS_ENABLED(MALLOC_SLAB) || \
+	CONFIG_IS_ENABLED(MALLOC_TRACE)
+#define MALLOC_WRAP
+#endif
+
+#if defined(MCHECK_HEAP_PROTECTION) && defined(MALLOC_WRAP)
+ #error "MALLOC_STATS/SLAB/TRACE cannot be used with MCHECK_HEAP_PROTECTION"
+#endif
+
 #ifdef MCHECK_HEAP_PROTECTION
  #define STATIC_IF_MCHECK static
  #undef MALLOC_COPY
  #undef MALLOC_ZERO
 static inline void MALLOC_ZERO(void *p, size_t sz) { memset(p, 0, sz); }
 static inline void MALLOC_COPY(void *dest, const void *src, size_t sz) { memcpy(dest, src, sz); }
+#elif defined(MALLOC_WRAP)
+ #define STATIC_IF_MCHECK static
 #else
  #define STATIC_IF_MCHECK
  #define mALLOc_impl mALLOc
@@ -48,6 +62,14 @@ static inline void MALLOC_COPY(void *dest, const void *src, size_t sz) { memcpy(
  #define cALLOc_impl cALLOc
 #endif
 
+STATIC_IF_MCHECK void fREe_impl(Void_t *mem);
+#if CONFIG_IS_ENABLED(MALLOC_SLAB)
+static void slab_reset(void);
+#endif
+#if CONFIG_IS_ENABLED(MALLOC_TRACE)
+static void malloc_trace_reset(void);
+#endif
+
 /*
   Emulation of sbrk for WIN32
   All code within the ifdef WIN32 is untested by me.
@@ -607,6 +629,12 @@ void mem_malloc_init(ulong start, ulong size)
 #ifdef CONFIG_SYS_MALLOC_DEFAULT_TO_INIT
 	malloc_init();
 #endif
+#if CONFIG_IS_ENABLED(MALLOC_SLAB)
+	slab_reset();
+#endif
+#if CONFIG_IS_ENABLED(MALLOC_TRACE)
+	malloc_trace_reset();
+#endif
 
 	debug("using memory %#lx-%#lx for malloc()\n", mem_malloc_start,
 	      mem_malloc_end);
@@ -1165,7 +1193,7 @@ static void malloc_extend_top(nb) INTERNAL_SIZE_T nb;
 	SIZE_SZ|PREV_INUSE;
       /* If possible, release the rest. */
       if (old_top_size >= MINSIZE)
-	fREe(chunk2mem(old_top));
+	fREe_impl(chunk2mem(old_top));
     }
   }
 
@@ -2244,6 +2272,571 @@ enum mcheck_status mprobe(void *__ptr) { return mcheck_mprobe(__ptr); }
 // mcheck API }
 #endif
 
+/* Allocations made before relocation come from malloc_simple() */
+static inline bool malloc_full_init(void)
+{
+	return !CONFIG_IS_ENABLED(SYS_MALLOC_F) ||
+		(gd->flags & GD_FLG_FULL_MALLOC_INIT);
+}
+
+#if CONFIG_IS_ENABLED(MALLOC_SLAB)
+/*
+ * Small allocations are served from slabs: pages holding objects of a single
+ * size class, within a region obtained from dlmalloc on first use. There is
+ * no per-object overhead and no bin search, and small objects are kept
+ * together rather than scattered through the heap. A freed object goes on the
+ * free list of its page. Once a page is empty it can be used for any class.
+ */
+#define SLAB_PAGE_SIZE		4096
+#define SLAB_NUM_PAGES		(CONFIG_MALLOC_SLAB_SIZE / SLAB_PAGE_SIZE)
+#define SLAB_MAX_SIZE		512
+#define SLAB_UNIT		16
+
+/* Object sizes, each a multiple of MALLOC_ALIGNMENT */
+static const u16 slab_sizes[] = {
+	16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512,
+};
+
+/**
+ * struct slab_page - Information about a page of the slab region
+ *
+ * @sibling: Node in the list of pages with space for the class, or in the
+ *	list of empty pages. Not in any list if the page is full
+ * @free: Freed objects, linked through their first word
+ * @used: Number of objects allocated
+ * @fresh: Number of objects at the end of the page never yet allocated
+ * @cls: Size class of the objects
+ */
+struct slab_page {
+	struct list_head sibling;
+	void *free;
+	u16 used;
+	u16 fresh;
+	u8 cls;
+};
+
+/**
+ * struct slab_state - State of the slab allocator
+ *
+ * @base: Start of the region, NULL if not set up yet
+ * @pages: Information about each page of the region
+ * @partial: Pages with space, for each class
+ * @empty: Pages with no objects
+ * @lookup: Class for each size, indexed by the size in units of SLAB_UNIT,
+ *	rounded up
+ * @in_use: Bytes in allocated objects
+ * @disabled: true to use dlmalloc for everything
+ * @failed: true if the region could not be allocated
+ */
+static struct slab_state {
+	char *base;
+	struct slab_page pages[SLAB_NUM_PAGES];
+	struct list_head partial[ARRAY_SIZE(slab_sizes)];
+	struct list_head empty;
+	u8 lookup[SLAB_MAX_SIZE / SLAB_UNIT + 1];
+	ulong in_use;
+	bool disabled;
+	bool failed;
+} slab;
+
+static void slab_reset(void)
+{
+	memset(&slab, '\0', sizeof(slab));
+}
+
+static bool slab_setup(void)
+{
+	int i, cls;
+
+	if (slab.failed)
+		return false;
+	slab.base = mALLOc_impl(SLAB_NUM_PAGES * SLAB_PAGE_SIZE);
+	if (!slab.base) {
+		slab.failed = true;
+		return false;
+	}
+
+	INIT_LIST_HEAD(&slab.empty);
+	for (i = 0; i < SLAB_NUM_PAGES; i++)
+		list_add_tail(&slab.pages[i].sibling, &slab.empty);
+	for (cls = 0; cls < ARRAY_SIZE(slab_sizes); cls++)
+		INIT_LIST_HEAD(&slab.partial[cls]);
+	for (cls = 0, i = 0; i < ARRAY_SIZE(slab.lookup); i++) {
+		while (slab_sizes[cls] < i * SLAB_UNIT)
+			cls++;
+		slab.lookup[i] = cls;
+	}
+
+	return true;
+}
+
+static Void_t *slab_alloc(size_t bytes)
+{
+	struct list_head *partial;
+	struct slab_page *page;
+	uint size, per_page;
+	char *obj;
+	int cls;
+
+	if (bytes > SLAB_MAX_SIZE || slab.disabled || malloc_testing ||
+	    !malloc_full_init())
+		return NULL;
+	if (!slab.base && !slab_setup())
+		return NULL;
+
+	cls = slab.lookup[(bytes + SLAB_UNIT - 1) / SLAB_UNIT];
+	size = slab_sizes[cls];
+	per_page = SLAB_PAGE_SIZE / size;
+	partial = &slab.partial[cls];
+	if (list_empty(partial)) {
+		if (list_empty(&slab.empty))
+			return NULL;
+		page = list_first_entry(&slab.empty, struct slab_page, sibling);
+		list_move(&page->sibling, partial);
+		page->free = NULL;
+		page->fresh = per_page;
+		page->cls = cls;
+	}
+
+	page = list_first_entry(partial, struct slab_page, sibling);
+	if (page->free) {
+		obj = page->free;
+		page->free = *(void **)obj;
+	} else {
+		obj = slab.base + (page - slab.pages) * SLAB_PAGE_SIZE +
+			(per_page - page->fresh) * size;
+		page->fresh--;
+	}
+	if (!page->free && !page->fresh)
+		list_del_init(&page->sibling);
+	page->used++;
+	slab.in_use += size;
+
+	return obj;
+}
+
+/*
+ * Get the page holding an allocation, or NULL if it is not in a slab. Before
+ * relocation the slab state is in BSS, which is not usable yet, and nothing
+ * can be in a slab anyway.
+ */
+static struct slab_page *slab_page_of(Void_t *mem)
+{
+	ulong offset;
+
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return NULL;
+
+	offset = (ulong)mem - (ulong)slab.base;
+	if (!slab.base || offset >= SLAB_NUM_PAGES * SLAB_PAGE_SIZE)
+		return NULL;
+
+	return &slab.pages[offset / SLAB_PAGE_SIZE];
+}
+
+static ulong slab_size(struct slab_page *page)
+{
+	return slab_sizes[page->cls];
+}
+
+static void slab_free(struct slab_page *page, Void_t *mem)
+{
+	*(void **)mem = page->free;
+	page->free = mem;
+	slab.in_use -= slab_size(page);
+
+	/* Use the most recently freed object next, since it is likely cached */
+	if (--page->used)
+		list_move(&page->sibling, &slab.partial[page->cls]);
+	else
+		list_move(&page->sibling, &slab.empty);
+}
+
+static Void_t *slab_realloc(struct slab_page *page, Void_t *oldmem,
+			    size_t bytes)
+{
+	ulong size = slab_size(page);
+	Void_t *mem;
+
+	if (bytes <= size)
+		return oldmem;
+	mem = slab_alloc(bytes);
+	if (!mem)
+		mem = mALLOc_impl(bytes);
+	if (mem) {
+		memcpy(mem, oldmem, size);
+		slab_free(page, oldmem);
+	}
+
+	return mem;
+}
+
+static Void_t *slab_calloc(size_t n, size_t elem_size)
+{
+	Void_t *mem;
+
+	if (elem_size && n > SLAB_MAX_SIZE / elem_size)
+		return NULL;
+	mem = slab_alloc(n * elem_size);
+	if (mem)
+		memset(mem, '\0', n * elem_size);
+
+	return mem;
+}
+
+/* Space in the region which is not allocated */
+static ulong slab_avail(void)
+{
+	if (!slab.base)
+		return 0;
+
+	return chunksize(mem2chunk(slab.base)) - slab.in_use;
+}
+
+void malloc_slab_enable(bool enable)
+{
+	slab.disabled = !enable;
+}
+#else
+static inline Void_t *slab_alloc(size_t bytes)
+{
+	return NULL;
+}
+
+static inline struct slab_page *slab_page_of(Void_t *mem)
+{
+	return NULL;
+}
+
+static inline ulong slab_size(struct slab_page *page)
+{
+	return 0;
+}
+
+static inline void slab_free(struct slab_page *page, Void_t *mem)
+{
+}
+
+static inline Void_t *slab_realloc(struct slab_page *page, Void_t *oldmem,
+				   size_t bytes)
+{
+	return NULL;
+}
+
+static inline Void_t *slab_calloc(size_t n, size_t elem_size)
+{
+	return NULL;
+}
+
+static inline ulong slab_avail(void)
+{
+	return 0;
+}
+#endif
+
+#if CONFIG_IS_ENABLED(MALLOC_STATS)
+/*
+ * Statistics are kept by wrapping the public routines, so that the internal
+ * calls between them (e.g. memalign() freeing the unused ends of a chunk) are
+ * not counted. Sizes are chunk or slab-object sizes, i.e. including overhead.
+ */
+static struct {
+	ulong in_use;
+	ulong peak;
+	ulong count;
+	ulong calls;
+	ulong frees;
+} mstats;
+
+/* Get the size of an allocation, including any overhead */
+static ulong malloc_mem_size(Void_t *mem)
+{
+	struct slab_page *page = slab_page_of(mem);
+
+	if (page)
+		return slab_size(page);
+
+	return chunksize(mem2chunk(mem));
+}
+
+static void malloc_stats_grow(ulong size)
+{
+	mstats.in_use += size;
+	if (mstats.in_use > mstats.peak)
+		mstats.peak = mstats.in_use;
+}
+
+static Void_t *malloc_stats_add(Void_t *mem)
+{
+	if (!malloc_full_init())
+		return mem;
+	mstats.calls++;
+	if (mem) {
+		mstats.count++;
+		malloc_stats_grow(malloc_mem_size(mem));
+	}
+
+	return mem;
+}
+
+static void malloc_stats_remove(Void_t *mem)
+{
+	if (!malloc_full_init())
+		return;
+	mstats.in_use -= malloc_mem_size(mem);
+	mstats.count--;
+	mstats.frees++;
+}
+
+static void malloc_stats_resize(ulong oldsize, Void_t *mem)
+{
+	if (!malloc_full_init())
+		return;
+	mstats.calls++;
+	if (mem) {
+		mstats.in_use -= oldsize;
+		malloc_stats_grow(malloc_mem_size(mem));
+	}
+}
+
+int malloc_get_info(struct malloc_info *info)
+{
+	ulong size;
+	mchunkptr p;
+	mbinptr b;
+	int i;
+
+	memset(info, '\0', sizeof(*info));
+	info->total_bytes = mem_malloc_end - mem_malloc_start;
+	info->heap_bytes = sbrked_mem;
+	info->in_use_bytes = mstats.in_use;
+	info->peak_bytes = mstats.peak;
+	info->count = mstats.count;
+	info->calls = mstats.calls;
+	info->frees = mstats.frees;
+
+	/* The top chunk is free too, and is extended from the pool as needed */
+	info->free_bytes = chunksize(top);
+	info->largest_free = info->free_bytes;
+	for (i = 1; i < NAV; ++i) {
+		b = bin_at(i);
+		for (p = last(b); p != b; p = p->bk) {
+			size = chunksize(p);
+			info->free_bytes += size;
+			info->free_chunks++;
+			if (size > info->largest_free)
+				info->largest_free = size;
+		}
+	}
+
+	/* Space in the slabs is free, but only for small allocations */
+	info->free_bytes += slab_avail();
+
+	return 0;
+}
+#else
+static inline Void_t *malloc_stats_add(Void_t *mem)
+{
+	return mem;
+}
+
+static inline void malloc_stats_remove(Void_t *mem)
+{
+}
+
+static inline void malloc_stats_resize(ulong oldsize, Void_t *mem)
+{
+}
+#endif
+
+#if CONFIG_IS_ENABLED(MALLOC_TRACE)
+/*
+ * Each call is recorded in a ring buffer, which is allocated on first use.
+ * Reading the timer may itself allocate memory, e.g. to probe the timer
+ * device, so calls made while a record is being added are not recorded.
+ */
+static struct {
+	struct malloc_trace_rec *recs;
+	uint next;
+	uint count;
+	ulong dropped;
+	bool disabled;
+	bool busy;
+	bool failed;
+} mtrace;
+
+static void malloc_trace_reset(void)
+{
+	memset(&mtrace, '\0', sizeof(mtrace));
+}
+
+static void malloc_trace_add(enum malloc_trace_op op, void *caller,
+			     Void_t *mem, size_t size)
+{
+	struct malloc_trace_rec *rec;
+
+	if (mtrace.disabled || mtrace.busy || !malloc_full_init())
+		return;
+	if (!mtrace.recs) {
+		if (mtrace.failed)
+			return;
+		mtrace.recs = mALLOc_impl(CONFIG_MALLOC_TRACE_COUNT *
+					  sizeof(*rec));
+		if (!mtrace.recs) {
+			mtrace.failed = true;
+			return;
+		}
+	}
+
+	rec = &mtrace.recs[mtrace.next];
+	mtrace.busy = true;
+	rec->time = timer_get_us();
+	mtrace.busy = false;
+	rec->caller = (ulong)caller - gd->reloc_off;
+	rec->ptr = (ulong)mem;
+	rec->size = size;
+	rec->op = op;
+
+	if (++mtrace.next == CONFIG_MALLOC_TRACE_COUNT)
+		mtrace.next = 0;
+	if (mtrace.count < CONFIG_MALLOC_TRACE_COUNT)
+		mtrace.count++;
+	else
+		mtrace.dropped++;
+}
+
+const struct malloc_trace_rec *malloc_trace_get(uint idx)
+{
+	uint first;
+
+	if (idx >= mtrace.count)
+		return NULL;
+	first = mtrace.next + CONFIG_MALLOC_TRACE_COUNT - mtrace.count;
+
+	return &mtrace.recs[(first + idx) % CONFIG_MALLOC_TRACE_COUNT];
+}
+
+ulong malloc_trace_dropped(void)
+{
+	return mtrace.dropped;
+}
+
+void malloc_trace_clear(void)
+{
+	mtrace.next = 0;
+	mtrace.count = 0;
+	mtrace.dropped = 0;
+}
+
+bool malloc_trace_enable(bool enable)
+{
+	bool old = !mtrace.disabled;
+
+	mtrace.disabled = !enable;
+
+	return old;
+}
+#else
+static inline void malloc_trace_add(enum malloc_trace_op op, void *caller,
+				    Void_t *mem, size_t size)
+{
+}
+#endif
+
+#ifdef MALLOC_WRAP
+static Void_t *malloc_alloc(size_t bytes)
+{
+	Void_t *mem;
+
+	mem = slab_alloc(bytes);
+	if (!mem)
+		mem = mALLOc_impl(bytes);
+
+	return malloc_stats_add(mem);
+}
+
+Void_t *mALLOc(size_t bytes)
+{
+	Void_t *mem = malloc_alloc(bytes);
+
+	malloc_trace_add(MALLOC_TRACE_MALLOC, __builtin_return_address(0), mem,
+			 bytes);
+
+	return mem;
+}
+
+void fREe(Void_t *mem)
+{
+	struct slab_page *page;
+
+	if (!mem)
+		return;
+	malloc_trace_add(MALLOC_TRACE_FREE, __builtin_return_address(0), mem, 0);
+	malloc_stats_remove(mem);
+	page = slab_page_of(mem);
+	if (page)
+		slab_free(page, mem);
+	else
+		fREe_impl(mem);
+}
+
+Void_t *rEALLOc(Void_t *oldmem, size_t bytes)
+{
+	void *caller = __builtin_return_address(0);
+	struct slab_page *page;
+	ulong oldsize = 0;
+	Void_t *mem;
+
+	if (!oldmem) {
+		mem = malloc_alloc(bytes);
+		malloc_trace_add(MALLOC_TRACE_REALLOC, caller, mem, bytes);
+		return mem;
+	}
+
+	page = slab_page_of(oldmem);
+	if (page) {
+		oldsize = slab_size(page);
+		mem = slab_realloc(page, oldmem, bytes);
+	} else {
+		if (CONFIG_IS_ENABLED(MALLOC_STATS) && malloc_full_init())
+			oldsize = chunksize(mem2chunk(oldmem));
+		mem = rEALLOc_impl(oldmem, bytes);
+	}
+	malloc_stats_resize(oldsize, mem);
+
+	/* The old memory is only freed if the call succeeds */
+	if (mem)
+		malloc_trace_add(MALLOC_TRACE_FREE, caller, oldmem, 0);
+	malloc_trace_add(MALLOC_TRACE_REALLOC, caller, mem, bytes);
+
+	return mem;
+}
+
+Void_t *mEMALIGn(size_t alignment, size_t bytes)
+{
+	Void_t *mem = malloc_stats_add(mEMALIGn_impl(alignment, bytes));
+
+	malloc_trace_add(MALLOC_TRACE_MEMALIGN, __builtin_return_address(0),
+			 mem, bytes);
+
+	return mem;
+}
+
+Void_t *cALLOc(size_t n, size_t elem_size)
+{
+	Void_t *mem;
+
+	mem = slab_calloc(n, elem_size);
+	if (!mem)
+		mem = cALLOc_impl(n, elem_size);
+	malloc_stats_add(mem);
+	malloc_trace_add(MALLOC_TRACE_CALLOC, __builtin_return_address(0), mem,
+			 n * elem_size);
+
+	return mem;
+}
+#endif
+
 /*
 
     Malloc_trim gives memory back to the system (via negative
@@ -2340,9 +2933,13 @@ size_t malloc_usable_size(Void_t* mem)
 size_t malloc_usable_size(mem) Void_t* mem;
 #endif
 {
+  struct slab_page *page;
   mchunkptr p;
   if (mem == NULL)
     return 0;
+  page = slab_page_of(mem);
+  if (page)
+    return slab_size(page);
   else
   {
     p = mem2chunk(mem);
@@ -2388,6 +2985,9 @@ static void malloc_update_mallinfo(void)
     }
   }
 
+  /* Count the objects in the slabs, rather than the region holding them */
+  avail += slab_avail();
+
   current_mallinfo.ordblks = navail;
   current_mallinfo.uordblks = sbrked_mem - avail;
   current_mallinfo.fordblks = avail;
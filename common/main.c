@@ -16,6 +16,7 @@
 #include <env.h>
 #include <fdtdec.h>
 #include <init.h>
+#include <initcall.h>
 #include <net.h>
 #include <version_string.h>
 #include <efi_loader.h>
@@ -28,6 +29,8 @@ static void run_preboot_environment_command(void)
 	if (p != NULL) {
 		int prev = 0;
 
+		initcall_late_finish();
+
 		if (IS_ENABLED(CONFIG_AUTOBOOT_KEYED))
 			prev = disable_ctrlc(1); /* disable Ctrl-C checking */
 
@@ -53,10 +56,13 @@ void main_loop(void)
 	if (IS_ENABLED(CONFIG_USE_PREBOOT))
 		run_preboot_environment_command();
 
-	if (IS_ENABLED(CONFIG_UPDATE_TFTP))
+	if (IS_ENABLED(CONFIG_UPDATE_TFTP)) {
+		initcall_late_finish();
 		update_tftp(0UL, NULL, NULL);
+	}
 
 	if (IS_ENABLED(CONFIG_EFI_CAPSULE_ON_DISK_EARLY)) {
+		initcall_late_finish();
 		/* efi_init_early() already called */
 		if (efi_init_obj_list() == EFI_SUCCESS)
 			efi_launch_capsules();
@@ -69,6 +75,7 @@ void main_loop(void)
 		cli_secure_boot_cmd(s);
 
 	autoboot_command(s);
+	initcall_late_finish();
 
 	/* if standard boot if enabled, assume that it will be able to boot */
 	if (IS_ENABLED(CONFIG_BOOTSTD_PROG)) {
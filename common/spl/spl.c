@@ -36,6 +36,7 @@
 #include <dm/root.h>
 #include <dm/util.h>
 #include <dm/device-internal.h>
+#include <dm/handoff.h>
 #include <dm/uclass-internal.h>
 #include <linux/compiler.h>
 #include <fdt_support.h>
@@ -808,6 +809,12 @@ void board_init_r(gd_t *dummy1, ulong dummy2)
 			printf(PHASE_PROMPT
 			       "SPL hand-off write failed (err=%d)\n", ret);
 	}
+	if (CONFIG_IS_ENABLED(DM_HANDOFF)) {
+		ret = dm_handoff_write();
+		if (ret)
+			printf(PHASE_PROMPT
+			       "DM state hand-off write failed (err=%d)\n", ret);
+	}
 	if (CONFIG_IS_ENABLED(UPL_OUT) && (gd->flags & GD_FLG_UPL)) {
 		ret = spl_write_upl_handoff(&spl_image);
 		if (ret) {
@@ -4,9 +4,11 @@
  * Written by Simon Glass <sjg@chromium.org>
  */
 
+#include <bootstage.h>
 #include <errno.h>
 #include <fpga.h>
 #include <gzip.h>
+#include <hash.h>
 #include <image.h>
 #include <log.h>
 #include <memalign.h>
@@ -18,6 +20,7 @@
 #include <asm/io.h>
 #include <linux/libfdt.h>
 #include <linux/printk.h>
+#include <lzma/LzmaTools.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -28,6 +31,44 @@ struct spl_fit_info {
 	int conf_node;		/* FDT offset to selected configuration node */
 };
 
+/* Most hash nodes which can be checked while an image is read */
+#define SPL_FIT_MAX_HASHES	4
+
+/**
+ * struct spl_fit_hash - Hash calculated while an image is read
+ *
+ * @algo: Hash algorithm
+ * @ctx: Hash context, NULL once finished
+ * @noffset: Offset of the hash node in the FIT
+ */
+struct spl_fit_hash {
+	struct hash_algo *algo;
+	void *ctx;
+	int noffset;
+};
+
+/**
+ * struct spl_fit_stream - State for processing an image as it is read
+ *
+ * @hash: Hashes being calculated
+ * @hash_count: Number of hashes in @hash
+ * @hashing: true if the hashes are calculated while reading, false if the
+ *	image must be verified once it is read
+ * @comp: Compression being undone while reading, or IH_COMP_NONE
+ * @gz: gzip state, if @comp is IH_COMP_GZIP
+ * @lz: LZMA state, if @comp is IH_COMP_LZMA
+ */
+struct spl_fit_stream {
+	struct spl_fit_hash hash[SPL_FIT_MAX_HASHES];
+	int hash_count;
+	bool hashing;
+	uint8_t comp;
+	union {
+		struct gunzip_stream gz;
+		struct lzma_stream lz;
+	};
+};
+
 __weak ulong board_spl_fit_size_align(ulong size)
 {
 	return size;
@@ -187,6 +228,254 @@ static int get_aligned_image_size(struct spl_load_info *info, int data_size,
 	return ALIGN(data_size, spl_get_bl_len(info));
 }
 
+static void spl_fit_hash_abort(struct spl_fit_stream *st)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(uint8_t, value, FIT_MAX_HASH_LEN);
+	struct spl_fit_hash *hash;
+	int i;
+
+	for (i = 0, hash = st->hash; i < st->hash_count; i++, hash++) {
+		if (hash->ctx)
+			hash->algo->hash_finish(hash->algo, hash->ctx, value,
+						FIT_MAX_HASH_LEN);
+		hash->ctx = NULL;
+	}
+	st->hash_count = 0;
+	st->hashing = false;
+}
+
+/**
+ * spl_fit_hash_start() - Set up the hashes of an image to check as it is read
+ *
+ * This only handles plain hash nodes. If signatures may need checking, the
+ * image is verified by fit_image_verify_with_data() once it is read.
+ *
+ * @st: Stream state
+ * @fit: FIT containing the image
+ * @node: Image node
+ */
+static void spl_fit_hash_start(struct spl_fit_stream *st, const void *fit,
+			       int node)
+{
+	const void *key_blob = gd_fdt_blob();
+	struct spl_fit_hash *hash;
+	const char *algo_name;
+	int noffset;
+
+	st->hash_count = 0;
+	st->hashing = false;
+	if (key_blob && fdt_subnode_offset(key_blob, 0, FIT_SIG_NODENAME) >= 0)
+		return;
+
+	fdt_for_each_subnode(noffset, fit, node) {
+		const char *name = fit_get_name(fit, noffset, NULL);
+
+		if (!strncmp(name, FIT_SIG_NODENAME, strlen(FIT_SIG_NODENAME)))
+			goto fallback;
+		if (strncmp(name, FIT_HASH_NODENAME, strlen(FIT_HASH_NODENAME)))
+			continue;
+		if (st->hash_count == SPL_FIT_MAX_HASHES ||
+		    fdt_getprop(fit, noffset, FIT_IGNORE_PROP, NULL) ||
+		    fit_image_hash_get_algo(fit, noffset, &algo_name))
+			goto fallback;
+
+		hash = &st->hash[st->hash_count];
+		if (hash_progressive_lookup_algo(algo_name, &hash->algo) ||
+		    hash->algo->hash_init(hash->algo, &hash->ctx))
+			goto fallback;
+		hash->noffset = noffset;
+		st->hash_count++;
+	}
+	st->hashing = true;
+
+	return;
+fallback:
+	log_debug("Image '%s' is verified after reading\n",
+		  fit_get_name(fit, node, NULL));
+	spl_fit_hash_abort(st);
+}
+
+/**
+ * spl_fit_hash_check() - Check the hashes calculated while reading an image
+ *
+ * This prints the same output as fit_image_verify_with_data()
+ *
+ * @st: Stream state
+ * @fit: FIT containing the image
+ * @node: Image node
+ * Return: 0 if all hashes match, -EPERM if not
+ */
+static int spl_fit_hash_check(struct spl_fit_stream *st, const void *fit,
+			      int node)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(uint8_t, value, FIT_MAX_HASH_LEN);
+	struct spl_fit_hash *hash;
+	uint8_t *fit_value;
+	int fit_value_len;
+	char *err_msg;
+	int i;
+
+	for (i = 0, hash = st->hash; i < st->hash_count; i++, hash++) {
+		printf("%s", hash->algo->name);
+		err_msg = NULL;
+		if (!hash->ctx ||
+		    hash->algo->hash_finish(hash->algo, hash->ctx, value,
+					    FIT_MAX_HASH_LEN))
+			err_msg = "Unsupported hash algorithm";
+		hash->ctx = NULL;
+		if (err_msg)
+			goto error;
+
+		/* The progressive CRCs are in CPU order but FIT uses BE */
+		if (!strcmp(hash->algo->name, "crc32"))
+			*(u32 *)value = cpu_to_be32(*(u32 *)value);
+		else if (!strcmp(hash->algo->name, "crc16-ccitt"))
+			*(u16 *)value = cpu_to_be16(*(u16 *)value);
+
+		if (fit_image_hash_get_value(fit, hash->noffset, &fit_value,
+					     &fit_value_len))
+			err_msg = "Can't get hash value property";
+		else if (hash->algo->digest_size != fit_value_len)
+			err_msg = "Bad hash value len";
+		else if (memcmp(value, fit_value, fit_value_len))
+			err_msg = "Bad hash value";
+		if (err_msg)
+			goto error;
+		puts("+ ");
+	}
+	st->hash_count = 0;
+
+	return 0;
+error:
+	printf(" error!\n%s for '%s' hash node in '%s' image node\n", err_msg,
+	       fit_get_name(fit, hash->noffset, NULL),
+	       fit_get_name(fit, node, NULL));
+	spl_fit_hash_abort(st);
+
+	return -EPERM;
+}
+
+static int spl_fit_decomp_start(struct spl_fit_stream *st, uint8_t comp,
+				void *dst)
+{
+	int ret;
+
+	st->comp = IH_COMP_NONE;
+	if (IS_ENABLED(CONFIG_SPL_GZIP) && comp == IH_COMP_GZIP) {
+		ret = gunzip_stream_start(&st->gz, dst, CONFIG_SYS_BOOTM_LEN);
+		if (ret)
+			return ret;
+	} else if (IS_ENABLED(CONFIG_SPL_LZMA) && comp == IH_COMP_LZMA) {
+		lzmaStreamStart(&st->lz, dst, CONFIG_SYS_BOOTM_LEN);
+	} else {
+		return 0;
+	}
+	st->comp = comp;
+
+	return 0;
+}
+
+static int spl_fit_decomp_finish(struct spl_fit_stream *st, ulong *lenp)
+{
+	SizeT size;
+	int ret;
+
+	if (IS_ENABLED(CONFIG_SPL_GZIP) && st->comp == IH_COMP_GZIP) {
+		ret = gunzip_stream_finish(&st->gz, lenp);
+	} else if (IS_ENABLED(CONFIG_SPL_LZMA) && st->comp == IH_COMP_LZMA) {
+		ret = lzmaStreamFinish(&st->lz, &size) ? -EIO : 0;
+		*lenp = size;
+	} else {
+		return 0;
+	}
+	st->comp = IH_COMP_NONE;
+
+	return ret;
+}
+
+/* Hash and decompress the next piece of an image */
+static int spl_fit_stream_data(struct spl_fit_stream *st, const void *buf,
+			       ulong len, bool last)
+{
+	struct spl_fit_hash *hash;
+	int ret = 0;
+	int i;
+
+	if (st->hashing) {
+		bootstage_start(BOOTSTAGE_ID_ACCUM_SPL_FIT_HASH, "spl_fit_hash");
+		for (i = 0, hash = st->hash; i < st->hash_count; i++, hash++) {
+			/* the context is freed on error */
+			if (hash->ctx &&
+			    hash->algo->hash_update(hash->algo, hash->ctx, buf,
+						    len, last))
+				hash->ctx = NULL;
+		}
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_SPL_FIT_HASH);
+	}
+
+	if (st->comp != IH_COMP_NONE) {
+		bootstage_start(BOOTSTAGE_ID_ACCUM_DECOMP, "decomp");
+		if (IS_ENABLED(CONFIG_SPL_GZIP) && st->comp == IH_COMP_GZIP)
+			ret = gunzip_stream_feed(&st->gz, buf, len);
+		else if (IS_ENABLED(CONFIG_SPL_LZMA))
+			ret = lzmaStreamFeed(&st->lz, buf, len) ? -EIO : 0;
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_DECOMP);
+		if (ret) {
+			puts("Uncompressing error\n");
+			return -EIO;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * spl_fit_read_chunked() - Read an image in pieces, processing each one
+ *
+ * Each piece is hashed and decompressed as set up in @st, while it is still
+ * in the cache. The data is left in @buf as well, so it can be verified
+ * afterwards if needed.
+ *
+ * @info: Device to read from
+ * @offset: Offset to read from, aligned to the block size
+ * @size: Number of bytes to read, aligned to the block size
+ * @buf: Buffer to read into
+ * @overhead: Offset of the image data within @buf
+ * @length: Length of the image data
+ * @st: Stream state
+ * Return: 0 if OK, -EIO on a read or decompression error
+ */
+static int spl_fit_read_chunked(struct spl_load_info *info, ulong offset,
+				ulong size, void *buf, ulong overhead,
+				ulong length, struct spl_fit_stream *st)
+{
+	ulong chunk = ALIGN(CONFIG_IF_ENABLED_INT(FIT_CHUNKED_LOAD,
+						  FIT_CHUNK_SIZE),
+			    spl_get_bl_len(info));
+	ulong pos, count, start, end, got;
+	int ret;
+
+	for (pos = 0; pos < size; pos += count) {
+		count = min(chunk, size - pos);
+		bootstage_start(BOOTSTAGE_ID_ACCUM_SPL_FIT_READ, "spl_fit_read");
+		got = info->read(info, offset + pos, count, buf + pos);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_SPL_FIT_READ);
+
+		/* the part of this piece which holds image data */
+		start = max(pos, overhead);
+		end = min(pos + count, overhead + length);
+		if (got < end - pos)
+			return -EIO;
+
+		ret = spl_fit_stream_data(st, buf + start, end - start,
+					  end == overhead + length);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
 /**
  * load_simple_fit(): load the image described in a certain FIT node
  * @info:	points to information about the device to load data from
@@ -217,6 +506,10 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 	const void *data;
 	const void *fit = ctx->fit;
 	bool external_data = false;
+	struct spl_fit_stream st = { .comp = IH_COMP_NONE };
+	bool decomp = false;
+	ulong out_len = 0;
+	int ret;
 
 	if (IS_ENABLED(CONFIG_SPL_FPGA) ||
 	    (IS_ENABLED(CONFIG_SPL_OS_BOOT) && spl_decompression_enabled())) {
@@ -248,6 +541,7 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 	}
 
 	if (external_data) {
+		ulong read_offset;
 		void *src_ptr;
 
 		/* External data */
@@ -270,12 +564,51 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 
 		overhead = get_aligned_image_overhead(info, offset);
 		size = get_aligned_image_size(info, length, offset);
+		read_offset = fit_offset + get_aligned_image_offset(info, offset);
 
-		if (info->read(info,
-			       fit_offset +
-			       get_aligned_image_offset(info, offset), size,
-			       src_ptr) < length)
-			return -EIO;
+		if (CONFIG_IS_ENABLED(FIT_CHUNKED_LOAD)) {
+			if (CONFIG_IS_ENABLED(FIT_SIGNATURE))
+				spl_fit_hash_start(&st, fit, node);
+
+			/*
+			 * The decompressor must not see data which is not yet
+			 * verified, nor write over the load address before the
+			 * check, so only do this without verification. Also,
+			 * post-processing must see the compressed data.
+			 */
+			if (!CONFIG_IS_ENABLED(FIT_SIGNATURE) &&
+			    !CONFIG_IS_ENABLED(FIT_IMAGE_POST_PROCESS)) {
+				load_ptr = map_sysmem(load_addr, 0);
+				ret = spl_fit_decomp_start(&st, image_comp,
+							   load_ptr);
+				if (ret) {
+					spl_fit_hash_abort(&st);
+					return ret;
+				}
+				decomp = st.comp != IH_COMP_NONE;
+			}
+
+			ret = spl_fit_read_chunked(info, read_offset, size,
+						   src_ptr, overhead, length,
+						   &st);
+			if (decomp && spl_fit_decomp_finish(&st, &out_len) &&
+			    !ret) {
+				puts("Uncompressing error\n");
+				ret = -EIO;
+			}
+			if (ret) {
+				spl_fit_hash_abort(&st);
+				return ret;
+			}
+		} else {
+			bootstage_start(BOOTSTAGE_ID_ACCUM_SPL_FIT_READ,
+					"spl_fit_read");
+			ret = info->read(info, read_offset, size,
+					 src_ptr) < length ? -EIO : 0;
+			bootstage_accum(BOOTSTAGE_ID_ACCUM_SPL_FIT_READ);
+			if (ret)
+				return ret;
+		}
 
 		debug("External data: dst=%p, offset=%x, size=%lx\n",
 		      src_ptr, offset, (unsigned long)length);
@@ -294,9 +627,19 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 	if (CONFIG_IS_ENABLED(FIT_SIGNATURE)) {
 		printf("## Checking hash(es) for Image %s ... ",
 		       fit_get_name(fit, node, NULL));
-		if (!fit_image_verify_with_data(fit, node, gd_fdt_blob(), src,
-						length))
-			return -EPERM;
+		if (st.hashing) {
+			if (spl_fit_hash_check(&st, fit, node))
+				return -EPERM;
+		} else {
+			bootstage_start(BOOTSTAGE_ID_ACCUM_SPL_FIT_HASH,
+					"spl_fit_hash");
+			ret = fit_image_verify_with_data(fit, node,
+							 gd_fdt_blob(), src,
+							 length);
+			bootstage_accum(BOOTSTAGE_ID_ACCUM_SPL_FIT_HASH);
+			if (!ret)
+				return -EPERM;
+		}
 		puts("OK\n");
 	}
 
@@ -304,9 +647,15 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 		board_fit_image_post_process(fit, node, &src, &length);
 
 	load_ptr = map_sysmem(load_addr, length);
-	if (IS_ENABLED(CONFIG_SPL_GZIP) && image_comp == IH_COMP_GZIP) {
+	if (decomp) {
+		/* already decompressed while reading */
+		length = out_len;
+	} else if (IS_ENABLED(CONFIG_SPL_GZIP) && image_comp == IH_COMP_GZIP) {
 		size = length;
-		if (gunzip(load_ptr, CONFIG_SYS_BOOTM_LEN, src, &size)) {
+		bootstage_start(BOOTSTAGE_ID_ACCUM_DECOMP, "decomp");
+		ret = gunzip(load_ptr, CONFIG_SYS_BOOTM_LEN, src, &size);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_DECOMP);
+		if (ret) {
 			puts("Uncompressing error\n");
 			return -EIO;
 		}
@@ -315,8 +664,11 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 		size = CONFIG_SYS_BOOTM_LEN;
 		ulong loadEnd;
 
-		if (image_decomp(IH_COMP_LZMA, CONFIG_SYS_LOAD_ADDR, 0, 0,
-				 load_ptr, src, length, size, &loadEnd)) {
+		bootstage_start(BOOTSTAGE_ID_ACCUM_DECOMP, "decomp");
+		ret = image_decomp(IH_COMP_LZMA, CONFIG_SYS_LOAD_ADDR, 0, 0,
+				   load_ptr, src, length, size, &loadEnd);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_DECOMP);
+		if (ret) {
 			puts("Uncompressing error\n");
 			return -EIO;
 		}
@@ -652,6 +1004,180 @@ static int spl_fit_load_fpga(struct spl_fit_info *ctx,
 	return spl_fit_upload_fpga(ctx, node, &fpga_image);
 }
 
+/* Most ranges of image data which are considered for prefetching */
+#define SPL_FIT_PREFETCH_MAX	16
+
+/**
+ * struct spl_fit_run - Image data read from the device in a single call
+ *
+ * @start: Offset of the data on the device, aligned to the block size
+ * @size: Size of the data, aligned to the block size
+ * @valid: Number of bytes actually read
+ * @buf: The data, or NULL if it could not be read
+ */
+struct spl_fit_run {
+	ulong start;
+	ulong size;
+	ulong valid;
+	void *buf;
+};
+
+/**
+ * struct spl_fit_prefetch - Image data read before the images are loaded
+ *
+ * @load: Loader which copies from @runs, falling back to @info
+ * @info: Loader for the device
+ * @runs: Runs of data which were read, in order of offset
+ * @count: Number of entries in @runs
+ */
+struct spl_fit_prefetch {
+	struct spl_load_info load;
+	struct spl_load_info *info;
+	struct spl_fit_run runs[SPL_FIT_PREFETCH_MAX];
+	int count;
+};
+
+static ulong spl_fit_prefetch_read(struct spl_load_info *load, ulong offset,
+				   ulong count, void *buf)
+{
+	struct spl_fit_prefetch *pf = load->priv;
+	struct spl_fit_run *run;
+	int i;
+
+	for (i = 0, run = pf->runs; i < pf->count; i++, run++) {
+		if (offset < run->start ||
+		    offset + count > run->start + run->size)
+			continue;
+
+		/* a short read at the end of the device gives a short run */
+		if (offset >= run->start + run->valid)
+			return 0;
+		count = min(count, run->start + run->valid - offset);
+		memcpy(buf, run->buf + offset - run->start, count);
+
+		return count;
+	}
+
+	return pf->info->read(pf->info, offset, count, buf);
+}
+
+/**
+ * spl_fit_prefetch() - Read the data of all images in a configuration
+ *
+ * This finds the external data of each image in the configuration and sorts
+ * it by offset. Data which is contiguous on the device, or separated by no
+ * more than SPL_FIT_PREFETCH_GAP bytes, is read in a single call. The images
+ * are then copied out by @pf->load as they are loaded, so the device sees a
+ * few large sequential reads instead of one for each image.
+ *
+ * Data which cannot be prefetched, e.g. because there is not enough memory,
+ * is read from the device as usual.
+ *
+ * @pf: Prefetch state to set up
+ * @ctx: FIT context
+ * @info: Loader for the device
+ * @offset: Offset of the FIT on the device
+ */
+static void spl_fit_prefetch(struct spl_fit_prefetch *pf,
+			     const struct spl_fit_info *ctx,
+			     struct spl_load_info *info, ulong offset)
+{
+	static const char *const props[] = {
+		FIT_FIRMWARE_PROP, FIT_KERNEL_PROP, FIT_FDT_PROP,
+		FIT_LOADABLE_PROP, FIT_FPGA_PROP,
+	};
+	ulong gap = CONFIG_IF_ENABLED_INT(FIT_PREFETCH, FIT_PREFETCH_GAP);
+	struct spl_fit_run ranges[SPL_FIT_PREFETCH_MAX], tmp, *run;
+	const void *fit = ctx->fit;
+	int count = 0, i, j, node, pos, len;
+	const char *name;
+
+	memset(pf, '\0', sizeof(*pf));
+	pf->info = info;
+	spl_load_init(&pf->load, spl_fit_prefetch_read, pf,
+		      spl_get_bl_len(info));
+
+	/* collect the data of each image, as load_simple_fit() reads it */
+	for (i = 0; i < ARRAY_SIZE(props); i++) {
+		/* skip images which spl_load_simple_fit() does not load */
+		if (!strcmp(props[i], FIT_KERNEL_PROP) &&
+		    (!IS_ENABLED(CONFIG_SPL_OS_BOOT) ||
+		     fdt_getprop(fit, ctx->conf_node, FIT_FIRMWARE_PROP, NULL)))
+			continue;
+		if (!strcmp(props[i], FIT_FPGA_PROP) &&
+		    !IS_ENABLED(CONFIG_SPL_FPGA))
+			continue;
+
+		for (j = 0; count < SPL_FIT_PREFETCH_MAX; j++) {
+			name = fdt_stringlist_get(fit, ctx->conf_node, props[i],
+						  j, NULL);
+			if (!name)
+				break;
+			node = fdt_subnode_offset(fit, ctx->images_node, name);
+			if (node < 0 || fit_image_get_data_size(fit, node, &len) ||
+			    !len)
+				continue;
+			if (fit_image_get_data_position(fit, node, &pos)) {
+				if (fit_image_get_data_offset(fit, node, &pos))
+					continue;
+				pos += ctx->ext_data_offset;
+			}
+
+			tmp.start = offset + get_aligned_image_offset(info, pos);
+			tmp.size = get_aligned_image_size(info, len, pos);
+
+			/* keep the ranges sorted by offset */
+			for (run = &ranges[count]; run > ranges &&
+			     run[-1].start > tmp.start; run--)
+				*run = run[-1];
+			*run = tmp;
+			count++;
+		}
+	}
+
+	/* merge them into runs, each read in one go */
+	for (i = 0; i < count; i = j) {
+		tmp = ranges[i];
+		for (j = i + 1; j < count &&
+		     ranges[j].start <= tmp.start + tmp.size + gap; j++)
+			tmp.size = max(tmp.size, ranges[j].start +
+				       ranges[j].size - tmp.start);
+
+		/* a single image gains nothing from an extra copy */
+		if (j - i < 2)
+			continue;
+
+		run = &pf->runs[pf->count];
+		*run = tmp;
+		run->buf = malloc_cache_aligned(run->size);
+		if (!run->buf) {
+			log_debug("No memory to prefetch %lx bytes\n",
+				  run->size);
+			continue;
+		}
+		bootstage_start(BOOTSTAGE_ID_ACCUM_SPL_FIT_READ,
+				"spl_fit_read");
+		run->valid = info->read(info, run->start, run->size, run->buf);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_SPL_FIT_READ);
+		log_debug("Prefetched %d images: offset %lx size %lx\n", j - i,
+			  run->start, run->valid);
+		if (!run->valid) {
+			free(run->buf);
+			continue;
+		}
+		pf->count++;
+	}
+}
+
+static void spl_fit_prefetch_free(struct spl_fit_prefetch *pf)
+{
+	int i;
+
+	for (i = 0; i < pf->count; i++)
+		free(pf->runs[i].buf);
+	pf->count = 0;
+}
+
 static int spl_simple_fit_read(struct spl_fit_info *ctx,
 			       struct spl_load_info *info, ulong offset,
 			       const void *fit_header)
@@ -712,32 +1238,27 @@ static int spl_simple_fit_parse(struct spl_fit_info *ctx)
 	return 0;
 }
 
-int spl_load_simple_fit(struct spl_image_info *spl_image,
-			struct spl_load_info *info, ulong offset, void *fit)
+/**
+ * spl_fit_load_images() - Load the images in the selected configuration
+ *
+ * @spl_image: Returns information about the image to boot
+ * @info: Loader for the device
+ * @offset: Offset of the FIT on the device
+ * @ctx: FIT context, set up by spl_simple_fit_parse()
+ * Return: 0 if OK, -ve on error
+ */
+static int spl_fit_load_images(struct spl_image_info *spl_image,
+			       struct spl_load_info *info, ulong offset,
+			       struct spl_fit_info *ctx)
 {
 	struct spl_image_info image_info;
-	struct spl_fit_info ctx;
 	int node = -1;
 	int ret;
 	int index = 0;
 	int firmware_node;
 
-	ret = spl_simple_fit_read(&ctx, info, offset, fit);
-	if (ret < 0)
-		return ret;
-
-	/* skip further processing if requested to enable load-only use cases */
-	if (spl_load_simple_fit_skip_processing())
-		return 0;
-
-	ctx.fit = spl_load_simple_fit_fix_load(ctx.fit);
-
-	ret = spl_simple_fit_parse(&ctx);
-	if (ret < 0)
-		return ret;
-
 	if (IS_ENABLED(CONFIG_SPL_FPGA))
-		spl_fit_load_fpga(&ctx, info, offset);
+		spl_fit_load_fpga(ctx, info, offset);
 
 	/*
 	 * Find the U-Boot image using the following search order:
@@ -746,14 +1267,14 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 	 *   - fall back to using the first 'loadables' entry
 	 */
 	if (node < 0)
-		node = spl_fit_get_image_node(&ctx, FIT_FIRMWARE_PROP, 0);
+		node = spl_fit_get_image_node(ctx, FIT_FIRMWARE_PROP, 0);
 
 	if (node < 0 && IS_ENABLED(CONFIG_SPL_OS_BOOT))
-		node = spl_fit_get_image_node(&ctx, FIT_KERNEL_PROP, 0);
+		node = spl_fit_get_image_node(ctx, FIT_KERNEL_PROP, 0);
 
 	if (node < 0) {
 		debug("could not find firmware image, trying loadables...\n");
-		node = spl_fit_get_image_node(&ctx, "loadables", 0);
+		node = spl_fit_get_image_node(ctx, "loadables", 0);
 		/*
 		 * If we pick the U-Boot image from "loadables", start at
 		 * the second image when later loading additional images.
@@ -767,7 +1288,7 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 	}
 
 	/* Load the image and set up the spl_image structure */
-	ret = load_simple_fit(info, offset, &ctx, node, spl_image);
+	ret = load_simple_fit(info, offset, ctx, node, spl_image);
 	if (ret)
 		return ret;
 
@@ -775,7 +1296,7 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 	 * For backward compatibility, we treat the first node that is
 	 * as a U-Boot image, if no OS-type has been declared.
 	 */
-	if (!spl_fit_image_get_os(ctx.fit, node, &spl_image->os))
+	if (!spl_fit_image_get_os(ctx->fit, node, &spl_image->os))
 		debug("Image OS is %s\n", genimg_get_os_name(spl_image->os));
 	else if (!IS_ENABLED(CONFIG_SPL_OS_BOOT))
 		spl_image->os = IH_OS_U_BOOT;
@@ -785,7 +1306,7 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 	 * We allow this to fail, as the U-Boot image might embed its FDT.
 	 */
 	if (os_takes_devicetree(spl_image->os)) {
-		ret = spl_fit_append_fdt(spl_image, info, offset, &ctx);
+		ret = spl_fit_append_fdt(spl_image, info, offset, ctx);
 		if (ret < 0 && spl_image->os != IH_OS_U_BOOT)
 			return ret;
 	}
@@ -795,7 +1316,7 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 	for (; ; index++) {
 		uint8_t os_type = IH_OS_INVALID;
 
-		node = spl_fit_get_image_node(&ctx, "loadables", index);
+		node = spl_fit_get_image_node(ctx, "loadables", index);
 		if (node < 0)
 			break;
 
@@ -808,21 +1329,21 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 			continue;
 
 		image_info.load_addr = 0;
-		ret = load_simple_fit(info, offset, &ctx, node, &image_info);
+		ret = load_simple_fit(info, offset, ctx, node, &image_info);
 		if (ret < 0) {
 			printf("%s: can't load image loadables index %d (ret = %d)\n",
 			       __func__, index, ret);
 			return ret;
 		}
 
-		if (spl_fit_image_is_fpga(ctx.fit, node))
-			spl_fit_upload_fpga(&ctx, node, &image_info);
+		if (spl_fit_image_is_fpga(ctx->fit, node))
+			spl_fit_upload_fpga(ctx, node, &image_info);
 
-		if (!spl_fit_image_get_os(ctx.fit, node, &os_type))
+		if (!spl_fit_image_get_os(ctx->fit, node, &os_type))
 			debug("Loadable is %s\n", genimg_get_os_name(os_type));
 
 		if (os_takes_devicetree(os_type)) {
-			spl_fit_append_fdt(&image_info, info, offset, &ctx);
+			spl_fit_append_fdt(&image_info, info, offset, ctx);
 			spl_image->fdt_addr = image_info.fdt_addr;
 		}
 
@@ -836,7 +1357,7 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 
 		/* Record our loadables into the FDT */
 		if (spl_image->fdt_addr)
-			spl_fit_record_loadable(&ctx, index,
+			spl_fit_record_loadable(ctx, index,
 						spl_image->fdt_addr,
 						&image_info);
 	}
@@ -850,12 +1371,44 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 		spl_image->entry_point = spl_image->load_addr;
 
 	spl_image->flags |= SPL_FIT_FOUND;
-	upl_set_fit_info(map_to_sysmem(ctx.fit), ctx.conf_node,
+	upl_set_fit_info(map_to_sysmem(ctx->fit), ctx->conf_node,
 			 spl_image->entry_point);
 
 	return 0;
 }
 
+int spl_load_simple_fit(struct spl_image_info *spl_image,
+			struct spl_load_info *info, ulong offset, void *fit)
+{
+	struct spl_fit_prefetch pf;
+	struct spl_fit_info ctx;
+	int ret;
+
+	ret = spl_simple_fit_read(&ctx, info, offset, fit);
+	if (ret < 0)
+		return ret;
+
+	/* skip further processing if requested to enable load-only use cases */
+	if (spl_load_simple_fit_skip_processing())
+		return 0;
+
+	ctx.fit = spl_load_simple_fit_fix_load(ctx.fit);
+
+	ret = spl_simple_fit_parse(&ctx);
+	if (ret < 0)
+		return ret;
+
+	if (CONFIG_IS_ENABLED(FIT_PREFETCH)) {
+		spl_fit_prefetch(&pf, &ctx, info, offset);
+		ret = spl_fit_load_images(spl_image, &pf.load, offset, &ctx);
+		spl_fit_prefetch_free(&pf);
+
+		return ret;
+	}
+
+	return spl_fit_load_images(spl_image, info, offset, &ctx);
+}
+
 /* Parse and load full fitImage in SPL */
 int spl_load_fit_image(struct spl_image_info *spl_image,
 		       const struct legacy_img_hdr *header)
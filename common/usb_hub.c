@@ -619,6 +619,53 @@ static struct usb_hub_device *usb_get_hub_device(struct usb_device *dev)
 	return hub;
 }
 
+static int usb_hub_scan_ports(struct usb_device *dev,
+			      struct usb_hub_device *hub)
+{
+	int i;
+
+	/*
+	 * Only add the connected USB devices, including potential hubs,
+	 * to a scanning list. This list will get scanned and devices that
+	 * are detected (either via port connected or via port timeout)
+	 * will get removed from this list. Scanning of the devices on this
+	 * list will continue until all devices are removed.
+	 */
+	for (i = 0; i < dev->maxchild; i++) {
+		struct usb_device_scan *usb_scan;
+
+		usb_scan = calloc(1, sizeof(*usb_scan));
+		if (!usb_scan) {
+			printf("Can't allocate memory for USB device!\n");
+			return -ENOMEM;
+		}
+		usb_scan->dev = dev;
+		usb_scan->hub = hub;
+		usb_scan->port = i;
+		list_add_tail(&usb_scan->list, &usb_scan_list);
+	}
+
+	/*
+	 * And now call the scanning code which loops over the generated list
+	 */
+	return usb_device_list_scan();
+}
+
+/*
+ * usb_init_start() powers up the ports of each root hub and leaves them to
+ * settle. usb_init() scans them later with usb_hub_scan_powered().
+ */
+static bool usb_hub_power_only(struct usb_device *dev)
+{
+#if CONFIG_IS_ENABLED(DM_USB)
+	struct usb_bus_priv *priv = dev_get_uclass_priv(usb_get_bus(dev->dev));
+
+	return priv->rh_powered;
+#else
+	return false;
+#endif
+}
+
 static int usb_hub_configure(struct usb_device *dev)
 {
 	int i, length;
@@ -855,33 +902,10 @@ static int usb_hub_configure(struct usb_device *dev)
 	for (i = 0; i < dev->maxchild; i++)
 		usb_hub_reset_devices(hub, i + 1);
 
-	/*
-	 * Only add the connected USB devices, including potential hubs,
-	 * to a scanning list. This list will get scanned and devices that
-	 * are detected (either via port connected or via port timeout)
-	 * will get removed from this list. Scanning of the devices on this
-	 * list will continue until all devices are removed.
-	 */
-	for (i = 0; i < dev->maxchild; i++) {
-		struct usb_device_scan *usb_scan;
-
-		usb_scan = calloc(1, sizeof(*usb_scan));
-		if (!usb_scan) {
-			printf("Can't allocate memory for USB device!\n");
-			return -ENOMEM;
-		}
-		usb_scan->dev = dev;
-		usb_scan->hub = hub;
-		usb_scan->port = i;
-		list_add_tail(&usb_scan->list, &usb_scan_list);
-	}
-
-	/*
-	 * And now call the scanning code which loops over the generated list
-	 */
-	ret = usb_device_list_scan();
+	if (usb_hub_power_only(dev))
+		return 0;
 
-	return ret;
+	return usb_hub_scan_ports(dev, hub);
 }
 
 static int usb_hub_check(struct usb_device *dev, int ifnum)
@@ -943,6 +967,13 @@ int usb_hub_scan(struct udevice *hub)
 	return usb_hub_configure(udev);
 }
 
+int usb_hub_scan_powered(struct udevice *hub)
+{
+	struct usb_device *udev = dev_get_parent_priv(hub);
+
+	return usb_hub_scan_ports(udev, usb_get_hub_device(udev));
+}
+
 static int usb_hub_post_probe(struct udevice *dev)
 {
 	debug("%s\n", __func__);
@@ -19,6 +19,7 @@
 #include <dm/device_compat.h>
 #include <dm/device-internal.h>
 #include <dm/devres.h>
+#include <dm/handoff.h>
 #include <dm/read.h>
 #include <linux/bug.h>
 #include <linux/clk-provider.h>
@@ -284,6 +285,18 @@ static int clk_set_default_parents(struct udevice *dev,
 	return 0;
 }
 
+/* Check whether a prior phase set this rate and the clock still has it */
+static bool clk_handoff_done(struct clk *clk, ulong rate)
+{
+	u64 val;
+
+	if (dev_handoff_find(clk->dev, DM_HANDOFF_CLK_RATE, clk->id, &val) ||
+	    val != rate)
+		return false;
+
+	return clk_get_rate(clk) == rate;
+}
+
 static int clk_set_default_rates(struct udevice *dev,
 				 enum clk_defaults_stage stage)
 {
@@ -351,6 +364,12 @@ static int clk_set_default_rates(struct udevice *dev,
 		if (IS_ERR(c))
 			return PTR_ERR(c);
 
+		if (clk_handoff_done(c, rates[index])) {
+			dev_dbg(dev, "clock index %d already set\n", index);
+			ret = 0;
+			continue;
+		}
+
 		ret = clk_set_rate(c, rates[index]);
 
 		if (ret < 0) {
@@ -563,6 +582,7 @@ ulong clk_set_rate(struct clk *clk, ulong rate)
 {
 	const struct clk_ops *ops;
 	struct clk *clkp;
+	ulong ret;
 
 	debug("%s(clk=%p, rate=%lu)\n", __func__, clk, rate);
 	if (!clk_valid(clk))
@@ -577,7 +597,11 @@ ulong clk_set_rate(struct clk *clk, ulong rate)
 	/* Clean up cached rates for us and all child clocks */
 	clk_clean_rate_cache(clkp);
 
-	return ops->set_rate(clk, rate);
+	ret = ops->set_rate(clk, rate);
+	if (ret == rate && dev_has_ofnode(clk->dev))
+		dev_handoff_save(clk->dev, DM_HANDOFF_CLK_RATE, clk->id, rate);
+
+	return ret;
 }
 
 int clk_set_parent(struct clk *clk, struct clk *parent)
@@ -800,5 +824,6 @@ int clk_uclass_post_probe(struct udevice *dev)
 UCLASS_DRIVER(clk) = {
 	.id		= UCLASS_CLK,
 	.name		= "clk",
+	.flags		= DM_UC_FLAG_HANDOFF,
 	.post_probe	= clk_uclass_post_probe,
 };
@@ -21,11 +21,13 @@
 #include <asm/cache.h>
 #include <dm/device.h>
 #include <dm/device-internal.h>
+#include <dm/handoff.h>
 #include <dm/lists.h>
 #include <dm/of_access.h>
 #include <dm/pinctrl.h>
 #include <dm/platdata.h>
 #include <dm/read.h>
+#include <dm/root.h>
 #include <dm/uclass.h>
 #include <dm/uclass-internal.h>
 #include <dm/util.h>
@@ -56,7 +58,7 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 	if (!name)
 		return -EINVAL;
 
-	ret = uclass_get(drv->id, &uc);
+	ret = uclass_get_nobind(drv->id, &uc);
 	if (ret) {
 		dm_warn("Missing uclass for driver %s\n", drv->name);
 		return ret;
@@ -601,6 +603,11 @@ int device_probe(struct udevice *dev)
 	if (ret)
 		goto fail_event;
 
+	if (CONFIG_IS_ENABLED(DM_HANDOFF) &&
+	    (dev->uclass->uc_drv->flags & DM_UC_FLAG_HANDOFF) &&
+	    dev_has_ofnode(dev))
+		dev_handoff_save(dev, DM_HANDOFF_PROBED, 0, 1);
+
 	return 0;
 fail_event:
 fail_uclass:
@@ -791,6 +798,7 @@ int device_get_child(const struct udevice *parent, int index,
 {
 	struct udevice *dev;
 
+	dm_lazy_bind_children(parent);
 	device_foreach_child(dev, parent) {
 		if (!index--)
 			return device_get_device_tail(dev, 0, devp);
@@ -804,6 +812,7 @@ int device_get_child_count(const struct udevice *parent)
 	struct udevice *dev;
 	int count = 0;
 
+	dm_lazy_bind_children(parent);
 	device_foreach_child(dev, parent)
 		count++;
 
@@ -827,6 +836,7 @@ int device_find_child_by_seq(const struct udevice *parent, int seq,
 	struct udevice *dev;
 
 	*devp = NULL;
+	dm_lazy_bind_children(parent);
 
 	device_foreach_child(dev, parent) {
 		if (dev->seq_ == seq) {
@@ -856,6 +866,7 @@ int device_find_child_by_of_offset(const struct udevice *parent, int of_offset,
 	struct udevice *dev;
 
 	*devp = NULL;
+	dm_lazy_bind_children(parent);
 
 	device_foreach_child(dev, parent) {
 		if (dev_of_offset(dev) == of_offset) {
@@ -897,6 +908,7 @@ static struct udevice *_device_find_global_by_ofnode(struct udevice *parent,
 
 int device_find_global_by_ofnode(ofnode ofnode, struct udevice **devp)
 {
+	dm_lazy_bind_node(ofnode);
 	*devp = _device_find_global_by_ofnode(gd->dm_root, ofnode);
 
 	return *devp ? 0 : -ENOENT;
@@ -906,6 +918,7 @@ int device_get_global_by_ofnode(ofnode ofnode, struct udevice **devp)
 {
 	struct udevice *dev;
 
+	dm_lazy_bind_node(ofnode);
 	dev = _device_find_global_by_ofnode(gd->dm_root, ofnode);
 	return device_get_device_tail(dev, dev ? 0 : -ENOENT, devp);
 }
@@ -932,6 +945,7 @@ int device_get_by_ofplat_idx(uint idx, struct udevice **devp)
 
 int device_find_first_child(const struct udevice *parent, struct udevice **devp)
 {
+	dm_lazy_bind_children(parent);
 	if (list_empty(&parent->child_head)) {
 		*devp = NULL;
 	} else {
@@ -964,6 +978,7 @@ int device_find_first_inactive_child(const struct udevice *parent,
 	struct udevice *dev;
 
 	*devp = NULL;
+	dm_lazy_bind_children(parent);
 	device_foreach_child(dev, parent) {
 		if (!device_active(dev) &&
 		    device_get_uclass_id(dev) == uclass_id) {
@@ -982,6 +997,7 @@ int device_find_first_child_by_uclass(const struct udevice *parent,
 	struct udevice *dev;
 
 	*devp = NULL;
+	dm_lazy_bind_children(parent);
 	device_foreach_child(dev, parent) {
 		if (device_get_uclass_id(dev) == uclass_id) {
 			*devp = dev;
@@ -998,6 +1014,7 @@ int device_find_child_by_namelen(const struct udevice *parent, const char *name,
 	struct udevice *dev;
 
 	*devp = NULL;
+	dm_lazy_bind_children(parent);
 
 	device_foreach_child(dev, parent) {
 		if (!strncmp(dev->name, name, len) &&
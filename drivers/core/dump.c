@@ -332,6 +332,10 @@ void dm_dump_mem(struct dm_stats *stats)
 	       stats->attach_size_total + stats->uc_attach_size, "", "",
 	       total_delta > 0 ? total_delta : 0, total_delta);
 	printf("%-16s %5x %6x\n", "tags", stats->tag_count, stats->tag_size);
+	if (CONFIG_IS_ENABLED(DM_LAZY_BIND))
+		printf("%-16s %5x %6x  (pending %x)\n", "lazy bound",
+		       stats->lazy_bound_count, stats->lazy_bound_size,
+		       stats->lazy_pending_count);
 	printf("\n");
 	printf("Total size: %x (%d)\n", stats->total_size, stats->total_size);
 	printf("\n");
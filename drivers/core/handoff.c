@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Passing driver-model state from SPL to U-Boot proper
+ *
+ * Devices are identified by a hash of their devicetree path, since the
+ * devicetree used by SPL is normally a subset of the one used by U-Boot
+ * proper, so node offsets differ. Users of the state must check that the
+ * hardware matches it before skipping any work, since a hash can collide.
+ */
+
+#define LOG_CATEGORY	LOGC_DM
+
+#include <alist.h>
+#include <bloblist.h>
+#include <dm.h>
+#include <log.h>
+#include <malloc.h>
+#include <asm/global_data.h>
+#include <dm/handoff.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Longest devicetree path which can be recorded */
+#define DM_HANDOFF_MAX_PATH	256
+
+/* FNV-1a */
+static u32 dm_handoff_hash(const char *str)
+{
+	u32 hash = 2166136261U;
+
+	while (*str) {
+		hash ^= (u8)*str++;
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+static int dev_handoff_key(struct udevice *dev, u32 *keyp)
+{
+	char path[DM_HANDOFF_MAX_PATH];
+	int ret;
+
+	if (!dev_has_ofnode(dev))
+		return -ENOENT;
+	ret = ofnode_get_path(dev_ofnode(dev), path, sizeof(path));
+	if (ret)
+		return ret;
+	*keyp = dm_handoff_hash(path);
+
+	return 0;
+}
+
+int dev_handoff_add(struct udevice *dev, enum dm_handoff_t type, ulong id,
+		    u64 val)
+{
+	struct alist *lst = gd->dm_handoff;
+	struct dm_handoff_rec *rec;
+	u32 key;
+	int ret, i;
+
+	if (id > U32_MAX)
+		return log_msg_ret("id", -E2BIG);
+	ret = dev_handoff_key(dev, &key);
+	if (ret)
+		return log_msg_ret("key", ret);
+
+	if (!lst) {
+		lst = malloc(sizeof(*lst));
+		if (!lst)
+			return log_msg_ret("lst", -ENOMEM);
+		alist_init_struct(lst, struct dm_handoff_rec);
+		gd->dm_handoff = lst;
+	}
+
+	for (i = 0; i < lst->count; i++) {
+		rec = alist_getw(lst, i, struct dm_handoff_rec);
+		if (rec->key == key && rec->type == type && rec->id == id) {
+			rec->val = val;
+			return 0;
+		}
+	}
+
+	rec = alist_add_placeholder(lst);
+	if (!rec)
+		return log_msg_ret("add", -ENOMEM);
+	rec->key = key;
+	rec->type = type;
+	rec->id = id;
+	rec->reserved = 0;
+	rec->val = val;
+
+	return 0;
+}
+
+int dev_handoff_find(struct udevice *dev, enum dm_handoff_t type, ulong id,
+		     u64 *valp)
+{
+	const struct dm_handoff_rec *rec;
+	const struct dm_handoff *ho;
+	u32 key;
+	int i;
+
+	ho = bloblist_find(BLOBLISTT_U_BOOT_DM_STATE, 0);
+	if (!ho || ho->rec_size != sizeof(*rec) || id > U32_MAX ||
+	    dev_handoff_key(dev, &key))
+		return -ENOENT;
+
+	for (i = 0, rec = ho->recs; i < ho->count; i++, rec++) {
+		if (rec->key == key && rec->type == type && rec->id == id) {
+			*valp = rec->val;
+			return 0;
+		}
+	}
+
+	return -ENOENT;
+}
+
+int dm_handoff_write(void)
+{
+	struct alist *lst = gd->dm_handoff;
+	struct dm_handoff *ho;
+	int size, ret;
+
+	if (!lst || !lst->count)
+		return 0;
+
+	/* replace any state passed on by an earlier phase */
+	size = sizeof(*ho) + lst->count * sizeof(struct dm_handoff_rec);
+	if (bloblist_find(BLOBLISTT_U_BOOT_DM_STATE, 0)) {
+		ret = bloblist_resize(BLOBLISTT_U_BOOT_DM_STATE, size);
+		if (ret)
+			return log_msg_ret("rsz", ret);
+	}
+	ret = bloblist_ensure_size(BLOBLISTT_U_BOOT_DM_STATE, size, 0,
+				   (void **)&ho);
+	if (ret)
+		return log_msg_ret("blb", ret);
+	ho->count = lst->count;
+	ho->rec_size = sizeof(struct dm_handoff_rec);
+	memcpy(ho->recs, lst->data, lst->count * sizeof(struct dm_handoff_rec));
+	log_debug("Wrote %d records\n", lst->count);
+
+	alist_uninit(lst);
+	free(lst);
+	gd->dm_handoff = NULL;
+
+	return 0;
+}
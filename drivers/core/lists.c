@@ -14,6 +14,7 @@
 #include <dm/device.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
+#include <dm/of_index.h>
 #include <dm/platdata.h>
 #include <dm/uclass.h>
 #include <dm/util.h>
@@ -196,11 +197,32 @@ static int driver_check_compatible(const struct udevice_id *of_match,
 	return -ENOENT;
 }
 
-int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
-		   struct driver *drv, bool pre_reloc_only)
+int lists_driver_lookup_compat(const char *compat, struct driver **drvp,
+			       const struct udevice_id **of_idp)
 {
 	struct driver *driver = ll_entry_start(struct driver, driver);
 	const int n_ents = ll_entry_count(struct driver, driver);
+	struct driver *entry;
+	int ret;
+
+	ret = of_index_find_driver(compat, drvp, of_idp);
+	if (ret != -ENOENT && ret) {
+		for (entry = driver; entry != driver + n_ents; entry++) {
+			if (!driver_check_compatible(entry->of_match, of_idp,
+						     compat)) {
+				*drvp = entry;
+				return 0;
+			}
+		}
+		ret = -ENOENT;
+	}
+
+	return ret;
+}
+
+int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
+		   struct driver *drv, bool pre_reloc_only)
+{
 	const struct udevice_id *id;
 	struct driver *entry;
 	struct udevice *dev;
@@ -238,19 +260,15 @@ int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 			  compat);
 
 		id = NULL;
-		for (entry = driver; entry != driver + n_ents; entry++) {
-			if (drv) {
-				if (drv != entry)
-					continue;
-				if (!entry->of_match)
-					break;
-			}
-			ret = driver_check_compatible(entry->of_match, &id,
-						      compat);
-			if (!ret)
-				break;
+		if (drv) {
+			entry = drv;
+			ret = entry->of_match ?
+				driver_check_compatible(entry->of_match, &id,
+							compat) : 0;
+		} else {
+			ret = lists_driver_lookup_compat(compat, &entry, &id);
 		}
-		if (entry == driver + n_ents)
+		if (ret)
 			continue;
 
 		if (pre_reloc_only) {
@@ -21,6 +21,7 @@
 
 #include <log.h>
 #include <malloc.h>
+#include <of_live.h>
 #include <asm/global_data.h>
 #include <linux/bug.h>
 #include <linux/libfdt.h>
@@ -387,9 +388,16 @@ struct device_node *of_find_node_opts_by_path(struct device_node *root,
 		path = p;
 	}
 
-	/* Step down the tree matching path components */
-	if (!np)
+	/* Use the index if there is one, else step down the tree */
+	if (!np) {
+		int len = separator ? separator - path : strlen(path);
+		int ret;
+
+		ret = of_live_index_path(root, path, len, &np);
+		if (ret != -ENOSYS)
+			return ret ? NULL : of_node_get(np);
 		np = of_node_get(root);
+	}
 	while (np && *path == '/') {
 		struct device_node *tmp = np;
 
@@ -449,10 +457,15 @@ struct device_node *of_find_node_by_phandle(struct device_node *root,
 					    phandle handle)
 {
 	struct device_node *np;
+	int ret;
 
 	if (!handle)
 		return NULL;
 
+	ret = of_live_index_phandle(root ?: gd->of_root, handle, &np);
+	if (ret != -ENOSYS)
+		return ret ? NULL : of_node_get(np);
+
 	for_each_of_allnodes_from(root, np)
 		if (np->phandle == handle)
 			break;
@@ -1035,6 +1048,7 @@ int of_add_subnode(struct device_node *parent, const char *name, int len,
 	if (!parent->child)
 		parent->child = new;
 	new->parent = parent;
+	of_live_index_node_added(new);
 
 	*childp = new;
 
@@ -1086,6 +1100,7 @@ int of_remove_node(struct device_node *to_remove)
 	}
 	if (!np)
 		return -EFAULT;
+	of_live_index_node_removed(np);
 
 	/* if there is a previous node, link it to this one's sibling */
 	if (prev)
@@ -0,0 +1,319 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Lookup index for phandles in the control FDT and for driver compatible
+ * strings
+ *
+ * Both tables are built on first use. Until the full malloc() is ready they
+ * come from the early malloc() area; after that a fresh index is built, since
+ * the early area may be gone and cannot be freed with the full malloc().
+ */
+
+#define LOG_CATEGORY	LOGC_DT
+
+#include <dm.h>
+#include <log.h>
+#include <malloc.h>
+#include <sort.h>
+#include <asm/global_data.h>
+#include <dm/of_index.h>
+#include <linux/libfdt.h>
+#include <linux/log2.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/**
+ * struct of_index_phandle - phandle table entry
+ *
+ * @phandle: phandle of the node
+ * @offset: offset of the node in the FDT
+ */
+struct of_index_phandle {
+	u32 phandle;
+	int offset;
+};
+
+/**
+ * struct of_index_compat - compatible hash table entry
+ *
+ * @hash: hash of the compatible string
+ * @drv: index of the driver in the driver linker list plus one, 0 if the
+ *	slot is free
+ * @id: index of the compatible string in the driver's of_match table
+ */
+struct of_index_compat {
+	u32 hash;
+	u16 drv;
+	u16 id;
+};
+
+/**
+ * struct of_index - lookup index
+ *
+ * @full_malloc: true if allocated with the full malloc()
+ * @blob: FDT the phandle table was built from, NULL if it must be rebuilt
+ * @phandles: phandle table, sorted by phandle
+ * @phandle_count: number of entries in @phandles
+ * @compats: compatible hash table, NULL if not built yet
+ * @compat_mask: number of slots in @compats minus one
+ * @compat_err: error from building @compats, so that it is not tried again
+ */
+struct of_index {
+	bool full_malloc;
+	const void *blob;
+	struct of_index_phandle *phandles;
+	int phandle_count;
+	struct of_index_compat *compats;
+	uint compat_mask;
+	int compat_err;
+};
+
+static struct of_index *of_index_get(void)
+{
+	bool full_malloc = gd->flags & GD_FLG_FULL_MALLOC_INIT;
+	struct of_index *idx = gd->of_index;
+
+	/* An index in the early malloc() area is abandoned, not freed */
+	if (idx && idx->full_malloc == full_malloc)
+		return idx;
+
+	idx = calloc(1, sizeof(*idx));
+	if (!idx)
+		return NULL;
+	idx->full_malloc = full_malloc;
+	gd->of_index = idx;
+
+	return idx;
+}
+
+static int of_index_phandle_cmp(const void *a, const void *b)
+{
+	const struct of_index_phandle *pa = a, *pb = b;
+
+	if (pa->phandle == pb->phandle)
+		return 0;
+
+	return pa->phandle < pb->phandle ? -1 : 1;
+}
+
+static int of_index_build_phandles(struct of_index *idx, const void *blob)
+{
+	struct of_index_phandle *ents;
+	int offset, count, i;
+	u32 phandle;
+
+	free(idx->phandles);
+	idx->phandles = NULL;
+	idx->phandle_count = 0;
+	idx->blob = NULL;
+
+	count = 0;
+	for (offset = fdt_next_node(blob, -1, NULL); offset >= 0;
+	     offset = fdt_next_node(blob, offset, NULL)) {
+		if (fdt_get_phandle(blob, offset))
+			count++;
+	}
+
+	ents = malloc(count * sizeof(*ents) ?: 1);
+	if (!ents)
+		return -ENOMEM;
+
+	i = 0;
+	for (offset = fdt_next_node(blob, -1, NULL); offset >= 0 && i < count;
+	     offset = fdt_next_node(blob, offset, NULL)) {
+		phandle = fdt_get_phandle(blob, offset);
+		if (phandle) {
+			ents[i].phandle = phandle;
+			ents[i].offset = offset;
+			i++;
+		}
+	}
+	qsort(ents, count, sizeof(*ents), of_index_phandle_cmp);
+
+	idx->phandles = ents;
+	idx->phandle_count = count;
+	idx->blob = blob;
+	log_debug("of_index: %d phandles\n", count);
+
+	return 0;
+}
+
+static struct of_index_phandle *of_index_find_phandle(struct of_index *idx,
+						      u32 phandle)
+{
+	int lo = 0, hi = idx->phandle_count;
+
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		struct of_index_phandle *ent = &idx->phandles[mid];
+
+		if (ent->phandle == phandle)
+			return ent;
+		if (ent->phandle < phandle)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return NULL;
+}
+
+int of_index_phandle_offset(const void *blob, uint phandle)
+{
+	struct of_index_phandle *ent = NULL;
+	struct of_index *idx = NULL;
+	int offset;
+
+	if (blob == gd->fdt_blob && phandle && phandle != (uint)-1)
+		idx = of_index_get();
+	if (idx && idx->blob != blob && of_index_build_phandles(idx, blob))
+		idx = NULL;
+
+	if (idx) {
+		ent = of_index_find_phandle(idx, phandle);
+		if (ent && fdt_get_phandle(blob, ent->offset) == phandle)
+			return ent->offset;
+	}
+
+	offset = fdt_node_offset_by_phandle(blob, phandle);
+
+	/* The tree has changed since the index was built */
+	if (idx && (ent || offset >= 0)) {
+		log_debug("of_index: stale entry for phandle %x\n", phandle);
+		idx->blob = NULL;
+	}
+
+	return offset;
+}
+
+void of_index_invalidate(void)
+{
+	struct of_index *idx = gd->of_index;
+
+	if (idx)
+		idx->blob = NULL;
+}
+
+/* FNV-1a */
+static u32 of_index_hash(const char *str)
+{
+	u32 hash = 2166136261U;
+
+	while (*str) {
+		hash ^= (u8)*str++;
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+static const char *of_index_compat_str(struct driver *drivers,
+				       struct of_index_compat *ent)
+{
+	return drivers[ent->drv - 1].of_match[ent->id].compatible;
+}
+
+/*
+ * The early malloc() area may only be a few KB, so before relocation the
+ * hash table may use at most a quarter of what is left of it
+ */
+static bool of_index_compats_fit(uint size)
+{
+#if CONFIG_IS_ENABLED(SYS_MALLOC_F)
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return size <= (gd->malloc_limit - gd->malloc_ptr) / 4;
+#endif
+
+	return true;
+}
+
+static int of_index_build_compats(struct of_index *idx)
+{
+	struct driver *drivers = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	const struct udevice_id *of_match;
+	struct of_index_compat *table, *ent;
+	uint count = 0, mask, slot;
+	u32 hash;
+	int i, j;
+
+	if (n_ents >= U16_MAX)
+		return -E2BIG;
+
+	for (i = 0; i < n_ents; i++) {
+		for (of_match = drivers[i].of_match; of_match &&
+		     of_match->compatible; of_match++)
+			count++;
+	}
+
+	mask = roundup_pow_of_two(max(count * 2, 16U)) - 1;
+	if (!of_index_compats_fit((mask + 1) * sizeof(*table))) {
+		log_debug("of_index: no room for %u slots\n", mask + 1);
+		return -ENOSPC;
+	}
+	table = calloc(mask + 1, sizeof(*table));
+	if (!table)
+		return -ENOMEM;
+
+	for (i = 0; i < n_ents; i++) {
+		of_match = drivers[i].of_match;
+		for (j = 0; of_match && of_match[j].compatible; j++) {
+			hash = of_index_hash(of_match[j].compatible);
+			for (slot = hash & mask; table[slot].drv;
+			     slot = (slot + 1) & mask) {
+				ent = &table[slot];
+				/* Keep the first driver, as a linear search would */
+				if (ent->hash == hash &&
+				    !strcmp(of_index_compat_str(drivers, ent),
+					    of_match[j].compatible))
+					break;
+			}
+			if (table[slot].drv)
+				continue;
+			table[slot].hash = hash;
+			table[slot].drv = i + 1;
+			table[slot].id = j;
+		}
+	}
+
+	idx->compats = table;
+	idx->compat_mask = mask;
+	log_debug("of_index: %u compatible strings, %u slots\n", count,
+		  mask + 1);
+
+	return 0;
+}
+
+int of_index_find_driver(const char *compat, struct driver **drvp,
+			 const struct udevice_id **of_idp)
+{
+	struct driver *drivers = ll_entry_start(struct driver, driver);
+	struct of_index_compat *ent;
+	struct of_index *idx;
+	uint slot;
+	u32 hash;
+
+	idx = of_index_get();
+	if (!idx)
+		return -ENOMEM;
+	if (idx->compat_err)
+		return idx->compat_err;
+	if (!idx->compats) {
+		idx->compat_err = of_index_build_compats(idx);
+		if (idx->compat_err)
+			return idx->compat_err;
+	}
+
+	hash = of_index_hash(compat);
+	for (slot = hash & idx->compat_mask; idx->compats[slot].drv;
+	     slot = (slot + 1) & idx->compat_mask) {
+		ent = &idx->compats[slot];
+		if (ent->hash == hash &&
+		    !strcmp(of_index_compat_str(drivers, ent), compat)) {
+			*drvp = &drivers[ent->drv - 1];
+			*of_idp = &(*drvp)->of_match[ent->id];
+			return 0;
+		}
+	}
+
+	return -ENOENT;
+}
@@ -15,6 +15,7 @@
 #include <linux/libfdt.h>
 #include <dm/of_access.h>
 #include <dm/of_addr.h>
+#include <dm/of_index.h>
 #include <dm/ofnode.h>
 #include <dm/util.h>
 #include <linux/err.h>
@@ -712,8 +713,8 @@ ofnode ofnode_get_by_phandle(uint phandle)
 	if (of_live_active())
 		node = np_to_ofnode(of_find_node_by_phandle(NULL, phandle));
 	else
-		node.of_offset = fdt_node_offset_by_phandle(gd->fdt_blob,
-							    phandle);
+		node.of_offset = of_index_phandle_offset(gd->fdt_blob,
+							 phandle);
 
 	return node;
 }
@@ -726,8 +727,8 @@ ofnode oftree_get_by_phandle(oftree tree, uint phandle)
 		node = np_to_ofnode(of_find_node_by_phandle(tree.np, phandle));
 	else
 		node = ofnode_from_tree_offset(tree,
-			fdt_node_offset_by_phandle(oftree_lookup_fdt(tree),
-						   phandle));
+			of_index_phandle_offset(oftree_lookup_fdt(tree),
+						phandle));
 
 	return node;
 }
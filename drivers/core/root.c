@@ -36,6 +36,37 @@ static struct driver_info root_info = {
 	.name		= "root_driver",
 };
 
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+/**
+ * struct dm_lazy_node - node in a pending subtree which has a driver
+ *
+ * @node: Device tree node
+ * @id: Uclass of the driver for its first matching compatible string
+ */
+struct dm_lazy_node {
+	ofnode node;
+	enum uclass_id id;
+};
+
+/**
+ * struct dm_lazy_index - nodes of all pending subtrees, with their uclass
+ *
+ * This saves matching the compatible strings of every node again for each
+ * uclass which is searched.
+ *
+ * @nodes: Nodes, in device tree order
+ * @count: Number of entries in @nodes
+ * @gen: Incremented each time @nodes is rebuilt
+ * @stale: true if a subtree not covered by @nodes was deferred
+ */
+struct dm_lazy_index {
+	struct dm_lazy_node *nodes;
+	int count;
+	uint gen;
+	bool stale;
+};
+#endif
+
 struct udevice *dm_root(void)
 {
 	if (!gd->dm_root) {
@@ -99,6 +130,10 @@ int dm_init(bool of_live)
 		dm_warn("Virtual root driver already exists!\n");
 		return -EINVAL;
 	}
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+	/* An index from before relocation is abandoned, like the old tree */
+	gd->dm_lazy_index = NULL;
+#endif
 	if (CONFIG_IS_ENABLED(OF_PLATDATA_INST)) {
 		gd->uclass_root = &uclass_head;
 	} else {
@@ -136,6 +171,13 @@ int dm_uninit(void)
 	device_remove(dm_root(), DM_REMOVE_NORMAL);
 	device_unbind(dm_root());
 	gd->dm_root = NULL;
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+	if (gd->dm_lazy_index) {
+		free(gd->dm_lazy_index->nodes);
+		free(gd->dm_lazy_index);
+		gd->dm_lazy_index = NULL;
+	}
+#endif
 
 	return 0;
 }
@@ -226,6 +268,11 @@ static int dm_scan_fdt_node(struct udevice *parent, ofnode parent_node,
 
 int dm_scan_fdt_dev(struct udevice *dev)
 {
+	if (CONFIG_IS_ENABLED(DM_LAZY_BIND) && !(gd->flags & GD_FLG_RELOC)) {
+		dm_lazy_bind_defer(dev);
+		return 0;
+	}
+
 	return dm_scan_fdt_node(dev, dev_ofnode(dev),
 				gd->flags & GD_FLG_RELOC ? false : true);
 }
@@ -312,6 +359,286 @@ probe_children:
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+static int dm_lazy_index_subtree(ofnode parent, struct dm_lazy_node *nodes,
+				 int count)
+{
+	const struct udevice_id *of_id;
+	const char *compat_list, *compat;
+	struct driver *drv;
+	ofnode node;
+	int len, i;
+
+	ofnode_for_each_subnode(node, parent) {
+		compat_list = ofnode_get_property(node, "compatible", &len);
+		for (i = 0; compat_list && i < len; i += strlen(compat) + 1) {
+			compat = compat_list + i;
+			if (lists_driver_lookup_compat(compat, &drv, &of_id))
+				continue;
+			if (nodes) {
+				nodes[count].node = node;
+				nodes[count].id = drv->id;
+			}
+			count++;
+			break;
+		}
+		count = dm_lazy_index_subtree(node, nodes, count);
+	}
+
+	return count;
+}
+
+static int dm_lazy_index_devs(struct udevice *dev, struct dm_lazy_node *nodes,
+			      int count)
+{
+	struct udevice *child;
+
+	if (dev != gd->dm_root && (dev_get_flags(dev) & DM_FLAG_BIND_PENDING))
+		return dm_lazy_index_subtree(dev_ofnode(dev), nodes, count);
+
+	device_foreach_child(child, dev)
+		count = dm_lazy_index_devs(child, nodes, count);
+
+	return count;
+}
+
+/*
+ * The index is built by walking the pending subtrees once. It stays valid as
+ * they are bound, since a subtree deferred by a device bound from the index
+ * is already in it.
+ */
+static struct dm_lazy_index *dm_lazy_get_index(void)
+{
+	struct dm_lazy_index *idx = gd->dm_lazy_index;
+	struct dm_lazy_node *nodes;
+	int count;
+
+	if (!idx) {
+		idx = calloc(1, sizeof(*idx));
+		if (!idx)
+			return NULL;
+		idx->stale = true;
+		gd->dm_lazy_index = idx;
+	}
+	if (!idx->stale)
+		return idx;
+
+	count = dm_lazy_index_devs(gd->dm_root, NULL, 0);
+	nodes = malloc(count * sizeof(*nodes) ?: 1);
+	if (!nodes)
+		return NULL;
+	free(idx->nodes);
+	idx->nodes = nodes;
+	idx->count = dm_lazy_index_devs(gd->dm_root, nodes, 0);
+	idx->stale = false;
+	idx->gen++;
+
+	return idx;
+}
+
+static bool dm_lazy_indexed(struct dm_lazy_index *idx, ofnode node)
+{
+	int i;
+
+	for (i = 0; i < idx->count; i++) {
+		if (ofnode_equal(idx->nodes[i].node, node))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * The root device never has subnodes pending. Its DM_FLAG_BIND_PENDING flag
+ * means that some device in the tree does, so lookups can skip the walk.
+ */
+void dm_lazy_bind_defer(struct udevice *dev)
+{
+	struct dm_lazy_index *idx = gd->dm_lazy_index;
+	struct uclass *uc;
+
+	dev_or_flags(dev, DM_FLAG_BIND_PENDING);
+	dev_or_flags(gd->dm_root, DM_FLAG_BIND_PENDING);
+
+	/* The subnodes of a node in the index are in it too */
+	if (idx && !idx->stale && !dm_lazy_indexed(idx, dev_ofnode(dev)))
+		idx->stale = true;
+
+	/* Each uclass must look again for its nodes in the new subtree */
+	list_for_each_entry(uc, gd->uclass_root, sibling_node)
+		uc->lazy_bound = false;
+}
+
+static bool dm_lazy_pending(void)
+{
+	return gd->dm_root &&
+		(dev_get_flags(gd->dm_root) & DM_FLAG_BIND_PENDING);
+}
+
+static int dm_lazy_bind_dev(struct udevice *dev)
+{
+	bool pre_reloc_only = !(gd->flags & GD_FLG_RELOC);
+	struct list_head *last = dev->child_head.prev;
+	struct udevice *child;
+	int ret;
+
+	if (!(dev_get_flags(dev) & DM_FLAG_BIND_PENDING) || dev == gd->dm_root)
+		return 0;
+
+	/* Clear the flag first, since binding may trigger other lookups */
+	dev_bic_flags(dev, DM_FLAG_BIND_PENDING);
+	log_debug("lazy bind: %s\n", dev->name);
+	ret = dm_scan_fdt_node(dev, dev_ofnode(dev), pre_reloc_only);
+
+	/* New children follow the previous last child */
+	for (child = list_entry(last->next, struct udevice, sibling_node);
+	     &child->sibling_node != &dev->child_head;
+	     child = list_entry(child->sibling_node.next, struct udevice,
+				sibling_node)) {
+		dev_or_flags(child, DM_FLAG_BIND_LAZY);
+		dm_probe_devices(child, pre_reloc_only);
+	}
+
+	return ret;
+}
+
+/*
+ * Lookups pass a const parent, so find the same device through its parent's
+ * list of children, from the root down
+ */
+static struct udevice *dm_lazy_get_dev(const struct udevice *target)
+{
+	struct udevice *parent, *dev;
+
+	if (target == gd->dm_root)
+		return gd->dm_root;
+	parent = target->parent ? dm_lazy_get_dev(target->parent) : NULL;
+	if (!parent)
+		return NULL;
+	device_foreach_child(dev, parent) {
+		if (dev == target)
+			return dev;
+	}
+
+	return NULL;
+}
+
+int dm_lazy_bind_children(const struct udevice *parent)
+{
+	struct udevice *dev;
+
+	if (!(dev_get_flags(parent) & DM_FLAG_BIND_PENDING))
+		return 0;
+	dev = dm_lazy_get_dev(parent);
+
+	return dev ? dm_lazy_bind_dev(dev) : -ENODEV;
+}
+
+/*
+ * Bind the pending subnodes of each ancestor of @node from the top down,
+ * returning the device for @node, or for its closest ancestor which has one.
+ * Nodes without a device, such as /clocks, keep the device of their parent,
+ * since dm_extended_scan() binds their subnodes there.
+ */
+static struct udevice *dm_lazy_bind_path(ofnode node, int *errp)
+{
+	struct udevice *dev, *child;
+	ofnode parent;
+	int ret;
+
+	parent = ofnode_get_parent(node);
+	if (!ofnode_valid(parent))
+		return gd->dm_root;
+	dev = dm_lazy_bind_path(parent, errp);
+
+	ret = dm_lazy_bind_dev(dev);
+	if (ret && !*errp)
+		*errp = ret;
+	device_foreach_child(child, dev) {
+		if (ofnode_equal(dev_ofnode(child), node))
+			return child;
+	}
+
+	return dev;
+}
+
+int dm_lazy_bind_node(ofnode node)
+{
+	int ret = 0;
+
+	if (dm_lazy_pending() && ofnode_valid(node))
+		dm_lazy_bind_path(node, &ret);
+
+	return ret;
+}
+
+int dm_lazy_bind_uclass(struct uclass *uc)
+{
+	enum uclass_id id = uc->uc_drv->id;
+	struct dm_lazy_index *idx;
+	int ret, err = 0;
+	uint gen;
+	int i;
+
+	if (uc->lazy_bound || !dm_lazy_pending())
+		return 0;
+	idx = dm_lazy_get_index();
+	if (!idx)
+		return dm_lazy_bind_all();
+
+	/* Set this first, since binding may search the uclass again */
+	uc->lazy_bound = true;
+	gen = idx->gen;
+	for (i = 0; i < idx->count; i++) {
+		if (idx->nodes[i].id != id)
+			continue;
+		ret = dm_lazy_bind_node(idx->nodes[i].node);
+		if (ret && !err)
+			err = ret;
+
+		/* Start again if a subtree outside the index was deferred */
+		if (idx->stale || idx->gen != gen) {
+			if (!dm_lazy_get_index())
+				return dm_lazy_bind_all();
+			gen = idx->gen;
+			i = -1;
+		}
+	}
+	uc->lazy_bound = true;
+
+	return err;
+}
+
+static int dm_lazy_bind_tree(struct udevice *parent)
+{
+	struct udevice *dev;
+	int ret, err;
+
+	err = dm_lazy_bind_dev(parent);
+
+	device_foreach_child(dev, parent) {
+		ret = dm_lazy_bind_tree(dev);
+		if (ret && !err)
+			err = ret;
+	}
+
+	return err;
+}
+
+int dm_lazy_bind_all(void)
+{
+	int ret;
+
+	if (!dm_lazy_pending())
+		return 0;
+
+	ret = dm_lazy_bind_tree(gd->dm_root);
+	dev_bic_flags(gd->dm_root, DM_FLAG_BIND_PENDING);
+
+	return ret;
+}
+#endif
+
 /**
  * dm_scan() - Scan tables to bind devices
  *
@@ -388,6 +715,14 @@ void dev_collect_stats(struct dm_stats *stats, const struct udevice *parent)
 	stats->dev_count++;
 	stats->dev_size += sizeof(struct udevice);
 	stats->dev_name_size += strlen(parent->name) + 1;
+	if (dev_get_flags(parent) & DM_FLAG_BIND_LAZY) {
+		stats->lazy_bound_count++;
+		stats->lazy_bound_size += sizeof(struct udevice) +
+			strlen(parent->name) + 1;
+	}
+	if (parent != gd->dm_root &&
+	    (dev_get_flags(parent) & DM_FLAG_BIND_PENDING))
+		stats->lazy_pending_count++;
 	for (i = 0; i < DM_TAG_ATTACH_COUNT; i++) {
 		int size = dev_get_attach_size(parent, i);
 
@@ -397,6 +732,8 @@ void dev_collect_stats(struct dm_stats *stats, const struct udevice *parent)
 			stats->attach_size[i] += size;
 			stats->attach_count_total++;
 			stats->attach_size_total += size;
+			if (dev_get_flags(parent) & DM_FLAG_BIND_LAZY)
+				stats->lazy_bound_size += size;
 		}
 	}
 
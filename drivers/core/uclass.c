@@ -16,6 +16,7 @@
 #include <dm/device.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
+#include <dm/root.h>
 #include <dm/uclass.h>
 #include <dm/uclass-internal.h>
 #include <dm/util.h>
@@ -141,7 +142,7 @@ int uclass_destroy(struct uclass *uc)
 	return 0;
 }
 
-int uclass_get(enum uclass_id id, struct uclass **ucp)
+int uclass_get_nobind(enum uclass_id id, struct uclass **ucp)
 {
 	struct uclass *uc;
 
@@ -160,11 +161,23 @@ int uclass_get(enum uclass_id id, struct uclass **ucp)
 	return 0;
 }
 
+int uclass_get(enum uclass_id id, struct uclass **ucp)
+{
+	int ret;
+
+	ret = uclass_get_nobind(id, ucp);
+	if (ret)
+		return ret;
+	dm_lazy_bind_uclass(*ucp);
+
+	return 0;
+}
+
 const char *uclass_get_name(enum uclass_id id)
 {
 	struct uclass *uc;
 
-	if (uclass_get(id, &uc))
+	if (uclass_get_nobind(id, &uc))
 		return NULL;
 	return uc->uc_drv->name;
 }
@@ -348,6 +361,7 @@ int uclass_find_device_by_seq(enum uclass_id id, int seq, struct udevice **devp)
 	log_debug("%d\n", seq);
 	if (seq == -1)
 		return -ENODEV;
+	dm_lazy_bind_all();
 	ret = uclass_get(id, &uc);
 	if (ret)
 		return ret;
@@ -375,7 +389,8 @@ int uclass_find_device_by_of_offset(enum uclass_id id, int node,
 	*devp = NULL;
 	if (node < 0)
 		return -ENODEV;
-	ret = uclass_get(id, &uc);
+	dm_lazy_bind_node(offset_to_ofnode(node));
+	ret = uclass_get_nobind(id, &uc);
 	if (ret)
 		return ret;
 
@@ -400,7 +415,8 @@ int uclass_find_device_by_ofnode(enum uclass_id id, ofnode node,
 	*devp = NULL;
 	if (!ofnode_valid(node))
 		return -ENODEV;
-	ret = uclass_get(id, &uc);
+	dm_lazy_bind_node(node);
+	ret = uclass_get_nobind(id, &uc);
 	if (ret)
 		return ret;
 
@@ -429,7 +445,8 @@ static int uclass_find_device_by_phandle_id(enum uclass_id id,
 	struct uclass *uc;
 	int ret;
 
-	ret = uclass_get(id, &uc);
+	dm_lazy_bind_node(ofnode_get_by_phandle(find_phandle));
+	ret = uclass_get_nobind(id, &uc);
 	if (ret)
 		return ret;
 
@@ -835,6 +852,7 @@ int uclass_id_count(enum uclass_id id)
 	struct uclass *uc;
 	int count = 0;
 
+	dm_lazy_bind_all();
 	uclass_id_foreach_dev(id, dev, uc)
 		count++;
 
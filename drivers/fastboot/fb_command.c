@@ -12,6 +12,7 @@
 #include <fb_nand.h>
 #include <part.h>
 #include <stdlib.h>
+#include <time.h>
 #include <vsprintf.h>
 #include <linux/printk.h>
 
@@ -30,6 +31,13 @@ static u32 fastboot_bytes_received;
  */
 static u32 fastboot_bytes_expected;
 
+/**
+ * fastboot_download_start - timestamp at which the current download started
+ */
+static ulong fastboot_download_start;
+
+struct fastboot_stats fastboot_stats;
+
 static void okay(char *, char *);
 static void getvar(char *, char *);
 static void download(char *, char *);
@@ -249,6 +257,7 @@ static void download(char *cmd_parameter, char *response)
 	} else {
 		printf("Starting download of %d bytes\n",
 		       fastboot_bytes_expected);
+		fastboot_download_start = get_timer(0);
 		fastboot_response("DATA", response, "%s", cmd_parameter);
 	}
 }
@@ -321,6 +330,8 @@ void fastboot_data_complete(char *response)
 	printf("\ndownloading of %d bytes finished\n", fastboot_bytes_received);
 	image_size = fastboot_bytes_received;
 	env_set_hex("filesize", image_size);
+	fastboot_stats.download_bytes = image_size;
+	fastboot_stats.download_ms = get_timer(fastboot_download_start);
 	fastboot_bytes_expected = 0;
 	fastboot_bytes_received = 0;
 }
@@ -336,6 +347,8 @@ void fastboot_data_complete(char *response)
  */
 static void __maybe_unused flash(char *cmd_parameter, char *response)
 {
+	ulong start = get_timer(0);
+
 	if (IS_ENABLED(CONFIG_FASTBOOT_FLASH_MMC))
 		fastboot_mmc_flash_write(cmd_parameter, fastboot_buf_addr,
 					 image_size, response);
@@ -343,6 +356,8 @@ static void __maybe_unused flash(char *cmd_parameter, char *response)
 	if (IS_ENABLED(CONFIG_FASTBOOT_FLASH_NAND))
 		fastboot_nand_flash_write(cmd_parameter, fastboot_buf_addr,
 					  image_size, response);
+
+	fastboot_stats.flash_ms = get_timer(start);
 }
 
 /**
@@ -26,6 +26,7 @@ static void getvar_has_slot(char *var_parameter, char *response);
 static void getvar_partition_type(char *part_name, char *response);
 static void getvar_partition_size(char *part_name, char *response);
 static void getvar_is_userspace(char *var_parameter, char *response);
+static void getvar_stats(char *var_parameter, char *response);
 
 static const struct {
 	const char *variable;
@@ -90,6 +91,10 @@ static const struct {
 		.variable = "is-userspace",
 		.dispatch = getvar_is_userspace,
 		.list = true
+	}, {
+		.variable = "stats",
+		.dispatch = getvar_stats,
+		.list = true
 	}
 };
 
@@ -252,6 +257,18 @@ static void getvar_is_userspace(char *var_parameter, char *response)
 	fastboot_okay("no", response);
 }
 
+static void getvar_stats(char *var_parameter, char *response)
+{
+	ulong ms = fastboot_stats.download_ms;
+
+	/* bytes per millisecond is kB/s */
+	fastboot_response("OKAY", response,
+			  "download %u B %lu ms %lu kB/s, flash %lu ms",
+			  fastboot_stats.download_bytes, ms,
+			  ms ? fastboot_stats.download_bytes / ms : 0,
+			  fastboot_stats.flash_ms);
+}
+
 static int current_all_dispatch;
 void fastboot_getvar_all(char *response)
 {
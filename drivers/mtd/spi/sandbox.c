@@ -498,6 +498,29 @@ static int sandbox_sf_xfer(struct udevice *dev, unsigned int bitlen,
 	return pos == bytes ? 0 : -EIO;
 }
 
+static ssize_t sandbox_sf_map_read(struct udevice *dev, ulong offset,
+				   size_t len, void *buf)
+{
+	struct sandbox_spi_flash *sbsf = dev_get_priv(dev);
+	ulong size = sbsf->data->sector_size * sbsf->data->n_sectors;
+	ssize_t ret;
+
+	if (offset >= size)
+		return -EINVAL;
+	len = min_t(size_t, len, size - offset);
+
+	if (os_lseek(sbsf->fd, offset, OS_SEEK_SET) < 0)
+		return -EIO;
+	ret = os_read(sbsf->fd, buf, len);
+	if (ret < 0)
+		return -EIO;
+
+	/* the backing file may be shorter than the flash, so it is erased */
+	memset(buf + ret, 0xff, len - ret);
+
+	return len;
+}
+
 int sandbox_sf_of_to_plat(struct udevice *dev)
 {
 	struct sandbox_spi_flash_plat_data *pdata = dev_get_plat(dev);
@@ -515,6 +538,7 @@ int sandbox_sf_of_to_plat(struct udevice *dev)
 
 static const struct dm_spi_emul_ops sandbox_sf_emul_ops = {
 	.xfer          = sandbox_sf_xfer,
+	.map_read      = sandbox_sf_map_read,
 };
 
 #ifdef CONFIG_SPI_FLASH
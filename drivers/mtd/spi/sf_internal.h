@@ -79,6 +79,25 @@ extern const struct flash_info spi_nor_ids[];
 /* Get software write-protect value (BP bits) */
 int spi_flash_cmd_get_sw_write_prot(struct spi_flash *flash);
 
+/**
+ * spi_nor_create_read_dirmap() - Create the direct mapping used for reads
+ *
+ * @nor: SPI NOR to map, using its current read settings
+ * Return: 0 if OK, -ve on error
+ */
+int spi_nor_create_read_dirmap(struct spi_nor *nor);
+
+/**
+ * spi_nor_set_read_hwcap() - Switch to another read command
+ *
+ * @nor: SPI NOR to update
+ * @hwcap: Read capability to use (SNOR_HWCAPS_READ...), which must be in
+ *	nor->tune_hwcaps
+ * Return: 0 if OK, -EINVAL if @hwcap is not supported, -EOPNOTSUPP if the
+ *	flash would need to be switched into another mode to use it
+ */
+int spi_nor_set_read_hwcap(struct spi_nor *nor, u32 hwcap);
+
 #if CONFIG_IS_ENABLED(SPI_FLASH_MTD)
 int spi_flash_mtd_register(struct spi_flash *flash);
 void spi_flash_mtd_unregister(struct spi_flash *flash);
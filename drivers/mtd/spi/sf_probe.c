@@ -18,7 +18,7 @@
 
 #include "sf_internal.h"
 
-static int spi_nor_create_read_dirmap(struct spi_nor *nor)
+int spi_nor_create_read_dirmap(struct spi_nor *nor)
 {
 	struct spi_mem_dirmap_info info = {
 		.op_tmpl = SPI_MEM_OP(SPI_MEM_OP_CMD(nor->read_opcode, 0),
@@ -100,6 +100,9 @@ static int spi_flash_probe_slave(struct spi_flash *flash)
 	if (ret)
 		goto err_read_id;
 
+	if (CONFIG_IS_ENABLED(SPI_FLASH_TUNE))
+		spi_flash_tune_apply(flash);
+
 	if (CONFIG_IS_ENABLED(SPI_DIRMAP)) {
 		ret = spi_nor_create_read_dirmap(flash);
 		if (ret)
@@ -0,0 +1,323 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tuning the read setting of SPI NOR flash
+ *
+ * The read protocols supported by both the flash and the controller are tried
+ * at several bus speeds, checking the data read from a region of the flash
+ * against a reference read made at a safe setting. The setting with the
+ * highest data rate is recorded in the environment, keyed by the JEDEC ID of
+ * the flash, so that later boots can use it straight away.
+ *
+ * Sampling-delay calibration is left to the controller's set_speed() method,
+ * as the Cadence driver does, since there is no generic interface for it.
+ */
+
+#define LOG_CATEGORY UCLASS_SPI_FLASH
+
+#include <env.h>
+#include <log.h>
+#include <malloc.h>
+#include <spi.h>
+#include <spi_flash.h>
+#include <spi-mem.h>
+#include <time.h>
+#include <vsprintf.h>
+#include <u-boot/crc.h>
+#include <asm/cache.h>
+#include <linux/mtd/spi-nor.h>
+
+#include "sf_internal.h"
+
+/* Number of bus speeds tried, from max_hz down in equal steps */
+#define SF_TUNE_STEPS		4
+
+/* Environment variable name: prefix plus the JEDEC ID in hex */
+#define SF_TUNE_PREFIX		"sf_tune_"
+#define SF_TUNE_KEY_LEN		(sizeof(SF_TUNE_PREFIX) + SPI_NOR_MAX_ID_LEN * 2)
+
+/* Indexed by bit number of the SNOR_HWCAPS_READ... values */
+static const char *const sf_tune_names[] = {
+	"read", "fast", "1-1-1-dtr",
+	"1-1-2", "1-2-2", "2-2-2", "1-2-2-dtr",
+	"1-1-4", "1-4-4", "4-4-4", "1-4-4-dtr",
+	"1-1-8", "1-8-8", "8-8-8", "1-8-8-dtr", "8-8-8-dtr",
+};
+
+/* Read settings which can be restored if tuning fails */
+struct sf_tune_state {
+	u8 opcode;
+	u8 dummy;
+	enum spi_nor_protocol proto;
+	uint hz;
+};
+
+const char *spi_flash_tune_name(u32 hwcap)
+{
+	int bit = ffs(hwcap) - 1;
+
+	if (bit < 0 || bit >= ARRAY_SIZE(sf_tune_names) || hwcap != BIT(bit))
+		return "?";
+
+	return sf_tune_names[bit];
+}
+
+static void sf_tune_key(struct spi_flash *flash, char *key)
+{
+	const struct flash_info *info = flash->info;
+	char *p = key;
+	int i;
+
+	p += sprintf(p, SF_TUNE_PREFIX);
+	for (i = 0; i < info->id_len; i++)
+		p += sprintf(p, "%02x", info->id[i]);
+}
+
+static int sf_tune_read(struct spi_flash *flash, u32 offset, u32 len,
+			void *buf)
+{
+	struct mtd_info *mtd = &flash->mtd;
+	size_t retlen;
+	int ret;
+
+	ret = mtd->_read(mtd, offset, len, &retlen, buf);
+	if (ret)
+		return ret;
+
+	return retlen == len ? 0 : -EIO;
+}
+
+/* The read mapping holds the read settings, so must be created again */
+static void sf_tune_remap(struct spi_flash *flash)
+{
+	if (!CONFIG_IS_ENABLED(SPI_DIRMAP) || !flash->dirmap.rdesc)
+		return;
+
+	spi_mem_dirmap_destroy(flash->dirmap.rdesc);
+	if (spi_nor_create_read_dirmap(flash))
+		flash->dirmap.rdesc = NULL;
+}
+
+static int sf_tune_set(struct spi_flash *flash, u32 hwcap, uint hz)
+{
+	int ret;
+
+	ret = spi_nor_set_read_hwcap(flash, hwcap);
+	if (ret)
+		return ret;
+	flash->spi->max_hz = hz;
+	sf_tune_remap(flash);
+
+	return 0;
+}
+
+static void sf_tune_save_state(struct spi_flash *flash,
+			       struct sf_tune_state *state)
+{
+	state->opcode = flash->read_opcode;
+	state->dummy = flash->read_dummy;
+	state->proto = flash->read_proto;
+	state->hz = flash->spi->max_hz;
+}
+
+static void sf_tune_restore_state(struct spi_flash *flash,
+				  const struct sf_tune_state *state)
+{
+	flash->read_opcode = state->opcode;
+	flash->read_dummy = state->dummy;
+	flash->read_proto = state->proto;
+	flash->spi->max_hz = state->hz;
+	sf_tune_remap(flash);
+}
+
+static bool sf_tune_is_blank(const u8 *buf, u32 len)
+{
+	u32 i;
+
+	for (i = 1; i < len; i++) {
+		if (buf[i] != buf[0])
+			return false;
+	}
+
+	return true;
+}
+
+int spi_flash_tune(struct spi_flash *flash, u32 offset, u32 len, uint max_hz,
+		   struct spi_flash_tune *tune)
+{
+	struct sf_tune_state orig;
+	u64 rate, best_rate = 0;
+	ulong start, us;
+	u8 *ref, *buf;
+	int bit, step;
+	u32 hwcap;
+	uint hz;
+	int ret;
+
+	if (!max_hz)
+		max_hz = flash->spi->max_hz;
+	if (!len || !max_hz || offset > flash->size ||
+	    len > flash->size - offset)
+		return -EINVAL;
+
+	ref = memalign(ARCH_DMA_MINALIGN, len);
+	buf = memalign(ARCH_DMA_MINALIGN, len);
+	if (!ref || !buf) {
+		ret = -ENOMEM;
+		goto out;
+	}
+	sf_tune_save_state(flash, &orig);
+
+	/* Read the reference data twice, at the current setting but slowly */
+	flash->spi->max_hz = min(orig.hz ?: max_hz, max_hz) / SF_TUNE_STEPS;
+	ret = sf_tune_read(flash, offset, len, ref);
+	if (!ret)
+		ret = sf_tune_read(flash, offset, len, buf);
+	flash->spi->max_hz = orig.hz;
+	if (ret)
+		goto out;
+	if (memcmp(ref, buf, len)) {
+		log_debug("Reference reads differ\n");
+		ret = -EIO;
+		goto out;
+	}
+	if (sf_tune_is_blank(ref, len)) {
+		log_debug("Region is blank\n");
+		ret = -EINVAL;
+		goto out;
+	}
+
+	/* Try each protocol in priority order, from the fastest speed down */
+	for (bit = fls(flash->tune_hwcaps) - 1; bit >= 0; bit--) {
+		hwcap = BIT(bit);
+		if (!(flash->tune_hwcaps & hwcap))
+			continue;
+		for (step = SF_TUNE_STEPS; step > 0; step--) {
+			hz = (u64)max_hz * step / SF_TUNE_STEPS;
+			if (sf_tune_set(flash, hwcap, hz))
+				break;
+
+			/* Stop once this protocol cannot beat the best so far */
+			rate = (u64)hz *
+				spi_nor_get_protocol_data_nbits(flash->read_proto);
+			if (spi_nor_protocol_is_dtr(flash->read_proto))
+				rate *= 2;
+			if (rate <= best_rate)
+				break;
+
+			start = timer_get_us();
+			ret = sf_tune_read(flash, offset, len, buf);
+			us = max(timer_get_us() - start, 1UL);
+			log_debug("%s at %u Hz: %s\n", spi_flash_tune_name(hwcap),
+				  hz, !ret && !memcmp(ref, buf, len) ? "OK" :
+				  "failed");
+			if (ret || memcmp(ref, buf, len))
+				continue;
+
+			best_rate = rate;
+			tune->hwcap = hwcap;
+			tune->hz = hz;
+			tune->rate = (u64)len * 1000000 / us;
+			break;
+		}
+	}
+
+	if (!best_rate) {
+		sf_tune_restore_state(flash, &orig);
+		ret = -EIO;
+		goto out;
+	}
+	tune->offset = offset;
+	tune->len = len;
+	tune->crc = crc32(0, ref, len);
+	ret = sf_tune_set(flash, tune->hwcap, tune->hz);
+	if (ret)
+		sf_tune_restore_state(flash, &orig);
+
+out:
+	free(buf);
+	free(ref);
+
+	return ret;
+}
+
+int spi_flash_tune_save(struct spi_flash *flash,
+			const struct spi_flash_tune *tune)
+{
+	char key[SF_TUNE_KEY_LEN];
+	char val[64];
+
+	sf_tune_key(flash, key);
+	snprintf(val, sizeof(val), "%s %u %x %x %08x",
+		 spi_flash_tune_name(tune->hwcap), tune->hz, tune->offset,
+		 tune->len, tune->crc);
+
+	return env_set(key, val);
+}
+
+static int sf_tune_parse(const char *val, struct spi_flash_tune *tune)
+{
+	const char *p = strchr(val, ' ');
+	char *end;
+	int i;
+
+	if (!p)
+		return -EINVAL;
+	for (i = 0; i < ARRAY_SIZE(sf_tune_names); i++) {
+		if (strlen(sf_tune_names[i]) == p - val &&
+		    !strncmp(val, sf_tune_names[i], p - val))
+			break;
+	}
+	if (i == ARRAY_SIZE(sf_tune_names))
+		return -EINVAL;
+	tune->hwcap = BIT(i);
+
+	tune->hz = simple_strtoul(p, &end, 10);
+	tune->offset = hextoul(end, &end);
+	tune->len = hextoul(end, &end);
+	tune->crc = hextoul(end, &end);
+	if (*end || !tune->hz || !tune->len)
+		return -EINVAL;
+
+	return 0;
+}
+
+int spi_flash_tune_apply(struct spi_flash *flash)
+{
+	char key[SF_TUNE_KEY_LEN];
+	struct spi_flash_tune tune;
+	struct sf_tune_state orig;
+	const char *val;
+	u8 *buf;
+	int ret;
+
+	sf_tune_key(flash, key);
+	val = env_get(key);
+	if (!val)
+		return -ENOENT;
+	ret = sf_tune_parse(val, &tune);
+	if (ret || tune.offset > flash->size ||
+	    tune.len > flash->size - tune.offset) {
+		log_warning("Invalid %s\n", key);
+		return -EINVAL;
+	}
+
+	buf = memalign(ARCH_DMA_MINALIGN, tune.len);
+	if (!buf)
+		return -ENOMEM;
+	sf_tune_save_state(flash, &orig);
+	ret = sf_tune_set(flash, tune.hwcap, tune.hz);
+	if (!ret)
+		ret = sf_tune_read(flash, tune.offset, tune.len, buf);
+	if (!ret && crc32(0, buf, tune.len) != tune.crc)
+		ret = -EIO;
+	free(buf);
+	if (ret) {
+		log_warning("Ignoring %s (err=%d)\n", key, ret);
+		sf_tune_restore_state(flash, &orig);
+		return ret;
+	}
+	log_debug("Using %s at %u Hz\n", spi_flash_tune_name(tune.hwcap),
+		  tune.hz);
+
+	return 0;
+}
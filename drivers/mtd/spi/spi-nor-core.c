@@ -3524,6 +3524,43 @@ static int spi_nor_select_read(struct spi_nor *nor,
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(SPI_FLASH_TUNE)
+int spi_nor_set_read_hwcap(struct spi_nor *nor, u32 hwcap)
+{
+	const struct spi_nor_read_command *read;
+	int cmd;
+
+	if (!(nor->tune_hwcaps & hwcap) || (hwcap & (hwcap - 1)))
+		return -EINVAL;
+	cmd = spi_nor_hwcaps_read2cmd(hwcap);
+	if (cmd < 0)
+		return -EINVAL;
+	read = &nor->tune_reads[cmd];
+
+	/*
+	 * DTR reads need 4-byte addresses, and n-n-n reads need the flash to
+	 * be switched into that mode, so neither can be swapped in here
+	 */
+	if (spi_nor_protocol_is_dtr(read->proto) !=
+	    spi_nor_protocol_is_dtr(nor->read_proto))
+		return -EOPNOTSUPP;
+	if ((spi_nor_get_protocol_inst_nbits(read->proto) > 1 ||
+	     spi_nor_get_protocol_inst_nbits(nor->read_proto) > 1) &&
+	    read->proto != nor->read_proto)
+		return -EOPNOTSUPP;
+
+	nor->read_opcode = read->opcode;
+#ifndef CONFIG_SPI_FLASH_BAR
+	if (nor->tune_4b_opcodes)
+		nor->read_opcode = spi_nor_convert_3to4_read(read->opcode);
+#endif
+	nor->read_proto = read->proto;
+	nor->read_dummy = read->num_mode_clocks + read->num_wait_states;
+
+	return 0;
+}
+#endif
+
 static int spi_nor_select_pp(struct spi_nor *nor,
 			     const struct spi_nor_flash_parameter *params,
 			     u32 shared_hwcaps)
@@ -4437,6 +4474,9 @@ int spi_nor_scan(struct spi_nor *nor)
 	int ret;
 	int cfi_mtd_nb = 0;
 	bool shift = 0;
+#if CONFIG_IS_ENABLED(SPI_FLASH_TUNE)
+	u8 tune_opcode;
+#endif
 
 #ifdef CONFIG_FLASH_CFI_MTD
 	cfi_mtd_nb = CFI_FLASH_BANKS;
@@ -4563,6 +4603,14 @@ int spi_nor_scan(struct spi_nor *nor)
 	if (ret)
 		return ret;
 
+#if CONFIG_IS_ENABLED(SPI_FLASH_TUNE)
+	/* Keep the read commands which can be tried when tuning */
+	spi_nor_adjust_hwcaps(nor, &params, &nor->tune_hwcaps);
+	nor->tune_hwcaps &= SNOR_HWCAPS_READ_MASK;
+	memcpy(nor->tune_reads, params.reads, sizeof(nor->tune_reads));
+	tune_opcode = nor->read_opcode;
+#endif
+
 	if (spi_nor_protocol_is_dtr(nor->read_proto)) {
 		 /* Always use 4-byte addresses in DTR mode. */
 		nor->addr_width = 4;
@@ -4613,6 +4661,9 @@ int spi_nor_scan(struct spi_nor *nor)
 
 	nor->rdsr_dummy = params.rdsr_dummy;
 	nor->rdsr_addr_nbytes = params.rdsr_addr_nbytes;
+#if CONFIG_IS_ENABLED(SPI_FLASH_TUNE)
+	nor->tune_4b_opcodes = nor->read_opcode != tune_opcode;
+#endif
 	nor->name = info->name;
 	nor->size = mtd->size;
 	nor->erase_size = mtd->erasesize;
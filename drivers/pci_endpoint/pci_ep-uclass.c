@@ -13,6 +13,7 @@
 
 #include <dm.h>
 #include <errno.h>
+#include <initcall.h>
 #include <asm/global_data.h>
 #include <linux/log2.h>
 #include <pci_ep.h>
@@ -224,3 +225,8 @@ int pci_ep_init(void)
 
 	return 0;
 }
+
+#if CONFIG_IS_ENABLED(INITCALL_GROUPS)
+/* nothing needs the endpoints until a command is run */
+INITCALL_LATE_GROUP(pci_ep_init);
+#endif
@@ -10,6 +10,7 @@
 #include <dm.h>
 #include <log.h>
 #include <dm/device_compat.h>
+#include <dm/handoff.h>
 #include <dm/uclass-internal.h>
 #include <linux/delay.h>
 #include <power/pmic.h>
@@ -77,6 +78,7 @@ int regulator_set_value(struct udevice *dev, int uV)
 		if (uc_pdata->ramp_delay && old_uV > 0 && is_enabled)
 			regulator_set_value_ramp_delay(dev, old_uV, uV,
 						       uc_pdata->ramp_delay);
+		dev_handoff_save(dev, DM_HANDOFF_REGULATOR_UV, 0, uV);
 	}
 
 	return ret;
@@ -190,6 +192,7 @@ int regulator_set_enable(struct udevice *dev, bool enable)
 							       uc_pdata->ramp_delay);
 			}
 		}
+		dev_handoff_save(dev, DM_HANDOFF_REGULATOR_ENABLE, 0, enable);
 	}
 
 	return ret;
@@ -291,6 +294,42 @@ int device_get_supply_regulator(struct udevice *dev, const char *supply_name,
 					    supply_name, devp);
 }
 
+/*
+ * Check whether a prior phase set the regulator to this voltage or enable
+ * state and it is still there, to avoid setting it again and waiting for it
+ * to ramp
+ */
+static bool regulator_handoff_done(struct udevice *dev, enum dm_handoff_t type,
+				   int val)
+{
+	u64 prev;
+
+	if (dev_handoff_find(dev, type, 0, &prev) || prev != val)
+		return false;
+	if (type == DM_HANDOFF_REGULATOR_UV)
+		return regulator_get_value(dev) == val;
+
+	return regulator_get_enable(dev) == val;
+}
+
+/*
+ * Enable a regulator during autoset. If a prior phase left it enabled, the
+ * driver may skip the hardware write and the start-up delay, but the enable
+ * is still counted, so a consumer's later disable does not switch it off
+ */
+static int regulator_autoset_enable(struct udevice *dev)
+{
+	struct dm_regulator_uclass_plat *uc_pdata = dev_get_uclass_plat(dev);
+	int ret;
+
+	if (regulator_handoff_done(dev, DM_HANDOFF_REGULATOR_ENABLE, true))
+		uc_pdata->flags |= REGULATOR_FLAG_HANDOFF_ON;
+	ret = regulator_set_enable(dev, true);
+	uc_pdata->flags &= ~REGULATOR_FLAG_HANDOFF_ON;
+
+	return ret;
+}
+
 int regulator_autoset(struct udevice *dev)
 {
 	struct dm_regulator_uclass_plat *uc_pdata;
@@ -325,19 +364,23 @@ int regulator_autoset(struct udevice *dev)
 	}
 
 	if (uc_pdata->type == REGULATOR_TYPE_FIXED) {
-		ret = regulator_set_enable(dev, true);
+		ret = regulator_autoset_enable(dev);
 		goto out;
 	}
 
-	if (uc_pdata->flags & REGULATOR_FLAG_AUTOSET_UV)
+	if ((uc_pdata->flags & REGULATOR_FLAG_AUTOSET_UV) &&
+	    !regulator_handoff_done(dev, DM_HANDOFF_REGULATOR_UV,
+				    uc_pdata->min_uV))
 		ret = regulator_set_value(dev, uc_pdata->min_uV);
-	if (uc_pdata->init_uV > 0)
+	if (uc_pdata->init_uV > 0 &&
+	    !regulator_handoff_done(dev, DM_HANDOFF_REGULATOR_UV,
+				    uc_pdata->init_uV))
 		ret = regulator_set_value(dev, uc_pdata->init_uV);
 	if (!ret && (uc_pdata->flags & REGULATOR_FLAG_AUTOSET_UA))
 		ret = regulator_set_current(dev, uc_pdata->min_uA);
 
 	if (!ret)
-		ret = regulator_set_enable(dev, true);
+		ret = regulator_autoset_enable(dev);
 
 out:
 	uc_pdata->flags |= REGULATOR_FLAG_AUTOSET_DONE;
@@ -528,6 +571,7 @@ static int regulator_post_probe(struct udevice *dev)
 UCLASS_DRIVER(regulator) = {
 	.id		= UCLASS_REGULATOR,
 	.name		= "regulator",
+	.flags		= DM_UC_FLAG_HANDOFF,
 	.post_bind	= regulator_post_bind,
 	.pre_probe	= regulator_pre_probe,
 	.post_probe	= regulator_post_probe,
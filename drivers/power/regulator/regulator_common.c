@@ -61,6 +61,7 @@ int regulator_common_get_enable(const struct udevice *dev,
 int regulator_common_set_enable(const struct udevice *dev,
 	struct regulator_common_plat *plat, bool enable)
 {
+	struct dm_regulator_uclass_plat *uc_pdata;
 	int ret;
 
 	debug("%s: dev='%s', enable=%d, delay=%d, has_gpio=%d\n", __func__,
@@ -73,6 +74,14 @@ int regulator_common_set_enable(const struct udevice *dev,
 		return 0;
 	}
 
+	/* A prior phase enabled it and waited for it to start up */
+	uc_pdata = dev_get_uclass_plat(dev);
+	if (enable && !plat->enable_count &&
+	    (uc_pdata->flags & REGULATOR_FLAG_HANDOFF_ON)) {
+		plat->enable_count++;
+		return 0;
+	}
+
 	/* If previously enabled, increase count */
 	if (enable && plat->enable_count > 0) {
 		plat->enable_count++;
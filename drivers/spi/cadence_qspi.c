@@ -432,9 +432,54 @@ static int cadence_spi_of_to_plat(struct udevice *bus)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+static int cadence_spi_dirmap_create(struct spi_mem_dirmap_desc *desc)
+{
+	struct udevice *bus = desc->slave->dev->parent;
+	struct cadence_spi_priv *priv = dev_get_priv(bus);
+
+	/* Writes and indirect DMA reads are left to exec_op() */
+	if (desc->info.op_tmpl.data.dir != SPI_MEM_DATA_IN ||
+	    !priv->use_dac_mode || priv->is_dma)
+		return -EOPNOTSUPP;
+
+	return 0;
+}
+
+static ssize_t cadence_spi_dirmap_read(struct spi_mem_dirmap_desc *desc,
+				       u64 offs, size_t len, void *buf)
+{
+	struct udevice *bus = desc->slave->dev->parent;
+	struct cadence_spi_priv *priv = dev_get_priv(bus);
+	struct spi_mem_op op = desc->info.op_tmpl;
+	int err;
+
+	op.addr.val = desc->info.offset + offs;
+	op.data.buf.in = buf;
+	op.data.nbytes = len;
+
+	/*
+	 * Stop at the end of the DAC window, so that only the part of the
+	 * read beyond it falls back to an indirect read
+	 */
+	if (op.addr.val < priv->ahbsize)
+		op.data.nbytes = min_t(u64, len, priv->ahbsize - op.addr.val);
+
+	err = cadence_spi_mem_exec_op(desc->slave, &op);
+	if (err)
+		return err;
+
+	return op.data.nbytes;
+}
+#endif
+
 static const struct spi_controller_mem_ops cadence_spi_mem_ops = {
 	.exec_op = cadence_spi_mem_exec_op,
 	.supports_op = cadence_spi_mem_supports_op,
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+	.dirmap_create = cadence_spi_dirmap_create,
+	.dirmap_read = cadence_spi_dirmap_read,
+#endif
 };
 
 static const struct dm_spi_ops cadence_spi_ops = {
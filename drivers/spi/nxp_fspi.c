@@ -831,6 +831,57 @@ static int nxp_fspi_adjust_op_size(struct spi_slave *slave,
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+static int nxp_fspi_dirmap_create(struct spi_mem_dirmap_desc *desc)
+{
+	struct nxp_fspi *f = dev_get_priv(desc->slave->dev->parent);
+	struct spi_mem_op op = desc->info.op_tmpl;
+
+	if (op.data.dir != SPI_MEM_DATA_IN || needs_ip_only(f))
+		return -EOPNOTSUPP;
+
+	/* The whole region must be inside the AHB window */
+	if (desc->info.offset + desc->info.length > f->memmap_phy_size)
+		return -EOPNOTSUPP;
+
+	op.data.nbytes = 0;
+	if (!nxp_fspi_supports_op(desc->slave, &op))
+		return -EOPNOTSUPP;
+
+	return 0;
+}
+
+/*
+ * Read the whole request through the AHB window, rather than splitting it
+ * into ahb_buf_size pieces with the LUT set up and the AHB buffer reset for
+ * each one, as exec_op() does
+ */
+static ssize_t nxp_fspi_dirmap_read(struct spi_mem_dirmap_desc *desc,
+				    u64 offs, size_t len, void *buf)
+{
+	struct nxp_fspi *f = dev_get_priv(desc->slave->dev->parent);
+	u64 addr = desc->info.offset + offs;
+	int err;
+
+	if (offs >= desc->info.length)
+		return -EINVAL;
+	len = min_t(u64, len, desc->info.length - offs);
+
+	err = fspi_readl_poll_tout(f, f->iobase + FSPI_STS0,
+				   FSPI_STS0_ARB_IDLE, 1, POLL_TOUT, true);
+	if (err)
+		return err;
+
+	nxp_fspi_prepare_lut(f, &desc->info.op_tmpl);
+	memcpy_fromio(buf, f->ahb_addr + addr, len);
+
+	/* Invalidate the data in the AHB buffer, as exec_op() does */
+	nxp_fspi_invalid(f);
+
+	return len;
+}
+#endif
+
 #ifdef CONFIG_FSL_LAYERSCAPE
 static void erratum_err050568(struct nxp_fspi *f)
 {
@@ -1044,6 +1095,10 @@ static const struct spi_controller_mem_ops nxp_fspi_mem_ops = {
 	.adjust_op_size = nxp_fspi_adjust_op_size,
 	.supports_op = nxp_fspi_supports_op,
 	.exec_op = nxp_fspi_exec_op,
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+	.dirmap_create = nxp_fspi_dirmap_create,
+	.dirmap_read = nxp_fspi_dirmap_read,
+#endif
 };
 
 static const struct dm_spi_ops nxp_fspi_ops = {
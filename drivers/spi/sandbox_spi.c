@@ -15,6 +15,7 @@
 #include <malloc.h>
 #include <spi.h>
 #include <spi_flash.h>
+#include <spi-mem.h>
 #include <os.h>
 
 #include <linux/errno.h>
@@ -34,10 +35,12 @@
  *
  * @speed:	Current bus speed.
  * @mode:	Current bus mode.
+ * @dirmap_reads: Number of reads through a direct mapping.
  */
 struct sandbox_spi_priv {
 	uint speed;
 	uint mode;
+	uint dirmap_reads;
 };
 
 __weak int sandbox_spi_get_emul(struct sandbox_state *state,
@@ -61,6 +64,13 @@ uint sandbox_spi_get_mode(struct udevice *dev)
 	return priv->mode;
 }
 
+uint sandbox_spi_get_dirmap_reads(struct udevice *dev)
+{
+	struct sandbox_spi_priv *priv = dev_get_priv(dev);
+
+	return priv->dirmap_reads;
+}
+
 static int sandbox_spi_xfer(struct udevice *slave, unsigned int bitlen,
 			    const void *dout, void *din, unsigned long flags)
 {
@@ -152,12 +162,75 @@ static int sandbox_spi_get_mmap(struct udevice *dev, ulong *map_basep,
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+static int sandbox_spi_get_map_emul(struct udevice *slave,
+				    struct udevice **emulp)
+{
+	struct sandbox_state *state = state_get_current();
+	struct udevice *emul;
+	int ret;
+
+	ret = sandbox_spi_get_emul(state, slave->parent, slave, &emul);
+	if (ret)
+		return ret;
+	ret = device_probe(emul);
+	if (ret)
+		return ret;
+	if (!spi_emul_get_ops(emul)->map_read)
+		return -ENOSYS;
+	*emulp = emul;
+
+	return 0;
+}
+
+static int sandbox_spi_dirmap_create(struct spi_mem_dirmap_desc *desc)
+{
+	struct udevice *emul;
+
+	/* writes always go through a command, as with most controllers */
+	if (desc->info.op_tmpl.data.dir != SPI_MEM_DATA_IN)
+		return -EOPNOTSUPP;
+	if (sandbox_spi_get_map_emul(desc->slave->dev, &emul))
+		return -EOPNOTSUPP;
+
+	return 0;
+}
+
+static ssize_t sandbox_spi_dirmap_read(struct spi_mem_dirmap_desc *desc,
+				       u64 offs, size_t len, void *buf)
+{
+	struct udevice *slave = desc->slave->dev;
+	struct sandbox_spi_priv *priv = dev_get_priv(slave->parent);
+	struct udevice *emul;
+	int ret;
+
+	if (offs >= desc->info.length)
+		return -EINVAL;
+	len = min_t(u64, len, desc->info.length - offs);
+	ret = sandbox_spi_get_map_emul(slave, &emul);
+	if (ret)
+		return ret;
+	priv->dirmap_reads++;
+
+	return spi_emul_get_ops(emul)->map_read(emul, desc->info.offset + offs,
+						len, buf);
+}
+
+static const struct spi_controller_mem_ops sandbox_spi_mem_ops = {
+	.dirmap_create	= sandbox_spi_dirmap_create,
+	.dirmap_read	= sandbox_spi_dirmap_read,
+};
+#endif
+
 static const struct dm_spi_ops sandbox_spi_ops = {
 	.xfer		= sandbox_spi_xfer,
 	.set_speed	= sandbox_spi_set_speed,
 	.set_mode	= sandbox_spi_set_mode,
 	.cs_info	= sandbox_cs_info,
 	.get_mmap	= sandbox_spi_get_mmap,
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+	.mem_ops	= &sandbox_spi_mem_ops,
+#endif
 };
 
 static const struct udevice_id sandbox_spi_ids[] = {
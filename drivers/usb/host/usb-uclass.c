@@ -233,7 +233,16 @@ static void usb_scan_bus(struct udevice *bus, bool recurse)
 
 	printf("scanning bus %s for devices... ", bus->name);
 	debug("\n");
-	ret = usb_scan_device(bus, 0, USB_SPEED_FULL, &dev);
+	if (priv->rh_powered) {
+		/* usb_init_start() has set up the root hub already */
+		priv->rh_powered = false;
+		ret = device_find_first_child_by_uclass(bus, UCLASS_USB_HUB,
+							&dev);
+		if (!ret)
+			ret = usb_hub_scan_powered(dev);
+	} else {
+		ret = usb_scan_device(bus, 0, USB_SPEED_FULL, &dev);
+	}
 	if (ret)
 		printf("failed, error %d\n", ret);
 	else if (priv->next_addr == 0)
@@ -287,6 +296,88 @@ static int usb_probe_companion(struct udevice *bus)
 	return 0;
 }
 
+int usb_init_start(void)
+{
+	struct usb_bus_priv *priv;
+	struct udevice *bus, *rh;
+	struct uclass *uc;
+	int ret;
+
+	ret = uclass_get(UCLASS_USB, &uc);
+	if (ret)
+		return ret;
+
+	uclass_foreach_dev(bus, uc) {
+		if (device_active(bus))
+			continue;
+
+		/* See usb_init() */
+		if (IS_ENABLED(CONFIG_SANDBOX) ||
+		    IS_ENABLED(CONFIG_USB_ONBOARD_HUB)) {
+			ret = dm_scan_fdt_dev(bus);
+			if (ret)
+				return ret;
+		}
+
+		/* usb_init() reports any failure when it tries again */
+		ret = device_probe(bus);
+		if (ret) {
+			log_debug("Bus %s: probe failed (err=%dE)\n", bus->name,
+				  ret);
+			continue;
+		}
+		priv = dev_get_uclass_priv(bus);
+		priv->early = true;
+
+		/*
+		 * Set up the root hub and power up its ports, leaving the
+		 * power-on and connect delays to run until usb_init()
+		 */
+		priv->rh_powered = true;
+		ret = usb_scan_device(bus, 0, USB_SPEED_FULL, &rh);
+		if (ret) {
+			log_debug("Bus %s: root hub failed (err=%dE)\n",
+				  bus->name, ret);
+			priv->rh_powered = false;
+		}
+	}
+
+	return 0;
+}
+
+int usb_init_stop(void)
+{
+	struct usb_bus_priv *priv;
+	struct udevice *bus, *rh;
+	struct uclass *uc;
+	int err = 0, ret;
+
+	ret = uclass_get(UCLASS_USB, &uc);
+	if (ret)
+		return ret;
+
+	uclass_foreach_dev(bus, uc) {
+		if (!device_active(bus))
+			continue;
+		priv = dev_get_uclass_priv(bus);
+		if (!priv->early)
+			continue;
+
+		/* as usb_stop(), so that usb_init() can start afresh */
+		ret = device_remove(bus, DM_REMOVE_NORMAL);
+		if (ret && !err)
+			err = ret;
+		device_find_first_child(bus, &rh);
+		if (rh) {
+			ret = device_unbind(rh);
+			if (ret && !err)
+				err = ret;
+		}
+	}
+
+	return err;
+}
+
 int usb_init(void)
 {
 	int controllers_initialized = 0;
@@ -308,6 +399,13 @@ int usb_init(void)
 		/* init low_level USB */
 		printf("Bus %s: ", bus->name);
 
+		/* usb_init_start() may have probed it already */
+		if (device_active(bus)) {
+			priv = dev_get_uclass_priv(bus);
+			priv->early = false;
+			goto probed;
+		}
+
 		/*
 		 * For Sandbox, we need scan the device tree each time when we
 		 * start the USB stack, in order to re-create the emulated USB
@@ -338,6 +436,7 @@ int usb_init(void)
 			continue;
 		}
 
+probed:
 		ret = usb_probe_companion(bus);
 		if (ret)
 			continue;
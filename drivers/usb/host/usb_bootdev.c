@@ -27,6 +27,22 @@ static int usb_bootdev_hunt(struct bootdev_hunter *info, bool show)
 	return usb_init();
 }
 
+static int usb_bootdev_start(struct bootdev_hunter *info, bool show)
+{
+	if (!IS_ENABLED(CONFIG_DM_USB) || usb_started)
+		return 0;
+
+	return usb_init_start();
+}
+
+static int usb_bootdev_stop(struct bootdev_hunter *info, bool show)
+{
+	if (!IS_ENABLED(CONFIG_DM_USB))
+		return 0;
+
+	return usb_init_stop();
+}
+
 struct bootdev_ops usb_bootdev_ops = {
 };
 
@@ -47,5 +63,7 @@ BOOTDEV_HUNTER(usb_bootdev_hunter) = {
 	.prio		= BOOTDEVP_5_SCAN_SLOW,
 	.uclass		= UCLASS_USB,
 	.hunt		= usb_bootdev_hunt,
+	.start		= usb_bootdev_start,
+	.stop		= usb_bootdev_stop,
 	.drv		= DM_DRIVER_REF(usb_bootdev),
 };
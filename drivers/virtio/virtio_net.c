@@ -5,21 +5,45 @@
  */
 
 #include <dm.h>
+#include <log.h>
 #include <net.h>
 #include <virtio_types.h>
 #include <virtio.h>
 #include <virtio_ring.h>
-#include "virtio_net.h"
+#include <virtio_net.h>
 
 /* Amount of buffers to keep in the RX virtqueue */
 #define VIRTIO_NET_NUM_RX_BUFS	32
 
+/*
+ * Number of RX buffers handed back by free_pkt() before the device is
+ * notified. Refilled buffers are always flushed once the ring runs dry.
+ */
+#define VIRTIO_NET_RX_REFILL_BATCH	(VIRTIO_NET_NUM_RX_BUFS / 2)
+
+/* Amount of transmit buffers which may be in flight at the same time */
+#define VIRTIO_NET_NUM_TX_BUFS	16
+
 /*
  * This value comes from the VirtIO spec: 1500 for maximum packet size,
  * 14 for the Ethernet header, 12 for virtio_net_hdr. In total 1526 bytes.
  */
 #define VIRTIO_NET_RX_BUF_SIZE	1526
 
+/**
+ * struct virtio_net_tx_buf - transmit buffer owned by the driver
+ *
+ * Packets are copied here so that send() can return without waiting for the
+ * device to consume them.
+ *
+ * @hdr: virtio-net header, only the first @net_hdr_len bytes are used
+ * @data: Ethernet frame
+ */
+struct virtio_net_tx_buf {
+	struct virtio_net_hdr_v1 hdr;
+	u8 data[PKTSIZE_ALIGN];
+};
+
 struct virtio_net_priv {
 	union {
 		struct virtqueue *vqs[2];
@@ -31,22 +55,91 @@ struct virtio_net_priv {
 
 	char rx_buff[VIRTIO_NET_NUM_RX_BUFS][VIRTIO_NET_RX_BUF_SIZE];
 	bool rx_running;
+	int rx_refill;
+	struct virtio_net_tx_buf tx_buff[VIRTIO_NET_NUM_TX_BUFS];
+	bool tx_busy[VIRTIO_NET_NUM_TX_BUFS];
+	int tx_next;
 	int net_hdr_len;
 };
 
 /*
- * For simplicity, the driver only negotiates the VIRTIO_NET_F_MAC feature.
- * For the VIRTIO_NET_F_STATUS feature, we don't negotiate it, hence per spec
- * we should assume the link is always active.
+ * The driver negotiates the VIRTIO_NET_F_MAC feature and receive checksum
+ * offload. For the VIRTIO_NET_F_STATUS feature, we don't negotiate it, hence
+ * per spec we should assume the link is always active.
+ *
+ * Mergeable receive buffers (VIRTIO_NET_F_MRG_RXBUF) are not negotiated since
+ * each receive buffer already holds a full frame. Transmit checksum offload
+ * (VIRTIO_NET_F_CSUM) is not negotiated since the network stack always hands
+ * over packets with complete checksums.
  */
 static const u32 feature[] = {
-	VIRTIO_NET_F_MAC
+	VIRTIO_NET_F_MAC,
+	VIRTIO_NET_F_GUEST_CSUM,
 };
 
 static const u32 feature_legacy[] = {
-	VIRTIO_NET_F_MAC
+	VIRTIO_NET_F_MAC,
+	VIRTIO_NET_F_GUEST_CSUM,
 };
 
+static void virtio_net_rx_refill(struct virtio_net_priv *priv, void *buf)
+{
+	struct virtio_sg sg = { buf, VIRTIO_NET_RX_BUF_SIZE };
+	struct virtio_sg *sgs[] = { &sg };
+
+	virtqueue_add(priv->rx_vq, sgs, 0, 1);
+	priv->rx_refill++;
+}
+
+static void virtio_net_rx_flush(struct virtio_net_priv *priv)
+{
+	if (!priv->rx_refill)
+		return;
+
+	virtqueue_kick(priv->rx_vq);
+	priv->rx_refill = 0;
+}
+
+/* Reclaim all transmit buffers which the device has finished with */
+static void virtio_net_tx_reclaim(struct virtio_net_priv *priv)
+{
+	struct virtio_net_tx_buf *tx;
+	void *buf;
+	int i;
+
+	while ((buf = virtqueue_get_buf(priv->tx_vq, NULL))) {
+		tx = container_of(buf, struct virtio_net_tx_buf, hdr);
+		i = tx - priv->tx_buff;
+		if (i < 0 || i >= VIRTIO_NET_NUM_TX_BUFS) {
+			log_warning("Unexpected TX buffer %p\n", buf);
+			continue;
+		}
+		priv->tx_busy[i] = false;
+	}
+}
+
+/*
+ * Complete a partially checksummed packet (VIRTIO_NET_HDR_F_NEEDS_CSUM). The
+ * checksum field already holds the pseudo-header sum, so folding the data
+ * from csum_start onwards into it gives the final checksum.
+ */
+static int virtio_net_rx_csum(struct udevice *dev,
+			      struct virtio_net_hdr_v1 *hdr, uchar *packet,
+			      int length)
+{
+	u16 start = virtio16_to_cpu(dev, hdr->csum_start);
+	u16 offset = virtio16_to_cpu(dev, hdr->csum_offset);
+	u16 *csum;
+
+	if ((int)start + offset + sizeof(*csum) > length)
+		return -EINVAL;
+
+	csum = (u16 *)(packet + start + offset);
+	*csum = compute_ip_checksum(packet + start, length - start);
+
+	return 0;
+}
+
 static int virtio_net_start(struct udevice *dev)
 {
 	struct virtio_net_priv *priv = dev_get_priv(dev);
@@ -65,6 +158,7 @@ static int virtio_net_start(struct udevice *dev)
 		}
 
 		virtqueue_kick(priv->rx_vq);
+		priv->rx_refill = 0;
 
 		/* setup the receive queue only once */
 		priv->rx_running = true;
@@ -76,31 +170,44 @@ static int virtio_net_start(struct udevice *dev)
 static int virtio_net_send(struct udevice *dev, void *packet, int length)
 {
 	struct virtio_net_priv *priv = dev_get_priv(dev);
-	struct virtio_net_hdr hdr;
-	struct virtio_net_hdr_v1 hdr_v1;
+	struct virtio_net_tx_buf *tx;
 	struct virtio_sg hdr_sg;
-	struct virtio_sg data_sg = { packet, length };
+	struct virtio_sg data_sg;
 	struct virtio_sg *sgs[] = { &hdr_sg, &data_sg };
 	int ret;
 
-	if (priv->net_hdr_len == sizeof(struct virtio_net_hdr))
-		hdr_sg.addr = &hdr;
-	else
-		hdr_sg.addr = &hdr_v1;
-	hdr_sg.length = priv->net_hdr_len;
+	if (length > sizeof(tx->data))
+		return -EINVAL;
 
-	memset(hdr_sg.addr, 0, priv->net_hdr_len);
+	/*
+	 * Wait for the oldest buffer only when every slot is in flight, so
+	 * that back-to-back packets are queued without a round trip each.
+	 */
+	virtio_net_tx_reclaim(priv);
+	while (priv->tx_busy[priv->tx_next])
+		virtio_net_tx_reclaim(priv);
+
+	tx = &priv->tx_buff[priv->tx_next];
+	memset(&tx->hdr, 0, priv->net_hdr_len);
+	memcpy(tx->data, packet, length);
+
+	hdr_sg.addr = &tx->hdr;
+	hdr_sg.length = priv->net_hdr_len;
+	data_sg.addr = tx->data;
+	data_sg.length = length;
 
 	ret = virtqueue_add(priv->tx_vq, sgs, 2, 0);
 	if (ret)
 		return ret;
 
-	virtqueue_kick(priv->tx_vq);
+	priv->tx_busy[priv->tx_next] = true;
+	priv->tx_next = (priv->tx_next + 1) % VIRTIO_NET_NUM_TX_BUFS;
 
-	while (1) {
-		if (virtqueue_get_buf(priv->tx_vq, NULL))
-			break;
-	}
+	/*
+	 * The kick is suppressed by the ring while the device is still
+	 * processing earlier packets, so a burst costs a single notification.
+	 */
+	virtqueue_kick(priv->tx_vq);
 
 	return 0;
 }
@@ -108,32 +215,54 @@ static int virtio_net_send(struct udevice *dev, void *packet, int length)
 static int virtio_net_recv(struct udevice *dev, int flags, uchar **packetp)
 {
 	struct virtio_net_priv *priv = dev_get_priv(dev);
+	struct virtio_net_hdr_v1 *hdr;
 	unsigned int len;
+	uchar *packet;
 	void *buf;
+	int length;
+
+	while (1) {
+		buf = virtqueue_get_buf(priv->rx_vq, &len);
+		if (!buf) {
+			/* Make any batched refills visible before idling */
+			virtio_net_rx_flush(priv);
+			return -EAGAIN;
+		}
 
-	buf = virtqueue_get_buf(priv->rx_vq, &len);
-	if (!buf)
-		return -EAGAIN;
+		hdr = buf;
+		packet = buf + priv->net_hdr_len;
+		length = len - priv->net_hdr_len;
+
+		if (virtio_has_feature(dev, VIRTIO_NET_F_GUEST_CSUM) &&
+		    (hdr->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM) &&
+		    virtio_net_rx_csum(dev, hdr, packet, length)) {
+			virtio_net_rx_refill(priv, buf);
+			continue;
+		}
 
-	*packetp = buf + priv->net_hdr_len;
-	return len - priv->net_hdr_len;
+		*packetp = packet;
+		return length;
+	}
 }
 
 static int virtio_net_free_pkt(struct udevice *dev, uchar *packet, int length)
 {
 	struct virtio_net_priv *priv = dev_get_priv(dev);
-	void *buf = packet - priv->net_hdr_len;
-	struct virtio_sg sg = { buf, VIRTIO_NET_RX_BUF_SIZE };
-	struct virtio_sg *sgs[] = { &sg };
 
-	/* Put the buffer back to the rx ring */
-	virtqueue_add(priv->rx_vq, sgs, 0, 1);
+	/* Put the buffer back to the rx ring, notifying the device in batches */
+	virtio_net_rx_refill(priv, packet - priv->net_hdr_len);
+	if (priv->rx_refill >= VIRTIO_NET_RX_REFILL_BATCH)
+		virtio_net_rx_flush(priv);
 
 	return 0;
 }
 
 static void virtio_net_stop(struct udevice *dev)
 {
+	struct virtio_net_priv *priv = dev_get_priv(dev);
+
+	virtio_net_rx_flush(priv);
+
 	/*
 	 * There is no way to stop the queue from running, unless we issue
 	 * a reset to the virtio device, and re-do the queue initialization
@@ -204,8 +333,8 @@ static int virtio_net_probe(struct udevice *dev)
 	 * For v1.0 compliant device, it always assumes the member
 	 * 'num_buffers' exists in the struct virtio_net_hdr while
 	 * the legacy driver only presented 'num_buffers' when
-	 * VIRTIO_NET_F_MRG_RXBUF was negotiated. Without that feature
-	 * the structure was 2 bytes shorter.
+	 * VIRTIO_NET_F_MRG_RXBUF was negotiated. That feature is never
+	 * negotiated, so legacy devices use the 2 bytes shorter structure.
 	 */
 	if (uc_priv->legacy)
 		priv->net_hdr_len = sizeof(struct virtio_net_hdr);
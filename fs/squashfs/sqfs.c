@@ -7,6 +7,7 @@
  * sqfs.c: SquashFS filesystem implementation
  */
 
+#include <arena.h>
 #include <asm/unaligned.h>
 #include <div64.h>
 #include <errno.h>
@@ -251,14 +252,15 @@ static int sqfs_get_tokens_length(char **tokens, int count)
 }
 
 /* Takes a token list and returns a single string with '/' as separator. */
-static char *sqfs_concat_tokens(char **token_list, int token_count)
+static char *sqfs_concat_tokens(struct arena *arena, char **token_list,
+				int token_count)
 {
 	char *result;
 	int i, length = 0, offset = 0;
 
 	length = sqfs_get_tokens_length(token_list, token_count);
 
-	result = malloc(length + 1);
+	result = arena_alloc(arena, length + 1);
 	if (!result)
 		return NULL;
 
@@ -293,40 +295,31 @@ static int sqfs_join(char **strings, char *dest, int start, int end,
 }
 
 /*
- * Fills the given token list using its size (count) and a source string (str)
+ * Fills the given token list using its size (count) and a source string (str).
+ * The tokens point into a copy of the string, which is allocated in the arena.
  */
-static int sqfs_tokenize(char **tokens, int count, const char *str)
+static int sqfs_tokenize(struct arena *arena, char **tokens, int count,
+			 const char *str)
 {
-	int i, j, ret = 0;
-	char *aux, *strc;
+	char *strc;
+	int j;
 
-	strc = strdup(str);
+	strc = arena_strdup(arena, str);
 	if (!strc)
 		return -ENOMEM;
 
 	if (!strcmp(strc, "/")) {
-		tokens[0] = strdup(strc);
-		if (!tokens[0]) {
-			ret = -ENOMEM;
-			goto free_strc;
-		}
-	} else {
-		for (j = 0; j < count; j++) {
-			aux = strtok(!j ? strc : NULL, "/");
-			tokens[j] = strdup(aux);
-			if (!tokens[j]) {
-				for (i = 0; i < j; i++)
-					free(tokens[i]);
-				ret = -ENOMEM;
-				goto free_strc;
-			}
-		}
+		tokens[0] = strc;
+		return 0;
 	}
 
-free_strc:
-	free(strc);
+	for (j = 0; j < count; j++) {
+		tokens[j] = strtok(!j ? strc : NULL, "/");
+		if (!tokens[j])
+			return -EINVAL;
+	}
 
-	return ret;
+	return 0;
 }
 
 /*
@@ -336,11 +329,6 @@ free_strc:
  */
 static int sqfs_clean_base_path(char **base, int count, int updir)
 {
-	int i;
-
-	for (i = count - updir - 1; i < count; i++)
-		free(base[i]);
-
 	return count - updir - 1;
 }
 
@@ -352,9 +340,7 @@ static char *sqfs_get_abs_path(const char *base, const char *rel)
 {
 	char **base_tokens, **rel_tokens, *resolved = NULL;
 	int ret, bc, rc, i, updir = 0, resolved_size = 0, offset = 0;
-
-	base_tokens = NULL;
-	rel_tokens = NULL;
+	struct arena arena;
 
 	/* Memory allocation for the token lists */
 	bc = sqfs_count_tokens(base);
@@ -362,20 +348,18 @@ static char *sqfs_get_abs_path(const char *base, const char *rel)
 	if (bc < 1 || rc < 1)
 		return NULL;
 
-	base_tokens = calloc(bc, sizeof(char *));
-	if (!base_tokens)
-		return NULL;
-
-	rel_tokens = calloc(rc, sizeof(char *));
-	if (!rel_tokens)
+	arena_init(&arena, 0);
+	base_tokens = arena_alloc(&arena, bc * sizeof(char *));
+	rel_tokens = arena_alloc(&arena, rc * sizeof(char *));
+	if (!base_tokens || !rel_tokens)
 		goto out;
 
 	/* Fill token lists */
-	ret = sqfs_tokenize(base_tokens, bc, base);
+	ret = sqfs_tokenize(&arena, base_tokens, bc, base);
 	if (ret)
 		goto out;
 
-	ret = sqfs_tokenize(rel_tokens, rc, rel);
+	ret = sqfs_tokenize(&arena, rel_tokens, rc, rel);
 	if (ret)
 		goto out;
 
@@ -408,15 +392,7 @@ static char *sqfs_get_abs_path(const char *base, const char *rel)
 	offset += sqfs_join(rel_tokens, resolved + offset, updir, rc, '/');
 
 out:
-	if (rel_tokens)
-		for (i = 0; i < rc; i++)
-			free(rel_tokens[i]);
-	if (base_tokens)
-		for (i = 0; i < bc; i++)
-			free(base_tokens[i]);
-
-	free(rel_tokens);
-	free(base_tokens);
+	arena_uninit(&arena);
 
 	return resolved;
 }
@@ -467,12 +443,10 @@ static int sqfs_search_dir(struct squashfs_dir_stream *dirs, char **token_list,
 	struct fs_dir_stream *dirsp;
 	struct fs_dirent *dent;
 	unsigned char *table;
+	struct arena arena;
 
-	res = NULL;
-	rem = NULL;
-	path = NULL;
 	target = NULL;
-	sym_tokens = NULL;
+	arena_init(&arena, 0);
 
 	dirsp = (struct fs_dir_stream *)dirs;
 
@@ -549,7 +523,7 @@ static int sqfs_search_dir(struct squashfs_dir_stream *dirs, char **token_list,
 
 			sym = (struct squashfs_symlink_inode *)table;
 			/* Get first j + 1 tokens */
-			path = sqfs_concat_tokens(token_list, j + 1);
+			path = sqfs_concat_tokens(&arena, token_list, j + 1);
 			if (!path) {
 				ret = -ENOMEM;
 				goto out;
@@ -561,8 +535,8 @@ static int sqfs_search_dir(struct squashfs_dir_stream *dirs, char **token_list,
 				goto out;
 			}
 			/* Join remaining tokens */
-			rem = sqfs_concat_tokens(token_list + j + 1, token_count -
-						 j - 1);
+			rem = sqfs_concat_tokens(&arena, token_list + j + 1,
+						 token_count - j - 1);
 			if (!rem) {
 				ret = -ENOMEM;
 				goto out;
@@ -571,7 +545,7 @@ static int sqfs_search_dir(struct squashfs_dir_stream *dirs, char **token_list,
 			 * Concatenate remaining tokens and symlink's target.
 			 * Allocate enough space for rem, target, '/' and '\0'.
 			 */
-			res = malloc(strlen(rem) + strlen(target) + 2);
+			res = arena_alloc(&arena, strlen(rem) + strlen(target) + 2);
 			if (!res) {
 				ret = -ENOMEM;
 				goto out;
@@ -586,14 +560,15 @@ static int sqfs_search_dir(struct squashfs_dir_stream *dirs, char **token_list,
 				goto out;
 			}
 
-			sym_tokens = malloc(token_count * sizeof(char *));
+			sym_tokens = arena_alloc(&arena,
+						 token_count * sizeof(char *));
 			if (!sym_tokens) {
 				ret = -EINVAL;
 				goto out;
 			}
 
 			/* Fill tokens list */
-			ret = sqfs_tokenize(sym_tokens, token_count, res);
+			ret = sqfs_tokenize(&arena, sym_tokens, token_count, res);
 			if (ret) {
 				ret = -EINVAL;
 				goto out;
@@ -650,11 +625,8 @@ static int sqfs_search_dir(struct squashfs_dir_stream *dirs, char **token_list,
 		memcpy(&dirs->i_ldir, ldir, sizeof(*ldir));
 
 out:
-	free(res);
-	free(rem);
-	free(path);
+	arena_uninit(&arena);
 	free(target);
-	free(sym_tokens);
 	return ret;
 }
 
@@ -900,14 +872,16 @@ out:
 static int sqfs_opendir_nest(const char *filename, struct fs_dir_stream **dirsp)
 {
 	unsigned char *inode_table = NULL, *dir_table = NULL;
-	int j, token_count = 0, ret = 0, metablks_count;
+	int token_count = 0, ret = 0, metablks_count;
 	struct squashfs_dir_stream *dirs;
-	char **token_list = NULL, *path = NULL;
+	char **token_list = NULL;
 	u32 *pos_list = NULL;
+	struct arena arena;
 
 	dirs = calloc(1, sizeof(*dirs));
 	if (!dirs)
 		return -EINVAL;
+	arena_init(&arena, 0);
 
 	/* these should be set to NULL to prevent dangling pointers */
 	dirs->dir_header = NULL;
@@ -935,20 +909,14 @@ static int sqfs_opendir_nest(const char *filename, struct fs_dir_stream **dirsp)
 		goto out;
 	}
 
-	path = strdup(filename);
-	if (!path) {
-		ret = -EINVAL;
-		goto out;
-	}
-
-	token_list = malloc(token_count * sizeof(char *));
+	token_list = arena_alloc(&arena, token_count * sizeof(char *));
 	if (!token_list) {
 		ret = -EINVAL;
 		goto out;
 	}
 
 	/* Fill tokens list */
-	ret = sqfs_tokenize(token_list, token_count, path);
+	ret = sqfs_tokenize(&arena, token_list, token_count, filename);
 	if (ret)
 		goto out;
 	/*
@@ -979,11 +947,8 @@ static int sqfs_opendir_nest(const char *filename, struct fs_dir_stream **dirsp)
 	*dirsp = (struct fs_dir_stream *)dirs;
 
 out:
-	for (j = 0; j < token_count; j++)
-		free(token_list[j]);
-	free(token_list);
+	arena_uninit(&arena);
 	free(pos_list);
-	free(path);
 	if (ret) {
 		free(inode_table);
 		free(dirs);
@@ -0,0 +1,121 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Region allocator for short-lived allocations
+ *
+ * An arena hands out memory from large blocks obtained with malloc(). There is
+ * no way to free a single allocation: everything is freed at once, when the
+ * operation using the arena is complete. This suits code which makes many
+ * small allocations with the same lifetime, such as the strings produced when
+ * parsing a file or a path, since it avoids a malloc()/free() pair for each
+ * one and keeps them from fragmenting the heap.
+ */
+
+#ifndef __ARENA_H
+#define __ARENA_H
+
+#include <linux/types.h>
+
+struct arena_block;
+
+/* Default size of each block of an arena, if none is given */
+#define ARENA_DEFAULT_BLOCK_SIZE	1024
+
+/**
+ * struct arena - Region allocator
+ *
+ * @blocks: Blocks obtained from malloc(). If @ptr is not NULL, the first is
+ *	the one being allocated from
+ * @ptr: Next free byte in the block being allocated from, NULL if none
+ * @end: End of the block being allocated from
+ * @block_size: Size of each block, excluding its header
+ */
+struct arena {
+	struct arena_block *blocks;
+	char *ptr;
+	char *end;
+	uint block_size;
+};
+
+/**
+ * arena_init() - Set up a new arena
+ *
+ * No memory is allocated until the first call to arena_alloc()
+ *
+ * @arena: Arena to set up
+ * @block_size: Size of each block to obtain from malloc(), or 0 to use
+ *	ARENA_DEFAULT_BLOCK_SIZE. Allocations larger than a quarter of this are
+ *	given a block of their own
+ */
+void arena_init(struct arena *arena, uint block_size);
+
+/**
+ * arena_uninit() - Free all memory used by an arena
+ *
+ * All pointers returned by the arena become invalid. The arena can be used
+ * again after this, as if it had just been set up
+ *
+ * @arena: Arena to free
+ */
+void arena_uninit(struct arena *arena);
+
+/**
+ * arena_reset() - Free all allocations in an arena
+ *
+ * All pointers returned by the arena become invalid. One block is kept, so
+ * that an arena used repeatedly for the same operation need not call malloc()
+ * each time
+ *
+ * @arena: Arena to reset
+ */
+void arena_reset(struct arena *arena);
+
+/**
+ * arena_alloc() - Allocate memory from an arena
+ *
+ * The memory is aligned as for malloc() but is not cleared
+ *
+ * @arena: Arena to allocate from
+ * @size: Number of bytes to allocate
+ * Return: pointer to the memory, or NULL if out of memory
+ */
+void *arena_alloc(struct arena *arena, size_t size);
+
+/**
+ * arena_zalloc() - Allocate zeroed memory from an arena
+ *
+ * @arena: Arena to allocate from
+ * @size: Number of bytes to allocate
+ * Return: pointer to the memory, or NULL if out of memory
+ */
+void *arena_zalloc(struct arena *arena, size_t size);
+
+/**
+ * arena_strndup() - Copy part of a string into an arena
+ *
+ * The copy is always nul-terminated
+ *
+ * @arena: Arena to allocate from
+ * @str: String to copy
+ * @len: Maximum number of characters to copy
+ * Return: pointer to the copy, or NULL if out of memory
+ */
+char *arena_strndup(struct arena *arena, const char *str, size_t len);
+
+/**
+ * arena_strdup() - Copy a string into an arena
+ *
+ * @arena: Arena to allocate from
+ * @str: String to copy
+ * Return: pointer to the copy, or NULL if out of memory
+ */
+char *arena_strdup(struct arena *arena, const char *str);
+
+/**
+ * arena_size() - Get the amount of memory obtained by an arena
+ *
+ * @arena: Arena to check
+ * Return: total size of the blocks obtained from malloc(), in bytes
+ */
+size_t arena_size(const struct arena *arena);
+
+#endif /* __ARENA_H */
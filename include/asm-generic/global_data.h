@@ -269,6 +269,26 @@ struct global_data {
 	 */
 	struct device_node *of_root;
 #endif
+#if CONFIG_IS_ENABLED(OF_INDEX)
+	/**
+	 * @of_index: phandle and compatible-string lookup index
+	 */
+	struct of_index *of_index;
+#endif
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+	/**
+	 * @dm_lazy_index: nodes of the subtrees left for lazy binding,
+	 * NULL if not built yet
+	 */
+	struct dm_lazy_index *dm_lazy_index;
+#endif
+#if CONFIG_IS_ENABLED(DM_HANDOFF)
+	/**
+	 * @dm_handoff: driver-model state to pass to the next phase
+	 * (struct dm_handoff_rec), NULL if none
+	 */
+	struct alist *dm_handoff;
+#endif
 #if CONFIG_IS_ENABLED(MULTI_DTB_FIT)
 	/**
 	 * @multi_dtb_fit: pointer to uncompressed multi-dtb FIT image
@@ -77,6 +77,12 @@ typedef int (*bootdev_hunter_func)(struct bootdev_hunter *info, bool show);
  * @uclass: Uclass ID for the media associated with this bootdev
  * @drv: bootdev driver for the things found by this hunter
  * @hunt: Function to call to hunt for bootdevs of this type (NULL if none)
+ * @start: Function to call to start hunting without waiting for the result
+ *	(NULL if none). This powers up or kicks off whatever is slow, so that
+ *	it can settle while faster bootdevs are scanned. @hunt is still called
+ *	later to complete the hunt
+ * @stop: Function to call to undo @start if the hunt is not completed, e.g.
+ *	because a bootflow was found first (NULL if none)
  *
  * Some bootdevs are not visible until other devices are enumerated. For
  * example, USB bootdevs only appear when the USB bus is enumerated.
@@ -93,6 +99,8 @@ struct bootdev_hunter {
 	enum uclass_id uclass;
 	struct driver *drv;
 	bootdev_hunter_func hunt;
+	bootdev_hunter_func start;
+	bootdev_hunter_func stop;
 };
 
 /* declare a new bootdev hunter */
@@ -321,6 +329,41 @@ int bootdev_hunt(const char *spec, bool show);
  */
 int bootdev_hunt_prio(enum bootdev_prio_t prio, bool show);
 
+/**
+ * bootdev_hunt_start() - Start all hunters which can work in the background
+ *
+ * This calls the start() function of each hunter which has one and has not
+ * been used yet. At present only the USB hunter has one. The hunt is
+ * completed when the hunter is used in the normal way, e.g. with
+ * bootdev_hunt_prio()
+ *
+ * @show: true to show each hunter as it is started
+ * Returns: 0 if OK, -ve on error
+ */
+int bootdev_hunt_start(bool show);
+
+/**
+ * bootdev_hunt_stop() - Stop hunters which were started but not used
+ *
+ * This calls the stop() function of each hunter which was started with
+ * bootdev_hunt_start() but has not completed its hunt, e.g. so that USB
+ * controllers are not left powered up when booting from other media
+ */
+void bootdev_hunt_stop(void);
+
+/**
+ * bootdev_list_hunt_times() - Show how long hunters took
+ *
+ * For each selected hunter this shows the time spent in the hunter itself and
+ * the time from when it was started until the hunt completed. These differ
+ * when the hunter was started early with bootdev_hunt_start()
+ *
+ * @std: Pointer to bootstd private info
+ * @mask: Bitmask of hunters to show, indexed by their position in the linker
+ *	list
+ */
+void bootdev_list_hunt_times(struct bootstd_priv *std, uint mask);
+
 /**
  * bootdev_unhunt() - Mark a device as needing to be hunted again
  *
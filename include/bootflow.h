@@ -221,6 +221,7 @@ enum bootflow_meth_flags_t {
  *	happens before the normal ones)
  * @method_flags: flags controlling which methods should be used for this @dev
  * (enum bootflow_meth_flags_t)
+ * @start_time: Time when the iteration started, from get_timer()
  */
 struct bootflow_iter {
 	int flags;
@@ -242,6 +243,7 @@ struct bootflow_iter {
 	struct udevice **method_order;
 	bool doing_global;
 	int method_flags;
+	ulong start_time;
 };
 
 /**
@@ -269,6 +271,8 @@ void bootflow_iter_init(struct bootflow_iter *iter, int flags);
 /**
  * bootflow_iter_uninit() - Free memory used by an interator
  *
+ * This also stops any hunters which were started early but not used
+ *
  * @iter:	Iterator to free
  */
 void bootflow_iter_uninit(struct bootflow_iter *iter);
@@ -382,6 +386,66 @@ int bootflow_read_all(struct bootflow *bflow);
  */
 int bootflow_run_boot(struct bootflow_iter *iter, struct bootflow *bflow);
 
+/**
+ * bootflow_cache_save() - Remember a bootflow so it can be tried first later
+ *
+ * This records the location of the bootflow, with the size of its file as a
+ * fingerprint, in the 'bootflow_cache' environment variable. The record is
+ * left alone if it already refers to this bootflow. With
+ * CONFIG_BOOTFLOW_CACHE_SAVEENV the environment is saved when the record
+ * changes.
+ *
+ * Bootflows from global bootmeths are not recorded, since they do not have a
+ * fixed location.
+ *
+ * @bflow: Bootflow which is about to be booted
+ * @scan_ms: Time taken by the scan to find it, in milliseconds, 0 if unknown
+ * Return: 0 if OK, -EINVAL if the bootflow cannot be recorded, -E2BIG if the
+ * record is too long, -EIO if the variable could not be set
+ */
+int bootflow_cache_save(const struct bootflow *bflow, ulong scan_ms);
+
+/**
+ * bootflow_cache_clear() - Forget the cached bootflow
+ *
+ * With CONFIG_BOOTFLOW_CACHE_SAVEENV the environment is saved if there was a
+ * record to remove.
+ */
+void bootflow_cache_clear(void);
+
+/**
+ * bootflow_cache_find() - Find and check the cached bootflow
+ *
+ * This runs the hunter for the cached bootdev, if any, then reads the
+ * bootflows on the cached partition until it finds the one from the cached
+ * bootmeth. This is checked against the recorded filename and size.
+ *
+ * The iterator is set up even on failure, so bootflow_iter_uninit() must be
+ * called in all cases. On success, @bflow must be freed with bootflow_free()
+ *
+ * @iter: Returns the iterator used to find the bootflow
+ * @bflow: Returns the bootflow
+ * @scan_msp: If non-NULL, returns the time the full scan took to find this
+ *	bootflow, in milliseconds
+ * Return: 0 if OK, -ENOENT if there is no cached bootflow or it was not found,
+ * -EINVAL if the record is invalid, -ENODEV if the bootdev is missing,
+ * -ESTALE if the bootflow has changed
+ */
+int bootflow_cache_find(struct bootflow_iter *iter, struct bootflow *bflow,
+			ulong *scan_msp);
+
+/**
+ * bootflow_cache_run() - Try to boot the cached bootflow
+ *
+ * The time taken is recorded in bootstage as 'bootflow_cache', along with an
+ * estimate of the time saved by skipping the full scan, 'bootflow_cache_saved'
+ *
+ * @show: true to show the bootflow before booting it
+ * Return: does not return on success, since the OS is booted, else -ve error
+ * from bootflow_cache_find() or bootflow_run_boot()
+ */
+int bootflow_cache_run(bool show);
+
 /**
  * bootflow_state_get_name() - Get the name of a bootflow state
  *
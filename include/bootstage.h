@@ -213,6 +213,11 @@ enum bootstage_id {
 	BOOTSTAGE_ID_ACCUM_FSP_M,
 	BOOTSTAGE_ID_ACCUM_FSP_S,
 	BOOTSTAGE_ID_ACCUM_MMAP_SPI,
+	BOOTSTAGE_ID_ACCUM_BOOTFLOW_CACHE,
+	BOOTSTAGE_ID_ACCUM_BOOTFLOW_SAVED,
+	BOOTSTAGE_ID_ACCUM_FDT_FIXUP,
+	BOOTSTAGE_ID_ACCUM_SPL_FIT_READ,
+	BOOTSTAGE_ID_ACCUM_SPL_FIT_HASH,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
@@ -335,6 +340,34 @@ uint32_t bootstage_start(enum bootstage_id id, const char *name);
  */
 uint32_t bootstage_accum(enum bootstage_id id);
 
+/**
+ * Add a known amount of time to an accumulator
+ *
+ * This is for activities which are not timed directly, e.g. time which was
+ * saved by skipping some work. The time shows up in the report alongside the
+ * accumulators from bootstage_start() and bootstage_accum().
+ *
+ * @param id		Bootstage id to record this time against
+ * @param name		Textual name to display for this id in the report
+ * @param time_us	Time to add, in microseconds
+ */
+void bootstage_accum_add(enum bootstage_id id, const char *name,
+			 uint32_t time_us);
+
+/**
+ * Add a record of how long an activity took
+ *
+ * This allocates a new id, so is for activities which are timed once each,
+ * such as initcalls. The record shows up with the accumulators in the report.
+ *
+ * @param name		Textual name to display in the report, which must
+ *			remain valid until bootstage is relocated
+ * @param start_us	Time the activity started, in microseconds
+ * @param time_us	Time the activity took, in microseconds
+ */
+void bootstage_add_duration(const char *name, uint32_t start_us,
+			    uint32_t time_us);
+
 /* Print a report about boot time */
 void bootstage_report(void);
 
@@ -435,6 +468,16 @@ static inline uint32_t bootstage_accum(enum bootstage_id id)
 	return 0;
 }
 
+static inline void bootstage_accum_add(enum bootstage_id id, const char *name,
+				       uint32_t time_us)
+{
+}
+
+static inline void bootstage_add_duration(const char *name, uint32_t start_us,
+					  uint32_t time_us)
+{
+}
+
 static inline int bootstage_stash(void *base, int size)
 {
 	return 0;	/* Pretend to succeed */
@@ -15,6 +15,22 @@
 
 struct udevice;
 
+/* Maximum number of hunters, limited by the size of the hunters_used mask */
+#define BOOTSTD_MAX_HUNTERS	32
+
+/**
+ * struct bootstd_hunt_stats - timing information for a bootdev hunter
+ *
+ * @begin_us: Time when the hunter was started, in microseconds
+ * @busy_us: Time spent in the hunter's start() and hunt() functions
+ * @total_us: Time from @begin_us until the hunt completed, 0 if not complete
+ */
+struct bootstd_hunt_stats {
+	ulong begin_us;
+	ulong busy_us;
+	ulong total_us;
+};
+
 /**
  * struct bootstd_priv - priv data for the bootstd driver
  *
@@ -37,6 +53,9 @@ struct udevice;
  * @theme: Node containing the theme information
  * @hunters_used: Bitmask of used hunters, indexed by their position in the
  * linker list. The bit is set if the hunter has been used already
+ * @hunters_started: Bitmask of hunters which have been started with
+ * bootdev_hunt_start() but not yet used, indexed like @hunters_used
+ * @hunt_stats: Timing information for each hunter, indexed like @hunters_used
  */
 struct bootstd_priv {
 	const char **prefixes;
@@ -50,6 +69,8 @@ struct bootstd_priv {
 	struct udevice *vbe_bootmeth;
 	ofnode theme;
 	uint hunters_used;
+	uint hunters_started;
+	struct bootstd_hunt_stats hunt_stats[BOOTSTD_MAX_HUNTERS];
 };
 
 /**
@@ -84,6 +84,12 @@ struct driver_info;
 /* Device must be probed after it was bound */
 #define DM_FLAG_PROBE_AFTER_BIND	(1 << 15)
 
+/* Device tree subnodes of this device have not been bound yet (lazy binding) */
+#define DM_FLAG_BIND_PENDING		(1 << 16)
+
+/* Device was bound on demand by lazy binding */
+#define DM_FLAG_BIND_LAZY		(1 << 17)
+
 /*
  * One or multiple of these flags are passed to device_remove() so that
  * a selective device removal as specified by the remove-stage and the
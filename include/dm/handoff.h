@@ -0,0 +1,163 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Passing driver-model state from SPL to U-Boot proper
+ *
+ * SPL records what it has done to each device, such as the clock rates and
+ * regulator voltages it has set. These are passed on in a bloblist so that
+ * U-Boot proper can avoid doing the same work again.
+ */
+
+#ifndef _DM_HANDOFF_H
+#define _DM_HANDOFF_H
+
+#include <linux/errno.h>
+#include <linux/types.h>
+
+struct udevice;
+
+/**
+ * enum dm_handoff_t - Type of state recorded for a device
+ *
+ * @DM_HANDOFF_PROBED: Device was probed (value is 1)
+ * @DM_HANDOFF_CLK_RATE: Rate of a clock in Hz (id is the clock ID)
+ * @DM_HANDOFF_REGULATOR_UV: Regulator output voltage in microvolts
+ * @DM_HANDOFF_REGULATOR_ENABLE: Regulator is enabled (value is 1) or
+ *	disabled (value is 0)
+ */
+enum dm_handoff_t {
+	DM_HANDOFF_PROBED,
+	DM_HANDOFF_CLK_RATE,
+	DM_HANDOFF_REGULATOR_UV,
+	DM_HANDOFF_REGULATOR_ENABLE,
+};
+
+/**
+ * struct dm_handoff_rec - State recorded for a device
+ *
+ *
+ * @key: Hash of the path of the device's devicetree node
+ * @type: Type of state (enum dm_handoff_t)
+ * @id: Identifies the item within the device, e.g. the clock ID, else 0
+ * @reserved: Must be 0
+ * @val: Value, as described by @type
+ */
+struct dm_handoff_rec {
+	u32 key;
+	u32 type;
+	u32 id;
+	u32 reserved;
+	u64 val;
+};
+
+/**
+ * struct dm_handoff - Contents of the BLOBLISTT_U_BOOT_DM_STATE blob
+ *
+ * @count: Number of records
+ * @rec_size: Size of each record, i.e. sizeof(struct dm_handoff_rec)
+ * @recs: Records
+ */
+struct dm_handoff {
+	u32 count;
+	u32 rec_size;
+	struct dm_handoff_rec recs[];
+};
+
+#if CONFIG_IS_ENABLED(DM_HANDOFF)
+/**
+ * dev_handoff_add() - Record some state of a device
+ *
+ * This replaces any value recorded earlier for the same item. Records are
+ * held in memory until dm_handoff_write() is called.
+ *
+ * @dev: Device, which must have a devicetree node
+ * @type: Type of state
+ * @id: Item within the device, e.g. the clock ID, else 0
+ * @val: Value to record
+ * Return: 0 if OK, -ENOENT if the device has no node, -E2BIG if @id is too
+ *	large, -ENOSPC if the node path is too long, -ENOMEM if out of memory
+ */
+int dev_handoff_add(struct udevice *dev, enum dm_handoff_t type, ulong id,
+		    u64 val);
+
+/**
+ * dev_handoff_find() - Find some state recorded for a device by a prior phase
+ *
+ * This looks in the bloblist, so only sees state recorded by an earlier
+ * phase.
+ *
+ * @dev: Device to check
+ * @type: Type of state
+ * @id: Item within the device, e.g. the clock ID, else 0
+ * @valp: Returns the value
+ * Return: 0 if found, -ENOENT if not
+ */
+int dev_handoff_find(struct udevice *dev, enum dm_handoff_t type, ulong id,
+		     u64 *valp);
+
+/**
+ * dm_handoff_write() - Write the recorded state to the bloblist
+ *
+ * This is called by SPL just before jumping to the next phase. The records
+ * are then freed.
+ *
+ * Return: 0 if OK (including if nothing was recorded), -ve on error
+ */
+int dm_handoff_write(void);
+#else
+static inline int dev_handoff_add(struct udevice *dev, enum dm_handoff_t type,
+				  ulong id, u64 val)
+{
+	return 0;
+}
+
+static inline int dev_handoff_find(struct udevice *dev, enum dm_handoff_t type,
+				   ulong id, u64 *valp)
+{
+	return -ENOENT;
+}
+
+static inline int dm_handoff_write(void)
+{
+	return 0;
+}
+#endif
+
+/**
+ * dev_handoff_save() - Record state of a device for the next phase
+ *
+ * This does nothing in U-Boot proper, since there is no next phase to use it
+ *
+ * @dev: Device, which must have a devicetree node
+ * @type: Type of state
+ * @id: Item within the device, e.g. the clock ID, else 0
+ * @val: Value to record
+ * Return: 0 if OK, -ve on error
+ */
+static inline int dev_handoff_save(struct udevice *dev, enum dm_handoff_t type,
+				   ulong id, u64 val)
+{
+	if (!IS_ENABLED(CONFIG_XPL_BUILD))
+		return 0;
+
+	return dev_handoff_add(dev, type, id, val);
+}
+
+/**
+ * dev_handoff_probed() - Check whether a prior phase probed a device
+ *
+ * A driver can use this to skip hardware set-up which was already done, e.g.
+ * by SPL. It must still set up any software state it needs. Probing is only
+ * recorded for uclasses with DM_UC_FLAG_HANDOFF, such as clocks and
+ * regulators.
+ *
+ * @dev: Device to check
+ * Return: true if the device was probed by a prior phase
+ */
+static inline bool dev_handoff_probed(struct udevice *dev)
+{
+	u64 val;
+
+	return !dev_handoff_find(dev, DM_HANDOFF_PROBED, 0, &val) && val;
+}
+
+#endif
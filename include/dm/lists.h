@@ -45,6 +45,20 @@ struct uclass_driver *lists_uclass_lookup(enum uclass_id id);
  */
 int lists_bind_drivers(struct udevice *parent, bool pre_reloc_only);
 
+/**
+ * lists_driver_lookup_compat() - Find the driver for a compatible string
+ *
+ * This uses the of_index compatible table if available, else searches the
+ * drivers in turn.
+ *
+ * @compat: Compatible string to look up
+ * @drvp: Returns the driver
+ * @of_idp: Returns the matching entry in the driver's of_match table
+ * Return: 0 if found, -ENOENT if no driver matches
+ */
+int lists_driver_lookup_compat(const char *compat, struct driver **drvp,
+			       const struct udevice_id **of_idp);
+
 /**
  * lists_bind_fdt() - bind a device tree node
  *
@@ -0,0 +1,73 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Lookup index for phandles in the control FDT and for driver compatible
+ * strings
+ */
+
+#ifndef _DM_OF_INDEX_H
+#define _DM_OF_INDEX_H
+
+#include <linux/errno.h>
+#include <linux/libfdt.h>
+
+struct driver;
+struct udevice_id;
+
+#if CONFIG_IS_ENABLED(OF_INDEX)
+/**
+ * of_index_phandle_offset() - Find the node with a given phandle
+ *
+ * When @blob is the control FDT this uses the phandle index, building it on
+ * first use. The index entry is checked against the tree and the index is
+ * rebuilt if the tree has changed. Other trees are searched with
+ * fdt_node_offset_by_phandle().
+ *
+ * @blob: Device tree blob
+ * @phandle: Phandle to look up
+ * Return: node offset, or -ve FDT_ERR_... value if not found
+ */
+int of_index_phandle_offset(const void *blob, uint phandle);
+
+/**
+ * of_index_find_driver() - Find the first driver matching a compatible string
+ *
+ * This gives the same result as checking the of_match table of each driver
+ * in turn, in linker-list order.
+ *
+ * @compat: Compatible string to look up
+ * @drvp: Returns the driver
+ * @of_idp: Returns the matching entry in the driver's of_match table
+ * Return: 0 if found, -ENOENT if no driver matches, other -ve value if the
+ * index could not be built (e.g. -ENOSPC if it does not fit in the early
+ * malloc() area), in which case the caller must search the drivers
+ */
+int of_index_find_driver(const char *compat, struct driver **drvp,
+			 const struct udevice_id **of_idp);
+
+/**
+ * of_index_invalidate() - Drop the phandle index
+ *
+ * This is not normally needed since a stale index is detected on lookup, but
+ * allows the index to be rebuilt eagerly after a batch of changes to the
+ * control FDT.
+ */
+void of_index_invalidate(void);
+#else
+static inline int of_index_phandle_offset(const void *blob, uint phandle)
+{
+	return fdt_node_offset_by_phandle(blob, phandle);
+}
+
+static inline int of_index_find_driver(const char *compat,
+				       struct driver **drvp,
+				       const struct udevice_id **of_idp)
+{
+	return -ENOSYS;
+}
+
+static inline void of_index_invalidate(void)
+{
+}
+#endif
+
+#endif
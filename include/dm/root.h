@@ -9,8 +9,11 @@
 #ifndef _DM_ROOT_H_
 #define _DM_ROOT_H_
 
+#include <dm/ofnode_decl.h>
 #include <dm/tag.h>
+#include <dm/uclass-id.h>
 
+struct uclass;
 struct udevice;
 
 /* Head of the uclass list if CONFIG_OF_PLATDATA_INST is enabled */
@@ -34,6 +37,9 @@ extern struct list_head uclass_head;
  * @attach_size_total: Total number of bytes of attached data
  * @attach_count: Number of devices with attached, for each type
  * @attach_size: Total number of bytes of attached data, for each type
+ * @lazy_pending_count: Number of devices whose subnodes are not bound yet
+ * @lazy_bound_count: Number of devices bound on demand by lazy binding
+ * @lazy_bound_size: Bytes used by those devices, including attached data
  */
 struct dm_stats {
 	int total_size;
@@ -50,6 +56,9 @@ struct dm_stats {
 	int attach_size_total;
 	int attach_count[DM_TAG_ATTACH_COUNT];
 	int attach_size[DM_TAG_ATTACH_COUNT];
+	int lazy_pending_count;
+	int lazy_bound_count;
+	int lazy_bound_size;
 };
 
 /**
@@ -109,6 +118,75 @@ int dm_scan_fdt(bool pre_reloc_only);
  */
 int dm_extended_scan(bool pre_reloc_only);
 
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+/**
+ * dm_lazy_bind_defer() - Leave the subnodes of a device to be bound later
+ *
+ * This marks @dev with DM_FLAG_BIND_PENDING. Its subnodes are bound when a
+ * lookup needs them. dm_scan_fdt_dev() calls this before relocation.
+ *
+ * @dev: Device whose subnodes should not be bound yet
+ */
+void dm_lazy_bind_defer(struct udevice *dev);
+
+/**
+ * dm_lazy_bind_children() - Bind the pending subnodes of a device
+ *
+ * Does nothing unless @parent has DM_FLAG_BIND_PENDING set. Devices bound
+ * here are marked with DM_FLAG_BIND_LAZY.
+ *
+ * @parent: Device whose subnodes should be bound
+ * Return: 0 if OK, -ve on error
+ */
+int dm_lazy_bind_children(const struct udevice *parent);
+
+/**
+ * dm_lazy_bind_node() - Bind the devices leading to a device tree node
+ *
+ * Binds the pending subnodes of each ancestor of @node, from the top down,
+ * so that a device for @node exists if one would have been bound by a full
+ * scan.
+ *
+ * @node: Node being looked up
+ * Return: 0 if OK, -ve on error
+ */
+int dm_lazy_bind_node(ofnode node);
+
+/**
+ * dm_lazy_bind_uclass() - Bind the pending nodes for a uclass
+ *
+ * Binds the path to each node with a compatible string matching a driver in
+ * the uclass, so that a search of the uclass finds the same devices as after
+ * a full scan. The pending nodes are indexed by uclass on first use, so this
+ * does not match compatible strings again for each uclass. Devices which are
+ * bound by their parent's driver rather than from a compatible string are
+ * only bound along with their parent. uclass_get() calls this.
+ *
+ * @uc: Uclass being searched
+ * Return: 0 if OK, -ve on error
+ */
+int dm_lazy_bind_uclass(struct uclass *uc);
+
+/**
+ * dm_lazy_bind_all() - Bind all pending subnodes
+ *
+ * This is needed before searching a uclass by sequence number or counting
+ * its devices, since aliases and positions depend on every device.
+ *
+ * Return: 0 if OK, -ve on error
+ */
+int dm_lazy_bind_all(void);
+#else
+static inline void dm_lazy_bind_defer(struct udevice *dev) { }
+static inline int dm_lazy_bind_children(const struct udevice *parent)
+{
+	return 0;
+}
+static inline int dm_lazy_bind_node(ofnode node) { return 0; }
+static inline int dm_lazy_bind_uclass(struct uclass *uc) { return 0; }
+static inline int dm_lazy_bind_all(void) { return 0; }
+#endif
+
 /**
  * dm_scan_other() - Scan for other devices
  *
@@ -329,6 +329,20 @@ static inline int uclass_pre_remove_device(struct udevice *dev) { return 0; }
  */
 int uclass_get_count(void);
 
+/**
+ * uclass_get_nobind() - Get a uclass, creating it if needed
+ *
+ * This is uclass_get() without binding the nodes left for lazy binding
+ * (CONFIG_DM_LAZY_BIND) which have a driver in the uclass. It is used when
+ * binding a device and when looking up a single node.
+ *
+ * @key: ID to look up
+ * @ucp: Returns pointer to uclass (there is only one per ID)
+ * Return: 0 if OK, -EDEADLK if driver model is not yet inited, other -ve on
+ * other error
+ */
+int uclass_get_nobind(enum uclass_id key, struct uclass **ucp);
+
 /**
  * uclass_find() - Find uclass by its id
  *
@@ -30,12 +30,17 @@
  * @dev_head: List of devices in this uclass (devices are attached to their
  * uclass when their bind method is called)
  * @sibling_node: Next uclass in the linked list of uclasses
+ * @lazy_bound: true if no subtree left for lazy binding has a node for this
+ * uclass (DM_LAZY_BIND)
  */
 struct uclass {
 	void *priv_;
 	struct uclass_driver *uc_drv;
 	struct list_head dev_head;
 	struct list_head sibling_node;
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+	bool lazy_bound;
+#endif
 };
 
 struct driver;
@@ -47,6 +52,9 @@ struct udevice;
 /* Members of this uclass without aliases don't get a sequence number */
 #define DM_UC_FLAG_NO_AUTO_SEQ			(1 << 1)
 
+/* Record in SPL that members were probed, for dev_handoff_probed() */
+#define DM_UC_FLAG_HANDOFF			(1 << 2)
+
 /* Same as DM_FLAG_ALLOC_PRIV_DMA */
 #define DM_UC_FLAG_ALLOC_PRIV_DMA		(1 << 5)
 
@@ -156,6 +164,10 @@ void *uclass_get_priv(const struct uclass *uc);
  * the number of uclasses. This function allows looking up a uclass by its
  * ID.
  *
+ * With CONFIG_DM_LAZY_BIND, this first binds any pending device tree nodes
+ * with a driver in the uclass, so that iterating its devices with
+ * uclass_foreach_dev() finds the same devices as after a full scan.
+ *
  * @key: ID to look up
  * @ucp: Returns pointer to uclass (there is only one per ID)
  * Return:
@@ -18,6 +18,24 @@ extern u32 fastboot_buf_size;
  */
 extern void (*fastboot_progress_callback)(const char *msg);
 
+/**
+ * struct fastboot_stats - timing of the last transfers
+ *
+ * @download_bytes: size of the last completed download
+ * @download_ms: time taken by the last completed download
+ * @flash_ms: time taken by the last flash command
+ */
+struct fastboot_stats {
+	u32 download_bytes;
+	ulong download_ms;
+	ulong flash_ms;
+};
+
+/**
+ * fastboot_stats - statistics reported by "getvar stats"
+ */
+extern struct fastboot_stats fastboot_stats;
+
 /**
  * fastboot_getvar_all() - Writes current variable being listed from "all" to response.
  *
@@ -0,0 +1,152 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Batched edits to a flat devicetree
+ *
+ * Each libfdt call which adds or grows a property moves the rest of the blob
+ * along to make room. When many fixups are applied before booting an OS, this
+ * adds up. A fixup session instead queues the edits and applies them in a
+ * single pass over the tree, with a single size check.
+ *
+ * Node offsets are given relative to the tree as it was when the session
+ * started. The tree must not be changed by other means until the session is
+ * committed or aborted, after which all offsets are invalid.
+ */
+
+#ifndef __FDT_FIXUP_H
+#define __FDT_FIXUP_H
+
+#include <alist.h>
+#include <linux/string.h>
+#include <linux/libfdt.h>
+
+/**
+ * struct fdt_fixup - Fixup session
+ *
+ * @blob: Devicetree being edited
+ * @bufsize: Space available for @blob, in bytes
+ * @edits: Queued edits (struct fdt_fixup_edit)
+ * @seq: Sequence number for the next edit
+ * @err: First error seen when queueing an edit, 0 if none
+ */
+struct fdt_fixup {
+	void *blob;
+	int bufsize;
+	struct alist edits;
+	int seq;
+	int err;
+};
+
+/**
+ * fdt_fixup_begin() - Start a fixup session
+ *
+ * @fix: Session to set up
+ * @blob: Devicetree to edit
+ * @bufsize: Space available at @blob in bytes, or 0 to use the current total
+ *	size of @blob. The tree is expanded up to this size if needed.
+ */
+void fdt_fixup_begin(struct fdt_fixup *fix, void *blob, int bufsize);
+
+/**
+ * fdt_fixup_setprop() - Queue setting a property
+ *
+ * The value is copied, so need not be kept around until the session is
+ * committed. If the property is set more than once, the last value is used.
+ *
+ * New properties are added in the same position as fdt_setprop() would put
+ * them, i.e. the most recently queued property comes first.
+ *
+ * @fix: Session
+ * @nodeoffset: Offset of node to update
+ * @name: Property name
+ * @val: Property value
+ * @len: Length of @val in bytes
+ * Return: 0 if OK, -ve FDT_ERR_... on error. The error is also returned by
+ *	fdt_fixup_commit()
+ */
+int fdt_fixup_setprop(struct fdt_fixup *fix, int nodeoffset, const char *name,
+		      const void *val, int len);
+
+/**
+ * fdt_fixup_setprop_u32() - Queue setting a 32-bit property
+ *
+ * @fix: Session
+ * @nodeoffset: Offset of node to update
+ * @name: Property name
+ * @val: Value, in CPU byte order
+ * Return: 0 if OK, -ve FDT_ERR_... on error
+ */
+static inline int fdt_fixup_setprop_u32(struct fdt_fixup *fix, int nodeoffset,
+					const char *name, u32 val)
+{
+	fdt32_t tmp = cpu_to_fdt32(val);
+
+	return fdt_fixup_setprop(fix, nodeoffset, name, &tmp, sizeof(tmp));
+}
+
+/**
+ * fdt_fixup_setprop_string() - Queue setting a string property
+ *
+ * @fix: Session
+ * @nodeoffset: Offset of node to update
+ * @name: Property name
+ * @str: String value, including the terminator
+ * Return: 0 if OK, -ve FDT_ERR_... on error
+ */
+static inline int fdt_fixup_setprop_string(struct fdt_fixup *fix,
+					   int nodeoffset, const char *name,
+					   const char *str)
+{
+	return fdt_fixup_setprop(fix, nodeoffset, name, str, strlen(str) + 1);
+}
+
+/**
+ * fdt_fixup_delprop() - Queue deleting a property
+ *
+ * This drops any earlier edit to the property. It is not an error if the
+ * property does not exist.
+ *
+ * @fix: Session
+ * @nodeoffset: Offset of node to update
+ * @name: Property name
+ * Return: 0 if OK, -ve FDT_ERR_... on error
+ */
+int fdt_fixup_delprop(struct fdt_fixup *fix, int nodeoffset,
+		      const char *name);
+
+/**
+ * fdt_fixup_del_node() - Queue deleting a node
+ *
+ * The node and all its subnodes are removed, along with any edits queued for
+ * them
+ *
+ * @fix: Session
+ * @nodeoffset: Offset of node to delete, which must not be the root node
+ * Return: 0 if OK, -ve FDT_ERR_... on error
+ */
+int fdt_fixup_del_node(struct fdt_fixup *fix, int nodeoffset);
+
+/**
+ * fdt_fixup_commit() - Apply the queued edits and end the session
+ *
+ * If all the edits replace existing properties with values of the same size,
+ * they are written in place. Otherwise the tree is rebuilt in place in one
+ * pass, copying the parts between edits as they are. No memory is allocated
+ * for this.
+ *
+ * On error the contents of the tree are unchanged. Either way the session is
+ * ended.
+ *
+ * @fix: Session
+ * Return: 0 if OK, -FDT_ERR_NOSPACE if the result does not fit in the buffer
+ *	or memory ran out, other -ve FDT_ERR_... on error
+ */
+int fdt_fixup_commit(struct fdt_fixup *fix);
+
+/**
+ * fdt_fixup_abort() - End a session without applying the edits
+ *
+ * @fix: Session
+ */
+void fdt_fixup_abort(struct fdt_fixup *fix);
+
+#endif
@@ -428,6 +428,20 @@ int fdt_add_fb_mem_rsv(void *blob);
 
 int fdt_overlay_apply_verbose(void *fdt, void *fdto);
 
+/**
+ * fdt_overlay_batch_apply_verbose() - Apply an overlay as part of a series
+ *
+ * This is the same as fdt_overlay_apply_verbose() but uses the state in
+ * @batch, set up by fdt_overlay_batch_init()
+ *
+ * @batch: Batch state, or NULL to apply the overlay on its own
+ * @fdt: Base device tree
+ * @fdto: Overlay to apply
+ * Return: 0 if OK, -FDT_ERR_... on error
+ */
+int fdt_overlay_batch_apply_verbose(struct fdt_overlay_batch *batch,
+				    void *fdt, void *fdto);
+
 int fdt_valid(struct fdt_header **blobp);
 
 /**
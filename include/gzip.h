@@ -49,6 +49,56 @@ int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp);
 int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 	   int stoponerr, int offset);
 
+/**
+ * struct gunzip_stream - State for decompressing gzipped data in pieces
+ *
+ * @zs: zlib stream (z_stream)
+ * @started: true once the gzip header has been skipped
+ * @done: true once the end of the compressed data has been seen
+ */
+struct gunzip_stream {
+	void *zs;
+	bool started;
+	bool done;
+};
+
+/**
+ * gunzip_stream_start() - Start decompressing gzipped data in pieces
+ *
+ * gunzip_stream_finish() must be called afterwards, even on error
+ *
+ * @gs: Stream state to set up
+ * @dst: Destination for uncompressed data
+ * @dstlen: Size of destination buffer
+ * Return: 0 if OK, -ENOMEM if out of memory, -EIO if zlib cannot be set up
+ */
+int gunzip_stream_start(struct gunzip_stream *gs, void *dst, ulong dstlen);
+
+/**
+ * gunzip_stream_feed() - Decompress the next piece of gzipped data
+ *
+ * The gzip header must be entirely within the first piece. Any data after the
+ * end of the compressed data (i.e. the gzip trailer) is ignored.
+ *
+ * @gs: Stream state
+ * @src: Next piece of compressed data
+ * @len: Length of @src in bytes
+ * Return: 0 if OK, -EINVAL if the header is invalid, -ENOSPC if the
+ *	destination buffer is full, -EIO on a decompression error
+ */
+int gunzip_stream_feed(struct gunzip_stream *gs, const void *src, ulong len);
+
+/**
+ * gunzip_stream_finish() - Finish decompressing gzipped data in pieces
+ *
+ * This frees the stream state
+ *
+ * @gs: Stream state
+ * @lenp: Returns the number of bytes of uncompressed data
+ * Return: 0 if OK, -EIO if the end of the compressed data was not seen
+ */
+int gunzip_stream_finish(struct gunzip_stream *gs, ulong *lenp);
+
 /**
  * gzwrite progress indicators: defined weak to allow board-specific
  * overrides:
@@ -6,8 +6,9 @@
 #ifndef __INITCALL_H
 #define __INITCALL_H
 
-#include <asm/types.h>
 #include <event.h>
+#include <linker_lists.h>
+#include <asm/types.h>
 
 _Static_assert(EVT_COUNT < 256, "Can only support 256 event types with 8 bits");
 
@@ -35,4 +36,119 @@ typedef int (*init_fnc_t)(void);
  */
 int initcall_run_list(const init_fnc_t init_sequence[]);
 
+/**
+ * struct initcall_group - A group of initcalls which do not depend on each other
+ *
+ * The initcalls in a group are run one at a time by initcall_group_step(),
+ * at points where nothing else is in progress, e.g. while waiting for a key.
+ * Any which have not run by the time initcall_group_finish() is called are
+ * run then.
+ *
+ * @calls: Initcalls to run
+ * @count: Number of initcalls in @calls
+ * @next: Index of the next initcall to run
+ * @ret: Error from the first initcall which failed, 0 if none
+ */
+struct initcall_group {
+	const init_fnc_t *calls;
+	int count;
+	int next;
+	int ret;
+};
+
+/**
+ * INITCALL_LATE_GROUP() - Declare an initcall for the late group
+ *
+ * The late group is started after the console is ready in board_init_r(). Its
+ * initcalls run while the autoboot countdown waits for a key, and any left
+ * over run before the first command, so the initcall must not be needed by
+ * anything before that. It must not depend on any other initcall in the
+ * group and must not print output which is expected to appear in a
+ * particular place.
+ *
+ * This needs CONFIG_INITCALL_GROUPS
+ *
+ * @_func: Initcall to run
+ */
+#define INITCALL_LATE_GROUP(_func) \
+	ll_entry_declare(init_fnc_t, _func, initcall_late) = _func
+
+#if CONFIG_IS_ENABLED(INITCALL_GROUPS)
+/**
+ * initcall_group_start() - Start a group of initcalls
+ *
+ * No initcalls are run until initcall_group_step() or initcall_group_finish()
+ * is called
+ *
+ * @grp: Group to start
+ * @calls: Initcalls to run, which must remain valid until the group is
+ *	finished
+ * @count: Number of initcalls in @calls
+ */
+void initcall_group_start(struct initcall_group *grp, const init_fnc_t *calls,
+			  int count);
+
+/**
+ * initcall_group_step() - Run the next initcall in a group
+ *
+ * @grp: Group to run from
+ * Return: true if an initcall was run, false if there are none left or one
+ *	has failed
+ */
+bool initcall_group_step(struct initcall_group *grp);
+
+/**
+ * initcall_group_finish() - Finish running a group of initcalls
+ *
+ * This runs any initcalls in the group which have not been run yet
+ *
+ * @grp: Group to finish
+ * Return: 0 if OK, or -ve error code from the first failure
+ */
+int initcall_group_finish(struct initcall_group *grp);
+
+/**
+ * initcall_late_start() - Start the late group
+ *
+ * This sets up the group of initcalls declared with INITCALL_LATE_GROUP()
+ *
+ * Return: 0
+ */
+int initcall_late_start(void);
+
+/**
+ * initcall_late_idle() - Run the next initcall in the late group
+ *
+ * This is called where U-Boot would otherwise just wait, with no driver
+ * operation in progress
+ *
+ * Return: true if an initcall was run, false if there are none left
+ */
+bool initcall_late_idle(void);
+
+/**
+ * initcall_late_finish() - Run any initcalls left in the late group
+ *
+ * This must be called before running a command
+ *
+ * Return: 0 if OK, or -ve error code from the first failure
+ */
+int initcall_late_finish(void);
+#else
+static inline int initcall_late_start(void)
+{
+	return 0;
+}
+
+static inline bool initcall_late_idle(void)
+{
+	return false;
+}
+
+static inline int initcall_late_finish(void)
+{
+	return 0;
+}
+#endif
+
 #endif
@@ -10,4 +10,61 @@
 /* U-Boot local hacks */
 extern struct fdt_header *working_fdt;  /* Pointer to the working fdt */
 
+struct fdt_overlay_sym;
+
+/**
+ * struct fdt_overlay_batch - State kept while applying a series of overlays
+ *
+ * @syms: Index of the symbols in the base tree, sorted by label
+ * @count: Number of entries in @syms
+ * @alloc: Number of entries allocated for @syms
+ * @max_phandle: Highest phandle in the base tree
+ */
+struct fdt_overlay_batch {
+	struct fdt_overlay_sym *syms;
+	int count;
+	int alloc;
+	uint32_t max_phandle;
+};
+
+/**
+ * fdt_overlay_batch_init() - Prepare to apply a series of overlays
+ *
+ * fdt_overlay_apply() finds the highest phandle in the base tree, looks up
+ * each symbol used by the overlay in __symbols__ and scans the tree for each
+ * fragment's target phandle. When applying many overlays this is repeated for
+ * each one. This sets up an index of the symbols and the highest phandle,
+ * which fdt_overlay_batch_apply() then keeps up to date.
+ *
+ * The base tree may be moved or resized between overlays, but must not
+ * otherwise be changed.
+ *
+ * @batch: Batch to set up
+ * @fdt: Base device tree
+ * Return: 0 if OK, -FDT_ERR_NOSPACE if out of memory, other -FDT_ERR_...
+ *	on error
+ */
+int fdt_overlay_batch_init(struct fdt_overlay_batch *batch, const void *fdt);
+
+/**
+ * fdt_overlay_batch_apply() - Apply an overlay as part of a series
+ *
+ * This behaves the same as fdt_overlay_apply(), including damaging @fdto and,
+ * on error, @fdt
+ *
+ * @batch: Batch set up by fdt_overlay_batch_init()
+ * @fdt: Base device tree
+ * @fdto: Overlay to apply
+ * Return: 0 if OK, -FDT_ERR_... on error
+ */
+int fdt_overlay_batch_apply(struct fdt_overlay_batch *batch, void *fdt,
+			    void *fdto);
+
+/**
+ * fdt_overlay_batch_uninit() - Free the memory used by a batch
+ *
+ * @batch: Batch to free
+ */
+void fdt_overlay_batch_uninit(struct fdt_overlay_batch *batch);
+
 #endif /* _INCLUDE_LIBFDT_H_ */
@@ -552,6 +552,11 @@ struct spi_flash {
  * @octal_dtr_enable:	[FLASH-SPECIFIC] enables SPI NOR octal DTR mode.
  * @ready:		[FLASH-SPECIFIC] check if the flash is ready
  * @dirmap:		pointers to struct spi_mem_dirmap_desc for reads/writes.
+ * @tune_hwcaps:	read capabilities supported by both the controller and
+ *			the flash, which can be tried when tuning
+ * @tune_4b_opcodes:	true if the 3-byte read opcodes were converted to their
+ *			4-byte variants
+ * @tune_reads:		read commands, indexed by enum spi_nor_read_command_index
  * @priv:		the private data
  */
 struct spi_nor {
@@ -609,6 +614,12 @@ struct spi_nor {
 		struct spi_mem_dirmap_desc *wdesc;
 	} dirmap;
 
+#if CONFIG_IS_ENABLED(SPI_FLASH_TUNE)
+	u32			tune_hwcaps;
+	bool			tune_4b_opcodes;
+	struct spi_nor_read_command tune_reads[SNOR_CMD_READ_MAX];
+#endif
+
 	void *priv;
 	char mtd_name[MTD_NAME_SIZE(MTD_DEV_TYPE_NOR)];
 /* Compatibility for spi_flash, remove once sf layer is merged with mtd */
@@ -93,6 +93,26 @@ long lmb_reserve(phys_addr_t base, phys_size_t size);
  */
 long lmb_reserve_flags(phys_addr_t base, phys_size_t size,
 		       enum lmb_flags flags);
+
+/**
+ * lmb_reserve_regions() - Reserve a number of regions at once
+ *
+ * This has the same effect as calling lmb_reserve_flags() for each region, but
+ * sorts the regions and merges them with the existing reservations in a single
+ * pass, so is much faster when there are many of them. Changes to the EFI
+ * memory map are also batched, so that adjoining regions are sent together.
+ *
+ * A region is skipped if it overlaps an existing or earlier region and either
+ * of them has flags, i.e. where lmb_reserve_flags() would fail. Where regions
+ * in @rgns overlap each other, they are considered in order of base address.
+ *
+ * @rgns:	regions to reserve; these are sorted in place
+ * @count:	number of regions in @rgns
+ * Return:	number of regions skipped, -ENOMEM if out of memory, -E2BIG if
+ *		there are too many regions, or -1 if the EFI memory map could
+ *		not be updated
+ */
+long lmb_reserve_regions(struct lmb_region *rgns, uint count);
 phys_addr_t lmb_alloc(phys_size_t size, ulong align);
 phys_addr_t lmb_alloc_base(phys_size_t size, ulong align, phys_addr_t max_addr);
 phys_addr_t lmb_alloc_addr(phys_addr_t base, phys_size_t size);
@@ -991,6 +991,129 @@ extern ulong mem_malloc_brk;
  */
 void mem_malloc_init(ulong start, ulong size);
 
+/**
+ * struct malloc_info - Statistics about the malloc() pool
+ *
+ * Sizes include the overhead of each chunk. Only the allocations made after
+ * relocation are counted.
+ *
+ * @total_bytes: Size of the pool
+ * @heap_bytes: Part of the pool used so far, i.e. holding allocated or freed
+ *	chunks
+ * @in_use_bytes: Bytes in allocated chunks
+ * @peak_bytes: Highest value of @in_use_bytes so far
+ * @free_bytes: Bytes in free chunks within @heap_bytes
+ * @largest_free: Size of the largest free chunk. Memory in use between free
+ *	chunks prevents them being combined, so if this is much smaller than
+ *	@free_bytes, the pool is fragmented
+ * @free_chunks: Number of free chunks, not counting the one at the top
+ * @count: Number of allocations not yet freed
+ * @calls: Number of calls to malloc(), calloc(), realloc() and memalign()
+ * @frees: Number of calls to free() with a non-NULL pointer
+ */
+struct malloc_info {
+	ulong total_bytes;
+	ulong heap_bytes;
+	ulong in_use_bytes;
+	ulong peak_bytes;
+	ulong free_bytes;
+	ulong largest_free;
+	ulong free_chunks;
+	ulong count;
+	ulong calls;
+	ulong frees;
+};
+
+/**
+ * malloc_get_info() - Get statistics about the malloc() pool
+ *
+ * This is only available if CONFIG_MALLOC_STATS is enabled
+ *
+ * @info: Returns the statistics
+ * Return: 0 if OK
+ */
+int malloc_get_info(struct malloc_info *info);
+
+/**
+ * malloc_slab_enable() - Enable or disable the slabs for small allocations
+ *
+ * This is only available if CONFIG_MALLOC_SLAB is enabled, and is intended
+ * for tests and benchmarks. Allocations already in the slabs are still freed
+ * correctly while the slabs are disabled.
+ *
+ * @enable: true to serve small allocations from the slabs, false to use
+ *	dlmalloc for everything
+ */
+void malloc_slab_enable(bool enable);
+
+/**
+ * enum malloc_trace_op - Type of call recorded in the malloc() trace
+ *
+ * @MALLOC_TRACE_MALLOC: malloc()
+ * @MALLOC_TRACE_CALLOC: calloc()
+ * @MALLOC_TRACE_REALLOC: realloc(), preceded by a free record for the old
+ *	pointer if it was not NULL and the call succeeded
+ * @MALLOC_TRACE_MEMALIGN: memalign()
+ * @MALLOC_TRACE_FREE: free()
+ */
+enum malloc_trace_op {
+	MALLOC_TRACE_MALLOC,
+	MALLOC_TRACE_CALLOC,
+	MALLOC_TRACE_REALLOC,
+	MALLOC_TRACE_MEMALIGN,
+	MALLOC_TRACE_FREE,
+};
+
+/**
+ * struct malloc_trace_rec - Record of a call to malloc() and friends
+ *
+ * @time: Time of the call in microseconds, from timer_get_us()
+ * @caller: Address which made the call, less the relocation offset so that it
+ *	matches the U-Boot ELF file
+ * @ptr: Pointer returned (NULL on failure) or, for free(), the pointer freed
+ * @size: Number of bytes requested, 0 for free()
+ * @op: Type of call (enum malloc_trace_op)
+ */
+struct malloc_trace_rec {
+	ulong time;
+	ulong caller;
+	ulong ptr;
+	ulong size;
+	uint op;
+};
+
+/**
+ * malloc_trace_get() - Get a record from the malloc() trace
+ *
+ * This is only available if CONFIG_MALLOC_TRACE is enabled. Only calls made
+ * after relocation are recorded. Once the trace is full, each new record
+ * replaces the oldest one.
+ *
+ * @idx: Record number, 0 being the oldest
+ * Return: record, or NULL if @idx is not less than the number of records
+ */
+const struct malloc_trace_rec *malloc_trace_get(uint idx);
+
+/**
+ * malloc_trace_dropped() - Get the number of records lost from the trace
+ *
+ * Return: number of records replaced because the trace was full
+ */
+ulong malloc_trace_dropped(void);
+
+/** malloc_trace_clear() - Remove all records from the malloc() trace */
+void malloc_trace_clear(void);
+
+/**
+ * malloc_trace_enable() - Start or stop recording calls in the malloc() trace
+ *
+ * Recording is enabled at start-up
+ *
+ * @enable: true to record calls, false to stop
+ * Return: true if recording was enabled before the call
+ */
+bool malloc_trace_enable(bool enable);
+
 #ifdef __cplusplus
 };  /* end of extern "C" */
 #endif
@@ -122,6 +122,56 @@ extern struct in_addr	net_ip;		/* Our    IP addr (0 = unknown) */
 /* Indicates whether the pxe path prefix / config file was specified in dhcp option */
 extern char *pxelinux_configfile;
 
+/**
+ * ip_checksum_partial() - Add data to a running IP checksum sum
+ *
+ * This accumulates the one's complement sum of the data without folding it,
+ * so that discontiguous pieces such as a pseudo-header and a payload can be
+ * summed cheaply. Use ip_checksum_fold() to obtain the final checksum. Each
+ * piece except the last must have an even length.
+ *
+ * @sum:	Sum so far, 0 to start
+ * @addr:	Address of the data (ideally 32-bit aligned)
+ * @nbytes:	Number of bytes to add
+ * Return: updated sum
+ */
+u64 ip_checksum_partial(u64 sum, const void *addr, unsigned int nbytes);
+
+/**
+ * ip_checksum_fold() - Fold a sum from ip_checksum_partial() into a checksum
+ *
+ * @sum:	Sum to fold
+ * Return: 16-bit IP checksum
+ */
+unsigned int ip_checksum_fold(u64 sum);
+
+/**
+ * ip_checksum_update16() - Update an IP checksum after changing a 16-bit word
+ *
+ * This implements the incremental update from RFC 1624, so that rewriting
+ * a header field does not need the whole header to be summed again. All
+ * values are in the byte order in which they are stored in the packet.
+ *
+ * @sum:	Current checksum
+ * @old:	Previous value of the word
+ * @new:	New value of the word
+ * Return: updated 16-bit IP checksum
+ */
+unsigned int ip_checksum_update16(unsigned int sum, u16 old, u16 new);
+
+/**
+ * ip_checksum_update32() - Update an IP checksum after changing a 32-bit word
+ *
+ * This is the same as ip_checksum_update16() for a 32-bit field, such as an
+ * IPv4 address.
+ *
+ * @sum:	Current checksum
+ * @old:	Previous value of the field
+ * @new:	New value of the field
+ * Return: updated 16-bit IP checksum
+ */
+unsigned int ip_checksum_update32(unsigned int sum, u32 old, u32 new);
+
 /**
  * compute_ip_checksum() - Compute IP checksum
  *
@@ -428,6 +478,75 @@ struct in_addr string_to_ip(const char *s);
 /* copy a filename (allow for "..." notation, limit length) */
 void copy_filename(char *dst, const char *src, int size);
 
+#if CONFIG_IS_ENABLED(NET_DIGEST)
+/**
+ * net_digest_start() - Start hashing a download while it is received
+ *
+ * If the environment variable 'netdigest' is set to "<algo>[:<digest>]",
+ * the following net_digest_update() calls feed the named progressive hash.
+ * This avoids a separate pass over the image once it is loaded.
+ *
+ * Return: 0 if OK or no digest was requested, -EPROTONOSUPPORT for an
+ *	unknown algorithm, -EINVAL for a malformed digest
+ */
+int net_digest_start(void);
+
+/**
+ * net_digest_update() - Hash a block of a download
+ *
+ * Blocks must be passed in as they are stored. Only data which continues the
+ * hash in order is used; anything else is picked up from memory by
+ * net_digest_finish().
+ *
+ * @offset: Offset of the block within the file
+ * @data: Block data
+ * @len: Length of the block in bytes
+ */
+void net_digest_update(ulong offset, const void *data, ulong len);
+
+/**
+ * net_digest_finish() - Complete the hash of a download and check it
+ *
+ * Any part of the file not seen in order by net_digest_update() is hashed
+ * from memory. The result is stored in the environment variable
+ * 'netdigestvalue' as a hex string and compared with the expected digest,
+ * if one was given.
+ *
+ * @addr: Address the file was loaded to
+ * @size: Size of the file in bytes
+ * Return: 0 if OK or no digest was requested, -EILSEQ on a mismatch, other
+ *	-ve value on error
+ */
+int net_digest_finish(ulong addr, ulong size);
+
+/**
+ * net_digest_abort() - Drop the hash of a download which did not complete
+ *
+ * This must be called when a transfer fails or is aborted after
+ * net_digest_start(), so that no state is left for a later download.
+ */
+void net_digest_abort(void);
+#else
+static inline int net_digest_start(void)
+{
+	return 0;
+}
+
+static inline void net_digest_update(ulong offset, const void *data,
+				     ulong len)
+{
+}
+
+static inline int net_digest_finish(ulong addr, ulong size)
+{
+	return 0;
+}
+
+static inline void net_digest_abort(void)
+{
+}
+#endif
+
 /* Processes a received packet */
 void net_process_received_packet(uchar *in_packet, int len);
 
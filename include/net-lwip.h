@@ -16,6 +16,19 @@ void net_lwip_remove_netif(struct netif *netif);
 struct netif *net_lwip_get_netif(void);
 int net_lwip_rx(struct udevice *udev, struct netif *netif);
 
+/**
+ * net_lwip_dns_resolve() - resolve a host name using the 'dnsip'/'dnsip2'
+ *			    name servers
+ *
+ * @udev:	Ethernet device
+ * @netif:	lwIP network interface to use
+ * @name:	Host name, or an IP address which is returned as is
+ * @addr:	Returns the resolved address
+ * Return:	0 if OK, -ENOENT if the host was not found, other -ve on error
+ */
+int net_lwip_dns_resolve(struct udevice *udev, struct netif *netif,
+			 const char *name, ip_addr_t *addr);
+
 /**
  * wget_with_dns() - runs dns host IP address resulution before wget
  *
@@ -279,6 +279,7 @@ enum tcp_state {
 
 enum tcp_state tcp_get_tcp_state(void);
 void tcp_set_tcp_state(enum tcp_state new_state);
+void tcp_set_rx_window(u32 size);
 int tcp_set_tcp_header(uchar *pkt, int dport, int sport, int payload_len,
 		       u8 action, u32 tcp_seq_num, u32 tcp_ack_num);
 
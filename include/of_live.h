@@ -9,8 +9,9 @@
 #ifndef _OF_LIVE_H
 #define _OF_LIVE_H
 
+#include <dm/of.h>
+
 struct abuf;
-struct device_node;
 
 /**
  * of_live_build() - build a live (hierarchical) tree from a flat DT
@@ -37,6 +38,49 @@ int of_live_build(const void *fdt_blob, struct device_node **rootp);
  */
 int unflatten_device_tree(const void *blob, struct device_node **mynodes);
 
+/**
+ * of_live_index_phandle() - Look up a phandle in the index of a tree
+ *
+ * A tree created by unflatten_device_tree() has an index of its phandles, so
+ * long as they are reasonably dense
+ *
+ * @root: Root node of the tree
+ * @handle: Phandle to find
+ * @npp: Returns the node, if found
+ * Return: 0 if found, -ENOENT if there is no such phandle in the tree, -ENOSYS
+ *	if the tree has no phandle index, in which case it must be searched
+ */
+int of_live_index_phandle(const struct device_node *root, phandle handle,
+			  struct device_node **npp);
+
+/**
+ * of_live_index_path() - Look up a path in the index of a tree
+ *
+ * @root: Root node of the tree
+ * @path: Full path of the node, e.g. "/bus@1/spi@1100"
+ * @len: Length of @path, not including any terminator
+ * @npp: Returns the node, if found
+ * Return: 0 if found, -ENOENT if there is no such node in the tree, -ENOSYS
+ *	if the tree has no index or nodes have been added since it was created,
+ *	in which case it must be searched
+ */
+int of_live_index_path(const struct device_node *root, const char *path,
+		       int len, struct device_node **npp);
+
+/**
+ * of_live_index_node_added() - Tell the index that a node has been added
+ *
+ * @np: New node, which must already be linked into its tree
+ */
+void of_live_index_node_added(struct device_node *np);
+
+/**
+ * of_live_index_node_removed() - Remove a node and its subnodes from the index
+ *
+ * @np: Node being removed, which must still have its parent pointer
+ */
+void of_live_index_node_removed(struct device_node *np);
+
 /**
  * of_live_free() - Dispose of a livetree
  *
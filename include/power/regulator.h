@@ -137,6 +137,8 @@ enum regulator_flag {
 	REGULATOR_FLAG_AUTOSET_UV	= 1 << 0,
 	REGULATOR_FLAG_AUTOSET_UA	= 1 << 1,
 	REGULATOR_FLAG_AUTOSET_DONE	= 1 << 2,
+	/* Set during autoset if a prior phase left the regulator enabled */
+	REGULATOR_FLAG_HANDOFF_ON	= 1 << 3,
 };
 
 /**
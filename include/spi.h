@@ -566,6 +566,22 @@ struct dm_spi_emul_ops {
 	 */
 	int (*xfer)(struct udevice *slave, unsigned int bitlen,
 		    const void *dout, void *din, unsigned long flags);
+
+	/**
+	 * map_read() - Read through a memory-mapped window (optional)
+	 *
+	 * This emulates a controller which maps the device into the CPU
+	 * address space, so that data is read without a command being sent
+	 * for each transfer.
+	 *
+	 * @emul:	The emulation device
+	 * @offset:	Byte offset within the device to read from
+	 * @len:	Number of bytes to read
+	 * @buf:	Buffer to hold the data
+	 * Returns: number of bytes read, or -ve on error
+	 */
+	ssize_t (*map_read)(struct udevice *emul, ulong offset, size_t len,
+			    void *buf);
 };
 
 /**
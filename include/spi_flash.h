@@ -236,4 +236,85 @@ static inline int spi_flash_protect(struct spi_flash *flash, u32 ofs, u32 len,
 		return flash->flash_unlock(flash, ofs, len);
 }
 
+/**
+ * struct spi_flash_tune - Read setting found by tuning
+ *
+ * @hwcap: Read capability used (SNOR_HWCAPS_READ...)
+ * @hz: Bus speed in Hz
+ * @rate: Read rate measured with this setting, in bytes per second
+ * @offset: Offset of the region used to check the setting
+ * @len: Length of that region in bytes
+ * @crc: CRC32 of the data in that region
+ */
+struct spi_flash_tune {
+	u32 hwcap;
+	uint hz;
+	ulong rate;
+	u32 offset;
+	u32 len;
+	u32 crc;
+};
+
+/**
+ * spi_flash_tune() - Find the fastest read setting which works
+ *
+ * This reads a region of the flash at a safe setting, then tries each read
+ * protocol supported by both the flash and the controller at several bus
+ * speeds up to @max_hz, checking that the same data is read. The setting with
+ * the highest data rate is selected. The region should hold varied data, not
+ * erased flash.
+ *
+ * @flash: SPI flash to tune
+ * @offset: Offset of the region to check against
+ * @len: Length of the region in bytes
+ * @max_hz: Highest bus speed to try, or 0 to use the current maximum
+ * @tune: Returns the setting selected
+ * Return: 0 if OK, -EINVAL if the region is invalid or blank, -EIO if no
+ *	setting reads the region correctly, -ENOMEM if out of memory
+ */
+int spi_flash_tune(struct spi_flash *flash, u32 offset, u32 len, uint max_hz,
+		   struct spi_flash_tune *tune);
+
+/**
+ * spi_flash_tune_save() - Record a read setting in the environment
+ *
+ * The setting is stored in the sf_tune_<jedec-id> variable, for use by
+ * spi_flash_tune_apply(). The environment must be saved for it to be used on
+ * later boots.
+ *
+ * @flash: SPI flash which was tuned
+ * @tune: Setting to record
+ * Return: 0 if OK, -ve on error
+ */
+int spi_flash_tune_save(struct spi_flash *flash,
+			const struct spi_flash_tune *tune);
+
+/**
+ * spi_flash_tune_name() - Get the name of a read capability
+ *
+ * @hwcap: Read capability (SNOR_HWCAPS_READ...)
+ * Return: name, e.g. "1-4-4", or "?" if not known
+ */
+const char *spi_flash_tune_name(u32 hwcap);
+
+#if CONFIG_IS_ENABLED(SPI_FLASH_TUNE)
+/**
+ * spi_flash_tune_apply() - Use the read setting recorded for a flash
+ *
+ * This is called when the flash is probed. The setting is checked against
+ * the region it was found with and is ignored if that region does not read
+ * back correctly.
+ *
+ * @flash: SPI flash to set up
+ * Return: 0 if OK, -ENOENT if no setting is recorded, -EINVAL if it is
+ *	invalid, -EIO if it does not work
+ */
+int spi_flash_tune_apply(struct spi_flash *flash);
+#else
+static inline int spi_flash_tune_apply(struct spi_flash *flash)
+{
+	return -ENOSYS;
+}
+#endif
+
 #endif /* _SPI_FLASH_H_ */
@@ -263,6 +263,30 @@ int usb_host_eth_scan(int mode);
  */
 int usb_init(void);
 
+/**
+ * usb_init_start() - Start up the USB controllers without scanning the buses
+ *
+ * This probes the controllers, sets up each root hub and powers up its
+ * ports, so that the devices have time to settle and connect before
+ * usb_init() scans the ports. Calling this is optional, since usb_init()
+ * probes any controller which is not yet active.
+ *
+ * This is only available with CONFIG_DM_USB
+ *
+ * Returns: 0 if OK, -ve on error
+ */
+int usb_init_start(void);
+
+/**
+ * usb_init_stop() - Remove controllers started by usb_init_start()
+ *
+ * This removes any controller which usb_init_start() probed and usb_init()
+ * has not used since, so that it is not left powered up
+ *
+ * Returns: 0 if OK, -ve on error
+ */
+int usb_init_stop(void);
+
 int usb_stop(void); /* stop the USB Controller */
 int usb_detect_change(void); /* detect if a USB device has been (un)plugged */
 
@@ -658,11 +682,17 @@ struct usb_dev_plat {
  *		so this will be false.
  * @companion:  True if this is a companion controller to another USB
  *		controller
+ * @early:	True if probed by usb_init_start() and not yet used by
+ *		usb_init()
+ * @rh_powered:	True if usb_init_start() has powered up the ports of the root
+ *		hub, which usb_init() has not scanned yet
  */
 struct usb_bus_priv {
 	int next_addr;
 	bool desc_before_addr;
 	bool companion;
+	bool early;
+	bool rh_powered;
 };
 
 /**
@@ -843,6 +873,18 @@ bool usb_hub_is_root_hub(struct udevice *hub);
  */
 int usb_hub_scan(struct udevice *hub);
 
+/**
+ * usb_hub_scan_powered() - Find the devices of a hub which is powered up
+ *
+ * This completes the scan of a root hub whose ports usb_init_start() has
+ * powered up. The power-up and connect timeouts run from that time, so
+ * there is no further wait if they have passed.
+ *
+ * @hub:	Hub device to scan
+ * Return: 0 if OK, -ve on error
+ */
+int usb_hub_scan_powered(struct udevice *hub);
+
 /**
  * usb_scan_device() - Scan a device on a bus
  *
@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Region allocator for short-lived allocations
+ */
+
+#include <arena.h>
+#include <malloc.h>
+#include <string.h>
+#include <linux/kernel.h>
+
+/* Alignment of each allocation, as for malloc() */
+#define ARENA_ALIGN	(2 * sizeof(size_t))
+
+/**
+ * struct arena_block - Block of memory obtained from malloc()
+ *
+ * @next: Next block, NULL if none
+ * @size: Size of the data area, which follows this header
+ */
+struct arena_block {
+	struct arena_block *next;
+	size_t size;
+};
+
+#define ARENA_HDR_SIZE	ALIGN(sizeof(struct arena_block), ARENA_ALIGN)
+
+static char *arena_block_data(struct arena_block *blk)
+{
+	return (char *)blk + ARENA_HDR_SIZE;
+}
+
+void arena_init(struct arena *arena, uint block_size)
+{
+	arena->blocks = NULL;
+	arena->ptr = NULL;
+	arena->end = NULL;
+	arena->block_size = ALIGN(block_size ?: ARENA_DEFAULT_BLOCK_SIZE,
+				  ARENA_ALIGN);
+}
+
+static void arena_free_blocks(struct arena_block *blk)
+{
+	struct arena_block *next;
+
+	for (; blk; blk = next) {
+		next = blk->next;
+		free(blk);
+	}
+}
+
+void arena_uninit(struct arena *arena)
+{
+	arena_free_blocks(arena->blocks);
+	arena->blocks = NULL;
+	arena->ptr = NULL;
+	arena->end = NULL;
+}
+
+void arena_reset(struct arena *arena)
+{
+	struct arena_block *blk, **prevp;
+
+	/* keep one standard-sized block, preferring the current one */
+	for (prevp = &arena->blocks; (blk = *prevp); prevp = &blk->next) {
+		if (blk->size == arena->block_size)
+			break;
+	}
+	if (blk) {
+		*prevp = blk->next;
+		blk->next = NULL;
+	}
+	arena_free_blocks(arena->blocks);
+	arena->blocks = blk;
+
+	if (blk) {
+		arena->ptr = arena_block_data(blk);
+		arena->end = arena->ptr + blk->size;
+	} else {
+		arena->ptr = NULL;
+		arena->end = NULL;
+	}
+}
+
+void *arena_alloc(struct arena *arena, size_t size)
+{
+	struct arena_block *blk;
+	char *ptr;
+
+	if (size > SIZE_MAX - ARENA_HDR_SIZE - ARENA_ALIGN)
+		return NULL;
+	size = ALIGN(size, ARENA_ALIGN);
+	if (arena->ptr && size <= arena->end - arena->ptr) {
+		ptr = arena->ptr;
+		arena->ptr += size;
+		return ptr;
+	}
+
+	/*
+	 * A large allocation gets a block of its own. This goes after the
+	 * current block, so that the space left in that is not wasted.
+	 */
+	if (size > arena->block_size / 4) {
+		blk = malloc(ARENA_HDR_SIZE + size);
+		if (!blk)
+			return NULL;
+		blk->size = size;
+		if (arena->ptr) {
+			blk->next = arena->blocks->next;
+			arena->blocks->next = blk;
+		} else {
+			blk->next = arena->blocks;
+			arena->blocks = blk;
+		}
+
+		return arena_block_data(blk);
+	}
+
+	blk = malloc(ARENA_HDR_SIZE + arena->block_size);
+	if (!blk)
+		return NULL;
+	blk->size = arena->block_size;
+	blk->next = arena->blocks;
+	arena->blocks = blk;
+	ptr = arena_block_data(blk);
+	arena->ptr = ptr + size;
+	arena->end = ptr + blk->size;
+
+	return ptr;
+}
+
+void *arena_zalloc(struct arena *arena, size_t size)
+{
+	void *ptr;
+
+	ptr = arena_alloc(arena, size);
+	if (ptr)
+		memset(ptr, '\0', size);
+
+	return ptr;
+}
+
+char *arena_strndup(struct arena *arena, const char *str, size_t len)
+{
+	char *ptr;
+
+	len = strnlen(str, len);
+	ptr = arena_alloc(arena, len + 1);
+	if (!ptr)
+		return NULL;
+	memcpy(ptr, str, len);
+	ptr[len] = '\0';
+
+	return ptr;
+}
+
+char *arena_strdup(struct arena *arena, const char *str)
+{
+	return arena_strndup(arena, str, SIZE_MAX);
+}
+
+size_t arena_size(const struct arena *arena)
+{
+	struct arena_block *blk;
+	size_t size = 0;
+
+	for (blk = arena->blocks; blk; blk = blk->next)
+		size += ARENA_HDR_SIZE + blk->size;
+
+	return size;
+}
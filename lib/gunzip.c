@@ -8,6 +8,7 @@
 #include <command.h>
 #include <console.h>
 #include <div64.h>
+#include <errno.h>
 #include <gzip.h>
 #include <image.h>
 #include <malloc.h>
@@ -307,3 +308,81 @@ int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 
 	return err;
 }
+
+int gunzip_stream_start(struct gunzip_stream *gs, void *dst, ulong dstlen)
+{
+	z_stream *s;
+	int r;
+
+	memset(gs, '\0', sizeof(*gs));
+	s = calloc(1, sizeof(*s));
+	if (!s)
+		return -ENOMEM;
+	gs->zs = s;
+
+	s->zalloc = gzalloc;
+	s->zfree = gzfree;
+	r = inflateInit2(s, -MAX_WBITS);
+	if (r != Z_OK) {
+		printf("Error: inflateInit2() returned %d\n", r);
+		free(s);
+		gs->zs = NULL;
+		return -EIO;
+	}
+	s->next_out = dst;
+	s->avail_out = dstlen;
+
+	return 0;
+}
+
+int gunzip_stream_feed(struct gunzip_stream *gs, const void *src, ulong len)
+{
+	z_stream *s = gs->zs;
+	int offset, r;
+
+	if (!s)
+		return -EIO;
+	if (gs->done)
+		return 0;
+	if (!gs->started) {
+		offset = gzip_parse_header(src, len);
+		if (offset < 0)
+			return -EINVAL;
+		src += offset;
+		len -= offset;
+		gs->started = true;
+	}
+
+	s->next_in = (unsigned char *)src;
+	s->avail_in = len;
+	r = inflate(s, Z_NO_FLUSH);
+	schedule();
+	if (r == Z_STREAM_END) {
+		gs->done = true;
+		return 0;
+	}
+	if (r != Z_OK && r != Z_BUF_ERROR) {
+		printf("Error: inflate() returned %d\n", r);
+		return -EIO;
+	}
+
+	/* inflate() only leaves input behind if it runs out of space */
+	if (s->avail_in)
+		return -ENOSPC;
+
+	return 0;
+}
+
+int gunzip_stream_finish(struct gunzip_stream *gs, ulong *lenp)
+{
+	z_stream *s = gs->zs;
+
+	if (!s)
+		return -EIO;
+	*lenp = s->total_out;
+	inflateEnd(s);
+	free(s);
+	gs->zs = NULL;
+
+	return gs->done ? 0 : -EIO;
+}
@@ -3,11 +3,16 @@
  * Copyright (c) 2013 The Chromium OS Authors.
  */
 
+#include <bootstage.h>
 #include <efi.h>
 #include <initcall.h>
 #include <log.h>
+#include <malloc.h>
 #include <relocate.h>
+#include <time.h>
+#include <vsprintf.h>
 #include <asm/global_data.h>
+#include <linux/string.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -42,6 +47,70 @@ static int initcall_is_event(init_fnc_t func)
 	return 0;
 }
 
+#ifdef CONFIG_BOOTSTAGE_INITCALL
+/**
+ * initcall_record() - Record the time taken by an initcall in bootstage
+ *
+ * Only initcalls which take at least CONFIG_BOOTSTAGE_INITCALL_MIN_US are
+ * recorded, to avoid filling up the bootstage table
+ *
+ * @func: Initcall
+ * @type: Event number, if @func is an event, else 0
+ * @reloc_ofs: Relocation offset
+ * @start_us: Time when the initcall started
+ */
+static void initcall_record(init_fnc_t func, enum event_t type,
+			    ulong reloc_ofs, ulong start_us)
+{
+	ulong time_us = timer_get_boot_us() - start_us;
+	const char *name;
+	char buf[40];
+
+	if (time_us < CONFIG_BOOTSTAGE_INITCALL_MIN_US)
+		return;
+
+	/* use the unrelocated address, so it can be found in u-boot.map */
+	if (type)
+		snprintf(buf, sizeof(buf), "event %s", event_type_name(type));
+	else
+		snprintf(buf, sizeof(buf), "initcall %p",
+			 (char *)func - reloc_ofs);
+	name = strdup(buf);
+	if (name)
+		bootstage_add_duration(name, start_us, time_us);
+}
+#else
+static void initcall_record(init_fnc_t func, enum event_t type,
+			    ulong reloc_ofs, ulong start_us)
+{
+}
+#endif
+
+/**
+ * initcall_run() - Run a single initcall
+ *
+ * @func: Initcall to run
+ * @type: Event number, if @func is an event, else 0
+ * @reloc_ofs: Relocation offset
+ * Return: 0 if OK, -ve on error
+ */
+static int initcall_run(init_fnc_t func, enum event_t type, ulong reloc_ofs)
+{
+	ulong start_us = 0;
+	int ret;
+
+	/* bootstage needs a timer, which is ready once bootstage is */
+	if (IS_ENABLED(CONFIG_BOOTSTAGE_INITCALL) && gd_bootstage())
+		start_us = timer_get_boot_us();
+
+	ret = type ? event_notify_null(type) : func();
+
+	if (start_us)
+		initcall_record(func, type, reloc_ofs, start_us);
+
+	return ret;
+}
+
 /*
  * To enable debugging. add #define DEBUG at the top of the including file.
  *
@@ -71,7 +140,7 @@ int initcall_run_list(const init_fnc_t init_sequence[])
 			debug("initcall: %p\n", (char *)func - reloc_ofs);
 		}
 
-		ret = type ? event_notify_null(type) : func();
+		ret = initcall_run(func, type, reloc_ofs);
 		if (ret)
 			break;
 	}
@@ -100,3 +169,63 @@ int initcall_run_list(const init_fnc_t init_sequence[])
 
 	return 0;
 }
+
+#if CONFIG_IS_ENABLED(INITCALL_GROUPS)
+static struct initcall_group initcall_late_group;
+
+bool initcall_group_step(struct initcall_group *grp)
+{
+	ulong reloc_ofs = calc_reloc_ofs();
+	init_fnc_t func;
+	int ret;
+
+	if (grp->ret || grp->next >= grp->count)
+		return false;
+	func = grp->calls[grp->next++];
+	debug("initcall: group %p\n", (char *)func - reloc_ofs);
+	ret = initcall_run(func, 0, reloc_ofs);
+	if (ret) {
+		printf("initcall failed at group call %p (err=%dE)\n",
+		       (char *)func - reloc_ofs, ret);
+		grp->ret = ret;
+	}
+
+	return true;
+}
+
+void initcall_group_start(struct initcall_group *grp, const init_fnc_t *calls,
+			  int count)
+{
+	grp->calls = calls;
+	grp->count = count;
+	grp->next = 0;
+	grp->ret = 0;
+}
+
+int initcall_group_finish(struct initcall_group *grp)
+{
+	while (initcall_group_step(grp))
+		;
+
+	return grp->ret;
+}
+
+int initcall_late_start(void)
+{
+	initcall_group_start(&initcall_late_group,
+			     ll_entry_start(init_fnc_t, initcall_late),
+			     ll_entry_count(init_fnc_t, initcall_late));
+
+	return 0;
+}
+
+bool initcall_late_idle(void)
+{
+	return initcall_group_step(&initcall_late_group);
+}
+
+int initcall_late_finish(void)
+{
+	return initcall_group_finish(&initcall_late_group);
+}
+#endif
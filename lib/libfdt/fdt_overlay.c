@@ -1,2 +1,444 @@
 #include <linux/libfdt_env.h>
 #include "../../scripts/dtc/libfdt/fdt_overlay.c"
+
+/*
+ * U-Boot additions: applying a series of overlays with a shared index
+ *
+ * The index maps each label in the base tree's __symbols__ node to its path,
+ * with the phandle filled in on first use. Paths and phandles are not changed
+ * by applying an overlay, except where the overlay says so, so the index can
+ * be kept across overlays and across fdt_open_into() / fdt_pack() calls. It
+ * is only a cache: anything missing from it is looked up the usual way.
+ */
+#include <linux/libfdt.h>
+#include <malloc.h>
+#include <sort.h>
+
+/**
+ * struct fdt_overlay_sym - Index entry for a symbol
+ *
+ * @label: Symbol name
+ * @path: Path of the node in the base tree (allocated with @label), or NULL
+ *	if it could not be updated, in which case the tree is used instead
+ * @phandle: Phandle of the node, or 0 if not looked up yet
+ */
+struct fdt_overlay_sym {
+	char *label;
+	const char *path;
+	uint32_t phandle;
+};
+
+static int batch_sym_cmp(const void *va, const void *vb)
+{
+	const struct fdt_overlay_sym *a = va, *b = vb;
+
+	return strcmp(a->label, b->label);
+}
+
+/* Find a symbol in the first @count entries of the index, which are sorted */
+static struct fdt_overlay_sym *batch_find_sym(struct fdt_overlay_batch *batch,
+					      const char *label, int count)
+{
+	int lo = 0, hi = count;
+
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		int cmp = strcmp(label, batch->syms[mid].label);
+
+		if (!cmp)
+			return &batch->syms[mid];
+		if (cmp > 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return NULL;
+}
+
+/* Set up a symbol, allocating its label and path */
+static int batch_set_sym(struct fdt_overlay_sym *sym, const char *label,
+			 const char *path)
+{
+	int label_len = strlen(label) + 1;
+	char *buf;
+
+	buf = malloc(label_len + strlen(path) + 1);
+	if (!buf)
+		return -FDT_ERR_NOSPACE;
+	memcpy(buf, label, label_len);
+	strcpy(buf + label_len, path);
+
+	free(sym->label);
+	sym->label = buf;
+	sym->path = buf + label_len;
+	sym->phandle = 0;
+
+	return 0;
+}
+
+/* Add a symbol to the end of the index, which must be sorted afterwards */
+static int batch_add_sym(struct fdt_overlay_batch *batch, const char *label,
+			 const char *path)
+{
+	struct fdt_overlay_sym *sym;
+	int ret;
+
+	if (batch->count == batch->alloc) {
+		int alloc = batch->alloc ? batch->alloc * 2 : 64;
+
+		sym = realloc(batch->syms, alloc * sizeof(*sym));
+		if (!sym)
+			return -FDT_ERR_NOSPACE;
+		batch->syms = sym;
+		batch->alloc = alloc;
+	}
+
+	sym = &batch->syms[batch->count];
+	sym->label = NULL;
+	ret = batch_set_sym(sym, label, path);
+	if (ret)
+		return ret;
+	batch->count++;
+
+	return 0;
+}
+
+/* Look up the phandle for a label, using the index where possible */
+static int batch_get_phandle(struct fdt_overlay_batch *batch, const void *fdt,
+			     const char *label, uint32_t *phandlep)
+{
+	struct fdt_overlay_sym *sym;
+	const char *path;
+	uint32_t phandle;
+	int node, len;
+
+	sym = batch_find_sym(batch, label, batch->count);
+	if (sym && !sym->path)
+		sym = NULL;
+	if (sym && sym->phandle) {
+		*phandlep = sym->phandle;
+		return 0;
+	}
+
+	if (sym) {
+		path = sym->path;
+	} else {
+		node = fdt_path_offset(fdt, "/__symbols__");
+		if (node < 0)
+			return node;
+		path = fdt_getprop(fdt, node, label, &len);
+		if (!path)
+			return len;
+	}
+
+	node = fdt_path_offset(fdt, path);
+	if (node < 0)
+		return node;
+	phandle = fdt_get_phandle(fdt, node);
+	if (!phandle)
+		return -FDT_ERR_NOTFOUND;
+	if (sym)
+		sym->phandle = phandle;
+	*phandlep = phandle;
+
+	return 0;
+}
+
+/*
+ * As overlay_fixup_phandle() but with the symbol looked up just once, since
+ * the property holds all the fixups for a label
+ */
+static int batch_fixup_phandle(struct fdt_overlay_batch *batch, void *fdt,
+			       void *fdto, int property)
+{
+	const char *value, *label;
+	fdt32_t phandle_prop;
+	uint32_t phandle;
+	int len, ret;
+
+	value = fdt_getprop_by_offset(fdto, property, &label, &len);
+	if (!value) {
+		if (len == -FDT_ERR_NOTFOUND)
+			return -FDT_ERR_INTERNAL;
+
+		return len;
+	}
+
+	ret = batch_get_phandle(batch, fdt, label, &phandle);
+	if (ret)
+		return ret;
+	phandle_prop = cpu_to_fdt32(phandle);
+
+	do {
+		const char *path, *name, *fixup_end;
+		const char *fixup_str = value;
+		uint32_t path_len, name_len;
+		uint32_t fixup_len;
+		char *sep, *endptr;
+		int poffset, fixup_off;
+
+		fixup_end = memchr(value, '\0', len);
+		if (!fixup_end)
+			return -FDT_ERR_BADOVERLAY;
+		fixup_len = fixup_end - fixup_str;
+
+		len -= fixup_len + 1;
+		value += fixup_len + 1;
+
+		path = fixup_str;
+		sep = memchr(fixup_str, ':', fixup_len);
+		if (!sep)
+			return -FDT_ERR_BADOVERLAY;
+
+		path_len = sep - path;
+		if (path_len == (fixup_len - 1))
+			return -FDT_ERR_BADOVERLAY;
+
+		fixup_len -= path_len + 1;
+		name = sep + 1;
+		sep = memchr(name, ':', fixup_len);
+		if (!sep)
+			return -FDT_ERR_BADOVERLAY;
+
+		name_len = sep - name;
+		if (!name_len)
+			return -FDT_ERR_BADOVERLAY;
+
+		poffset = strtoul(sep + 1, &endptr, 10);
+		if ((*endptr != '\0') || (endptr <= (sep + 1)))
+			return -FDT_ERR_BADOVERLAY;
+
+		fixup_off = fdt_path_offset_namelen(fdto, path, path_len);
+		if (fixup_off == -FDT_ERR_NOTFOUND)
+			return -FDT_ERR_BADOVERLAY;
+		if (fixup_off < 0)
+			return fixup_off;
+
+		ret = fdt_setprop_inplace_namelen_partial(fdto, fixup_off,
+							  name, name_len,
+							  poffset,
+							  &phandle_prop,
+							  sizeof(phandle_prop));
+		if (ret)
+			return ret;
+	} while (len > 0);
+
+	return 0;
+}
+
+static int batch_fixup_phandles(struct fdt_overlay_batch *batch, void *fdt,
+				void *fdto)
+{
+	int fixups_off, property, ret;
+
+	fixups_off = fdt_path_offset(fdto, "/__fixups__");
+	if (fixups_off == -FDT_ERR_NOTFOUND)
+		return 0;
+	if (fixups_off < 0)
+		return fixups_off;
+
+	fdt_for_each_property_offset(property, fdto, fixups_off) {
+		ret = batch_fixup_phandle(batch, fdt, fdto, property);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/*
+ * As overlay_get_target() but using the index to avoid scanning the whole
+ * tree for a target given by phandle
+ */
+static int batch_get_target(struct fdt_overlay_batch *batch, const void *fdt,
+			    const void *fdto, int fragment)
+{
+	uint32_t phandle;
+	int i, node;
+
+	phandle = overlay_get_target_phandle(fdto, fragment);
+	for (i = 0; phandle && phandle != (uint32_t)-1 && i < batch->count;
+	     i++) {
+		if (batch->syms[i].phandle != phandle)
+			continue;
+		node = fdt_path_offset(fdt, batch->syms[i].path);
+		if (node >= 0 && fdt_get_phandle(fdt, node) == phandle)
+			return node;
+	}
+
+	return overlay_get_target(fdt, fdto, fragment, NULL);
+}
+
+/* As overlay_merge() but using batch_get_target() */
+static int batch_merge(struct fdt_overlay_batch *batch, void *fdt, void *fdto)
+{
+	int fragment;
+
+	fdt_for_each_subnode(fragment, fdto, 0) {
+		int overlay;
+		int target;
+		int ret;
+
+		overlay = fdt_subnode_offset(fdto, fragment, "__overlay__");
+		if (overlay == -FDT_ERR_NOTFOUND)
+			continue;
+
+		if (overlay < 0)
+			return overlay;
+
+		target = batch_get_target(batch, fdt, fdto, fragment);
+		if (target < 0)
+			return target;
+
+		ret = overlay_apply_node(fdt, target, fdto, overlay);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/*
+ * Bring the index up to date with the symbols added by an overlay. Failing to
+ * add a symbol is not fatal since it is then looked up in the tree.
+ */
+static void batch_update_syms(struct fdt_overlay_batch *batch,
+			      const void *fdt, const void *fdto)
+{
+	int ov_sym, root_sym, prop, sorted = batch->count;
+	struct fdt_overlay_sym *sym;
+	const char *label, *path;
+
+	ov_sym = fdt_subnode_offset(fdto, 0, "__symbols__");
+	root_sym = fdt_subnode_offset(fdt, 0, "__symbols__");
+	if (ov_sym < 0 || root_sym < 0)
+		return;
+
+	fdt_for_each_property_offset(prop, fdto, ov_sym) {
+		if (!fdt_getprop_by_offset(fdto, prop, &label, NULL))
+			continue;
+		path = fdt_getprop(fdt, root_sym, label, NULL);
+		if (!path)
+			continue;
+		sym = batch_find_sym(batch, label, sorted);
+		if (sym && batch_set_sym(sym, label, path)) {
+			sym->path = NULL;
+			sym->phandle = 0;
+		} else if (!sym) {
+			batch_add_sym(batch, label, path);
+		}
+	}
+	if (batch->count != sorted)
+		qsort(batch->syms, batch->count, sizeof(*batch->syms),
+		      batch_sym_cmp);
+}
+
+int fdt_overlay_batch_init(struct fdt_overlay_batch *batch, const void *fdt)
+{
+	const char *label, *path;
+	int symbols, prop, ret;
+
+	memset(batch, '\0', sizeof(*batch));
+	FDT_RO_PROBE(fdt);
+
+	ret = fdt_find_max_phandle(fdt, &batch->max_phandle);
+	if (ret)
+		return ret;
+
+	symbols = fdt_subnode_offset(fdt, 0, "__symbols__");
+	if (symbols == -FDT_ERR_NOTFOUND)
+		return 0;
+	if (symbols < 0)
+		return symbols;
+
+	fdt_for_each_property_offset(prop, fdt, symbols) {
+		path = fdt_getprop_by_offset(fdt, prop, &label, NULL);
+		if (!path)
+			continue;
+		ret = batch_add_sym(batch, label, path);
+		if (ret) {
+			fdt_overlay_batch_uninit(batch);
+			return ret;
+		}
+	}
+	qsort(batch->syms, batch->count, sizeof(*batch->syms), batch_sym_cmp);
+
+	return 0;
+}
+
+int fdt_overlay_batch_apply(struct fdt_overlay_batch *batch, void *fdt,
+			    void *fdto)
+{
+	uint32_t delta = batch->max_phandle, max_phandle;
+	int i, ret;
+
+	FDT_RO_PROBE(fdt);
+	FDT_RO_PROBE(fdto);
+
+	ret = overlay_adjust_local_phandles(fdto, delta);
+	if (ret)
+		goto err;
+
+	ret = overlay_update_local_references(fdto, delta);
+	if (ret)
+		goto err;
+
+	ret = fdt_find_max_phandle(fdto, &max_phandle);
+	if (ret)
+		goto err;
+
+	ret = batch_fixup_phandles(batch, fdt, fdto);
+	if (ret)
+		goto err;
+
+	ret = batch_merge(batch, fdt, fdto);
+	if (ret)
+		goto err;
+
+	ret = overlay_symbol_update(fdt, fdto);
+	if (ret)
+		goto err;
+
+	/*
+	 * The overlay may have given a new phandle to an existing node, so
+	 * look up the phandles again if it has any
+	 */
+	if (max_phandle > delta) {
+		for (i = 0; i < batch->count; i++)
+			batch->syms[i].phandle = 0;
+		batch->max_phandle = max_phandle;
+	}
+	batch_update_syms(batch, fdt, fdto);
+
+	/*
+	 * The overlay has been damaged, erase its magic.
+	 */
+	fdt_set_magic(fdto, ~0);
+
+	return 0;
+
+err:
+	/*
+	 * The overlay might have been damaged, erase its magic.
+	 */
+	fdt_set_magic(fdto, ~0);
+
+	/*
+	 * The base device tree might have been damaged, erase its
+	 * magic.
+	 */
+	fdt_set_magic(fdt, ~0);
+
+	return ret;
+}
+
+void fdt_overlay_batch_uninit(struct fdt_overlay_batch *batch)
+{
+	int i;
+
+	for (i = 0; i < batch->count; i++)
+		free(batch->syms[i].label);
+	free(batch->syms);
+	memset(batch, '\0', sizeof(*batch));
+}
@@ -14,6 +14,7 @@
 #include <lmb.h>
 #include <log.h>
 #include <malloc.h>
+#include <sort.h>
 #include <spl.h>
 
 #include <asm/global_data.h>
@@ -53,8 +54,8 @@ static long lmb_addrs_adjacent(phys_addr_t base1, phys_size_t size1,
 	return 0;
 }
 
-static long lmb_regions_overlap(struct alist *lmb_rgn_lst, unsigned long r1,
-				unsigned long r2)
+static long lmb_regions_adjacent(struct alist *lmb_rgn_lst, unsigned long r1,
+				 unsigned long r2)
 {
 	struct lmb_region *rgn = lmb_rgn_lst->data;
 
@@ -62,33 +63,51 @@ static long lmb_regions_overlap(struct alist *lmb_rgn_lst, unsigned long r1,
 	phys_size_t size1 = rgn[r1].size;
 	phys_addr_t base2 = rgn[r2].base;
 	phys_size_t size2 = rgn[r2].size;
-
-	return lmb_addrs_overlap(base1, size1, base2, size2);
+	return lmb_addrs_adjacent(base1, size1, base2, size2);
 }
 
-static long lmb_regions_adjacent(struct alist *lmb_rgn_lst, unsigned long r1,
-				 unsigned long r2)
+/**
+ * lmb_find_region() - Find the first region which does not end before an address
+ * @lmb_rgn_lst: LMB list to search
+ * @addr: Address to look for
+ *
+ * The regions in a list are sorted and do not overlap, so their end addresses
+ * are in order too and can be searched by bisection.
+ *
+ * Return: index of the first region which ends at or after @addr, or the
+ * number of regions if there is none
+ */
+static unsigned long lmb_find_region(struct alist *lmb_rgn_lst,
+				     phys_addr_t addr)
 {
 	struct lmb_region *rgn = lmb_rgn_lst->data;
+	unsigned long lo = 0, hi = lmb_rgn_lst->count, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (rgn[mid].base + rgn[mid].size - 1 < addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
 
-	phys_addr_t base1 = rgn[r1].base;
-	phys_size_t size1 = rgn[r1].size;
-	phys_addr_t base2 = rgn[r2].base;
-	phys_size_t size2 = rgn[r2].size;
-	return lmb_addrs_adjacent(base1, size1, base2, size2);
+	return lo;
 }
 
-static void lmb_remove_region(struct alist *lmb_rgn_lst, unsigned long r)
+/* Remove @num regions starting at index @r */
+static void lmb_remove_regions(struct alist *lmb_rgn_lst, unsigned long r,
+			       unsigned long num)
 {
-	unsigned long i;
 	struct lmb_region *rgn = lmb_rgn_lst->data;
 
-	for (i = r; i < lmb_rgn_lst->count - 1; i++) {
-		rgn[i].base = rgn[i + 1].base;
-		rgn[i].size = rgn[i + 1].size;
-		rgn[i].flags = rgn[i + 1].flags;
-	}
-	lmb_rgn_lst->count--;
+	memmove(&rgn[r], &rgn[r + num],
+		(lmb_rgn_lst->count - r - num) * sizeof(*rgn));
+	lmb_rgn_lst->count -= num;
+}
+
+static void lmb_remove_region(struct alist *lmb_rgn_lst, unsigned long r)
+{
+	lmb_remove_regions(lmb_rgn_lst, r, 1);
 }
 
 /* Assumption: base addr of region 1 < base addr of region 2 */
@@ -101,25 +120,6 @@ static void lmb_coalesce_regions(struct alist *lmb_rgn_lst, unsigned long r1,
 	lmb_remove_region(lmb_rgn_lst, r2);
 }
 
-/*Assumption : base addr of region 1 < base addr of region 2*/
-static void lmb_fix_over_lap_regions(struct alist *lmb_rgn_lst,
-				     unsigned long r1, unsigned long r2)
-{
-	struct lmb_region *rgn = lmb_rgn_lst->data;
-
-	phys_addr_t base1 = rgn[r1].base;
-	phys_size_t size1 = rgn[r1].size;
-	phys_addr_t base2 = rgn[r2].base;
-	phys_size_t size2 = rgn[r2].size;
-
-	if (base1 + size1 > base2 + size2) {
-		printf("This will not be a case any time\n");
-		return;
-	}
-	rgn[r1].size = base2 + size2 - base1;
-	lmb_remove_region(lmb_rgn_lst, r2);
-}
-
 static long lmb_resize_regions(struct alist *lmb_rgn_lst,
 			       unsigned long idx_start,
 			       phys_addr_t base, phys_size_t size)
@@ -145,6 +145,9 @@ static long lmb_resize_regions(struct alist *lmb_rgn_lst,
 		rgnbase = rgn[idx].base;
 		rgnsize = rgn[idx].size;
 
+		/* The regions are sorted, so none after this can overlap */
+		if (rgnbase > base + size - 1)
+			break;
 		if (lmb_addrs_overlap(base, size, rgnbase,
 				      rgnsize)) {
 			if (rgn[idx].flags != LMB_NONE)
@@ -165,8 +168,7 @@ static long lmb_resize_regions(struct alist *lmb_rgn_lst,
 	rgn[idx_start].size = mergeend - mergebase;
 
 	/* Now remove the merged regions */
-	while (--rgn_cnt)
-		lmb_remove_region(lmb_rgn_lst, idx_start + 1);
+	lmb_remove_regions(lmb_rgn_lst, idx_start + 1, rgn_cnt - 1);
 
 	return 0;
 }
@@ -191,62 +193,54 @@ static long lmb_resize_regions(struct alist *lmb_rgn_lst,
 static long lmb_add_region_flags(struct alist *lmb_rgn_lst, phys_addr_t base,
 				 phys_size_t size, enum lmb_flags flags)
 {
-	unsigned long coalesced = 0;
-	long ret, i;
 	struct lmb_region *rgn = lmb_rgn_lst->data;
+	bool left, right;
+	long ret, i;
 
 	if (alist_err(lmb_rgn_lst))
 		return -1;
 
-	/* First try and coalesce this LMB with another. */
-	for (i = 0; i < lmb_rgn_lst->count; i++) {
-		phys_addr_t rgnbase = rgn[i].base;
-		phys_size_t rgnsize = rgn[i].size;
-		phys_size_t rgnflags = rgn[i].flags;
-
-		ret = lmb_addrs_adjacent(base, size, rgnbase, rgnsize);
-		if (ret > 0) {
-			if (flags != rgnflags)
-				break;
-			rgn[i].base -= size;
-			rgn[i].size += size;
-			coalesced++;
-			break;
-		} else if (ret < 0) {
-			if (flags != rgnflags)
-				break;
-			rgn[i].size += size;
-			coalesced++;
-			break;
-		} else if (lmb_addrs_overlap(base, size, rgnbase, rgnsize)) {
-			if (flags != LMB_NONE)
-				return -EEXIST;
-
-			ret = lmb_resize_regions(lmb_rgn_lst, i, base, size);
-			if (ret < 0)
-				return -1;
-
-			coalesced++;
-			break;
-		}
-	}
+	/* Only the first region not ending before @base can overlap it */
+	i = lmb_find_region(lmb_rgn_lst, base);
+	if (i < lmb_rgn_lst->count &&
+	    lmb_addrs_overlap(base, size, rgn[i].base, rgn[i].size)) {
+		if (flags != LMB_NONE)
+			return -EEXIST;
+
+		ret = lmb_resize_regions(lmb_rgn_lst, i, base, size);
+		if (ret < 0)
+			return -1;
+
+		/* Coalesce the resized region with its neighbours */
+		if (i < lmb_rgn_lst->count - 1 &&
+		    rgn[i].flags == rgn[i + 1].flags &&
+		    lmb_regions_adjacent(lmb_rgn_lst, i, i + 1))
+			lmb_coalesce_regions(lmb_rgn_lst, i, i + 1);
+		if (i > 0 && rgn[i - 1].flags == rgn[i].flags &&
+		    lmb_regions_adjacent(lmb_rgn_lst, i - 1, i))
+			lmb_coalesce_regions(lmb_rgn_lst, i - 1, i);
 
-	if (lmb_rgn_lst->count && i < lmb_rgn_lst->count - 1) {
-		rgn = lmb_rgn_lst->data;
-		if (rgn[i].flags == rgn[i + 1].flags) {
-			if (lmb_regions_adjacent(lmb_rgn_lst, i, i + 1)) {
-				lmb_coalesce_regions(lmb_rgn_lst, i, i + 1);
-				coalesced++;
-			} else if (lmb_regions_overlap(lmb_rgn_lst, i, i + 1)) {
-				/* fix overlapping area */
-				lmb_fix_over_lap_regions(lmb_rgn_lst, i, i + 1);
-				coalesced++;
-			}
-		}
+		return 0;
 	}
 
-	if (coalesced)
+	/* Next try and coalesce this LMB with the regions either side */
+	left = i > 0 && rgn[i - 1].flags == flags &&
+		lmb_addrs_adjacent(base, size, rgn[i - 1].base,
+				   rgn[i - 1].size) < 0;
+	right = i < lmb_rgn_lst->count && rgn[i].flags == flags &&
+		lmb_addrs_adjacent(base, size, rgn[i].base, rgn[i].size) > 0;
+	if (left && right) {
+		rgn[i - 1].size += size;
+		lmb_coalesce_regions(lmb_rgn_lst, i - 1, i);
+		return 0;
+	} else if (left) {
+		rgn[i - 1].size += size;
+		return 0;
+	} else if (right) {
+		rgn[i].base -= size;
+		rgn[i].size += size;
 		return 0;
+	}
 
 	if (alist_full(lmb_rgn_lst) &&
 	    !alist_expand_by(lmb_rgn_lst, lmb_rgn_lst->alloc))
@@ -254,16 +248,11 @@ static long lmb_add_region_flags(struct alist *lmb_rgn_lst, phys_addr_t base,
 	rgn = lmb_rgn_lst->data;
 
 	/* Couldn't coalesce the LMB, so add it to the sorted table. */
-	for (i = lmb_rgn_lst->count; i >= 0; i--) {
-		if (i && base < rgn[i - 1].base) {
-			rgn[i] = rgn[i - 1];
-		} else {
-			rgn[i].base = base;
-			rgn[i].size = size;
-			rgn[i].flags = flags;
-			break;
-		}
-	}
+	memmove(&rgn[i + 1], &rgn[i],
+		(lmb_rgn_lst->count - i) * sizeof(*rgn));
+	rgn[i].base = base;
+	rgn[i].size = size;
+	rgn[i].flags = flags;
 
 	lmb_rgn_lst->count++;
 
@@ -278,20 +267,17 @@ static long _lmb_free(struct alist *lmb_rgn_lst, phys_addr_t base,
 	phys_addr_t end = base + size - 1;
 	int i;
 
-	rgnbegin = rgnend = 0; /* supress gcc warnings */
 	rgn = lmb_rgn_lst->data;
 	/* Find the region where (base, size) belongs to */
-	for (i = 0; i < lmb_rgn_lst->count; i++) {
-		rgnbegin = rgn[i].base;
-		rgnend = rgnbegin + rgn[i].size - 1;
-
-		if ((rgnbegin <= base) && (end <= rgnend))
-			break;
-	}
+	i = lmb_find_region(lmb_rgn_lst, base);
 
 	/* Didn't find the region */
 	if (i == lmb_rgn_lst->count)
 		return -1;
+	rgnbegin = rgn[i].base;
+	rgnend = rgnbegin + rgn[i].size - 1;
+	if (rgnbegin > base || end > rgnend)
+		return -1;
 
 	/* Check to see if we are removing entire region */
 	if ((rgnbegin == base) && (rgnend == end)) {
@@ -327,14 +313,13 @@ static long lmb_overlaps_region(struct alist *lmb_rgn_lst, phys_addr_t base,
 	unsigned long i;
 	struct lmb_region *rgn = lmb_rgn_lst->data;
 
-	for (i = 0; i < lmb_rgn_lst->count; i++) {
-		phys_addr_t rgnbase = rgn[i].base;
-		phys_size_t rgnsize = rgn[i].size;
-		if (lmb_addrs_overlap(base, size, rgnbase, rgnsize))
-			break;
-	}
+	/* Only the first region not ending before @base can overlap it */
+	i = lmb_find_region(lmb_rgn_lst, base);
+	if (i < lmb_rgn_lst->count &&
+	    lmb_addrs_overlap(base, size, rgn[i].base, rgn[i].size))
+		return i;
 
-	return (i < lmb_rgn_lst->count) ? i : -1;
+	return -1;
 }
 
 static phys_addr_t lmb_align_down(phys_addr_t addr, phys_size_t size)
@@ -703,6 +688,164 @@ long lmb_reserve(phys_addr_t base, phys_size_t size)
 	return lmb_reserve_flags(base, size, LMB_NONE);
 }
 
+/**
+ * struct lmb_notify_batch - Memory-map change waiting to be sent to EFI
+ *
+ * @base: Start address of the change
+ * @size: Size of the change, 0 if none is pending
+ * @op: Change to make (MAP_OP_...)
+ */
+struct lmb_notify_batch {
+	phys_addr_t base;
+	phys_size_t size;
+	u8 op;
+};
+
+static int lmb_notify_flush(struct lmb_notify_batch *batch)
+{
+	int ret;
+
+	if (!batch->size)
+		return 0;
+	ret = lmb_map_update_notify(batch->base, batch->size, batch->op,
+				    LMB_NONE);
+	batch->size = 0;
+
+	return ret;
+}
+
+/*
+ * Add a change to a batch, so that a run of changes to adjoining memory is
+ * sent as one call to the EFI memory map
+ */
+static int lmb_notify_add(struct lmb_notify_batch *batch, phys_addr_t base,
+			  phys_size_t size, u8 op, enum lmb_flags flags)
+{
+	phys_addr_t end;
+	int ret;
+
+	if (!lmb_should_notify(flags))
+		return 0;
+
+	if (batch->size && op == batch->op && base >= batch->base &&
+	    base <= batch->base + batch->size) {
+		end = max(batch->base + batch->size, base + size);
+		batch->size = end - batch->base;
+		return 0;
+	}
+	ret = lmb_notify_flush(batch);
+	batch->base = base;
+	batch->size = size;
+	batch->op = op;
+
+	return ret;
+}
+
+static int lmb_region_cmp(const void *a, const void *b)
+{
+	const struct lmb_region *rgn1 = a, *rgn2 = b;
+
+	if (rgn1->base < rgn2->base)
+		return -1;
+
+	return rgn1->base > rgn2->base;
+}
+
+/*
+ * Add a region to the end of a sorted list which has space for it, merging it
+ * with the last region if they overlap or are adjacent and have the same flags
+ */
+static void lmb_append_region(struct alist *lmb_rgn_lst,
+			      const struct lmb_region *new)
+{
+	struct lmb_region *rgn = lmb_rgn_lst->data;
+	struct lmb_region *last;
+	phys_addr_t end;
+
+	if (lmb_rgn_lst->count) {
+		last = &rgn[lmb_rgn_lst->count - 1];
+		if (last->flags == new->flags &&
+		    new->base <= last->base + last->size) {
+			end = max(last->base + last->size,
+				  new->base + new->size);
+			last->size = end - last->base;
+			return;
+		}
+	}
+	rgn[lmb_rgn_lst->count++] = *new;
+}
+
+/*
+ * Check whether a region can be reserved, given the last region added to the
+ * list being built and the existing regions still to be added. As with
+ * lmb_add_region_flags(), regions may only overlap if neither has any flags.
+ */
+static bool lmb_region_fits(struct alist *lmb_rgn_lst,
+			    const struct lmb_region *next, uint num,
+			    const struct lmb_region *new)
+{
+	struct lmb_region *rgn = lmb_rgn_lst->data;
+	struct lmb_region *last;
+	uint i;
+
+	if (lmb_rgn_lst->count) {
+		last = &rgn[lmb_rgn_lst->count - 1];
+		if (lmb_addrs_overlap(new->base, new->size, last->base,
+				      last->size) &&
+		    (new->flags != LMB_NONE || last->flags != LMB_NONE))
+			return false;
+	}
+	for (i = 0; i < num && next[i].base <= new->base + new->size - 1; i++) {
+		if (new->flags != LMB_NONE || next[i].flags != LMB_NONE)
+			return false;
+	}
+
+	return true;
+}
+
+long lmb_reserve_regions(struct lmb_region *rgns, uint count)
+{
+	struct lmb_region *used = lmb.used_mem.data;
+	uint num_used = lmb.used_mem.count;
+	struct lmb_notify_batch batch = {};
+	struct alist merged;
+	long skipped = 0;
+	int ret = 0;
+	uint i, j;
+
+	if (!count)
+		return 0;
+	if (num_used + count > U16_MAX)
+		return -E2BIG;
+	if (alist_err(&lmb.used_mem) ||
+	    !alist_init(&merged, sizeof(struct lmb_region), num_used + count))
+		return -ENOMEM;
+
+	/* Merge the sorted new regions with the existing ones in one pass */
+	qsort(rgns, count, sizeof(*rgns), lmb_region_cmp);
+	for (i = 0, j = 0; i < count; i++) {
+		while (j < num_used && used[j].base <= rgns[i].base)
+			lmb_append_region(&merged, &used[j++]);
+		if (!rgns[i].size ||
+		    !lmb_region_fits(&merged, &used[j], num_used - j,
+				     &rgns[i])) {
+			skipped++;
+			continue;
+		}
+		lmb_append_region(&merged, &rgns[i]);
+		ret = lmb_notify_add(&batch, rgns[i].base, rgns[i].size,
+				     MAP_OP_RESERVE, rgns[i].flags) ?: ret;
+	}
+	while (j < num_used)
+		lmb_append_region(&merged, &used[j++]);
+	ret = lmb_notify_flush(&batch) ?: ret;
+
+	alist_uninit(&lmb.used_mem);
+	lmb.used_mem = merged;
+
+	return ret ?: skipped;
+}
+
 static phys_addr_t _lmb_alloc_base(phys_size_t size, ulong align,
 				    phys_addr_t max_addr, enum lmb_flags flags)
 {
@@ -856,7 +999,7 @@ phys_addr_t lmb_alloc_addr_flags(phys_addr_t base, phys_size_t size,
 /* Return number of bytes from a given address that are free */
 phys_size_t lmb_get_free_size(phys_addr_t addr)
 {
-	int i;
+	unsigned long i;
 	long rgn;
 	struct lmb_region *lmb_used = lmb.used_mem.data;
 	struct lmb_region *lmb_memory = lmb.free_mem.data;
@@ -864,16 +1007,14 @@ phys_size_t lmb_get_free_size(phys_addr_t addr)
 	/* check if the requested address is in the memory regions */
 	rgn = lmb_overlaps_region(&lmb.free_mem, addr, 1);
 	if (rgn >= 0) {
-		for (i = 0; i < lmb.used_mem.count; i++) {
+		i = lmb_find_region(&lmb.used_mem, addr);
+		if (i < lmb.used_mem.count) {
 			if (addr < lmb_used[i].base) {
 				/* first reserved range > requested address */
 				return lmb_used[i].base - addr;
 			}
-			if (lmb_used[i].base +
-			    lmb_used[i].size > addr) {
-				/* requested addr is in this reserved range */
-				return 0;
-			}
+			/* requested addr is in this reserved range */
+			return 0;
 		}
 		/* if we come here: no reserved ranges above requested addr */
 		return lmb_memory[lmb.free_mem.count - 1].base +
@@ -884,15 +1025,13 @@ phys_size_t lmb_get_free_size(phys_addr_t addr)
 
 int lmb_is_reserved_flags(phys_addr_t addr, int flags)
 {
-	int i;
+	unsigned long i;
 	struct lmb_region *lmb_used = lmb.used_mem.data;
 
-	for (i = 0; i < lmb.used_mem.count; i++) {
-		phys_addr_t upper = lmb_used[i].base +
-			lmb_used[i].size - 1;
-		if (addr >= lmb_used[i].base && addr <= upper)
-			return (lmb_used[i].flags & flags) == flags;
-	}
+	i = lmb_find_region(&lmb.used_mem, addr);
+	if (i < lmb.used_mem.count && addr >= lmb_used[i].base)
+		return (lmb_used[i].flags & flags) == flags;
+
 	return 0;
 }
 
@@ -36,31 +36,13 @@
 static void *SzAlloc(void *p, size_t size) { return malloc(size); }
 static void SzFree(void *p, void *address) { free(address); }
 
-int lzmaBuffToBuffDecompress(unsigned char *outStream, SizeT *uncompressedSize,
-			     const unsigned char *inStream, SizeT length)
+/* Read the uncompressed size from the stream header */
+static int lzmaReadSize(const unsigned char *inStream, SizeT *outSizeFull)
 {
-    int res = SZ_ERROR_DATA;
+    SizeT outSize = 0;
+    SizeT outSizeHigh = 0;
     int i;
-    ISzAlloc g_Alloc;
-
-    SizeT outSizeFull = 0xFFFFFFFF; /* 4GBytes limit */
-    SizeT outProcessed;
-    SizeT outSize;
-    SizeT outSizeHigh;
-    ELzmaStatus state;
-    SizeT compressedSize = (SizeT)(length - LZMA_PROPS_SIZE);
-
-    debug ("LZMA: Image address............... 0x%p\n", inStream);
-    debug ("LZMA: Properties address.......... 0x%p\n", inStream + LZMA_PROPERTIES_OFFSET);
-    debug ("LZMA: Uncompressed size address... 0x%p\n", inStream + LZMA_SIZE_OFFSET);
-    debug ("LZMA: Compressed data address..... 0x%p\n", inStream + LZMA_DATA_OFFSET);
-    debug ("LZMA: Destination address......... 0x%p\n", outStream);
 
-    memset(&state, 0, sizeof(state));
-
-    outSize = 0;
-    outSizeHigh = 0;
-    /* Read the uncompressed size */
     for (i = 0; i < 8; i++) {
         unsigned char b = inStream[LZMA_SIZE_OFFSET + i];
             if (i < 4) {
@@ -70,13 +52,13 @@ int lzmaBuffToBuffDecompress(unsigned char *outStream, SizeT *uncompressedSize,
         }
     }
 
-    outSizeFull = (SizeT)outSize;
+    *outSizeFull = (SizeT)outSize;
     if (sizeof(SizeT) >= 8) {
         /*
          * SizeT is a 64 bit uint => We can manage files larger than 4GB!
          *
          */
-            outSizeFull |= (((SizeT)outSizeHigh << 16) << 16);
+            *outSizeFull |= (((SizeT)outSizeHigh << 16) << 16);
     } else if (outSizeHigh != 0 || (UInt32)(SizeT)outSize != outSize) {
         /*
          * SizeT is a 32 bit uint => We cannot manage files larger than
@@ -90,6 +72,32 @@ int lzmaBuffToBuffDecompress(unsigned char *outStream, SizeT *uncompressedSize,
         }
     }
 
+    return SZ_OK;
+}
+
+int lzmaBuffToBuffDecompress(unsigned char *outStream, SizeT *uncompressedSize,
+			     const unsigned char *inStream, SizeT length)
+{
+    int res = SZ_ERROR_DATA;
+    ISzAlloc g_Alloc;
+
+    SizeT outSizeFull = 0xFFFFFFFF; /* 4GBytes limit */
+    SizeT outProcessed;
+    ELzmaStatus state;
+    SizeT compressedSize = (SizeT)(length - LZMA_PROPS_SIZE);
+
+    debug ("LZMA: Image address............... 0x%p\n", inStream);
+    debug ("LZMA: Properties address.......... 0x%p\n", inStream + LZMA_PROPERTIES_OFFSET);
+    debug ("LZMA: Uncompressed size address... 0x%p\n", inStream + LZMA_SIZE_OFFSET);
+    debug ("LZMA: Compressed data address..... 0x%p\n", inStream + LZMA_DATA_OFFSET);
+    debug ("LZMA: Destination address......... 0x%p\n", outStream);
+
+    memset(&state, 0, sizeof(state));
+
+    res = lzmaReadSize(inStream, &outSizeFull);
+    if (res != SZ_OK)
+        return res;
+
     debug("LZMA: Uncompresed size............ 0x%zx\n", outSizeFull);
     debug("LZMA: Compresed size.............. 0x%zx\n", compressedSize);
 
@@ -120,4 +128,76 @@ int lzmaBuffToBuffDecompress(unsigned char *outStream, SizeT *uncompressedSize,
     return res;
 }
 
+static ISzAlloc lzmaStreamAlloc = { SzAlloc, SzFree };
+
+void lzmaStreamStart(struct lzma_stream *ls, unsigned char *outStream,
+                     SizeT outMax)
+{
+    memset(ls, 0, sizeof(*ls));
+    LzmaDec_Construct(&ls->dec);
+    ls->out = outStream;
+    ls->out_max = outMax;
+}
+
+int lzmaStreamFeed(struct lzma_stream *ls, const unsigned char *inStream,
+                   SizeT length)
+{
+    SizeT outSizeFull;
+    SizeT inProcessed;
+    int res;
+
+    /* The header may be split across pieces */
+    if (!ls->started) {
+        inProcessed = min(length, sizeof(ls->hdr) - ls->hdr_len);
+        memcpy(ls->hdr + ls->hdr_len, inStream, inProcessed);
+        ls->hdr_len += inProcessed;
+        inStream += inProcessed;
+        length -= inProcessed;
+        if (ls->hdr_len < sizeof(ls->hdr))
+            return SZ_OK;
+
+        res = lzmaReadSize(ls->hdr, &outSizeFull);
+        if (res != SZ_OK)
+            return res;
+        debug("LZMA: Uncompresed size............ 0x%zx\n", outSizeFull);
+        if (outSizeFull != (SizeT)-1 && ls->out_max < outSizeFull)
+            return SZ_ERROR_OUTPUT_EOF;
+
+        res = LzmaDec_AllocateProbs(&ls->dec, ls->hdr, LZMA_PROPS_SIZE,
+                                    &lzmaStreamAlloc);
+        if (res != SZ_OK)
+            return res;
+        ls->dec.dic = ls->out;
+        ls->dec.dicBufSize = min(outSizeFull, ls->out_max);
+        LzmaDec_Init(&ls->dec);
+        ls->started = 1;
+    }
+
+    /* As with LzmaDecode(), check for the end mark once the output is full */
+    inProcessed = length;
+    res = LzmaDec_DecodeToDic(&ls->dec, ls->dec.dicBufSize, inStream,
+                              &inProcessed, LZMA_FINISH_END, &ls->status);
+    schedule();
+
+    return res;
+}
+
+int lzmaStreamFinish(struct lzma_stream *ls, SizeT *uncompressedSize)
+{
+    if (!ls->started) {
+        *uncompressedSize = 0;
+        return SZ_ERROR_INPUT_EOF;
+    }
+
+    *uncompressedSize = ls->dec.dicPos;
+    debug("LZMA: Uncompressed ............... 0x%zx\n", ls->dec.dicPos);
+    LzmaDec_FreeProbs(&ls->dec, &lzmaStreamAlloc);
+    ls->started = 0;
+
+    if (ls->status == LZMA_STATUS_NEEDS_MORE_INPUT)
+        return SZ_ERROR_INPUT_EOF;
+
+    return SZ_OK;
+}
+
 #endif
@@ -12,6 +12,7 @@
 #define __LZMA_TOOL_H__
 
 #include <lzma/LzmaTypes.h>
+#include <lzma/LzmaDec.h>
 
 /**
  * lzmaBuffToBuffDecompress() - Decompress LZMA data
@@ -28,4 +29,60 @@
 int lzmaBuffToBuffDecompress(unsigned char *outStream, SizeT *uncompressedSize,
 			     const unsigned char *inStream, SizeT length);
 
+/**
+ * struct lzma_stream - State for decompressing LZMA data in pieces
+ *
+ * @dec: Decoder state
+ * @hdr: Stream header (properties and uncompressed size)
+ * @hdr_len: Number of bytes of @hdr received so far
+ * @out: Output buffer
+ * @out_max: Size of @out
+ * @status: Decoder status after the last piece
+ * @started: Non-zero once the decoder is set up, i.e. the header is complete
+ */
+struct lzma_stream {
+	CLzmaDec dec;
+	Byte hdr[LZMA_PROPS_SIZE + 8];
+	int hdr_len;
+	unsigned char *out;
+	SizeT out_max;
+	ELzmaStatus status;
+	int started;
+};
+
+/**
+ * lzmaStreamStart() - Start decompressing LZMA data in pieces
+ *
+ * lzmaStreamFinish() must be called afterwards, even on error
+ *
+ * @ls: Stream state to set up
+ * @outStream: output buffer
+ * @outMax: Size of @outStream
+ */
+void lzmaStreamStart(struct lzma_stream *ls, unsigned char *outStream,
+		     SizeT outMax);
+
+/**
+ * lzmaStreamFeed() - Decompress the next piece of LZMA data
+ *
+ * @ls: Stream state
+ * @inStream: Next piece of compressed data
+ * @length: Sizeof @inStream
+ * @return 0 if OK, SZ_ERROR_OUTPUT_EOF if the output buffer is too small;
+ *	see also other SZ_ERROR... values
+ */
+int lzmaStreamFeed(struct lzma_stream *ls, const unsigned char *inStream,
+		   SizeT length);
+
+/**
+ * lzmaStreamFinish() - Finish decompressing LZMA data in pieces
+ *
+ * This frees the decoder state
+ *
+ * @ls: Stream state
+ * @uncompressedSize: Returns the actual uncompressed size
+ * @return 0 if OK, SZ_ERROR_INPUT_EOF if the data ended early
+ */
+int lzmaStreamFinish(struct lzma_stream *ls, SizeT *uncompressedSize);
+
 #endif
@@ -12,6 +12,7 @@
 #include <net.h>
 #include <net6.h>
 #include <vsprintf.h>
+#include <asm/unaligned.h>
 
 struct in_addr string_to_ip(const char *s)
 {
@@ -167,29 +168,94 @@ void string_to_enetaddr(const char *addr, uint8_t *enetaddr)
 	}
 }
 
-uint compute_ip_checksum(const void *vptr, uint nbytes)
+u64 ip_checksum_partial(u64 sum, const void *vptr, uint nbytes)
 {
-	int sum, oddbyte;
-	const unsigned short *ptr = vptr;
+	const u8 *ptr = vptr;
+	const u32 *wptr;
+	u16 oddbyte;
+
+	/* Unaligned callers are rare, so keep them on a simple loop */
+	if ((ulong)ptr & 1) {
+		for (; nbytes > 1; nbytes -= 2, ptr += 2)
+			sum += get_unaligned((const u16 *)ptr);
+		goto tail;
+	}
 
-	sum = 0;
-	while (nbytes > 1) {
-		sum += *ptr++;
+	if (((ulong)ptr & 2) && nbytes > 1) {
+		sum += *(const u16 *)ptr;
+		ptr += 2;
+		nbytes -= 2;
+	}
+
+	/*
+	 * Add 32-bit words into the 64-bit accumulator; since 2^16 is 1 in
+	 * one's complement arithmetic the result folds down to the same
+	 * 16-bit sum, and the accumulator cannot overflow for any buffer
+	 * smaller than 16GB.
+	 */
+	wptr = (const u32 *)ptr;
+	for (; nbytes >= 32; nbytes -= 32, wptr += 8) {
+		sum += wptr[0];
+		sum += wptr[1];
+		sum += wptr[2];
+		sum += wptr[3];
+		sum += wptr[4];
+		sum += wptr[5];
+		sum += wptr[6];
+		sum += wptr[7];
+	}
+	for (; nbytes >= 4; nbytes -= 4)
+		sum += *wptr++;
+	ptr = (const u8 *)wptr;
+	if (nbytes > 1) {
+		sum += *(const u16 *)ptr;
+		ptr += 2;
 		nbytes -= 2;
 	}
+
+tail:
 	if (nbytes == 1) {
 		oddbyte = 0;
-		((u8 *)&oddbyte)[0] = *(u8 *)ptr;
-		((u8 *)&oddbyte)[1] = 0;
+		((u8 *)&oddbyte)[0] = *ptr;
 		sum += oddbyte;
 	}
-	sum = (sum >> 16) + (sum & 0xffff);
-	sum += (sum >> 16);
-	sum = ~sum & 0xffff;
 
 	return sum;
 }
 
+uint ip_checksum_fold(u64 sum)
+{
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+
+	return ~sum & 0xffff;
+}
+
+uint compute_ip_checksum(const void *vptr, uint nbytes)
+{
+	return ip_checksum_fold(ip_checksum_partial(0, vptr, nbytes));
+}
+
+uint ip_checksum_update16(uint sum, u16 old, u16 new)
+{
+	u32 csum;
+
+	/* RFC 1624, eqn. 3: HC' = ~(~HC + ~m + m') */
+	csum = (~sum & 0xffff) + (~old & 0xffff) + new;
+
+	return ip_checksum_fold(csum);
+}
+
+uint ip_checksum_update32(uint sum, u32 old, u32 new)
+{
+	sum = ip_checksum_update16(sum, old >> 16, new >> 16);
+
+	return ip_checksum_update16(sum, old & 0xffff, new & 0xffff);
+}
+
 uint add_ip_checksums(uint offset, uint sum, uint new)
 {
 	ulong checksum;
@@ -17,12 +17,43 @@
 #include <malloc.h>
 #include <dm/of_access.h>
 #include <linux/err.h>
+#include <linux/log2.h>
 #include <linux/sizes.h>
 
 enum {
 	BUF_STEP	= SZ_64K,
 };
 
+/* Marks a slot in the path table whose node has been removed */
+#define OF_LIVE_REMOVED		((struct device_node *)1)
+
+/**
+ * struct of_live_index - Lookup tables for a tree from unflatten_device_tree()
+ *
+ * This is allocated in the same block as the tree, after the nodes, and is
+ * found through a pointer stored after the root node's name. Only nodes from
+ * the flat tree are included, so nodes added later are found by walking the
+ * tree as usual.
+ *
+ * @root: Root node of the tree
+ * @max_phandle: Largest phandle in @phandles, or 0 if there is no phandle
+ *	table, because the phandles are too sparse, one is used twice or the
+ *	root node has one
+ * @phandles: Node for each phandle, indexed by phandle value
+ * @paths: Hash table of nodes by full path, with linear probing
+ * @path_mask: Number of slots in @paths minus one
+ * @paths_complete: true if every node in the tree is in @paths, so a path
+ *	which is not found there does not exist
+ */
+struct of_live_index {
+	struct device_node *root;
+	phandle max_phandle;
+	struct device_node **phandles;
+	struct device_node **paths;
+	uint path_mask;
+	bool paths_complete;
+};
+
 static void *unflatten_dt_alloc(void **mem, unsigned long size,
 				unsigned long align)
 {
@@ -98,6 +129,10 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 		}
 	}
 
+	/* the root node has a pointer to the lookup index after its name */
+	if (!dad)
+		allocl = ALIGN(allocl, sizeof(void *)) + sizeof(void *);
+
 	np = unflatten_dt_alloc(&mem, sizeof(struct device_node) + allocl,
 				__alignof__(struct device_node));
 	if (!dryrun) {
@@ -260,9 +295,113 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 	return mem;
 }
 
+/* FNV-1a */
+static u32 of_live_hash(const char *str, int len)
+{
+	u32 hash = 2166136261U;
+
+	while (len--) {
+		hash ^= (u8)*str++;
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+static struct of_live_index **of_live_index_ptr(const struct device_node *root)
+{
+	const char *end = root->full_name + strlen(root->full_name) + 1;
+
+	return (struct of_live_index **)PTR_ALIGN(end, sizeof(void *));
+}
+
+static struct of_live_index *of_live_get_index(const struct device_node *root)
+{
+	struct of_live_index *idx;
+
+	/* only a root node from unflatten_device_tree() has its name after it */
+	if (!root || root->parent || root->full_name != (const char *)(root + 1))
+		return NULL;
+	idx = *of_live_index_ptr(root);
+
+	return idx && idx->root == root ? idx : NULL;
+}
+
+/**
+ * of_live_index_add() - Add nodes to the index
+ *
+ * @idx: Index to update
+ * @np: First node of a list of siblings to add, along with their subnodes
+ * Return: true if a phandle was seen more than once
+ */
+static bool of_live_index_add(struct of_live_index *idx,
+			      struct device_node *np)
+{
+	bool dup = false;
+	uint slot;
+
+	for (; np; np = np->sibling) {
+		if (np->phandle && np->phandle <= idx->max_phandle) {
+			if (idx->phandles[np->phandle])
+				dup = true;
+			else
+				idx->phandles[np->phandle] = np;
+		}
+
+		slot = of_live_hash(np->full_name, strlen(np->full_name));
+		for (slot &= idx->path_mask; idx->paths[slot];
+		     slot = (slot + 1) & idx->path_mask)
+			;
+		idx->paths[slot] = np;
+
+		dup |= of_live_index_add(idx, np->child);
+	}
+
+	return dup;
+}
+
+/**
+ * of_live_index_size() - Work out the size of the lookup index for a tree
+ *
+ * @blob: Flat tree
+ * @max_phandlep: Returns the largest phandle to put in the index, or 0 if the
+ *	phandles are too sparse for a table
+ * @path_maskp: Returns the number of slots in the path table, minus one
+ * Return: size of the index in bytes
+ */
+static ulong of_live_index_size(const void *blob, phandle *max_phandlep,
+				uint *path_maskp)
+{
+	phandle max_phandle = 0;
+	int offset, count = 0;
+
+	/*
+	 * Whether of_find_node_by_phandle() finds a phandle on the root node
+	 * depends on how it is called, so don't use a table for that
+	 */
+	if (fdt_get_phandle(blob, 0))
+		max_phandle = -1U;
+	for (offset = fdt_next_node(blob, 0, NULL); offset >= 0;
+	     offset = fdt_next_node(blob, offset, NULL)) {
+		max_phandle = max(max_phandle, fdt_get_phandle(blob, offset));
+		count++;
+	}
+	if (max_phandle > count * 2)
+		max_phandle = 0;
+	*max_phandlep = max_phandle;
+	*path_maskp = roundup_pow_of_two(max(count * 2, 16)) - 1;
+
+	return sizeof(struct of_live_index) +
+		(max_phandle + 1 + *path_maskp + 1) *
+		sizeof(struct device_node *);
+}
+
 int unflatten_device_tree(const void *blob, struct device_node **mynodes)
 {
-	unsigned long size;
+	struct of_live_index *idx;
+	unsigned long size, idx_size;
+	phandle max_phandle;
+	uint path_mask;
 	int start;
 	void *mem;
 
@@ -290,12 +429,18 @@ int unflatten_device_tree(const void *blob, struct device_node **mynodes)
 	if (!size)
 		return -EFAULT;
 	size = ALIGN(size, 4);
+	idx_size = of_live_index_size(blob, &max_phandle, &path_mask);
 
-	debug("  size is %lx, allocating...\n", size);
+	debug("  size is %lx, index %lx, allocating...\n", size, idx_size);
 
-	/* Allocate memory for the expanded device tree */
-	mem = memalign(__alignof__(struct device_node), size + 4);
+	/* Allocate memory for the expanded device tree and its index */
+	mem = memalign(__alignof__(struct device_node),
+		       ALIGN(size + 4, sizeof(void *)) + idx_size);
+	if (!mem)
+		return -ENOMEM;
 	memset(mem, '\0', size);
+	idx = mem + ALIGN(size + 4, sizeof(void *));
+	memset(idx, '\0', idx_size);
 
 	/* Set up value for dm_test_livetree_align() */
 	*(u32 *)mem = BAD_OF_ROOT;
@@ -313,6 +458,18 @@ int unflatten_device_tree(const void *blob, struct device_node **mynodes)
 		return -ENOSPC;
 	}
 
+	idx->root = *mynodes;
+	idx->max_phandle = max_phandle;
+	idx->phandles = (void *)(idx + 1);
+	idx->paths = idx->phandles + max_phandle + 1;
+	idx->path_mask = path_mask;
+	idx->paths_complete = true;
+
+	/* with duplicate phandles, which node is found depends on the search */
+	if (of_live_index_add(idx, idx->root->child))
+		idx->max_phandle = 0;
+	*of_live_index_ptr(idx->root) = idx;
+
 	debug(" <- unflatten_device_tree()\n");
 
 	return 0;
@@ -338,6 +495,88 @@ int of_live_build(const void *fdt_blob, struct device_node **rootp)
 	return ret;
 }
 
+int of_live_index_phandle(const struct device_node *root, phandle handle,
+			  struct device_node **npp)
+{
+	struct of_live_index *idx = of_live_get_index(root);
+
+	if (!idx || !idx->max_phandle)
+		return -ENOSYS;
+	*npp = handle <= idx->max_phandle ? idx->phandles[handle] : NULL;
+
+	return *npp ? 0 : -ENOENT;
+}
+
+int of_live_index_path(const struct device_node *root, const char *path,
+		       int len, struct device_node **npp)
+{
+	struct of_live_index *idx = of_live_get_index(root);
+	struct device_node *np;
+	uint slot;
+
+	if (!idx)
+		return -ENOSYS;
+
+	slot = of_live_hash(path, len) & idx->path_mask;
+	for (; (np = idx->paths[slot]); slot = (slot + 1) & idx->path_mask) {
+		if (np != OF_LIVE_REMOVED && !strncmp(np->full_name, path, len) &&
+		    !np->full_name[len]) {
+			*npp = np;
+			return 0;
+		}
+	}
+
+	return idx->paths_complete ? -ENOENT : -ENOSYS;
+}
+
+static struct of_live_index *of_live_index_for_node(struct device_node *np)
+{
+	while (np->parent)
+		np = np->parent;
+
+	return of_live_get_index(np);
+}
+
+void of_live_index_node_added(struct device_node *np)
+{
+	struct of_live_index *idx = of_live_index_for_node(np);
+
+	if (idx)
+		idx->paths_complete = false;
+}
+
+/* Drop a node and its subnodes from the index */
+static void of_live_index_drop(struct of_live_index *idx,
+			       struct device_node *np)
+{
+	struct device_node *child;
+	uint slot;
+
+	if (np->phandle && np->phandle <= idx->max_phandle &&
+	    idx->phandles[np->phandle] == np)
+		idx->phandles[np->phandle] = NULL;
+
+	slot = of_live_hash(np->full_name, strlen(np->full_name));
+	for (slot &= idx->path_mask; idx->paths[slot];
+	     slot = (slot + 1) & idx->path_mask) {
+		if (idx->paths[slot] == np) {
+			idx->paths[slot] = OF_LIVE_REMOVED;
+			break;
+		}
+	}
+
+	for (child = np->child; child; child = child->sibling)
+		of_live_index_drop(idx, child);
+}
+
+void of_live_index_node_removed(struct device_node *np)
+{
+	struct of_live_index *idx = of_live_index_for_node(np);
+
+	if (idx)
+		of_live_index_drop(idx, np);
+}
+
 void of_live_free(struct device_node *root)
 {
 	/* the tree is stored as a contiguous block of memory */
@@ -20,7 +20,47 @@
 #include <linux/types.h>
 #include <linux/string.h>
 #include <linux/ctype.h>
+#include <linux/kernel.h>
 #include <malloc.h>
+#include <asm/byteorder.h>
+
+/*
+ * Helpers for the routines below which work a word at a time. These only use
+ * aligned loads, so never read past the end of a page and work on machines
+ * which do not support unaligned access. CONFIG_SPL_TINY_STRING and
+ * CONFIG_TPL_TINY_STRING drop them, leaving the simple byte loops.
+ */
+#define WORD_SIZE	sizeof(ulong)
+#define WORD_MASK	(WORD_SIZE - 1)
+#define WORD_BITS	(WORD_SIZE * 8)
+
+/*
+ * has_zero() - Check whether a word contains a zero byte
+ *
+ * This is non-zero if any byte is zero. A borrow can also mark the byte after a
+ * zero byte, so callers find the byte itself with a byte loop, which works for
+ * either byte order.
+ */
+static inline ulong has_zero(ulong val)
+{
+	return (val - REPEAT_BYTE(0x01)) & ~val & REPEAT_BYTE(0x80);
+}
+
+/*
+ * merge_words() - Get the word at a byte offset from an aligned word
+ *
+ * @lo: Aligned word containing the first byte
+ * @hi: Following aligned word
+ * @shift: Byte offset of the first byte in @lo, multiplied by 8 (non-zero)
+ */
+static inline ulong merge_words(ulong lo, ulong hi, uint shift)
+{
+#ifdef __BIG_ENDIAN
+	return lo << shift | hi >> (WORD_BITS - shift);
+#else
+	return lo >> shift | hi << (WORD_BITS - shift);
+#endif
+}
 
 /**
  * strncasecmp - Case insensitive, length-limited string comparison
@@ -252,8 +292,29 @@ int strncmp(const char *cs, const char *ct, size_t count)
  * @s: The string to be searched
  * @c: The character to search for
  */
-char * strchr(const char * s, int c)
-{
+__no_sanitize_address char *strchr(const char *s, int c)
+{
+	const ulong mask = REPEAT_BYTE((u8)c);
+	const ulong *sl;
+	ulong val;
+
+	if (!CONFIG_IS_ENABLED(TINY_STRING)) {
+		for (; (ulong)s & WORD_MASK; ++s) {
+			if (*s == (char)c)
+				return (char *)s;
+			if (*s == '\0')
+				return NULL;
+		}
+
+		/* skip words with neither the character nor a nul */
+		for (sl = (const ulong *)s;; sl++) {
+			val = *sl;
+			if (has_zero(val) || has_zero(val ^ mask))
+				break;
+		}
+		s = (const char *)sl;
+	}
+
 	for(; *s != (char) c; ++s)
 		if (*s == '\0')
 			return NULL;
@@ -291,11 +352,22 @@ char * strrchr(const char * s, int c)
  * strlen - Find the length of a string
  * @s: The string to be sized
  */
-size_t strlen(const char * s)
+__no_sanitize_address size_t strlen(const char *s)
 {
-	const char *sc;
+	const char *sc = s;
+	const ulong *sl;
+
+	if (!CONFIG_IS_ENABLED(TINY_STRING)) {
+		for (; (ulong)sc & WORD_MASK; ++sc) {
+			if (*sc == '\0')
+				return sc - s;
+		}
+		for (sl = (const ulong *)sc; !has_zero(*sl); sl++)
+			/* nothing */;
+		sc = (const char *)sl;
+	}
 
-	for (sc = s; *sc != '\0'; ++sc)
+	for (; *sc != '\0'; ++sc)
 		/* nothing */;
 	return sc - s;
 }
@@ -550,6 +622,54 @@ __used void * memset(void * s,int c,size_t count)
 #endif
 
 #ifndef __HAVE_ARCH_MEMCPY
+/* Copy aligned words, four at a time where possible */
+static void copy_words(ulong *dl, const ulong *sl, size_t words)
+{
+	ulong a, b, c, d;
+
+	for (; words >= 4; words -= 4, dl += 4, sl += 4) {
+		a = sl[0];
+		b = sl[1];
+		c = sl[2];
+		d = sl[3];
+		dl[0] = a;
+		dl[1] = b;
+		dl[2] = c;
+		dl[3] = d;
+	}
+	while (words--)
+		*dl++ = *sl++;
+}
+
+/*
+ * Copy words to an aligned destination from a misaligned source, merging
+ * aligned loads from the source. This reads up to a word after the last one
+ * copied, so the caller must leave that much still to copy.
+ */
+static void copy_words_shifted(ulong *dl, const u8 *s8, size_t words)
+{
+	uint shift = ((ulong)s8 & WORD_MASK) * 8;
+	const ulong *sl = (const ulong *)((ulong)s8 & ~WORD_MASK);
+	ulong lo = *sl, a, b, c, d;
+
+	for (; words >= 4; words -= 4, dl += 4, sl += 4) {
+		a = sl[1];
+		b = sl[2];
+		c = sl[3];
+		d = sl[4];
+		dl[0] = merge_words(lo, a, shift);
+		dl[1] = merge_words(a, b, shift);
+		dl[2] = merge_words(b, c, shift);
+		dl[3] = merge_words(c, d, shift);
+		lo = d;
+	}
+	for (; words; words--, sl++) {
+		a = sl[1];
+		*dl++ = merge_words(lo, a, shift);
+		lo = a;
+	}
+}
+
 /**
  * memcpy - Copy one area of memory to another
  * @dest: Where to copy to
@@ -561,22 +681,37 @@ __used void * memset(void * s,int c,size_t count)
  */
 __used void * memcpy(void *dest, const void *src, size_t count)
 {
-	unsigned long *dl = (unsigned long *)dest, *sl = (unsigned long *)src;
-	char *d8, *s8;
+	u8 *d8 = dest;
+	const u8 *s8 = src;
+	size_t words;
 
 	if (src == dest)
 		return dest;
 
-	/* while all data is aligned (common case), copy a word at a time */
-	if ( (((ulong)dest | (ulong)src) & (sizeof(*dl) - 1)) == 0) {
-		while (count >= sizeof(*dl)) {
-			*dl++ = *sl++;
-			count -= sizeof(*dl);
+	/*
+	 * align the destination, then copy a word at a time, shifting the
+	 * source data if it is not aligned too
+	 */
+	if (!CONFIG_IS_ENABLED(TINY_STRING) && count >= 2 * WORD_SIZE) {
+		for (; (ulong)d8 & WORD_MASK; count--)
+			*d8++ = *s8++;
+		words = count / WORD_SIZE;
+		if ((ulong)s8 & WORD_MASK)
+			copy_words_shifted((ulong *)d8, s8, --words);
+		else
+			copy_words((ulong *)d8, (const ulong *)s8, words);
+		d8 += words * WORD_SIZE;
+		s8 += words * WORD_SIZE;
+		count -= words * WORD_SIZE;
+	} else if (!(((ulong)d8 | (ulong)s8) & WORD_MASK)) {
+		/* while all data is aligned (common case), copy a word at a time */
+		for (; count >= WORD_SIZE; count -= WORD_SIZE) {
+			*(ulong *)d8 = *(const ulong *)s8;
+			d8 += WORD_SIZE;
+			s8 += WORD_SIZE;
 		}
 	}
-	/* copy the reset one byte at a time */
-	d8 = (char *)dl;
-	s8 = (char *)sl;
+	/* copy the rest one byte at a time */
 	while (count--)
 		*d8++ = *s8++;
 
@@ -631,10 +766,44 @@ __used void * memmove(void * dest,const void *src,size_t count)
  */
 __used int memcmp(const void * cs,const void * ct,size_t count)
 {
-	const unsigned char *su1, *su2;
+	const unsigned char *su1 = cs, *su2 = ct;
+	const ulong *sl1, *sl2;
+	uint shift;
+	ulong lo, hi;
 	int res = 0;
 
-	for( su1 = cs, su2 = ct; 0 < count; ++su1, ++su2, count--)
+	/*
+	 * compare a word at a time until there is a difference, which the byte
+	 * loop then finds
+	 */
+	if (!CONFIG_IS_ENABLED(TINY_STRING) && count >= 2 * WORD_SIZE) {
+		for (; (ulong)su1 & WORD_MASK; ++su1, ++su2, count--) {
+			if ((res = *su1 - *su2) != 0)
+				return res;
+		}
+		sl1 = (const ulong *)su1;
+		shift = ((ulong)su2 & WORD_MASK) * 8;
+		if (!shift) {
+			for (sl2 = (const ulong *)su2; count >= WORD_SIZE;
+			     count -= WORD_SIZE, sl1++, sl2++) {
+				if (*sl1 != *sl2)
+					break;
+			}
+		} else {
+			/* leave a word, as the last load is of the next one */
+			sl2 = (const ulong *)((ulong)su2 & ~WORD_MASK);
+			for (lo = *sl2; count >= 2 * WORD_SIZE;
+			     count -= WORD_SIZE, sl1++, lo = hi) {
+				hi = *++sl2;
+				if (*sl1 != merge_words(lo, hi, shift))
+					break;
+			}
+		}
+		su2 += (const u8 *)sl1 - su1;
+		su1 = (const u8 *)sl1;
+	}
+
+	for (; 0 < count; ++su1, ++su2, count--)
 		if ((res = *su1 - *su2) != 0)
 			break;
 	return res;
@@ -715,6 +884,23 @@ char * strstr(const char * s1,const char * s2)
 void *memchr(const void *s, int c, size_t n)
 {
 	const unsigned char *p = s;
+	const ulong mask = REPEAT_BYTE((u8)c);
+	const ulong *sl;
+
+	if (!CONFIG_IS_ENABLED(TINY_STRING)) {
+		for (; n && ((ulong)p & WORD_MASK); n--, p++) {
+			if ((unsigned char)c == *p)
+				return (void *)p;
+		}
+
+		/* skip whole words which do not contain the character */
+		for (sl = (const ulong *)p; n >= WORD_SIZE; n -= WORD_SIZE, sl++) {
+			if (has_zero(*sl ^ mask))
+				break;
+		}
+		p = (const unsigned char *)sl;
+	}
+
 	while (n-- != 0) {
 		if ((unsigned char)c == *p++) {
 			return (void *)(p-1);
@@ -7,6 +7,8 @@
 #include <net.h>
 #include <net/fastboot_tcp.h>
 #include <net/tcp.h>
+#include <asm/unaligned.h>
+#include <linux/kernel.h>
 
 static char command[FASTBOOT_COMMAND_LEN] = {0};
 static char response[FASTBOOT_RESPONSE_LEN] = {0};
@@ -16,23 +18,33 @@ static const uchar *handshake = "FB01";
 
 static u16 curr_sport;
 static u16 curr_dport;
-static u32 curr_tcp_seq_num;
-static u32 curr_tcp_ack_num;
-static unsigned int curr_request_len;
 static enum fastboot_tcp_state {
 	FASTBOOT_CLOSED,
 	FASTBOOT_CONNECTED,
 	FASTBOOT_DISCONNECTING
 } state = FASTBOOT_CLOSED;
 
+/* Next sequence number expected from the host */
+static u32 rcv_nxt;
+/* Next sequence number to send to the host */
+static u32 snd_nxt;
+
+/*
+ * Every fastboot message is prefixed by its 8 byte big endian length and
+ * may span any number of TCP segments. Download data is handed over to
+ * fastboot_data_download() as it arrives.
+ */
+static u8 msg_hdr[8];
+static unsigned int msg_hdr_len;
+static u64 msg_remaining;
+static bool msg_is_data;
+static unsigned int command_len;
+
 static void fastboot_tcp_answer(u8 action, unsigned int len)
 {
-	const u32 response_seq_num = curr_tcp_ack_num;
-	const u32 response_ack_num = curr_tcp_seq_num +
-		  (curr_request_len > 0 ? curr_request_len : 1);
-
 	net_send_tcp_packet(len, htons(curr_sport), htons(curr_dport),
-			    action, response_seq_num, response_ack_num);
+			    action, snd_nxt, rcv_nxt);
+	snd_nxt += len;
 }
 
 static void fastboot_tcp_reset(void)
@@ -67,25 +79,104 @@ static void fastboot_tcp_send_message(const char *message, unsigned int len)
 	memset(pkt, '\0', PKTSIZE);
 }
 
+static void fastboot_tcp_handle_command(void)
+{
+	int fastboot_command_id;
+
+	command[command_len] = '\0';
+	fastboot_command_id = fastboot_handle_command(command, response);
+	fastboot_tcp_send_message(response, strlen(response));
+	fastboot_handle_boot(fastboot_command_id,
+			     strncmp("OKAY", response, 4) == 0);
+	memset(command, 0, FASTBOOT_COMMAND_LEN);
+	memset(response, 0, FASTBOOT_RESPONSE_LEN);
+}
+
+/**
+ * fastboot_tcp_receive() - consume in-order stream data from the host
+ *
+ * @pkt: Pointer to the segment payload
+ * @len: Length of the segment payload
+ *
+ * Return: true if a message was sent back, which also acknowledges the
+ * segment, false if the segment still needs to be acknowledged
+ */
+static bool fastboot_tcp_receive(const uchar *pkt, unsigned int len)
+{
+	bool answered = false;
+	unsigned int n;
+
+	while (len) {
+		if (msg_hdr_len < sizeof(msg_hdr)) {
+			n = min(len, (unsigned int)sizeof(msg_hdr) - msg_hdr_len);
+			memcpy(msg_hdr + msg_hdr_len, pkt, n);
+			msg_hdr_len += n;
+			pkt += n;
+			len -= n;
+			if (msg_hdr_len < sizeof(msg_hdr))
+				break;
+
+			// First 8 bytes is big endian message length
+			msg_remaining = get_unaligned_be64(msg_hdr);
+			msg_is_data = fastboot_data_remaining() > 0;
+			command_len = 0;
+			if (!msg_remaining ||
+			    (msg_is_data &&
+			     msg_remaining > fastboot_data_remaining()) ||
+			    (!msg_is_data &&
+			     msg_remaining >= FASTBOOT_COMMAND_LEN)) {
+				fastboot_tcp_reset();
+				return true;
+			}
+			continue;
+		}
+
+		n = min_t(u64, len, msg_remaining);
+		if (msg_is_data) {
+			fastboot_data_download(pkt, n, response);
+			if (!fastboot_data_remaining()) {
+				fastboot_data_complete(response);
+				fastboot_tcp_send_message(response,
+							  strlen(response));
+				memset(response, 0, FASTBOOT_RESPONSE_LEN);
+				answered = true;
+			}
+		} else {
+			memcpy(command + command_len, pkt, n);
+			command_len += n;
+		}
+		msg_remaining -= n;
+		pkt += n;
+		len -= n;
+
+		if (!msg_remaining) {
+			msg_hdr_len = 0;
+			if (!msg_is_data) {
+				fastboot_tcp_handle_command();
+				answered = true;
+			}
+		}
+	}
+
+	return answered;
+}
+
 static void fastboot_tcp_handler_ipv4(uchar *pkt, u16 dport,
 				      struct in_addr sip, u16 sport,
 				      u32 tcp_seq_num, u32 tcp_ack_num,
 				      u8 action, unsigned int len)
 {
-	int fastboot_command_id;
-	u64 command_size;
 	u8 tcp_fin = action & TCP_FIN;
 	u8 tcp_push = action & TCP_PUSH;
 
 	curr_sport = sport;
 	curr_dport = dport;
-	curr_tcp_seq_num = tcp_seq_num;
-	curr_tcp_ack_num = tcp_ack_num;
-	curr_request_len = len;
 
 	switch (state) {
 	case FASTBOOT_CLOSED:
 		if (tcp_push) {
+			rcv_nxt = tcp_seq_num + (len > 0 ? len : 1);
+			snd_nxt = tcp_ack_num;
 			if (len != handshake_length ||
 			    strlen(pkt) != handshake_length ||
 			    memcmp(pkt, handshake, handshake_length) != 0) {
@@ -94,31 +185,31 @@ static void fastboot_tcp_handler_ipv4(uchar *pkt, u16 dport,
 			}
 			fastboot_tcp_send_packet(TCP_ACK | TCP_PUSH,
 						 handshake, handshake_length);
+			msg_hdr_len = 0;
 			state = FASTBOOT_CONNECTED;
 		}
 		break;
 	case FASTBOOT_CONNECTED:
-		if (tcp_fin) {
-			fastboot_tcp_answer(TCP_FIN | TCP_ACK, 0);
-			state = FASTBOOT_DISCONNECTING;
+		if (tcp_seq_num != rcv_nxt) {
+			/*
+			 * Out of order or retransmitted segment: drop it and
+			 * repeat our last acknowledgement so that the host
+			 * resends from the first missing byte.
+			 */
+			fastboot_tcp_answer(TCP_ACK, 0);
 			break;
 		}
-		if (tcp_push) {
-			// First 8 bytes is big endian message length
-			command_size = __be64_to_cpu(*(u64 *)pkt);
-			len -= 8;
-			pkt += 8;
-
-			// Only single packet messages are supported ATM
-			if (strlen(pkt) != command_size) {
-				fastboot_tcp_reset();
+		if (len) {
+			rcv_nxt += len;
+			if (!fastboot_tcp_receive(pkt, len))
+				fastboot_tcp_answer(TCP_ACK, 0);
+			if (state != FASTBOOT_CONNECTED)
 				break;
-			}
-			strlcpy(command, pkt, len + 1);
-			fastboot_command_id = fastboot_handle_command(command, response);
-			fastboot_tcp_send_message(response, strlen(response));
-			fastboot_handle_boot(fastboot_command_id,
-					     strncmp("OKAY", response, 4) == 0);
+		}
+		if (tcp_fin) {
+			rcv_nxt++;
+			fastboot_tcp_answer(TCP_FIN | TCP_ACK, 0);
+			state = FASTBOOT_DISCONNECTING;
 		}
 		break;
 	case FASTBOOT_DISCONNECTING:
@@ -127,13 +218,8 @@ static void fastboot_tcp_handler_ipv4(uchar *pkt, u16 dport,
 		break;
 	}
 
-	memset(command, 0, FASTBOOT_COMMAND_LEN);
-	memset(response, 0, FASTBOOT_RESPONSE_LEN);
 	curr_sport = 0;
 	curr_dport = 0;
-	curr_tcp_seq_num = 0;
-	curr_tcp_ack_num = 0;
-	curr_request_len = 0;
 }
 
 void fastboot_tcp_start_server(void)
@@ -141,5 +227,11 @@ void fastboot_tcp_start_server(void)
 	printf("Using %s device\n", eth_get_name());
 	printf("Listening for fastboot command on tcp %pI4\n", &net_ip);
 
+	/*
+	 * Download data is copied out of the receive buffer as soon as it
+	 * arrives, so the window is not bounded by the number of Ethernet
+	 * receive buffers.
+	 */
+	tcp_set_rx_window(CONFIG_TCP_FUNCTION_FASTBOOT_WINDOW);
 	tcp_set_tcp_handler(fastboot_tcp_handler_ipv4);
 }
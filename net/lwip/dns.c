@@ -13,7 +13,7 @@
 
 struct dns_cb_arg {
 	ip_addr_t host_ipaddr;
-	const char *var;
+	bool found;
 	bool done;
 };
 
@@ -25,38 +25,28 @@ static void do_dns_tmr(void *arg)
 static void dns_cb(const char *name, const ip_addr_t *ipaddr, void *arg)
 {
 	struct dns_cb_arg *dns_cb_arg = arg;
-	char *ipstr = ip4addr_ntoa(ipaddr);
 
 	dns_cb_arg->done = true;
 
-	if (!ipaddr) {
-		printf("DNS: host not found\n");
-		dns_cb_arg->host_ipaddr.addr = 0;
+	if (!ipaddr)
 		return;
-	}
 
-	if (dns_cb_arg->var)
-		env_set(dns_cb_arg->var, ipstr);
-
-	printf("%s\n", ipstr);
+	dns_cb_arg->host_ipaddr = *ipaddr;
+	dns_cb_arg->found = true;
 }
 
-static int dns_loop(struct udevice *udev, const char *name, const char *var)
+int net_lwip_dns_resolve(struct udevice *udev, struct netif *netif,
+			 const char *name, ip_addr_t *addr)
 {
 	struct dns_cb_arg dns_cb_arg = { };
 	bool has_server = false;
-	struct netif *netif;
-	ip_addr_t ipaddr;
 	ip_addr_t ns;
 	ulong start;
 	char *nsenv;
 	int ret;
 
-	dns_cb_arg.var = var;
-
-	netif = net_lwip_new_netif(udev);
-	if (!netif)
-		return CMD_RET_FAILURE;
+	if (ipaddr_aton(name, addr))
+		return 0;
 
 	dns_init();
 
@@ -74,38 +64,66 @@ static int dns_loop(struct udevice *udev, const char *name, const char *var)
 
 	if (!has_server) {
 		log_err("No valid name server (dnsip/dnsip2)\n");
-		net_lwip_remove_netif(netif);
-		return CMD_RET_FAILURE;
+		return -EINVAL;
 	}
 
-	dns_cb_arg.done = false;
-
-	ret = dns_gethostbyname(name, &ipaddr, dns_cb, &dns_cb_arg);
-
-	if (ret == ERR_OK) {
-		dns_cb(name, &ipaddr, &dns_cb_arg);
-	} else if (ret == ERR_INPROGRESS) {
-		start = get_timer(0);
-		sys_timeout(DNS_RESEND_MS, do_dns_tmr, NULL);
-		do {
-			net_lwip_rx(udev, netif);
-			if (dns_cb_arg.done)
-				break;
-			sys_check_timeouts();
-			if (ctrlc()) {
-				printf("\nAbort\n");
-				break;
-			}
-		} while (get_timer(start) < DNS_TIMEOUT_MS);
-		sys_untimeout(do_dns_tmr, NULL);
+	ret = dns_gethostbyname(name, addr, dns_cb, &dns_cb_arg);
+
+	if (ret == ERR_OK)
+		return 0;
+	if (ret != ERR_INPROGRESS)
+		return -EINVAL;
+
+	start = get_timer(0);
+	sys_timeout(DNS_RESEND_MS, do_dns_tmr, NULL);
+	do {
+		net_lwip_rx(udev, netif);
+		if (dns_cb_arg.done)
+			break;
+		sys_check_timeouts();
+		if (ctrlc()) {
+			printf("\nAbort\n");
+			break;
+		}
+	} while (get_timer(start) < DNS_TIMEOUT_MS);
+	sys_untimeout(do_dns_tmr, NULL);
+
+	if (!dns_cb_arg.done)
+		return -ETIMEDOUT;
+
+	if (!dns_cb_arg.found) {
+		printf("DNS: host not found\n");
+		return -ENOENT;
 	}
 
+	*addr = dns_cb_arg.host_ipaddr;
+
+	return 0;
+}
+
+static int dns_loop(struct udevice *udev, const char *name, const char *var)
+{
+	struct netif *netif;
+	ip_addr_t ipaddr;
+	char *ipstr;
+	int ret;
+
+	netif = net_lwip_new_netif(udev);
+	if (!netif)
+		return CMD_RET_FAILURE;
+
+	ret = net_lwip_dns_resolve(udev, netif, name, &ipaddr);
 	net_lwip_remove_netif(netif);
+	if (ret)
+		return CMD_RET_FAILURE;
+
+	ipstr = ip4addr_ntoa(&ipaddr);
+	if (var)
+		env_set(var, ipstr);
 
-	if (dns_cb_arg.done && dns_cb_arg.host_ipaddr.addr != 0)
-		return CMD_RET_SUCCESS;
+	printf("%s\n", ipstr);
 
-	return CMD_RET_FAILURE;
+	return CMD_RET_SUCCESS;
 }
 
 int do_dns(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
@@ -55,6 +55,11 @@ static void tftp_close(void *handle)
 	puts("\ndone\n");
 	printf("Bytes transferred = %lu (%lx hex)\n", ctx->size, ctx->size);
 
+	if (net_digest_finish(ctx->daddr - ctx->size, ctx->size)) {
+		ctx->done = FAILURE;
+		return;
+	}
+
 	if (env_set_hex("filesize", ctx->size)) {
 		log_err("filesize not updated\n");
 		return;
@@ -73,6 +78,7 @@ static int tftp_write(void *handle, struct pbuf *p)
 
 	for (q = p; q; q = q->next) {
 		memcpy((void *)ctx->daddr, q->payload, q->len);
+		net_digest_update(ctx->size, q->payload, q->len);
 		ctx->daddr += q->len;
 		ctx->size += q->len;
 		ctx->block_count++;
@@ -128,6 +134,11 @@ static int tftp_loop(struct udevice *udev, ulong addr, char *fname,
 	ctx.block_count = 0;
 	ctx.daddr = addr;
 
+	if (net_digest_start()) {
+		net_lwip_remove_netif(netif);
+		return -1;
+	}
+
 	printf("Using %s device\n", udev->name);
 	printf("TFTP from server %s; our IP address is %s\n",
 	       ip4addr_ntoa(&srvip), env_get("ipaddr"));
@@ -146,6 +157,7 @@ static int tftp_loop(struct udevice *udev, ulong addr, char *fname,
 	/* might return different errors, like routing problems */
 	if (err != ERR_OK) {
 		printf("tftp_get() error %d\n", err);
+		net_digest_abort();
 		net_lwip_remove_netif(netif);
 		return -1;
 	}
@@ -173,6 +185,7 @@ static int tftp_loop(struct udevice *udev, ulong addr, char *fname,
 				ctx.size);
 		return 0;
 	}
+	net_digest_abort();
 
 	return -1;
 }
@@ -6,6 +6,8 @@
 #include <display_options.h>
 #include <efi_loader.h>
 #include <image.h>
+#include <lmb.h>
+#include <lwip/altcp.h>
 #include <lwip/apps/http_client.h>
 #include "lwip/altcp_tls.h"
 #include <lwip/timeouts.h>
@@ -196,6 +198,7 @@ static err_t httpc_recv_cb(void *arg, struct altcp_pcb *pcb, struct pbuf *pbuf,
 
 	for (buf = pbuf; buf; buf = buf->next) {
 		memcpy((void *)ctx->daddr, buf->payload, buf->len);
+		net_digest_update(ctx->size, buf->payload, buf->len);
 		ctx->daddr += buf->len;
 		ctx->size += buf->len;
 		if (ctx->size - ctx->prevsize > PROGRESS_PRINT_STEP_BYTES) {
@@ -209,6 +212,19 @@ static err_t httpc_recv_cb(void *arg, struct altcp_pcb *pcb, struct pbuf *pbuf,
 	return ERR_OK;
 }
 
+static int wget_store_result(struct wget_ctx *ctx, ulong size)
+{
+	efi_set_bootdev("Net", "", ctx->path, map_sysmem(ctx->saved_daddr, 0),
+			size);
+	if (env_set_hex("filesize", size) ||
+	    env_set_hex("fileaddr", ctx->saved_daddr)) {
+		log_err("Could not set filesize or fileaddr\n");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 static void httpc_result_cb(void *arg, httpc_result_t httpc_result,
 			    u32_t rx_content_len, u32_t srv_res, err_t err)
 {
@@ -234,11 +250,8 @@ static void httpc_result_cb(void *arg, httpc_result_t httpc_result,
 	printf("%u bytes transferred in %lu ms (", rx_content_len, elapsed);
 	print_size(rx_content_len / elapsed * 1000, "/s)\n");
 	printf("Bytes transferred = %lu (%lx hex)\n", ctx->size, ctx->size);
-	efi_set_bootdev("Net", "", ctx->path, map_sysmem(ctx->saved_daddr, 0),
-			rx_content_len);
-	if (env_set_hex("filesize", rx_content_len) ||
-	    env_set_hex("fileaddr", ctx->saved_daddr)) {
-		log_err("Could not set filesize or fileaddr\n");
+	if (net_digest_finish(ctx->saved_daddr, ctx->size) ||
+	    wget_store_result(ctx, rx_content_len)) {
 		ctx->done = FAILURE;
 		return;
 	}
@@ -246,6 +259,543 @@ static void httpc_result_cb(void *arg, httpc_result_t httpc_result,
 	ctx->done = SUCCESS;
 }
 
+#if defined CONFIG_WGET_PARALLEL
+/*
+ * Parallel download using HTTP range requests
+ *
+ * The file is split into chunks of CONFIG_WGET_PARALLEL_CHUNK_SIZE bytes
+ * which are fetched over several TCP connections at once, each one writing
+ * straight to the chunk's offset in the destination buffer. A chunk whose
+ * connection fails is resumed from where it stopped, on any connection.
+ */
+
+#define WGET_RANGE_HDR_SIZE	1024
+#define WGET_RANGE_REQ_SIZE	(SERVER_NAME_SIZE + 1024)
+#define WGET_RANGE_RETRIES	3
+#define WGET_RANGE_TIMEOUT_MS	10000
+
+enum wget_range_state {
+	RANGE_PENDING,
+	RANGE_ACTIVE,
+	RANGE_DONE,
+};
+
+/**
+ * struct wget_range - one chunk of the file
+ *
+ * @offset: Offset of the next byte to fetch
+ * @end: Offset just past the last byte of the chunk
+ * @retries: Number of times the chunk was restarted
+ * @state: Download state
+ */
+struct wget_range {
+	ulong offset;
+	ulong end;
+	int retries;
+	enum wget_range_state state;
+};
+
+struct wget_pctx;
+
+/**
+ * struct wget_conn - one connection of a parallel download
+ *
+ * @pctx: Download this connection belongs to
+ * @pcb: TCP connection, NULL if idle
+ * @range: Chunk being fetched
+ * @hdr: Response header received so far
+ * @hdr_len: Number of bytes in @hdr
+ * @in_body: true once the response header was parsed
+ * @last_rx: Time of the last activity, for detecting stalls
+ * @start: Time the current request was issued
+ * @busy: Total time spent on requests in ms
+ * @bytes: Total number of body bytes received
+ */
+struct wget_conn {
+	struct wget_pctx *pctx;
+	struct altcp_pcb *pcb;
+	struct wget_range *range;
+	char hdr[WGET_RANGE_HDR_SIZE];
+	int hdr_len;
+	bool in_body;
+	ulong last_rx;
+	ulong start;
+	ulong busy;
+	ulong bytes;
+};
+
+/**
+ * struct wget_pctx - state of a parallel download
+ *
+ * @host: Server name, sent in the Host header
+ * @path: Path of the file
+ * @addr: Resolved server address
+ * @port: Server port
+ * @daddr: Destination address
+ * @total: File size, 0 until known
+ * @ranges: Chunks of the file
+ * @nranges: Number of chunks
+ * @conns: Connections
+ * @nconns: Number of connections
+ * @size: Number of bytes fetched so far
+ * @prevsize: Value of @size at the last progress mark
+ * @status: HTTP status of a failed request, 0 if none
+ * @err: Fatal error, stops the download
+ * @digest: Index of the first chunk which is not completely hashed
+ */
+struct wget_pctx {
+	const char *host;
+	const char *path;
+	ip_addr_t addr;
+	u16 port;
+	ulong daddr;
+	ulong total;
+	struct wget_range *ranges;
+	int nranges;
+	struct wget_conn *conns;
+	int nconns;
+	ulong size;
+	ulong prevsize;
+	int status;
+	int err;
+	int digest;
+};
+
+static void wget_conn_close(struct wget_conn *conn, bool failed)
+{
+	struct wget_range *range = conn->range;
+
+	if (conn->pcb) {
+		altcp_arg(conn->pcb, NULL);
+		altcp_recv(conn->pcb, NULL);
+		altcp_err(conn->pcb, NULL);
+		if (altcp_close(conn->pcb) != ERR_OK)
+			altcp_abort(conn->pcb);
+		conn->pcb = NULL;
+	}
+	if (!range)
+		return;
+
+	conn->busy += get_timer(conn->start);
+	conn->range = NULL;
+	if (range->offset == range->end) {
+		range->state = RANGE_DONE;
+		return;
+	}
+
+	range->state = RANGE_PENDING;
+	if (failed && ++range->retries > WGET_RANGE_RETRIES) {
+		log_err("\nRange %lx-%lx failed\n", range->offset,
+			range->end - 1);
+		conn->pctx->err = -EIO;
+	}
+}
+
+/*
+ * Parse the response header once complete. A 200 means that the server does
+ * not support ranges. Anything else other than a 206 with a Content-Range
+ * matching the request is treated as an error.
+ */
+static int wget_conn_parse_hdr(struct wget_conn *conn)
+{
+	struct wget_pctx *pctx = conn->pctx;
+	struct wget_range *range = conn->range;
+	ulong start, total;
+	char *p, *end;
+	int status;
+
+	end = strstr(conn->hdr, "\r\n\r\n");
+	if (!end)
+		return 0;
+	*end = '\0';
+
+	p = strchr(conn->hdr, ' ');
+	if (strncmp(conn->hdr, "HTTP/1.", 7) || !p)
+		return -EPROTO;
+	status = dectoul(p + 1, NULL);
+	if (status != 206) {
+		pctx->status = status;
+		if (status == 200)
+			return -EPROTONOSUPPORT;
+		log_err("\nHTTP server error %d\n", status);
+		return -EIO;
+	}
+
+	for (p = conn->hdr; (p = strstr(p, "\r\n")); ) {
+		p += 2;
+		if (!strncasecmp(p, "Content-Range: bytes ", 21))
+			break;
+	}
+	if (!p)
+		return -EPROTO;
+	start = simple_strtoul(p + 21, &p, 10);
+	p = strchr(p, '/');
+	if (start != range->offset || !p)
+		return -EPROTO;
+	total = simple_strtoul(p + 1, NULL, 10);
+	if (pctx->total && total != pctx->total)
+		return -EPROTO;
+	pctx->total = total;
+	conn->in_body = true;
+
+	return end + 4 - conn->hdr;
+}
+
+/**
+ * wget_pctx_store() - store received data in memory
+ *
+ * As with the legacy wget, this refuses to overwrite reserved memory
+ *
+ * @pctx: Download context
+ * @offset: Offset of the data within the file
+ * @data: Data to store
+ * @len: Length of the data in bytes
+ * Return: 0 if OK, -EACCES if the data would overwrite reserved memory
+ */
+static int wget_pctx_store(struct wget_pctx *pctx, ulong offset,
+			   const u8 *data, ulong len)
+{
+	ulong store_addr = pctx->daddr + offset;
+	void *ptr;
+
+	if (CONFIG_IS_ENABLED(LMB)) {
+		if (store_addr < pctx->daddr ||
+		    lmb_read_check(store_addr, len)) {
+			log_err("\nwget error: trying to overwrite reserved memory...\n");
+			return -EACCES;
+		}
+	}
+
+	ptr = map_sysmem(store_addr, len);
+	memcpy(ptr, data, len);
+	unmap_sysmem(ptr);
+	net_digest_update(offset, data, len);
+
+	return 0;
+}
+
+/*
+ * Data is hashed as it is received only when it continues the hash, i.e.
+ * for the first incomplete chunk. When that chunk completes, hash what has
+ * already arrived of the next one from memory, so that the rest of it is
+ * hashed as it is received.
+ */
+static void wget_pctx_digest(struct wget_pctx *pctx)
+{
+	struct wget_range *range;
+	const void *buf;
+	ulong start;
+
+	if (!CONFIG_IS_ENABLED(NET_DIGEST))
+		return;
+
+	while (pctx->digest < pctx->nranges) {
+		range = &pctx->ranges[pctx->digest];
+		if (range->offset != range->end)
+			break;
+		if (++pctx->digest == pctx->nranges)
+			break;
+
+		range++;
+		start = pctx->digest * CONFIG_WGET_PARALLEL_CHUNK_SIZE;
+		if (range->offset == start)
+			continue;
+		buf = map_sysmem(pctx->daddr + start, range->offset - start);
+		net_digest_update(start, buf, range->offset - start);
+		unmap_sysmem(buf);
+	}
+}
+
+static void wget_conn_data(struct wget_conn *conn, const u8 *data, int len)
+{
+	struct wget_pctx *pctx = conn->pctx;
+	struct wget_range *range = conn->range;
+	int used, ret;
+
+	conn->last_rx = get_timer(0);
+	if (!conn->in_body) {
+		used = min(len, WGET_RANGE_HDR_SIZE - 1 - conn->hdr_len);
+		memcpy(conn->hdr + conn->hdr_len, data, used);
+		conn->hdr[conn->hdr_len + used] = '\0';
+		ret = wget_conn_parse_hdr(conn);
+		if (ret < 0) {
+			pctx->err = ret;
+			return;
+		}
+		if (!ret) {
+			conn->hdr_len += used;
+			if (conn->hdr_len == WGET_RANGE_HDR_SIZE - 1)
+				pctx->err = -E2BIG;
+			return;
+		}
+		/* The body may start inside this segment */
+		used = ret - conn->hdr_len;
+		data += used;
+		len -= used;
+	}
+
+	len = min_t(ulong, len, range->end - range->offset);
+	ret = wget_pctx_store(pctx, range->offset, data, len);
+	if (ret) {
+		pctx->err = ret;
+		return;
+	}
+	range->offset += len;
+	if (range->offset == range->end)
+		wget_pctx_digest(pctx);
+	conn->bytes += len;
+	pctx->size += len;
+	if (pctx->size - pctx->prevsize > PROGRESS_PRINT_STEP_BYTES) {
+		printf("#");
+		pctx->prevsize = pctx->size;
+	}
+}
+
+static err_t wget_conn_recv(void *arg, struct altcp_pcb *pcb, struct pbuf *p,
+			    err_t err)
+{
+	struct wget_conn *conn = arg;
+	struct pbuf *q;
+
+	if (!p) {
+		/* The server closed the connection */
+		wget_conn_close(conn, true);
+		return ERR_OK;
+	}
+
+	for (q = p; q && conn->range && !conn->pctx->err; q = q->next)
+		wget_conn_data(conn, q->payload, q->len);
+	altcp_recved(pcb, p->tot_len);
+	pbuf_free(p);
+
+	if (conn->range && conn->range->offset == conn->range->end)
+		wget_conn_close(conn, false);
+
+	return ERR_OK;
+}
+
+static void wget_conn_err(void *arg, err_t err)
+{
+	struct wget_conn *conn = arg;
+
+	/* lwIP has already freed the pcb */
+	conn->pcb = NULL;
+	wget_conn_close(conn, true);
+}
+
+static err_t wget_conn_connected(void *arg, struct altcp_pcb *pcb, err_t err)
+{
+	struct wget_conn *conn = arg;
+	struct wget_pctx *pctx = conn->pctx;
+	char req[WGET_RANGE_REQ_SIZE];
+	int len;
+
+	len = snprintf(req, sizeof(req),
+		       "GET %s HTTP/1.1\r\n"
+		       "Host: %s\r\n"
+		       "User-Agent: U-Boot\r\n"
+		       "Range: bytes=%lu-%lu\r\n"
+		       "Connection: close\r\n\r\n",
+		       pctx->path, pctx->host, conn->range->offset,
+		       conn->range->end - 1);
+	if (len >= sizeof(req)) {
+		pctx->err = -ENAMETOOLONG;
+		return ERR_VAL;
+	}
+
+	err = altcp_write(pcb, req, len, TCP_WRITE_FLAG_COPY);
+	if (err == ERR_OK)
+		err = altcp_output(pcb);
+
+	return err;
+}
+
+static int wget_conn_start(struct wget_conn *conn, struct wget_range *range)
+{
+	struct altcp_pcb *pcb;
+
+	pcb = altcp_new(NULL);
+	if (!pcb)
+		return -ENOMEM;
+
+	conn->pcb = pcb;
+	conn->range = range;
+	conn->hdr_len = 0;
+	conn->in_body = false;
+	conn->start = get_timer(0);
+	conn->last_rx = conn->start;
+	range->state = RANGE_ACTIVE;
+
+	altcp_arg(pcb, conn);
+	altcp_recv(pcb, wget_conn_recv);
+	altcp_err(pcb, wget_conn_err);
+	if (altcp_connect(pcb, &conn->pctx->addr, conn->pctx->port,
+			  wget_conn_connected) != ERR_OK) {
+		wget_conn_close(conn, true);
+		return -ECONNREFUSED;
+	}
+
+	return 0;
+}
+
+/* Run the network until all connections are idle or an error occurs */
+static int wget_parallel_poll(struct udevice *udev, struct netif *netif,
+			      struct wget_pctx *pctx)
+{
+	struct wget_range *range = pctx->ranges;
+	struct wget_conn *conn;
+	bool busy, nomem;
+	int i, ret;
+
+	do {
+		busy = false;
+		nomem = false;
+		for (i = 0; i < pctx->nconns && !pctx->err; i++) {
+			conn = &pctx->conns[i];
+			if (conn->range &&
+			    get_timer(conn->last_rx) > WGET_RANGE_TIMEOUT_MS)
+				wget_conn_close(conn, true);
+			if (!conn->range) {
+				while (range < pctx->ranges + pctx->nranges &&
+				       range->state != RANGE_PENDING)
+					range++;
+				if (range == pctx->ranges + pctx->nranges)
+					range = pctx->ranges;
+				if (range->state == RANGE_PENDING) {
+					ret = wget_conn_start(conn, range);
+					/* Stay idle until a PCB is freed */
+					if (ret == -ENOMEM)
+						nomem = true;
+					else
+						pctx->err = ret;
+				}
+			}
+			if (conn->range)
+				busy = true;
+		}
+		if (nomem && !busy)
+			pctx->err = -ENOMEM;
+
+		net_lwip_rx(udev, netif);
+		sys_check_timeouts();
+		if (ctrlc()) {
+			pctx->err = -EINTR;
+			break;
+		}
+	} while (busy && !pctx->err);
+
+	for (i = 0; i < pctx->nconns; i++)
+		wget_conn_close(&pctx->conns[i], false);
+
+	return pctx->err;
+}
+
+static int wget_parallel_setup(struct wget_pctx *pctx)
+{
+	ulong chunk = CONFIG_WGET_PARALLEL_CHUNK_SIZE;
+	ulong offset;
+	int i;
+
+	pctx->nranges = DIV_ROUND_UP(pctx->total, chunk);
+	pctx->ranges = calloc(pctx->nranges, sizeof(*pctx->ranges));
+	if (!pctx->ranges)
+		return -ENOMEM;
+
+	for (i = 0, offset = 0; i < pctx->nranges; i++, offset += chunk) {
+		pctx->ranges[i].offset = offset;
+		pctx->ranges[i].end = min(offset + chunk, pctx->total);
+	}
+
+	/* The first byte was fetched by the probe */
+	pctx->ranges[0].offset = 1;
+	pctx->digest = 0;
+
+	return 0;
+}
+
+/**
+ * wget_parallel() - download a file using concurrent range requests
+ *
+ * @udev:	Ethernet device
+ * @netif:	lwIP network interface
+ * @ctx:	Download context, updated with the transfer size
+ * @host:	Server name
+ * @port:	Server port
+ * @nconns:	Number of connections to use
+ * Return: 0 on success, -EPROTONOSUPPORT if the server does not support
+ *	range requests, other -ve error otherwise
+ */
+static int wget_parallel(struct udevice *udev, struct netif *netif,
+			 struct wget_ctx *ctx, const char *host, u16 port,
+			 int nconns)
+{
+	struct wget_range probe = { .offset = 0, .end = 1 };
+	struct wget_pctx pctx = { };
+	ulong elapsed;
+	int ret, i;
+
+	pctx.host = host;
+	pctx.path = ctx->path;
+	pctx.port = port;
+	pctx.daddr = ctx->daddr;
+	pctx.nconns = nconns;
+	pctx.conns = calloc(nconns, sizeof(*pctx.conns));
+	if (!pctx.conns)
+		return -ENOMEM;
+	for (i = 0; i < nconns; i++)
+		pctx.conns[i].pctx = &pctx;
+
+	ret = net_lwip_dns_resolve(udev, netif, host, &pctx.addr);
+	if (ret)
+		goto out;
+
+	/* Fetch the first byte to learn the size and check range support */
+	pctx.ranges = &probe;
+	pctx.nranges = 1;
+	pctx.nconns = 1;
+	ret = wget_parallel_poll(udev, netif, &pctx);
+	pctx.nconns = nconns;
+	pctx.ranges = NULL;
+	if (ret)
+		goto out;
+	if (pctx.total <= 1) {
+		ctx->size = pctx.total;
+		goto out;
+	}
+
+	ret = wget_parallel_setup(&pctx);
+	if (ret)
+		goto out;
+
+	ctx->start_time = get_timer(0);
+	ret = wget_parallel_poll(udev, netif, &pctx);
+	if (ret)
+		goto out;
+
+	ctx->size = pctx.total;
+	elapsed = get_timer(ctx->start_time);
+	for (i = 0; i < nconns; i++) {
+		struct wget_conn *conn = &pctx.conns[i];
+
+		printf("\nconnection %d: %lu bytes in %lu ms (", i, conn->bytes,
+		       conn->busy);
+		print_size(conn->bytes / max(conn->busy, 1UL) * 1000, "/s)");
+	}
+	printf("\n%lu bytes transferred in %lu ms (", pctx.total, elapsed);
+	print_size(pctx.total / max(elapsed, 1UL) * 1000, "/s)\n");
+	printf("Bytes transferred = %lu (%lx hex)\n", pctx.total, pctx.total);
+
+out:
+	if (pctx.status)
+		debug("Server sent status %d to a range request\n",
+		      pctx.status);
+	free(pctx.ranges);
+	free(pctx.conns);
+
+	return ret;
+}
+#endif
+
 static int wget_loop(struct udevice *udev, ulong dst_addr, char *uri)
 {
 	char server_name[SERVER_NAME_SIZE];
@@ -259,6 +809,10 @@ static int wget_loop(struct udevice *udev, ulong dst_addr, char *uri)
 	char *path;
 	u16 port;
 	bool is_https;
+#if defined CONFIG_WGET_PARALLEL
+	int nconns;
+	int ret;
+#endif
 
 	ctx.daddr = dst_addr;
 	ctx.saved_daddr = dst_addr;
@@ -274,6 +828,40 @@ static int wget_loop(struct udevice *udev, ulong dst_addr, char *uri)
 	if (!netif)
 		return -1;
 
+	if (net_digest_start()) {
+		net_lwip_remove_netif(netif);
+		return -1;
+	}
+
+#if defined CONFIG_WGET_PARALLEL
+	/* Each connection needs a TCP PCB from lwIP's fixed pool */
+	nconns = min_t(ulong, env_get_ulong("wgetconns", 10, 1),
+		       MEMP_NUM_TCP_PCB);
+	if (nconns > 1 && !is_https) {
+		ctx.path = path;
+		ret = wget_parallel(udev, netif, &ctx, server_name, port,
+				    nconns);
+		if (!ret)
+			ret = net_digest_finish(ctx.saved_daddr, ctx.size);
+		if (!ret)
+			ret = wget_store_result(&ctx, ctx.size);
+		if (ret != -EPROTONOSUPPORT) {
+			if (ret)
+				net_digest_abort();
+			net_lwip_remove_netif(netif);
+			return ret ? -1 : 0;
+		}
+		printf("Server does not support ranges, using one connection\n");
+		ctx.size = 0;
+		ctx.prevsize = 0;
+		ctx.start_time = 0;
+		if (net_digest_start()) {
+			net_lwip_remove_netif(netif);
+			return -1;
+		}
+	}
+#endif
+
 	memset(&conn, 0, sizeof(conn));
 #if defined CONFIG_WGET_HTTPS
 	if (is_https) {
@@ -283,6 +871,7 @@ static int wget_loop(struct udevice *udev, ulong dst_addr, char *uri)
 
 		if (!tls_allocator.arg) {
 			log_err("error: Cannot create a TLS connection\n");
+			net_digest_abort();
 			net_lwip_remove_netif(netif);
 			return -1;
 		}
@@ -295,6 +884,7 @@ static int wget_loop(struct udevice *udev, ulong dst_addr, char *uri)
 	ctx.path = path;
 	if (httpc_get_file_dns(server_name, port, path, &conn, httpc_recv_cb,
 			       &ctx, &state)) {
+		net_digest_abort();
 		net_lwip_remove_netif(netif);
 		return CMD_RET_FAILURE;
 	}
@@ -310,6 +900,7 @@ static int wget_loop(struct udevice *udev, ulong dst_addr, char *uri)
 
 	if (ctx.done == SUCCESS)
 		return 0;
+	net_digest_abort();
 
 	return -1;
 }
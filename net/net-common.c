@@ -1,5 +1,15 @@
 // SPDX-License-Identifier: GPL-2.0
 
+#include <env.h>
+#include <hash.h>
+#include <log.h>
+#include <mapmem.h>
+#include <net-common.h>
+#include <stdio.h>
+#include <vsprintf.h>
+#include <linux/ctype.h>
+#include <linux/errno.h>
+
 void copy_filename(char *dst, const char *src, int size)
 {
 	if (src && *src && (*src == '"')) {
@@ -11,3 +21,151 @@ void copy_filename(char *dst, const char *src, int size)
 		*dst++ = *src++;
 	*dst = '\0';
 }
+
+#if CONFIG_IS_ENABLED(NET_DIGEST)
+/**
+ * struct net_digest - state of the hash of a running download
+ *
+ * @algo: Hash algorithm, NULL if no digest was requested
+ * @ctx: Progressive hash context
+ * @offset: Number of bytes hashed so far
+ * @check: true to compare the result with @expected
+ * @err: Error from the hash algorithm, reported by net_digest_finish()
+ * @expected: Expected digest
+ */
+static struct net_digest {
+	struct hash_algo *algo;
+	void *ctx;
+	ulong offset;
+	bool check;
+	int err;
+	u8 expected[HASH_MAX_DIGEST_SIZE];
+} net_digest;
+
+void net_digest_abort(void)
+{
+	struct net_digest *nd = &net_digest;
+	u8 digest[HASH_MAX_DIGEST_SIZE];
+
+	/* Finishing the hash frees its context */
+	if (nd->algo && !nd->err)
+		nd->algo->hash_finish(nd->algo, nd->ctx, digest,
+				      sizeof(digest));
+	memset(nd, '\0', sizeof(*nd));
+}
+
+int net_digest_start(void)
+{
+	struct net_digest *nd = &net_digest;
+	char name[16];
+	const char *arg, *hex;
+	int ret, len, i;
+
+	net_digest_abort();
+
+	arg = env_get("netdigest");
+	if (!arg || !*arg)
+		return 0;
+
+	hex = strchr(arg, ':');
+	len = hex ? hex - arg : strlen(arg);
+	if (len >= sizeof(name))
+		return -EPROTONOSUPPORT;
+	strlcpy(name, arg, len + 1);
+
+	ret = hash_progressive_lookup_algo(name, &nd->algo);
+	if (ret) {
+		log_err("Unknown digest algorithm '%s'\n", name);
+		return ret;
+	}
+
+	if (hex) {
+		hex++;
+		if (strlen(hex) != nd->algo->digest_size * 2)
+			goto err_digest;
+		for (i = 0; hex[i]; i++) {
+			if (!isxdigit(hex[i]))
+				goto err_digest;
+		}
+		hash_parse_string(name, hex, nd->expected);
+		nd->check = true;
+	}
+
+	if (nd->algo->hash_init(nd->algo, &nd->ctx)) {
+		nd->algo = NULL;
+		return -ENOMEM;
+	}
+
+	return 0;
+
+err_digest:
+	log_err("Invalid %s digest '%s'\n", name, hex);
+	nd->algo = NULL;
+
+	return -EINVAL;
+}
+
+void net_digest_update(ulong offset, const void *data, ulong len)
+{
+	struct net_digest *nd = &net_digest;
+	ulong skip;
+
+	if (!nd->algo || nd->err)
+		return;
+
+	/* Skip retransmitted data and leave gaps for net_digest_finish() */
+	if (offset > nd->offset || offset + len <= nd->offset)
+		return;
+
+	skip = nd->offset - offset;
+	if (nd->algo->hash_update(nd->algo, nd->ctx, data + skip, len - skip,
+				  0)) {
+		/* The context was freed by the algorithm */
+		nd->err = -EIO;
+		return;
+	}
+	nd->offset += len - skip;
+}
+
+int net_digest_finish(ulong addr, ulong size)
+{
+	struct net_digest *nd = &net_digest;
+	struct hash_algo *algo = nd->algo;
+	u8 digest[HASH_MAX_DIGEST_SIZE];
+	char str[HASH_MAX_DIGEST_SIZE * 2 + 1];
+	const void *buf;
+	int ret, i;
+
+	if (!algo)
+		return 0;
+	nd->algo = NULL;
+	if (nd->err)
+		return nd->err;
+
+	if (nd->offset < size) {
+		log_debug("Hashing %lx bytes received out of order\n",
+			  size - nd->offset);
+		buf = map_sysmem(addr + nd->offset, size - nd->offset);
+		ret = algo->hash_update(algo, nd->ctx, buf, size - nd->offset,
+					0);
+		unmap_sysmem(buf);
+		if (ret)
+			return -EIO;
+	}
+
+	ret = algo->hash_finish(algo, nd->ctx, digest, sizeof(digest));
+	if (ret)
+		return ret;
+
+	for (i = 0; i < algo->digest_size; i++)
+		sprintf(str + 2 * i, "%02x", digest[i]);
+	env_set("netdigestvalue", str);
+
+	if (nd->check && memcmp(digest, nd->expected, algo->digest_size)) {
+		printf("%s digest mismatch: got %s\n", algo->name, str);
+		return -EILSEQ;
+	}
+
+	return 0;
+}
+#endif
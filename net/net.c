@@ -395,6 +395,8 @@ static void net_clear_handlers(void)
 static void net_cleanup_loop(void)
 {
 	net_clear_handlers();
+	if (IS_ENABLED(CONFIG_PROT_TCP))
+		tcp_set_rx_window(0);
 }
 
 int net_init(void)
@@ -661,6 +663,7 @@ restart:
 			net_arp_wait_packet_ip.s_addr = 0;
 
 			net_cleanup_loop();
+			net_digest_abort();
 			eth_halt();
 			/* Invalidate the last protocol */
 			eth_set_last_protocol(BOOTP);
@@ -741,6 +744,7 @@ restart:
 
 		case NETLOOP_FAIL:
 			net_cleanup_loop();
+			net_digest_abort();
 			/* Invalidate the last protocol */
 			eth_set_last_protocol(BOOTP);
 			debug_cond(DEBUG_INT_STATE, "--- net_loop Fail!\n");
@@ -1410,35 +1414,20 @@ void net_process_received_packet(uchar *in_packet, int len)
 			   &dst_ip, &src_ip, len);
 
 		if (IS_ENABLED(CONFIG_UDP_CHECKSUM) && ip->udp_xsum != 0) {
-			ulong   xsum;
-			u8 *sumptr;
-			ushort  sumlen;
-
-			xsum  = ip->ip_p;
-			xsum += (ntohs(ip->udp_len));
-			xsum += (ntohl(ip->ip_src.s_addr) >> 16) & 0x0000ffff;
-			xsum += (ntohl(ip->ip_src.s_addr) >>  0) & 0x0000ffff;
-			xsum += (ntohl(ip->ip_dst.s_addr) >> 16) & 0x0000ffff;
-			xsum += (ntohl(ip->ip_dst.s_addr) >>  0) & 0x0000ffff;
-
-			sumlen = ntohs(ip->udp_len);
-			sumptr = (u8 *)&ip->udp_src;
-
-			while (sumlen > 1) {
-				/* inlined ntohs() to avoid alignment errors */
-				xsum += (sumptr[0] << 8) + sumptr[1];
-				sumptr += 2;
-				sumlen -= 2;
-			}
-			if (sumlen > 0)
-				xsum += (sumptr[0] << 8) + sumptr[0];
-			while ((xsum >> 16) != 0) {
-				xsum = (xsum & 0x0000ffff) +
-				       ((xsum >> 16) & 0x0000ffff);
-			}
-			if ((xsum != 0x00000000) && (xsum != 0x0000ffff)) {
-				printf(" UDP wrong checksum %08lx %08x\n",
-				       xsum, ntohs(ip->udp_xsum));
+			uint csum;
+			u64 sum;
+
+			/* Pseudo-header: addresses, protocol and UDP length */
+			sum = ip_checksum_partial(0, &ip->ip_src,
+						  2 * sizeof(struct in_addr));
+			sum += htons(IPPROTO_UDP);
+			sum += ip->udp_len;
+			sum = ip_checksum_partial(sum, &ip->udp_src,
+						  ntohs(ip->udp_len));
+			csum = ip_checksum_fold(sum);
+			if (csum) {
+				printf(" UDP wrong checksum %04x %04x\n",
+				       csum, ntohs(ip->udp_xsum));
 				return;
 			}
 		}
@@ -36,6 +36,13 @@ static u32 rmt_timestamp;
 static u32 tcp_seq_init;
 static u32 tcp_ack_edge;
 
+/* Receive window, 0 selects the default based on the RX buffer count */
+static u32 tcp_rx_window;
+/* Shift applied to the advertised receive window */
+static u8 tcp_rcv_scale = TCP_SCALE;
+/* Peer sent a window scale option in its SYN */
+static bool tcp_rmt_scale_ok;
+
 static int tcp_activity_count;
 
 /*
@@ -108,6 +115,22 @@ void tcp_set_tcp_handler(rxhand_tcp *f)
 		tcp_packet_handler = f;
 }
 
+/**
+ * tcp_set_rx_window() - set the receive window advertised to the peer
+ * @size: window size in bytes, or 0 to restore the default
+ */
+void tcp_set_rx_window(u32 size)
+{
+	tcp_rx_window = size;
+}
+
+static u16 tcp_get_rx_window(void)
+{
+	u32 win = tcp_rx_window ? tcp_rx_window : PKTBUFSRX * TCP_MSS;
+
+	return min_t(u32, win >> tcp_rcv_scale, 0xffff);
+}
+
 /**
  * tcp_set_pseudo_header() - set TCP pseudo header
  * @pkt: the packet
@@ -234,6 +257,52 @@ void net_set_syn_options(union tcp_build_pkt *b)
 	b->ip.t_opt.t_snd = 0;
 	b->ip.t_opt.t_rcv = 0;
 	b->ip.end = TCP_O_END;
+	tcp_rcv_scale = TCP_SCALE;
+}
+
+/**
+ * net_set_synack_options() - set TCP options in SYN ACK packets
+ * @b: the packet
+ *
+ * Answer a passive open with our MSS and, if the peer offered window
+ * scaling, a shift large enough to advertise the whole receive window.
+ * SACK is not offered as out-of-order segments are not kept.
+ */
+static void net_set_synack_options(union tcp_build_pkt *b)
+{
+	u32 win = tcp_rx_window ? tcp_rx_window : PKTBUFSRX * TCP_MSS;
+
+	if (IS_ENABLED(CONFIG_PROT_TCP_SACK))
+		tcp_lost.len = 0;
+
+	tcp_rcv_scale = 0;
+	if (tcp_rmt_scale_ok) {
+		while ((win >> tcp_rcv_scale) > 0xffff && tcp_rcv_scale < 14)
+			tcp_rcv_scale++;
+	}
+
+	b->ip.hdr.tcp_hlen = 0xa0;
+
+	b->ip.mss.kind = TCP_O_MSS;
+	b->ip.mss.len = TCP_OPT_LEN_4;
+	b->ip.mss.mss = htons(TCP_MSS);
+	if (tcp_rmt_scale_ok) {
+		b->ip.scale.kind = TCP_O_SCL;
+		b->ip.scale.len = TCP_OPT_LEN_3;
+		b->ip.scale.scale = tcp_rcv_scale;
+	} else {
+		b->ip.scale.kind = TCP_1_NOP;
+		b->ip.scale.len = TCP_1_NOP;
+		b->ip.scale.scale = TCP_1_NOP;
+	}
+	b->ip.sack_p.kind = TCP_1_NOP;
+	b->ip.sack_p.len = TCP_1_NOP;
+	b->ip.t_opt.kind = TCP_O_TS;
+	b->ip.t_opt.len = TCP_OPT_LEN_A;
+	loc_timestamp = get_ticks();
+	b->ip.t_opt.t_snd = htons(loc_timestamp);
+	b->ip.t_opt.t_rcv = rmt_timestamp;
+	b->ip.end = TCP_O_END;
 }
 
 int tcp_set_tcp_header(uchar *pkt, int dport, int sport, int payload_len,
@@ -271,6 +340,14 @@ int tcp_set_tcp_header(uchar *pkt, int dport, int sport, int payload_len,
 		}
 		break;
 	case TCP_SYN | TCP_ACK:
+		net_set_synack_options(b);
+		pkt_hdr_len = IP_TCP_O_SIZE;
+		b->ip.hdr.tcp_flags = action;
+		debug_cond(DEBUG_DEV_PKT,
+			   "TCP Hdr:SYN ACK (%pI4, %pI4, s=%u, a=%u, scale=%u)\n",
+			   &net_server_ip, &net_ip, tcp_seq_num, tcp_ack_num,
+			   tcp_rcv_scale);
+		break;
 	case TCP_ACK:
 		pkt_hdr_len = IP_HDR_SIZE + net_set_ack_options(b);
 		b->ip.hdr.tcp_flags = action;
@@ -339,7 +416,7 @@ int tcp_set_tcp_header(uchar *pkt, int dport, int sport, int payload_len,
 	 * it is, then the u-boot tftp or nfs kernel netboot should be
 	 * considered.
 	 */
-	b->ip.hdr.tcp_win = htons(PKTBUFSRX * TCP_MSS >> TCP_SCALE);
+	b->ip.hdr.tcp_win = htons(tcp_get_rx_window());
 
 	b->ip.hdr.tcp_xsum = 0;
 	b->ip.hdr.tcp_ugr = 0;
@@ -469,33 +546,33 @@ void tcp_hole(u32 tcp_seq_num, u32 len)
 void tcp_parse_options(uchar *o, int o_len)
 {
 	struct tcp_t_opt  *tsopt;
+	uchar *end = o + o_len;
 	uchar *p = o;
 
 	/*
-	 * NOPs are options with a zero length, and thus are special.
-	 * All other options have length fields.
+	 * NOPs and the end marker are single bytes. All other options
+	 * have a length field which covers the kind and length bytes.
 	 */
-	for (p = o; p < (o + o_len); p = p + p[1]) {
-		if (!p[1])
-			return; /* Finished processing options */
+	while (p < end) {
+		if (p[0] == TCP_O_END)
+			return;
+		if (p[0] == TCP_1_NOP) {
+			p++;
+			continue;
+		}
+		if (p + 1 >= end || p[1] < TCP_OPT_LEN_2 || p + p[1] > end)
+			return; /* Malformed option list */
 
 		switch (p[0]) {
-		case TCP_O_END:
-			return;
-		case TCP_O_MSS:
 		case TCP_O_SCL:
-		case TCP_P_SACK:
-		case TCP_V_SACK:
+			tcp_rmt_scale_ok = true;
 			break;
 		case TCP_O_TS:
 			tsopt = (struct tcp_t_opt *)p;
 			rmt_timestamp = tsopt->t_snd;
-			return;
+			break;
 		}
-
-		/* Process optional NOPs */
-		if (p[0] == TCP_O_NOP)
-			p++;
+		p += p[1];
 	}
 }
 
@@ -672,6 +749,8 @@ void rxhand_tcp_f(union tcp_build_pkt *b, unsigned int pkt_len)
 	tcp_hdr_len = GET_TCP_HDR_LEN_IN_BYTES(b->ip.hdr.tcp_hlen);
 	payload_len = tcp_len - tcp_hdr_len;
 
+	if (b->ip.hdr.tcp_flags & TCP_SYN)
+		tcp_rmt_scale_ok = false;
 	if (tcp_hdr_len > TCP_HDR_SIZE)
 		tcp_parse_options((uchar *)b + IP_TCP_HDR_SIZE,
 				  tcp_hdr_len - TCP_HDR_SIZE);
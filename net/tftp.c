@@ -170,6 +170,7 @@ static inline int store_block(int block, uchar *src, unsigned int len)
 	ptr = map_sysmem(store_addr, len);
 	memcpy(ptr, src, len);
 	unmap_sysmem(ptr);
+	net_digest_update(offset, src, len);
 
 	if (net_boot_file_size < newsize)
 		net_boot_file_size = newsize;
@@ -299,6 +300,12 @@ static void tftp_complete(void)
 
 	led_activity_off();
 
+	if (!tftp_put_active &&
+	    net_digest_finish(tftp_load_addr, net_boot_file_size)) {
+		net_set_state(NETLOOP_FAIL);
+		return;
+	}
+
 	if (!tftp_put_active)
 		efi_set_bootdev("Net", "", tftp_filename,
 				map_sysmem(tftp_load_addr, 0),
@@ -905,6 +912,11 @@ void tftp_start(enum proto_t protocol)
 			puts("trying to overwrite reserved memory...\n");
 			return;
 		}
+		if (net_digest_start()) {
+			eth_halt();
+			net_set_state(NETLOOP_FAIL);
+			return;
+		}
 		printf("Load address: 0x%lx\n", tftp_load_addr);
 		puts("Loading: *\b");
 		tftp_state = STATE_SEND_RRQ;
@@ -87,6 +87,7 @@ static inline int store_block(uchar *src, unsigned int offset, unsigned int len)
 	ptr = map_sysmem(store_addr, len);
 	memcpy(ptr, src, len);
 	unmap_sysmem(ptr);
+	net_digest_update(offset, src, len);
 
 	if (net_boot_file_size < (offset + len))
 		net_boot_file_size = newsize;
@@ -383,6 +384,9 @@ static void wget_handler(uchar *pkt, u16 dport,
 		break;
 	case WGET_TRANSFERRED:
 		printf("Packets received %d, Transfer Successful\n", packets);
+		if (wget_loop_state == NETLOOP_SUCCESS &&
+		    net_digest_finish(image_load_addr, net_boot_file_size))
+			wget_loop_state = NETLOOP_FAIL;
 		net_set_state(wget_loop_state);
 		efi_set_bootdev("Net", "", image_url,
 				map_sysmem(image_load_addr, 0),
@@ -455,6 +459,11 @@ void wget_start(void)
 	wget_timeout_count = 0;
 	current_wget_state = WGET_CLOSED;
 
+	if (net_digest_start()) {
+		net_set_state(NETLOOP_FAIL);
+		return;
+	}
+
 	our_port = random_port();
 
 	/*
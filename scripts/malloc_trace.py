@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0+
+
+"""Summarise the output of the 'malloc trace' command by call site
+
+The trace is read from a console log containing the output of 'malloc trace'.
+For each call site this shows the number of calls, the bytes requested, the
+bytes still allocated at the end of the trace and the bytes allocated at the
+point of peak usage. If a U-Boot ELF file is given, call sites are shown as
+function names and source locations.
+"""
+
+from argparse import ArgumentParser
+import collections
+import os
+import re
+import sys
+
+our_path = os.path.dirname(os.path.realpath(__file__))
+src_path = os.path.dirname(our_path)
+
+sys.path.insert(1, os.path.join(our_path, '../tools'))
+
+# Each record looks like this (time, call, caller, pointer, size):
+#      123456  malloc    0000000000040a3c  0000000013b86c40  232
+RE_REC = re.compile(r'^\s*(\d+)\s+(malloc|calloc|realloc|memalign|free)\s+'
+                    r'([0-9a-f]+)\s+([0-9a-f]+)\s+(\d+)\s*$')
+RE_END = re.compile(r'^(\d+) records, (\d+) dropped')
+
+SORT_KEYS = ['calls', 'bytes', 'live', 'peak']
+
+class Site:
+    """Information about allocations made from one call site
+
+    Properties:
+        addr (int): Address of the call site
+        calls (int): Number of calls which allocated memory
+        frees (int): Number of allocations which were freed
+        failed (int): Number of calls which returned NULL
+        bytes (int): Total bytes requested
+        live (int): Bytes currently allocated
+        peak (int): Bytes allocated at the point of peak total usage
+    """
+    def __init__(self, addr):
+        self.addr = addr
+        self.calls = 0
+        self.frees = 0
+        self.failed = 0
+        self.bytes = 0
+        self.live = 0
+        self.peak = 0
+
+
+def read_trace(fname):
+    """Read the trace records from a console log
+
+    Args:
+        fname (str): Filename of log, or '-' for stdin
+
+    Returns:
+        tuple:
+            list of tuple: Records, each (time, call, caller, ptr, size)
+            int: Number of records dropped from the start of the trace
+    """
+    recs = []
+    dropped = 0
+    with sys.stdin if fname == '-' else open(fname, encoding='utf-8',
+                                              errors='replace') as inf:
+        for line in inf:
+            m_rec = RE_REC.match(line)
+            if m_rec:
+                time, call, caller, ptr, size = m_rec.groups()
+                recs.append((int(time), call, int(caller, 16), int(ptr, 16),
+                             int(size)))
+                continue
+            m_end = RE_END.match(line)
+            if m_end:
+                dropped = int(m_end.group(2))
+    return recs, dropped
+
+def process(recs):
+    """Work out the allocations made from each call site
+
+    Args:
+        recs (list of tuple): Records, each (time, call, caller, ptr, size)
+
+    Returns:
+        tuple:
+            dict: Sites, key is address, value is Site
+            int: Peak bytes allocated
+            int: Number of free() calls for pointers not allocated in the trace
+    """
+    sites = collections.OrderedDict()
+    live = {}
+    in_use = 0
+    peak = 0
+    peak_live = {}
+    unknown = 0
+    for _, call, caller, ptr, size in recs:
+        if call == 'free':
+            if ptr not in live:
+                unknown += 1
+                continue
+            owner, old_size = live.pop(ptr)
+            owner.frees += 1
+            owner.live -= old_size
+            in_use -= old_size
+            continue
+
+        site = sites.get(caller)
+        if not site:
+            site = Site(caller)
+            sites[caller] = site
+        site.calls += 1
+        if not ptr:
+            site.failed += 1
+            continue
+        site.bytes += size
+        site.live += size
+        live[ptr] = (site, size)
+        in_use += size
+
+        # Record which sites contribute to the peak, when it is reached
+        if in_use > peak:
+            peak = in_use
+            peak_live = {addr: s.live for addr, s in sites.items() if s.live}
+    for addr, size in peak_live.items():
+        sites[addr].peak = size
+    return sites, peak, unknown
+
+def lookup_sites(fname, sites):
+    """Find the function and source location for each call site
+
+    Args:
+        fname (str): Filename of U-Boot ELF file
+        sites (dict): Sites, key is address, value is Site
+
+    Returns:
+        dict: key is address, value is str describing the call site
+    """
+    from u_boot_pylib import tools
+
+    addrs = list(sites.keys())
+    out = tools.run('addr2line', '-f', '-e', fname,
+                    *['%x' % addr for addr in addrs])
+    lines = out.splitlines()
+    names = {}
+    for i, addr in enumerate(addrs):
+        func, loc = lines[i * 2:i * 2 + 2]
+
+        # Drop the full path if it is the source directory
+        if loc.startswith(src_path):
+            loc = loc[len(src_path) + 1:]
+        names[addr] = '%s %s' % (func, loc)
+    return names
+
+def show_sites(sites, peak, names, sort_key, count):
+    """Show a table of call sites
+
+    Args:
+        sites (dict): Sites, key is address, value is Site
+        peak (int): Peak bytes allocated
+        names (dict): key is address, value is str describing the call site
+        sort_key (str): Property of Site to sort by, largest first
+        count (int): Number of sites to show, 0 for all
+    """
+    todo = sorted(sites.values(), key=lambda s: getattr(s, sort_key),
+                  reverse=True)
+    if count:
+        todo = todo[:count]
+    print('%7s  %7s  %10s  %10s  %10s  %s' %
+          ('Calls', 'Frees', 'Bytes', 'Live', 'At peak', 'Call site'))
+    print('%7s  %7s  %10s  %10s  %10s  %s' %
+          ('-' * 7, '-' * 7, '-' * 10, '-' * 10, '-' * 10, '-' * 30))
+    for site in todo:
+        print('%7d  %7d  %10d  %10d  %10d  %s' %
+              (site.calls, site.frees, site.bytes, site.live, site.peak,
+               names.get(site.addr, '%x' % site.addr)))
+    print('Peak: %d bytes' % peak)
+
+def main(argv):
+    """Main program
+
+    Args:
+        argv (list of str): List of program arguments, excluding arvg[0]
+    """
+    epilog = "Summarise the output of 'malloc trace' by call site"
+    parser = ArgumentParser(epilog=epilog)
+    parser.add_argument('log', type=str,
+                        help="Console log with 'malloc trace' output, or -")
+    parser.add_argument('-e', '--elf', type=str,
+                        help='U-Boot ELF file, to show function names')
+    parser.add_argument('-n', '--count', type=int, default=20,
+                        help='Number of call sites to show (0 for all)')
+    parser.add_argument('-s', '--sort', type=str, default='peak',
+                        choices=SORT_KEYS,
+                        help='Sort by this column, largest first')
+    args = parser.parse_args(argv)
+
+    recs, dropped = read_trace(args.log)
+    if not recs:
+        print('No trace records found', file=sys.stderr)
+        return 1
+    sites, peak, unknown = process(recs)
+    names = lookup_sites(args.elf, sites) if args.elf else {}
+    show_sites(sites, peak, names, args.sort, args.count)
+    if dropped or unknown:
+        print('Warning: %d records dropped, %d frees of unknown pointers' %
+              (dropped, unknown))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -12,6 +12,7 @@
 #include <bootflow.h>
 #include <mapmem.h>
 #include <os.h>
+#include <dm/uclass-internal.h>
 #include <test/suites.h>
 #include <test/ut.h>
 #include "bootstd_common.h"
@@ -559,6 +560,75 @@ static int bootdev_test_hunt_prio(struct unit_test_state *uts)
 }
 BOOTSTD_TEST(bootdev_test_hunt_prio, UTF_DM | UTF_SCAN_FDT | UTF_CONSOLE);
 
+/* Check starting a hunter early and completing it later */
+static int bootdev_test_hunt_start(struct unit_test_state *uts)
+{
+	struct bootstd_priv *std;
+	struct udevice *bus, *hub;
+
+	bootstd_reset_usb();
+	ut_assertok(bootstd_get_priv(&std));
+
+	/*
+	 * only the USB hunter can be started, which probes the controller and
+	 * powers up the root hub
+	 */
+	ut_assertok(bootdev_hunt_start(true));
+	ut_assert_nextline("Starting hunter: usb");
+	ut_assert_console_end();
+	ut_asserteq(BIT(USB_HUNTER), std->hunters_started);
+	ut_asserteq(0, std->hunters_used);
+	ut_assertok(uclass_find_first_device(UCLASS_USB, &bus));
+	ut_assertnonnull(bus);
+	ut_assert(device_active(bus));
+	ut_assertok(device_find_first_child_by_uclass(bus, UCLASS_USB_HUB,
+						      &hub));
+	ut_assert(device_active(hub));
+
+	/* its ports are not scanned yet */
+	ut_asserteq(0, device_get_child_count(hub));
+
+	/* starting again does nothing */
+	ut_assertok(bootdev_hunt_start(true));
+	ut_assert_console_end();
+
+	/* stopping an unused hunter removes the controller again */
+	bootdev_hunt_stop();
+	ut_asserteq(0, std->hunters_started);
+	ut_asserteq(0, std->hunters_used);
+	ut_assert(!device_active(bus));
+	ut_assert_console_end();
+
+	ut_assertok(bootdev_hunt_start(true));
+	ut_assert_nextline("Starting hunter: usb");
+	ut_assert_console_end();
+	ut_assert(device_active(bus));
+
+	/* the hunt completes the job, with the same output as usual */
+	ut_assertok(bootdev_hunt("usb", true));
+	ut_assert_nextline("Hunting with: usb");
+	ut_assert_nextline(
+		"Bus usb@1: scanning bus usb@1 for devices... 5 USB Device(s) found");
+	ut_assert_console_end();
+	ut_asserteq(BIT(USB_HUNTER), std->hunters_used);
+	ut_asserteq(0, std->hunters_started);
+	ut_assert(std->hunt_stats[USB_HUNTER].total_us >=
+		  std->hunt_stats[USB_HUNTER].busy_us);
+
+	bootdev_list_hunt_times(std, BIT(USB_HUNTER));
+	ut_assert_nextline("Hunter           Busy ms  Total ms");
+	ut_assert_nextline("---------------  -------  --------");
+	ut_assert_nextlinen("usb  ");
+	ut_assert_console_end();
+
+	/* a used hunter is left alone */
+	bootdev_hunt_stop();
+	ut_assert(device_active(bus));
+
+	return 0;
+}
+BOOTSTD_TEST(bootdev_test_hunt_start, UTF_DM | UTF_SCAN_FDT | UTF_CONSOLE);
+
 /* Check hunting for bootdevs with a particular label */
 static int bootdev_test_hunt_label(struct unit_test_state *uts)
 {
@@ -14,6 +14,7 @@
 #include <dm.h>
 #include <efi.h>
 #include <efi_loader.h>
+#include <env.h>
 #include <expo.h>
 #ifdef CONFIG_SANDBOX
 #include <asm/test.h>
@@ -704,6 +705,10 @@ static int bootflow_scan_menu(struct unit_test_state *uts)
 	ut_assert_skip_to_line("No more bootdevs");
 	ut_assert_nextlinen("--");
 	ut_assert_nextline("(2 bootflows, 2 valid)");
+	ut_assert_nextline("Hunter           Busy ms  Total ms");
+	ut_assert_nextlinen("---");
+	ut_assert_nextlinen("simple_bus  ");
+	ut_assert_nextlinen("mmc  ");
 
 	ut_assert_nextline("Selected: Armbian");
 	ut_assertnonnull(std->cur_bootflow);
@@ -749,6 +754,10 @@ static int bootflow_scan_menu_boot(struct unit_test_state *uts)
 	std->bootdev_order = old_order;
 
 	ut_assert_skip_to_line("(2 bootflows, 2 valid)");
+	ut_assert_nextline("Hunter           Busy ms  Total ms");
+	ut_assert_nextlinen("---");
+	ut_assert_nextlinen("simple_bus  ");
+	ut_assert_nextlinen("mmc  ");
 
 	ut_assert_nextline("Selected: Armbian");
 
@@ -786,6 +795,10 @@ static int bootflow_cmd_hunt_single(struct unit_test_state *uts)
 	ut_assertok(run_command("bootflow scan -l mmc1", 0));
 	ut_assert_nextline("Scanning for bootflows with label 'mmc1'");
 	ut_assert_skip_to_line("(1 bootflow, 1 valid)");
+	ut_assert_nextline("Hunter           Busy ms  Total ms");
+	ut_assert_nextlinen("---");
+	ut_assert_nextlinen("simple_bus  ");
+	ut_assert_nextlinen("mmc  ");
 	ut_assert_console_end();
 
 	/* check that the hunter was used */
@@ -826,12 +839,85 @@ static int bootflow_cmd_hunt_label(struct unit_test_state *uts)
 		"  0  extlinux     ready   mmc          1  mmc1.bootdev.part_1       /extlinux/extlinux.conf");
 	ut_assert_nextline("Scanning bootdev 'mmc0.bootdev':");
 	ut_assert_skip_to_line("(1 bootflow, 1 valid)");
+	ut_assert_nextline("Hunter           Busy ms  Total ms");
+	ut_assert_nextlinen("---");
+	ut_assert_nextlinen("simple_bus  ");
+	ut_assert_nextlinen("mmc  ");
 	ut_assert_console_end();
 
 	return 0;
 }
 BOOTSTD_TEST(bootflow_cmd_hunt_label, UTF_DM | UTF_SCAN_FDT | UTF_CONSOLE);
 
+/* Check remembering a bootflow and finding it again */
+static int bootflow_cache(struct unit_test_state *uts)
+{
+	struct bootflow bflow, found;
+	struct bootflow_iter iter;
+	char expect[80], rec[80];
+	ulong scan_ms;
+
+	if (!IS_ENABLED(CONFIG_BOOTFLOW_CACHE))
+		return -EAGAIN;
+
+	ut_assertok(bootflow_scan_first(NULL, "mmc1", &iter, 0, &bflow));
+	bootflow_iter_uninit(&iter);
+	ut_asserteq_str("mmc1.bootdev.part_1", bflow.name);
+
+	/* nothing is cached yet */
+	bootflow_cache_clear();
+	ut_asserteq(-ENOENT, bootflow_cache_find(&iter, &found, NULL));
+	bootflow_iter_uninit(&iter);
+
+	ut_assertok(bootflow_cache_save(&bflow, 123));
+	snprintf(expect, sizeof(expect),
+		 "123 mmc mmc1.bootdev 1 extlinux %d /extlinux/extlinux.conf",
+		 bflow.size);
+	ut_asserteq_str(expect, env_get("bootflow_cache"));
+
+	/* the scan time of the first record is kept */
+	ut_assertok(bootflow_cache_save(&bflow, 456));
+	ut_asserteq_str(expect, env_get("bootflow_cache"));
+
+	ut_assertok(bootflow_cache_find(&iter, &found, &scan_ms));
+	bootflow_iter_uninit(&iter);
+	ut_asserteq(123, scan_ms);
+	ut_asserteq_str(bflow.name, found.name);
+	ut_asserteq_str("extlinux", found.method->name);
+	ut_asserteq(bflow.size, found.size);
+	bootflow_free(&found);
+
+	/* a different size means that the bootflow has changed */
+	snprintf(rec, sizeof(rec),
+		 "123 mmc mmc1.bootdev 1 extlinux %d /extlinux/extlinux.conf",
+		 bflow.size + 1);
+	ut_assertok(env_set("bootflow_cache", rec));
+	ut_asserteq(-ESTALE, bootflow_cache_find(&iter, &found, NULL));
+	bootflow_iter_uninit(&iter);
+
+	/* the bootmeth must provide a bootflow */
+	ut_assertok(env_set("bootflow_cache",
+			    "0 - mmc1.bootdev 1 nosuchmeth 10 /boot/boot.scr"));
+	ut_asserteq(-ENOENT, bootflow_cache_find(&iter, &found, NULL));
+	bootflow_iter_uninit(&iter);
+
+	ut_assertok(env_set("bootflow_cache",
+			    "0 - mmc9.bootdev 1 extlinux 10 /extlinux/extlinux.conf"));
+	ut_asserteq(-ENODEV, bootflow_cache_find(&iter, &found, NULL));
+	bootflow_iter_uninit(&iter);
+
+	ut_assertok(env_set("bootflow_cache", "0 mmc mmc1.bootdev 1"));
+	ut_asserteq(-EINVAL, bootflow_cache_find(&iter, &found, NULL));
+	bootflow_iter_uninit(&iter);
+
+	bootflow_cache_clear();
+	ut_assertnull(env_get("bootflow_cache"));
+	bootflow_free(&bflow);
+
+	return 0;
+}
+BOOTSTD_TEST(bootflow_cache, UTF_DM | UTF_SCAN_FDT);
+
 /**
  * check_font() - Check that the font size for an item matches expectations
  *
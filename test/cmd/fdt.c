@@ -6,6 +6,7 @@
  */
 
 #include <console.h>
+#include <fdt_fixup.h>
 #include <fdt_support.h>
 #include <mapmem.h>
 #include <asm/global_data.h>
@@ -1314,6 +1315,90 @@ static int fdt_test_chosen(struct unit_test_state *uts)
 }
 FDT_TEST(fdt_test_chosen, UTF_CONSOLE);
 
+/* Test batching edits with a fixup session */
+static int fdt_test_fixup(struct unit_test_state *uts)
+{
+	struct fdt_fixup fix;
+	char fdt[8192];
+	int node, sub;
+	ulong addr;
+	u32 size;
+
+	ut_assertok(make_fuller_fdt(uts, fdt, sizeof(fdt), &addr));
+	size = fdt_totalsize(fdt);
+	node = fdt_path_offset(fdt, "/test-node@1234");
+	ut_assert(node > 0);
+	sub = fdt_path_offset(fdt, "/test-node@1234/subnode");
+	ut_assert(sub > 0);
+
+	/* Values of the same size are written in place */
+	fdt_fixup_begin(&fix, fdt, 0);
+	ut_assertok(fdt_fixup_setprop_u32(&fix, node, "clock-frequency", 1234));
+	ut_assertok(fdt_fixup_commit(&fix));
+	ut_asserteq(size, fdt_totalsize(fdt));
+	ut_asserteq(node, fdt_path_offset(fdt, "/test-node@1234"));
+	ut_asserteq(1234, fdt_getprop_u32_default_node(fdt, node, 0,
+						       "clock-frequency", 0));
+
+	/* The tree is left alone if there is no space */
+	fdt_fixup_begin(&fix, fdt, 0);
+	ut_assertok(fdt_fixup_setprop_string(&fix, node, "status", "okay"));
+	ut_asserteq(-FDT_ERR_NOSPACE, fdt_fixup_commit(&fix));
+	ut_asserteq(size, fdt_totalsize(fdt));
+	ut_assertnull(fdt_getprop(fdt, node, "status", NULL));
+
+	/* Errors in queueing are reported on commit */
+	fdt_fixup_begin(&fix, fdt, 0);
+	ut_asserteq(-FDT_ERR_BADOFFSET, fdt_fixup_del_node(&fix, 0));
+	ut_asserteq(-FDT_ERR_BADOFFSET, fdt_fixup_delprop(&fix, node, "regs"));
+	ut_asserteq(-FDT_ERR_BADOFFSET, fdt_fixup_commit(&fix));
+	ut_assertnonnull(fdt_getprop(fdt, node, "regs", NULL));
+
+	/* Apply a mix of edits in one go, growing the tree */
+	fdt_fixup_begin(&fix, fdt, sizeof(fdt));
+	ut_assertok(fdt_fixup_setprop_string(&fix, node, "compatible",
+					     "u-boot,fdt-test-device-two"));
+	ut_assertok(fdt_fixup_setprop_string(&fix, node, "status", "okay"));
+	ut_assertok(fdt_fixup_setprop_u32(&fix, node, "new-prop", 1));
+	ut_assertok(fdt_fixup_setprop_u32(&fix, node, "new-prop", 2));
+	ut_assertok(fdt_fixup_setprop_u32(&fix, node, "dropped", 3));
+	ut_assertok(fdt_fixup_delprop(&fix, node, "dropped"));
+	ut_assertok(fdt_fixup_delprop(&fix, node, "regs"));
+	ut_assertok(fdt_fixup_setprop_u32(&fix, sub, "in-deleted-node", 1));
+	ut_assertok(fdt_fixup_del_node(&fix, sub));
+	ut_assertok(fdt_fixup_setprop_string(&fix, 0, "model", "short"));
+	ut_assertok(fdt_fixup_commit(&fix));
+	ut_assertok(fdt_check_header(fdt));
+	ut_assert(fdt_totalsize(fdt) <= sizeof(fdt));
+
+	ut_assertok(run_command("fdt print", 0));
+	ut_assert_nextline("/ {");
+	ut_assert_nextline("\t#address-cells = <0x00000001>;");
+	ut_assert_nextline("\t#size-cells = <0x00000001>;");
+	ut_assert_nextline("\tcompatible = \"u-boot,fdt-test\";");
+	ut_assert_nextline("\tmodel = \"short\";");
+	ut_assert_nextline("\taliases {");
+	ut_assert_nextline("\t\tbadalias = \"/bad/alias\";");
+	ut_assert_nextline("\t\tsubnodealias = \"/test-node@1234/subnode\";");
+	ut_assert_nextline("\t\ttestnodealias = \"/test-node@1234\";");
+	ut_assert_nextline("\t};");
+	ut_assert_nextline("\ttest-node@1234 {");
+	ut_assert_nextline("\t\tnew-prop = <0x00000002>;");
+	ut_assert_nextline("\t\tstatus = \"okay\";");
+	ut_assert_nextline("\t\t#address-cells = <0x00000000>;");
+	ut_assert_nextline("\t\t#size-cells = <0x00000000>;");
+	ut_assert_nextline("\t\tcompatible = \"u-boot,fdt-test-device-two\";");
+	ut_assert_nextline("\t\tclock-names = \"fixed\", \"i2c\", \"spi\", \"uart2\", \"uart1\";");
+	ut_assert_nextline("\t\tu-boot,empty-property;");
+	ut_assert_nextline("\t\tclock-frequency = <0x000004d2>;");
+	ut_assert_nextline("\t};");
+	ut_assert_nextline("};");
+	ut_assert_console_end();
+
+	return 0;
+}
+FDT_TEST(fdt_test_fixup, UTF_CONSOLE);
+
 static int fdt_test_apply(struct unit_test_state *uts)
 {
 	char fdt[8192], fdto[8192];
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for 'malloc' command
+ */
+
+#include <malloc.h>
+#include <asm/global_data.h>
+#include <test/cmd.h>
+#include <test/ut.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Test the statistics kept by malloc() */
+static int cmd_test_malloc_stats(struct unit_test_state *uts)
+{
+	struct malloc_info before, info;
+	void *ptr;
+
+	ut_assertok(malloc_get_info(&before));
+	ut_assert(before.heap_bytes <= before.total_bytes);
+	ut_assert(before.free_bytes <= before.heap_bytes);
+	ut_assert(before.largest_free <= before.free_bytes);
+	ut_assert(before.in_use_bytes <= before.peak_bytes);
+
+	ptr = malloc(0x1000);
+	ut_assertnonnull(ptr);
+	ut_assertok(malloc_get_info(&info));
+	ut_asserteq(before.count + 1, info.count);
+	ut_asserteq(before.calls + 1, info.calls);
+	ut_assert(info.in_use_bytes >= before.in_use_bytes + 0x1000);
+	ut_assert(info.peak_bytes >= info.in_use_bytes);
+
+	ptr = realloc(ptr, 0x2000);
+	ut_assertnonnull(ptr);
+	ut_assertok(malloc_get_info(&info));
+	ut_asserteq(before.count + 1, info.count);
+	ut_asserteq(before.calls + 2, info.calls);
+	ut_assert(info.in_use_bytes >= before.in_use_bytes + 0x2000);
+
+	free(ptr);
+	ut_assertok(malloc_get_info(&info));
+	ut_asserteq(before.count, info.count);
+	ut_asserteq(before.in_use_bytes, info.in_use_bytes);
+	ut_asserteq(before.frees + 1, info.frees);
+
+	return 0;
+}
+CMD_TEST(cmd_test_malloc_stats, 0);
+
+/* Test 'malloc info' command */
+static int cmd_test_malloc_info(struct unit_test_state *uts)
+{
+	ut_assertok(run_command("malloc info", 0));
+	ut_assert_nextlinen("total         = ");
+	ut_assert_nextlinen("heap          = ");
+	ut_assert_nextlinen("in use        = ");
+	ut_assert_nextlinen("peak          = ");
+	ut_assert_nextlinen("free          = ");
+	ut_assert_nextlinen("largest free  = ");
+	ut_assert_nextlinen("free chunks   = ");
+	ut_assert_nextlinen("fragmentation = ");
+	ut_assert_nextlinen("allocations   = ");
+	ut_assert_nextlinen("calls         = ");
+	ut_assert_nextlinen("frees         = ");
+	ut_assert_console_end();
+
+	return 0;
+}
+CMD_TEST(cmd_test_malloc_info, UTF_CONSOLE);
+
+/* Test the trace of calls to malloc() */
+static int cmd_test_malloc_trace(struct unit_test_state *uts)
+{
+	const struct malloc_trace_rec *rec, *prev = NULL, *last = NULL;
+	ulong func;
+	void *ptr;
+	uint i;
+
+	malloc_trace_clear();
+	ptr = malloc(123);
+	ut_assertnonnull(ptr);
+	free(ptr);
+	ut_assert(malloc_trace_enable(false));
+
+	/* The pointer may have been used before, so check the last two uses */
+	for (i = 0; (rec = malloc_trace_get(i)); i++) {
+		if (rec->ptr == (ulong)ptr) {
+			prev = last;
+			last = rec;
+		}
+	}
+	ut_assertnonnull(prev);
+	ut_asserteq(MALLOC_TRACE_MALLOC, prev->op);
+	ut_asserteq(123, prev->size);
+	ut_asserteq(MALLOC_TRACE_FREE, last->op);
+	ut_assert(last->time >= prev->time);
+
+	/* The caller is an address in this function, as in the ELF file */
+	func = (ulong)cmd_test_malloc_trace - gd->reloc_off;
+	ut_assert(prev->caller > func && prev->caller < func + 0x1000);
+
+	ut_assertok(run_command("malloc trace", 0));
+	ut_assert_nextline(" Time (us)  Call                Caller           Pointer  Size");
+	ut_assert_skip_to_line("%u records, 0 dropped", i);
+	ut_assert_console_end();
+	ut_assertok(run_command("malloc trace clear", 0));
+	ut_assertok(run_command("malloc trace", 0));
+	ut_assert_nextlinen(" Time (us)");
+	ut_assert_nextline("0 records, 0 dropped");
+	ut_assert_console_end();
+	malloc_trace_enable(true);
+
+	return 0;
+}
+CMD_TEST(cmd_test_malloc_trace, UTF_CONSOLE);
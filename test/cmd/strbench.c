@@ -0,0 +1,26 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for 'strbench' command
+ */
+
+#include <test/cmd.h>
+#include <test/ut.h>
+
+/* Test 'strbench' command with an odd size, so that the tail is handled */
+static int cmd_test_strbench(struct unit_test_state *uts)
+{
+	ut_assertok(run_command("strbench 1003 2", 0));
+	ut_assert_nextline("4099 bytes, 2 times");
+	ut_assert_nextlinen("memset ");
+	ut_assert_nextlinen("memcpy unaligned ");
+	ut_assert_nextlinen("memmove ");
+	ut_assert_nextlinen("memcpy ");
+	ut_assert_nextlinen("memcmp ");
+	ut_assert_nextlinen("memchr ");
+	ut_assert_nextlinen("strlen ");
+	ut_assert_nextlinen("strchr ");
+	ut_assert_console_end();
+
+	return 0;
+}
+CMD_TEST(cmd_test_strbench, UTF_CONSOLE);
@@ -234,3 +234,51 @@ static int net_test_wget(struct unit_test_state *uts)
 	return 0;
 }
 CMD_TEST(net_test_wget, UTF_CONSOLE);
+
+static int check_wget_digest(struct unit_test_state *uts)
+{
+	env_set("netdigest", "sha256:c1ae9ee342a2e30b6a68003f66e7a4e14b1eb8c9e33deb35133885dcc47cc7a1");
+	ut_assertok(run_command("wget ${loadaddr} 1.1.2.2:/index.html", 0));
+	ut_asserteq_str("c1ae9ee342a2e30b6a68003f66e7a4e14b1eb8c9e33deb35133885dcc47cc7a1",
+			env_get("netdigestvalue"));
+	ut_assertok(console_record_reset_enable());
+
+	/* A wrong digest fails the command */
+	env_set("netdigest", "sha256:0000000000000000000000000000000000000000000000000000000000000000");
+	ut_asserteq(1, run_command("wget ${loadaddr} 1.1.2.2:/index.html", 0));
+	ut_assert_skip_to_line("sha256 digest mismatch: got c1ae9ee342a2e30b6a68003f66e7a4e14b1eb8c9e33deb35133885dcc47cc7a1");
+	ut_assertok(console_record_reset_enable());
+
+	return 0;
+}
+
+static int net_test_wget_digest(struct unit_test_state *uts)
+{
+	char *prev_ethact = env_get("ethact");
+	char *prev_ethrotate = env_get("ethrotate");
+	char *prev_loadaddr = env_get("loadaddr");
+	int ret;
+
+	if (!IS_ENABLED(CONFIG_NET_DIGEST))
+		return -EAGAIN;
+
+	sandbox_eth_set_tx_handler(0, sb_http_handler);
+	sandbox_eth_set_priv(0, uts);
+
+	env_set("ethact", "eth@10002000");
+	env_set("ethrotate", "no");
+	env_set("loadaddr", "0x20000");
+
+	/* Restore the environment even if a check fails */
+	ret = check_wget_digest(uts);
+
+	sandbox_eth_set_tx_handler(0, NULL);
+
+	env_set("netdigest", NULL);
+	env_set("ethact", prev_ethact);
+	env_set("ethrotate", prev_ethrotate);
+	env_set("loadaddr", prev_loadaddr);
+
+	return ret;
+}
+CMD_TEST(net_test_wget_digest, UTF_CONSOLE);
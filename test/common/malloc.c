@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the slabs used by malloc() for small allocations
+ */
+
+#include <malloc.h>
+#include <time.h>
+#include <test/common.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/* Number of devices in the replayed trace, and objects for each */
+#define TRACE_DEVICES	300
+#define TRACE_OBJS	5
+#define TRACE_MAX	(TRACE_DEVICES * TRACE_OBJS)
+
+/**
+ * struct trace_state - State while replaying an allocation trace
+ *
+ * @ptr: Live allocations, NULL if freed
+ * @size: Size requested for each allocation
+ * @seed: State of the random-number generator
+ * @in_use: Usable bytes in live allocations
+ * @peak: Highest value of @in_use
+ */
+struct trace_state {
+	u8 *ptr[TRACE_MAX];
+	ushort size[TRACE_MAX];
+	uint seed;
+	ulong in_use;
+	ulong peak;
+};
+
+static struct trace_state trace;
+
+/* Fixed pseudo-random sequence, so that each replay is the same */
+static uint trace_rand(uint range)
+{
+	trace.seed = trace.seed * 1103515245 + 12345;
+
+	return (trace.seed >> 16) % range;
+}
+
+static int trace_alloc(struct unit_test_state *uts, int idx, uint size)
+{
+	u8 *ptr;
+
+	ptr = malloc(size);
+	ut_assertnonnull(ptr);
+	ptr[0] = idx;
+	ptr[size - 1] = idx;
+	trace.ptr[idx] = ptr;
+	trace.size[idx] = size;
+	trace.in_use += malloc_usable_size(ptr);
+	trace.peak = max(trace.peak, trace.in_use);
+
+	return 0;
+}
+
+static int trace_free(struct unit_test_state *uts, int idx)
+{
+	u8 *ptr = trace.ptr[idx];
+
+	if (!ptr)
+		return 0;
+	ut_asserteq((u8)idx, ptr[0]);
+	ut_asserteq((u8)idx, ptr[trace.size[idx] - 1]);
+	trace.in_use -= malloc_usable_size(ptr);
+	free(ptr);
+	trace.ptr[idx] = NULL;
+
+	return 0;
+}
+
+/*
+ * Replay the allocations made when binding and probing devices: for each, the
+ * device, its name, platform data, private data and a uclass-private area,
+ * with some temporary buffers freed straight away and some devices removed
+ * again
+ */
+static int trace_replay(struct unit_test_state *uts, ulong *usp)
+{
+	static const ushort obj_size[TRACE_OBJS] = { 232, 32, 128, 512, 96 };
+	ulong start;
+	int i, j, idx;
+	void *tmp;
+
+	memset(&trace, '\0', sizeof(trace));
+	start = timer_get_us();
+	for (i = 0; i < TRACE_DEVICES; i++) {
+		for (j = 0; j < TRACE_OBJS; j++) {
+			idx = i * TRACE_OBJS + j;
+			if (j && trace_rand(4) == 0)
+				continue;
+			ut_assertok(trace_alloc(uts, idx,
+						1 + trace_rand(obj_size[j])));
+		}
+
+		tmp = malloc(64 + trace_rand(4096));
+		ut_assertnonnull(tmp);
+		free(tmp);
+
+		if (trace_rand(8) == 0) {
+			idx = trace_rand(i + 1) * TRACE_OBJS;
+			for (j = 0; j < TRACE_OBJS; j++)
+				ut_assertok(trace_free(uts, idx + j));
+		}
+	}
+	for (idx = 0; idx < TRACE_MAX; idx++)
+		ut_assertok(trace_free(uts, idx));
+	*usp = timer_get_us() - start;
+	ut_asserteq(0, trace.in_use);
+
+	return 0;
+}
+
+/* Test allocation from the slabs */
+static int common_test_malloc_slab(struct unit_test_state *uts)
+{
+	ulong mem_start;
+	u8 *ptr, *new;
+	int i;
+
+	mem_start = ut_check_free();
+
+	ptr = malloc(20);
+	ut_assertnonnull(ptr);
+	ut_asserteq(32, malloc_usable_size(ptr));
+	for (i = 0; i < 20; i++)
+		ptr[i] = i;
+
+	/* Growing within the size class keeps the same object */
+	ut_asserteq_ptr(ptr, realloc(ptr, 32));
+
+	/* Growing beyond it moves the data */
+	new = realloc(ptr, 100);
+	ut_assertnonnull(new);
+	ut_asserteq(112, malloc_usable_size(new));
+	for (i = 0; i < 20; i++)
+		ut_asserteq(i, new[i]);
+	ut_assert(ut_check_delta(mem_start) > 0);
+
+	/* A freed object is reused, so calloc() must clear it */
+	memset(new, '\xff', 112);
+	free(new);
+	ptr = calloc(10, 10);
+	ut_asserteq_ptr(new, ptr);
+	for (i = 0; i < 100; i++)
+		ut_asserteq(0, ptr[i]);
+	free(ptr);
+
+	/* Large allocations use dlmalloc */
+	ptr = malloc(1000);
+	ut_assertnonnull(ptr);
+	ut_assert(malloc_usable_size(ptr) >= 1000);
+	free(ptr);
+
+	ut_asserteq(0, ut_check_delta(mem_start));
+
+	return 0;
+}
+COMMON_TEST(common_test_malloc_slab, 0);
+
+/* Compare the time and memory used by a trace, with and without slabs */
+static int common_test_malloc_replay(struct unit_test_state *uts)
+{
+	ulong mem_start, dl_us, dl_peak, slab_us;
+	int ret;
+
+	mem_start = ut_check_free();
+
+	malloc_slab_enable(false);
+	ret = trace_replay(uts, &dl_us);
+	malloc_slab_enable(true);
+	ut_assertok(ret);
+	dl_peak = trace.peak;
+	ut_asserteq(0, ut_check_delta(mem_start));
+
+	ut_assertok(trace_replay(uts, &slab_us));
+	ut_asserteq(0, ut_check_delta(mem_start));
+
+	printf("dlmalloc: %lu us, peak %lu bytes\n", dl_us, dl_peak);
+	printf("slab:     %lu us, peak %lu bytes\n", slab_us, trace.peak);
+
+	return 0;
+}
+COMMON_TEST(common_test_malloc_replay, 0);
@@ -5,18 +5,23 @@
  * Copyright (c) 2013 Google, Inc
  */
 
+#include <bloblist.h>
 #include <errno.h>
 #include <dm.h>
 #include <fdtdec.h>
 #include <log.h>
 #include <malloc.h>
+#include <mapmem.h>
 #include <asm/global_data.h>
 #include <dm/device-internal.h>
+#include <dm/handoff.h>
+#include <dm/of_index.h>
 #include <dm/root.h>
 #include <dm/util.h>
 #include <dm/test.h>
 #include <dm/uclass-internal.h>
 #include <linux/list.h>
+#include <linux/sizes.h>
 #include <test/test.h>
 #include <test/ut.h>
 
@@ -1402,6 +1407,73 @@ static int dm_test_dev_get_mem(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_dev_get_mem, UTF_SCAN_FDT);
 
+/* Test binding device tree subnodes on demand */
+static int dm_test_lazy_bind(struct unit_test_state *uts)
+{
+	struct udevice *bus, *dev;
+	struct dm_stats stats;
+	struct uclass *uc;
+	bool found;
+	ofnode node;
+
+	if (!CONFIG_IS_ENABLED(DM_LAZY_BIND))
+		return -EAGAIN;
+
+	ut_assertok(uclass_find_device_by_name(UCLASS_SIMPLE_BUS, "bind-test",
+					       &bus));
+	ut_assertok(device_chld_unbind(bus, NULL));
+	dm_lazy_bind_defer(bus);
+	dm_get_mem(&stats);
+	ut_asserteq(1, stats.lazy_pending_count);
+	ut_asserteq(0, stats.lazy_bound_count);
+
+	/* Looking up a node binds the subtree it is in */
+	node = ofnode_path("/bind-test/bind-test-child1");
+	ut_assert(ofnode_valid(node));
+	ut_assertok(uclass_find_device_by_ofnode(UCLASS_PHY, node, &dev));
+	ut_asserteq_ptr(bus, dev->parent);
+	ut_assert(dev_get_flags(dev) & DM_FLAG_BIND_LAZY);
+	ut_assert(!(dev_get_flags(bus) & DM_FLAG_BIND_PENDING));
+	dm_get_mem(&stats);
+	ut_asserteq(0, stats.lazy_pending_count);
+	ut_asserteq(2, stats.lazy_bound_count);
+	ut_assert(stats.lazy_bound_size >= 2 * sizeof(struct udevice));
+
+	/* Searching a uclass binds only the subtrees with nodes for it */
+	ut_assertok(device_chld_unbind(bus, NULL));
+	dm_lazy_bind_defer(bus);
+	ut_assertok(uclass_find_first_device(UCLASS_TEST_FDT, &dev));
+	ut_assert(dev_get_flags(bus) & DM_FLAG_BIND_PENDING);
+	ut_assertok(uclass_find_first_device(UCLASS_PHY, &dev));
+	ut_assert(!(dev_get_flags(bus) & DM_FLAG_BIND_PENDING));
+	ut_asserteq(2, device_get_child_count(bus));
+
+	/* Getting the uclass to iterate it directly binds its nodes too */
+	ut_assertok(device_chld_unbind(bus, NULL));
+	dm_lazy_bind_defer(bus);
+	ut_assertok(uclass_get(UCLASS_PHY, &uc));
+	ut_assert(!(dev_get_flags(bus) & DM_FLAG_BIND_PENDING));
+	found = false;
+	uclass_foreach_dev(dev, uc)
+		found |= dev->parent == bus;
+	ut_assert(found);
+
+	/* Counting the devices in a uclass binds everything */
+	ut_assertok(device_chld_unbind(bus, NULL));
+	dm_lazy_bind_defer(bus);
+	ut_assert(uclass_id_count(UCLASS_TEST_FDT) > 0);
+	ut_assert(!(dev_get_flags(bus) & DM_FLAG_BIND_PENDING));
+
+	/* Searching the children of the bus binds them */
+	ut_assertok(device_chld_unbind(bus, NULL));
+	dm_lazy_bind_defer(bus);
+	ut_assertok(device_find_child_by_name(bus, "bind-test-child2", &dev));
+	ut_assert(dev_get_flags(dev) & DM_FLAG_BIND_LAZY);
+
+	return 0;
+}
+DM_TEST(dm_test_lazy_bind, UTF_SCAN_FDT);
+
 /* Test uclass_try_first_device() */
 static int dm_test_try_first_device(struct unit_test_state *uts)
 {
@@ -1423,3 +1495,95 @@ static int dm_test_try_first_device(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_try_first_device, 0);
+
+/* Test that the compatible index finds the same driver as a linear search */
+static int dm_test_of_index_driver(struct unit_test_state *uts)
+{
+	struct driver *drivers = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	const struct udevice_id *of_match, *id;
+	struct driver *drv, *first;
+	int i, j;
+
+	if (!CONFIG_IS_ENABLED(OF_INDEX))
+		return -EAGAIN;
+
+	for (i = 0; i < n_ents; i++) {
+		for (of_match = drivers[i].of_match; of_match &&
+		     of_match->compatible; of_match++) {
+			ut_assertok(of_index_find_driver(of_match->compatible,
+							 &drv, &id));
+			ut_asserteq_str(of_match->compatible, id->compatible);
+
+			/* The earliest driver with this string must win */
+			first = NULL;
+			for (j = 0; j <= i && !first; j++) {
+				const struct udevice_id *m;
+
+				for (m = drivers[j].of_match; m && m->compatible;
+				     m++) {
+					if (!strcmp(m->compatible,
+						    of_match->compatible)) {
+						first = &drivers[j];
+						break;
+					}
+				}
+			}
+			ut_asserteq_ptr(first, drv);
+		}
+	}
+
+	ut_asserteq(-ENOENT, of_index_find_driver("u-boot,no-such-driver",
+						  &drv, &id));
+
+	return 0;
+}
+DM_TEST(dm_test_of_index_driver, 0);
+
+/* Test recording driver-model state and passing it to the next phase */
+static int dm_test_handoff(struct unit_test_state *uts)
+{
+	static u64 buf[SZ_1K / sizeof(u64)];
+	struct udevice *dev, *other;
+	u64 val;
+
+	if (!CONFIG_IS_ENABLED(DM_HANDOFF))
+		return -EAGAIN;
+
+	/* Use a private bloblist, so no records are left for later tests */
+	ut_assertok(bloblist_new(map_to_sysmem(buf), sizeof(buf), 0, 0));
+
+	ut_assertok(uclass_get_device_by_name(UCLASS_TEST_FDT, "a-test", &dev));
+	ut_assertok(uclass_get_device_by_name(UCLASS_TEST_FDT, "another-test",
+					      &other));
+
+	/* Records are not visible until written */
+	ut_assertok(dev_handoff_add(dev, DM_HANDOFF_CLK_RATE, 3, 1000000));
+	ut_asserteq(-ENOENT, dev_handoff_find(dev, DM_HANDOFF_CLK_RATE, 3,
+					      &val));
+
+	/* A later value replaces an earlier one */
+	ut_assertok(dev_handoff_add(dev, DM_HANDOFF_CLK_RATE, 3, 2000000));
+	ut_assertok(dev_handoff_add(dev, DM_HANDOFF_PROBED, 0, 1));
+	ut_assertok(dm_handoff_write());
+
+	ut_assertok(dev_handoff_find(dev, DM_HANDOFF_CLK_RATE, 3, &val));
+	ut_asserteq(2000000, val);
+	ut_asserteq(-ENOENT, dev_handoff_find(dev, DM_HANDOFF_CLK_RATE, 4,
+					      &val));
+	ut_asserteq(-ENOENT, dev_handoff_find(dev, DM_HANDOFF_REGULATOR_UV, 3,
+					      &val));
+	ut_asserteq(-ENOENT, dev_handoff_find(other, DM_HANDOFF_CLK_RATE, 3,
+					      &val));
+	ut_assert(dev_handoff_probed(dev));
+	ut_assert(!dev_handoff_probed(other));
+
+	/* A second write replaces the first */
+	ut_assertok(dev_handoff_add(other, DM_HANDOFF_PROBED, 0, 1));
+	ut_assertok(dm_handoff_write());
+	ut_assert(!dev_handoff_probed(dev));
+	ut_assert(dev_handoff_probed(other));
+
+	return 0;
+}
+DM_TEST(dm_test_handoff, UTF_SCAN_FDT | UFT_BLOBLIST);
@@ -19,9 +19,12 @@
 #include <abuf.h>
 #include <dm.h>
 #include <log.h>
+#include <malloc.h>
 #include <of_live.h>
+#include <time.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
+#include <dm/of_access.h>
 #include <dm/of_extra.h>
 #include <dm/root.h>
 #include <dm/test.h>
@@ -152,6 +155,46 @@ static int dm_test_ofnode_get_by_phandle_ot(struct unit_test_state *uts)
 DM_TEST(dm_test_ofnode_get_by_phandle_ot,
 	UTF_SCAN_FDT | UTF_OTHER_FDT);
 
+static int check_all_phandles(struct unit_test_state *uts, const void *blob)
+{
+	int offset, count = 0;
+	u32 phandle;
+
+	for (offset = fdt_next_node(blob, -1, NULL); offset >= 0;
+	     offset = fdt_next_node(blob, offset, NULL)) {
+		phandle = fdt_get_phandle(blob, offset);
+		if (!phandle)
+			continue;
+		ut_asserteq(offset,
+			    ofnode_to_offset(ofnode_get_by_phandle(phandle)));
+		count++;
+	}
+	ut_assert(count > 1);
+
+	return 0;
+}
+
+/* test that phandle lookups follow changes to the flat tree */
+static int dm_test_ofnode_get_by_phandle_moved(struct unit_test_state *uts)
+{
+	const void *blob = ofnode_to_fdt(ofnode_root());
+	int before;
+
+	ut_assertok(check_all_phandles(uts, blob));
+	before = ofnode_to_offset(ofnode_get_by_phandle(1));
+
+	/* Adding a property to the root node moves every other node */
+	ut_assertok(ofnode_write_string(ofnode_root(), "phandle-test",
+					"moved"));
+	ut_assert(before != fdt_node_offset_by_phandle(blob, 1));
+	ut_asserteq(fdt_node_offset_by_phandle(blob, 1),
+		    ofnode_to_offset(ofnode_get_by_phandle(1)));
+	ut_assertok(check_all_phandles(uts, blob));
+
+	return 0;
+}
+DM_TEST(dm_test_ofnode_get_by_phandle_moved, UTF_SCAN_FDT | UTF_FLAT_TREE);
+
 static int check_prop_values(struct unit_test_state *uts, ofnode start,
 			     const char *propname, const char *propval,
 			     int expect_count)
@@ -1355,6 +1398,124 @@ static int dm_test_livetree_align(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_livetree_align, UTF_SCAN_FDT | UTF_LIVE_TREE);
 
+/**
+ * make_index_fdt() - Create a tree with many nodes, for testing the index
+ *
+ * This has nodes /bus<n>/node<m>, each with a phandle, numbered from 1 in
+ * order
+ */
+static int make_index_fdt(void *buf, int size, int buses, int per_bus)
+{
+	char name[20];
+	int i, j, ret;
+	u32 phandle;
+
+	phandle = 1;
+	ret = fdt_create(buf, size);
+	ret = ret ?: fdt_finish_reservemap(buf);
+	ret = ret ?: fdt_begin_node(buf, "");
+	for (i = 0; i < buses; i++) {
+		snprintf(name, sizeof(name), "bus%d", i);
+		ret = ret ?: fdt_begin_node(buf, name);
+		ret = ret ?: fdt_property_u32(buf, "phandle", phandle++);
+		for (j = 0; j < per_bus; j++) {
+			snprintf(name, sizeof(name), "node%d", j);
+			ret = ret ?: fdt_begin_node(buf, name);
+			ret = ret ?: fdt_property_u32(buf, "phandle",
+						      phandle++);
+			ret = ret ?: fdt_end_node(buf);
+		}
+		ret = ret ?: fdt_end_node(buf);
+	}
+	ret = ret ?: fdt_end_node(buf);
+
+	return ret ?: fdt_finish(buf);
+}
+
+/* Find a phandle by searching the whole tree, as is done without an index */
+static struct device_node *search_phandle(struct device_node *root,
+					  phandle handle)
+{
+	struct device_node *np;
+
+	for (np = root; np; np = of_find_all_nodes(np)) {
+		if (np->phandle == handle)
+			return np;
+	}
+
+	return NULL;
+}
+
+/* Check the lookup index for a large live tree */
+static int dm_test_livetree_index(struct unit_test_state *uts)
+{
+	const int buses = 50, per_bus = 100, count = buses * (per_bus + 1);
+	const int size = SZ_512K, samples = 100;
+	struct device_node *root, *np, *child;
+	ulong start, index_us, search_us;
+	const char *opts;
+	void *fdt;
+	int i;
+
+	fdt = malloc(size);
+	ut_assertnonnull(fdt);
+	ut_assertok(make_index_fdt(fdt, size, buses, per_bus));
+	ut_assertok(unflatten_device_tree(fdt, &root));
+
+	/* every node can be found by its phandle and path */
+	for (np = of_find_all_nodes(root); np; np = of_find_all_nodes(np)) {
+		ut_asserteq_ptr(np, of_find_node_by_phandle(root, np->phandle));
+		ut_asserteq_ptr(np, of_find_node_opts_by_path(root,
+							      np->full_name,
+							      NULL));
+	}
+	ut_assertnull(of_find_node_by_phandle(root, count + 1));
+	ut_assertnull(of_find_node_opts_by_path(root, "/bus1/node", NULL));
+	ut_assertnull(of_find_node_opts_by_path(root, "/bus1/", NULL));
+
+	np = of_find_node_opts_by_path(root, "/bus1/node2:opts", &opts);
+	ut_assertnonnull(np);
+	ut_asserteq_str("/bus1/node2", np->full_name);
+	ut_asserteq_str("opts", opts);
+
+	/* compare the time taken with and without the index */
+	start = timer_get_us();
+	for (i = 0; i < samples; i++)
+		ut_assertnonnull(of_find_node_by_phandle(root,
+							 count - i * 37));
+	index_us = timer_get_us() - start;
+
+	start = timer_get_us();
+	for (i = 0; i < samples; i++)
+		ut_assertnonnull(search_phandle(root, count - i * 37));
+	search_us = timer_get_us() - start;
+	printf("%d phandle lookups in %d nodes: %lu us indexed, %lu us search\n",
+	       samples, count, index_us, search_us);
+
+	/* removed nodes are dropped from the index */
+	np = of_find_node_opts_by_path(root, "/bus2", NULL);
+	ut_assertnonnull(np);
+	ut_assertok(of_remove_node(np));
+	ut_assertnull(of_find_node_opts_by_path(root, "/bus2", NULL));
+	ut_assertnull(of_find_node_opts_by_path(root, "/bus2/node3", NULL));
+	ut_assertnull(of_find_node_by_phandle(root, np->phandle));
+	ut_assertnull(of_find_node_by_phandle(root, np->child->phandle));
+	ut_assertnonnull(of_find_node_opts_by_path(root, "/bus3/node3", NULL));
+
+	/* added nodes are found by searching */
+	np = of_find_node_opts_by_path(root, "/bus3", NULL);
+	ut_assertok(of_add_subnode(np, "added", -1, &child));
+	ut_asserteq_ptr(child, of_find_node_opts_by_path(root, "/bus3/added",
+							 NULL));
+	ut_assertnonnull(of_find_node_opts_by_path(root, "/bus3/node3", NULL));
+
+	of_live_free(root);
+	free(fdt);
+
+	return 0;
+}
+DM_TEST(dm_test_livetree_index, 0);
+
 /* check that it is possible to load an arbitrary livetree */
 static int dm_test_livetree_ensure(struct unit_test_state *uts)
 {
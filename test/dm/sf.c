@@ -5,6 +5,7 @@
 
 #include <command.h>
 #include <dm.h>
+#include <env.h>
 #include <fdtdec.h>
 #include <mapmem.h>
 #include <os.h>
@@ -12,10 +13,13 @@
 #include <spi_flash.h>
 #include <asm/state.h>
 #include <asm/test.h>
+#include <dm/device-internal.h>
 #include <dm/test.h>
 #include <dm/util.h>
 #include <test/test.h>
 #include <test/ut.h>
+#include <u-boot/crc.h>
+#include <linux/mtd/spi-nor.h>
 
 /* Simple test of sandbox SPI flash */
 static int dm_test_spi_flash(struct unit_test_state *uts)
@@ -74,6 +78,108 @@ static int dm_test_spi_flash(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_spi_flash, UTF_SCAN_PDATA | UTF_SCAN_FDT);
 
+/* Test reading SPI flash through a direct mapping */
+static int dm_test_spi_flash_dirmap(struct unit_test_state *uts)
+{
+	int full_size = 0x200000;
+	int size = 0x10000;
+	struct udevice *dev;
+	u8 *src, *dst;
+	uint reads;
+
+	if (!IS_ENABLED(CONFIG_SPI_DIRMAP))
+		return -EAGAIN;
+
+	src = map_sysmem(0x20000, full_size);
+	ut_assertok(os_write_file("spi.bin", src, full_size));
+	ut_assertok(uclass_first_device_err(UCLASS_SPI_FLASH, &dev));
+	reads = sandbox_spi_get_dirmap_reads(dev->parent);
+
+	/* a large read should be done in a single access */
+	dst = map_sysmem(0x20000 + full_size, full_size);
+	ut_assertok(spi_flash_read_dm(dev, 0x1234, size, dst));
+	ut_asserteq_mem(src + 0x1234, dst, size);
+	ut_asserteq(reads + 1, sandbox_spi_get_dirmap_reads(dev->parent));
+
+	/* read up to the end of the flash */
+	ut_assertok(spi_flash_read_dm(dev, full_size - size, size, dst));
+	ut_asserteq_mem(src + full_size - size, dst, size);
+	ut_asserteq(reads + 2, sandbox_spi_get_dirmap_reads(dev->parent));
+
+	sandbox_sf_unbind_emul(state_get_current(), 0, 0);
+
+	return 0;
+}
+DM_TEST(dm_test_spi_flash_dirmap, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+/* Test tuning the read setting and using the recorded setting */
+static int dm_test_spi_flash_tune(struct unit_test_state *uts)
+{
+	int full_size = 0x200000;
+	int size = 0x1000;
+	struct spi_flash_tune tune;
+	struct spi_flash *flash;
+	struct udevice *dev;
+	char val[64];
+	u8 *src, *dst;
+	u32 crc;
+	int i;
+
+	if (!IS_ENABLED(CONFIG_SPI_FLASH_TUNE))
+		return -EAGAIN;
+
+	/* leave the top half of the flash erased */
+	src = map_sysmem(0x20000, full_size);
+	for (i = 0; i < full_size / 2; i++)
+		src[i] = i * 7 + (i >> 8);
+	memset(src + full_size / 2, '\xff', full_size / 2);
+	ut_assertok(os_write_file("spi.bin", src, full_size));
+	ut_assertok(uclass_first_device_err(UCLASS_SPI_FLASH, &dev));
+	flash = dev_get_uclass_priv(dev);
+
+	/* sandbox supports the normal and fast reads, at up to 40MHz */
+	ut_asserteq(-EINVAL, spi_flash_tune(flash, full_size / 2, size, 0,
+					    &tune));
+	ut_assertok(spi_flash_tune(flash, size, size, 0, &tune));
+	ut_asserteq(SNOR_HWCAPS_READ_FAST, tune.hwcap);
+	ut_asserteq(40000000, tune.hz);
+	ut_asserteq(size, tune.offset);
+	ut_asserteq(size, tune.len);
+	crc = crc32(0, src + size, size);
+	ut_asserteq(crc, tune.crc);
+	ut_asserteq(SPINOR_OP_READ_FAST, flash->read_opcode);
+
+	ut_assertok(spi_flash_tune_save(flash, &tune));
+	snprintf(val, sizeof(val), "fast 40000000 1000 1000 %08x", crc);
+	ut_asserteq_str(val, env_get("sf_tune_202015"));
+
+	/* a recorded setting is used when the flash is probed */
+	snprintf(val, sizeof(val), "read 20000000 1000 1000 %08x", crc);
+	ut_assertok(env_set("sf_tune_202015", val));
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_assertok(device_probe(dev));
+	ut_asserteq(SPINOR_OP_READ, flash->read_opcode);
+	ut_asserteq(20000000, flash->spi->max_hz);
+
+	dst = map_sysmem(0x20000 + full_size, full_size);
+	ut_assertok(spi_flash_read_dm(dev, 0, full_size / 2, dst));
+	ut_asserteq_mem(src, dst, full_size / 2);
+
+	/* a setting which does not match the flash contents is ignored */
+	snprintf(val, sizeof(val), "read 20000000 1000 1000 %08x", ~crc);
+	ut_assertok(env_set("sf_tune_202015", val));
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_assertok(device_probe(dev));
+	ut_asserteq(SPINOR_OP_READ_FAST, flash->read_opcode);
+	ut_asserteq(40000000, flash->spi->max_hz);
+
+	ut_assertok(env_set("sf_tune_202015", NULL));
+	sandbox_sf_unbind_emul(state_get_current(), 0, 0);
+
+	return 0;
+}
+DM_TEST(dm_test_spi_flash_tune, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
 /* Functional test that sandbox SPI flash works correctly */
 static int dm_test_spi_flash_func(struct unit_test_state *uts)
 {
@@ -4,10 +4,13 @@
  */
 
 #include <dm.h>
+#include <net.h>
 #include <virtio_types.h>
 #include <virtio.h>
 #include <virtio_ring.h>
+#include <virtio_net.h>
 #include <dm/device-internal.h>
+#include <dm/lists.h>
 #include <dm/root.h>
 #include <dm/test.h>
 #include <dm/uclass-internal.h>
@@ -195,3 +198,66 @@ static int dm_test_virtio_ring(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_virtio_ring, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+/* Test the features and receive header used by virtio-net */
+static int dm_test_virtio_net_features(struct unit_test_state *uts)
+{
+	const u8 enetaddr[ARP_HLEN] = { 0x02, 0x00, 0x11, 0x22, 0x33, 0x44 };
+	struct virtio_dev_priv *uc_priv;
+	struct eth_pdata *pdata;
+	struct udevice *bus, *dev;
+	struct virtqueue *vq;
+	u64 features, features_legacy;
+	const struct eth_ops *ops;
+	uchar *packet;
+	void *buf;
+	int i;
+
+	ut_assertok(uclass_first_device_err(UCLASS_VIRTIO, &bus));
+	ut_assertok(device_bind_driver(bus, VIRTIO_NET_DRV_NAME, "virtio-net#9",
+				       &dev));
+
+	/* binding sets up the features the driver offers */
+	uc_priv = dev_get_uclass_priv(bus);
+	features = 0;
+	for (i = 0; i < uc_priv->feature_table_size; i++)
+		features |= BIT_ULL(uc_priv->feature_table[i]);
+	features_legacy = 0;
+	for (i = 0; i < uc_priv->feature_table_size_legacy; i++)
+		features_legacy |= BIT_ULL(uc_priv->feature_table_legacy[i]);
+	ut_asserteq_64(BIT_ULL(VIRTIO_NET_F_MAC) |
+		       BIT_ULL(VIRTIO_NET_F_GUEST_CSUM), features);
+	ut_asserteq_64(features, features_legacy);
+
+	/* the sandbox transport is a v1.0 device without a MAC address */
+	pdata = dev_get_plat(dev);
+	memcpy(pdata->enetaddr, enetaddr, ARP_HLEN);
+	ut_assertok(device_probe(dev));
+	ut_asserteq(false, uc_priv->legacy);
+	ut_asserteq_64(BIT_ULL(VIRTIO_F_VERSION_1), uc_priv->features);
+
+	ops = eth_get_ops(dev);
+	ut_assertok(ops->start(dev));
+
+	/* the receive queue is set up first */
+	vq = list_first_entry(&uc_priv->vqs, struct virtqueue, list);
+	ut_asserteq(0, vq->index);
+
+	/* a received frame starts after the v1.0 header */
+	buf = (void *)(uintptr_t)virtio64_to_cpu(dev, vq->vring.desc[0].addr);
+	vq->vring.used->idx = 1;
+	vq->vring.used->ring[0].id = 0;
+	vq->vring.used->ring[0].len = sizeof(struct virtio_net_hdr_v1) + 60;
+	ut_asserteq(60, ops->recv(dev, 0, &packet));
+	ut_asserteq_ptr(buf + sizeof(struct virtio_net_hdr_v1), packet);
+	ut_assertok(ops->free_pkt(dev, packet, 60));
+	ut_asserteq(-EAGAIN, ops->recv(dev, 0, &packet));
+
+	ops->stop(dev);
+	ut_assertok(virtio_del_vqs(dev));
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_assertok(device_unbind(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_virtio_net_features, UTF_SCAN_PDATA | UTF_SCAN_FDT);
@@ -367,6 +367,168 @@ SPL_IMG_TEST(spl_test_image, IMX8, 0);
 SPL_IMG_TEST(spl_test_image, FIT_INTERNAL, 0);
 SPL_IMG_TEST(spl_test_image, FIT_EXTERNAL, 0);
 
+struct spl_test_reads {
+	void *img;
+	int count;
+};
+
+static ulong spl_test_read_count(struct spl_load_info *load, ulong offset,
+				 ulong count, void *buf)
+{
+	struct spl_test_reads *reads = load->priv;
+
+	reads->count++;
+	memcpy(buf, reads->img + offset, count);
+	return count;
+}
+
+/* Check that images next to each other in a FIT are read together */
+static int spl_test_fit_prefetch(struct unit_test_state *uts)
+{
+	static const char *const names[] = { "u-boot", "a", "b" };
+	size_t fit_size = 1024, data_size = SPL_TEST_DATA_SIZE;
+	struct spl_image_info info = { };
+	struct spl_test_reads reads = { };
+	struct spl_load_info load;
+	ulong addr;
+	char *data;
+	void *fit;
+	int i;
+
+	if (!IS_ENABLED(CONFIG_SPL_LOAD_FIT))
+		return -EAGAIN;
+
+	fit = calloc(fit_size + ARRAY_SIZE(names) * data_size, 1);
+	ut_assertnonnull(fit);
+	data = fit + fit_size;
+
+	ut_assertok(fdt_create(fit, fit_size));
+	ut_assertok(fdt_finish_reservemap(fit));
+	ut_assertok(fdt_begin_node(fit, ""));
+	ut_assertok(fdt_property_u32(fit, "#address-cells", ADDRESS_CELLS));
+	ut_assertok(fdt_begin_node(fit, "images"));
+	for (i = 0; i < ARRAY_SIZE(names); i++) {
+		addr = CONFIG_TEXT_BASE + i * 0x10000;
+		generate_data(data + i * data_size, data_size, names[i]);
+		ut_assertok(fdt_begin_node(fit, names[i]));
+		ut_assertok(fdt_property_string(fit, FIT_TYPE_PROP,
+						"firmware"));
+		ut_assertok(fdt_property_string(fit, FIT_COMP_PROP, "none"));
+		if (!i)
+			ut_assertok(fdt_property_string(fit, FIT_OS_PROP,
+							"tee"));
+		ut_assertok(fdt_property_u32(fit, FIT_DATA_OFFSET_PROP,
+					     i * data_size));
+		ut_assertok(fdt_property_u32(fit, FIT_DATA_SIZE_PROP,
+					     data_size));
+		ut_assertok(fdt_property_addr(fit, FIT_LOAD_PROP, addr));
+		ut_assertok(fdt_property_addr(fit, FIT_ENTRY_PROP, addr));
+		ut_assertok(fdt_end_node(fit));
+	}
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_begin_node(fit, "configurations"));
+	ut_assertok(fdt_property_string(fit, FIT_DEFAULT_PROP, "config-1"));
+	ut_assertok(fdt_begin_node(fit, "config-1"));
+	ut_assertok(fdt_property_string(fit, FIT_FIRMWARE_PROP, "u-boot"));
+	ut_assertok(fdt_property(fit, FIT_LOADABLE_PROP, "a\0b", 4));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_finish(fit));
+	ut_assert(fdt_totalsize(fit) <= fit_size);
+	fdt_set_totalsize(fit, fit_size);
+
+	reads.img = fit;
+	spl_load_init(&load, spl_test_read_count, &reads, 1);
+	ut_assertok(spl_load_simple_fit(&info, &load, 0, fit));
+	ut_asserteq(CONFIG_TEXT_BASE, info.load_addr);
+	for (i = 0; i < ARRAY_SIZE(names); i++)
+		ut_asserteq_mem(data + i * data_size,
+				map_sysmem(CONFIG_TEXT_BASE + i * 0x10000,
+					   data_size), data_size);
+
+	/* the FIT itself, then either all the images or one at a time */
+	ut_asserteq(IS_ENABLED(CONFIG_SPL_FIT_PREFETCH) ? 2 :
+		    1 + ARRAY_SIZE(names), reads.count);
+
+	free(fit);
+
+	return 0;
+}
+SPL_TEST(spl_test_fit_prefetch, 0);
+
+/* Check the hashes which are calculated while an image is read */
+static int spl_test_fit_hash(struct unit_test_state *uts)
+{
+	size_t fit_size = 1024, data_size = SPL_TEST_DATA_SIZE;
+	struct spl_image_info info = { };
+	struct spl_load_info load;
+	__be32 crc32_val;
+	__be16 crc16_val;
+	char *data;
+	void *fit;
+
+	if (!CONFIG_IS_ENABLED(FIT_SIGNATURE))
+		return -EAGAIN;
+
+	fit = calloc(fit_size + data_size, 1);
+	ut_assertnonnull(fit);
+	data = fit + fit_size;
+	generate_data(data, data_size, "hash");
+	crc32_val = cpu_to_be32(crc32(0, (u8 *)data, data_size));
+	crc16_val = cpu_to_be16(crc16_ccitt(0, (u8 *)data, data_size));
+
+	ut_assertok(fdt_create(fit, fit_size));
+	ut_assertok(fdt_finish_reservemap(fit));
+	ut_assertok(fdt_begin_node(fit, ""));
+	ut_assertok(fdt_property_u32(fit, "#address-cells", ADDRESS_CELLS));
+	ut_assertok(fdt_begin_node(fit, "images"));
+	ut_assertok(fdt_begin_node(fit, "u-boot"));
+	ut_assertok(fdt_property_string(fit, FIT_TYPE_PROP, "firmware"));
+	ut_assertok(fdt_property_string(fit, FIT_COMP_PROP, "none"));
+	ut_assertok(fdt_property_string(fit, FIT_OS_PROP, "tee"));
+	ut_assertok(fdt_property_u32(fit, FIT_DATA_OFFSET_PROP, 0));
+	ut_assertok(fdt_property_u32(fit, FIT_DATA_SIZE_PROP, data_size));
+	ut_assertok(fdt_property_addr(fit, FIT_LOAD_PROP, CONFIG_TEXT_BASE));
+	ut_assertok(fdt_property_addr(fit, FIT_ENTRY_PROP, CONFIG_TEXT_BASE));
+	ut_assertok(fdt_begin_node(fit, "hash-1"));
+	ut_assertok(fdt_property_string(fit, FIT_ALGO_PROP, "crc32"));
+	ut_assertok(fdt_property(fit, FIT_VALUE_PROP, &crc32_val,
+				 sizeof(crc32_val)));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_begin_node(fit, "hash-2"));
+	ut_assertok(fdt_property_string(fit, FIT_ALGO_PROP, "crc16-ccitt"));
+	ut_assertok(fdt_property(fit, FIT_VALUE_PROP, &crc16_val,
+				 sizeof(crc16_val)));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_begin_node(fit, "configurations"));
+	ut_assertok(fdt_property_string(fit, FIT_DEFAULT_PROP, "config-1"));
+	ut_assertok(fdt_begin_node(fit, "config-1"));
+	ut_assertok(fdt_property_string(fit, FIT_FIRMWARE_PROP, "u-boot"));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_finish(fit));
+	ut_assert(fdt_totalsize(fit) <= fit_size);
+	fdt_set_totalsize(fit, fit_size);
+
+	spl_load_init(&load, spl_test_read, fit, 1);
+	ut_assertok(spl_load_simple_fit(&info, &load, 0, fit));
+	ut_asserteq_mem(data, map_sysmem(CONFIG_TEXT_BASE, data_size),
+			data_size);
+
+	/* a corrupted image must be rejected */
+	data[data_size / 2] ^= 1;
+	ut_assert(spl_load_simple_fit(&info, &load, 0, fit));
+
+	free(fit);
+
+	return 0;
+}
+SPL_TEST(spl_test_fit_hash, 0);
+
 /*
  * LZMA is too complex to generate on the fly, so let's use some data I put in
  * the oven^H^H^H^H compressed earlier
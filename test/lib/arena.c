@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the region allocator
+ */
+
+#include <arena.h>
+#include <string.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/* Test allocating from an arena and freeing it */
+static int lib_test_arena_alloc(struct unit_test_state *uts)
+{
+	struct arena arena;
+	char *ptr, *big, *str;
+	ulong start;
+	size_t size;
+	int i;
+
+	start = ut_check_free();
+
+	/* nothing is allocated until needed */
+	arena_init(&arena, 256);
+	ut_asserteq(0, arena_size(&arena));
+	ut_assertok(ut_check_delta(start));
+
+	/* small allocations come from a single block and are aligned */
+	ptr = arena_alloc(&arena, 3);
+	ut_assertnonnull(ptr);
+	ut_asserteq(0, (ulong)ptr & (2 * sizeof(size_t) - 1));
+	size = arena_size(&arena);
+	ut_assert(size > 256);
+	for (i = 0; i < 3; i++) {
+		ptr = arena_zalloc(&arena, 10);
+		ut_assertnonnull(ptr);
+		ut_asserteq(0, (ulong)ptr & (2 * sizeof(size_t) - 1));
+		ut_asserteq(0, ptr[9]);
+	}
+	ut_asserteq(size, arena_size(&arena));
+
+	/* a large allocation gets its own block */
+	big = arena_alloc(&arena, 1000);
+	ut_assertnonnull(big);
+	memset(big, '\xff', 1000);
+	ut_assert(arena_size(&arena) > size + 1000);
+	size = arena_size(&arena);
+
+	/* ...and the space in the first block is still used */
+	str = arena_strdup(&arena, "hello");
+	ut_asserteq_str("hello", str);
+	str = arena_strndup(&arena, "goodbye", 4);
+	ut_asserteq_str("good", str);
+	ut_asserteq(size, arena_size(&arena));
+
+	/* once the block is full, another is obtained */
+	for (i = 0; i < 256 / 16; i++)
+		ut_assertnonnull(arena_alloc(&arena, 16));
+	ut_assert(arena_size(&arena) > size);
+
+	arena_uninit(&arena);
+	ut_asserteq(0, arena_size(&arena));
+	ut_assertok(ut_check_delta(start));
+
+	return 0;
+}
+LIB_TEST(lib_test_arena_alloc, 0);
+
+/* Test resetting an arena */
+static int lib_test_arena_reset(struct unit_test_state *uts)
+{
+	struct arena arena;
+	ulong start;
+	size_t size;
+	char *ptr;
+	int i;
+
+	start = ut_check_free();
+
+	arena_init(&arena, 0);
+	ptr = arena_alloc(&arena, 16);
+	ut_assertnonnull(ptr);
+	size = arena_size(&arena);
+	ut_assert(size > ARENA_DEFAULT_BLOCK_SIZE);
+	for (i = 0; i < 3; i++)
+		ut_assertnonnull(arena_alloc(&arena, ARENA_DEFAULT_BLOCK_SIZE));
+	for (i = 0; i < ARENA_DEFAULT_BLOCK_SIZE / 16 * 2; i++)
+		ut_assertnonnull(arena_alloc(&arena, 16));
+	ut_assert(arena_size(&arena) > size * 4);
+
+	/* one standard block is kept and used again */
+	arena_reset(&arena);
+	ut_asserteq(size, arena_size(&arena));
+	ut_assertnonnull(arena_alloc(&arena, 16));
+	ut_asserteq(size, arena_size(&arena));
+
+	arena_uninit(&arena);
+	ut_assertok(ut_check_delta(start));
+
+	/* an arena with only a large allocation keeps nothing */
+	arena_init(&arena, 0);
+	ut_assertnonnull(arena_alloc(&arena, ARENA_DEFAULT_BLOCK_SIZE * 2));
+	arena_reset(&arena);
+	ut_asserteq(0, arena_size(&arena));
+	ut_assertok(ut_check_delta(start));
+
+	return 0;
+}
+LIB_TEST(lib_test_arena_reset, 0);
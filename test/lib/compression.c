@@ -242,6 +242,56 @@ static int uncompress_using_lzma(struct unit_test_state *uts,
 	return (ret != SZ_OK);
 }
 
+/* Size of each piece of input for the streaming decompressors */
+#define STREAM_PIECE_SIZE	7
+
+static int uncompress_using_gzip_stream(struct unit_test_state *uts,
+					void *in, unsigned long in_size,
+					void *out, unsigned long out_max,
+					unsigned long *out_size)
+{
+	struct gunzip_stream gs;
+	ulong pos, len, size;
+	int ret;
+
+	ut_assertok(gunzip_stream_start(&gs, out, out_max));
+
+	/* the header must be in the first piece */
+	for (pos = 0, ret = 0; !ret && pos < in_size; pos += len) {
+		len = min(in_size - pos, pos ? STREAM_PIECE_SIZE : 32UL);
+		ret = gunzip_stream_feed(&gs, in + pos, len);
+	}
+	if (gunzip_stream_finish(&gs, &size) && !ret)
+		ret = -EIO;
+	if (out_size)
+		*out_size = size;
+
+	return ret;
+}
+
+static int uncompress_using_lzma_stream(struct unit_test_state *uts,
+					void *in, unsigned long in_size,
+					void *out, unsigned long out_max,
+					unsigned long *out_size)
+{
+	struct lzma_stream ls;
+	ulong pos, len;
+	SizeT size;
+	int ret;
+
+	lzmaStreamStart(&ls, out, out_max);
+	for (pos = 0, ret = SZ_OK; ret == SZ_OK && pos < in_size; pos += len) {
+		len = min(in_size - pos, (ulong)STREAM_PIECE_SIZE);
+		ret = lzmaStreamFeed(&ls, in + pos, len);
+	}
+	if (lzmaStreamFinish(&ls, &size) != SZ_OK && ret == SZ_OK)
+		ret = SZ_ERROR_INPUT_EOF;
+	if (out_size)
+		*out_size = size;
+
+	return (ret != SZ_OK);
+}
+
 static int compress_using_lzo(struct unit_test_state *uts,
 			      void *in, unsigned long in_size,
 			      void *out, unsigned long out_max,
@@ -472,6 +522,13 @@ static int compression_test_gzip(struct unit_test_state *uts)
 }
 LIB_TEST(compression_test_gzip, 0);
 
+static int compression_test_gzip_stream(struct unit_test_state *uts)
+{
+	return run_test(uts, "gzip_stream", compress_using_gzip,
+			uncompress_using_gzip_stream);
+}
+LIB_TEST(compression_test_gzip_stream, 0);
+
 static int compression_test_bzip2(struct unit_test_state *uts)
 {
 	return run_test(uts, "bzip2", compress_using_bzip2,
@@ -486,6 +543,13 @@ static int compression_test_lzma(struct unit_test_state *uts)
 }
 LIB_TEST(compression_test_lzma, 0);
 
+static int compression_test_lzma_stream(struct unit_test_state *uts)
+{
+	return run_test(uts, "lzma_stream", compress_using_lzma,
+			uncompress_using_lzma_stream);
+}
+LIB_TEST(compression_test_lzma_stream, 0);
+
 static int compression_test_lzo(struct unit_test_state *uts)
 {
 	return run_test(uts, "lzo", compress_using_lzo, uncompress_using_lzo);
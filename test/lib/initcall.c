@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for initcall groups
+ */
+
+#include <errno.h>
+#include <initcall.h>
+#include <test/lib.h>
+#include <test/ut.h>
+
+static struct initcall_group initcall_test_grp;
+static int initcall_test_count;
+static int initcall_test_order[4];
+
+static int initcall_test_a(void)
+{
+	initcall_test_order[initcall_test_count++] = 1;
+
+	return 0;
+}
+
+static int initcall_test_b(void)
+{
+	initcall_test_order[initcall_test_count++] = 2;
+
+	return 0;
+}
+
+static int initcall_test_fail(void)
+{
+	initcall_test_order[initcall_test_count++] = 3;
+
+	return -EIO;
+}
+
+/* Test running a group of initcalls one at a time */
+static int lib_test_initcall_group(struct unit_test_state *uts)
+{
+	static const init_fnc_t calls[] = {
+		initcall_test_a,
+		initcall_test_b,
+	};
+	struct initcall_group *grp = &initcall_test_grp;
+
+	initcall_test_count = 0;
+	initcall_group_start(grp, calls, ARRAY_SIZE(calls));
+	ut_asserteq(0, initcall_test_count);
+
+	/* Each step runs one initcall */
+	ut_assert(initcall_group_step(grp));
+	ut_asserteq(1, initcall_test_count);
+	ut_asserteq(1, initcall_test_order[0]);
+
+	/* The rest are run when the group is finished */
+	ut_assertok(initcall_group_finish(grp));
+	ut_asserteq(2, initcall_test_count);
+	ut_asserteq(2, initcall_test_order[1]);
+
+	/* Nothing runs after the group is finished */
+	ut_assert(!initcall_group_step(grp));
+	ut_assertok(initcall_group_finish(grp));
+	ut_asserteq(2, initcall_test_count);
+
+	/* An empty group is fine */
+	initcall_group_start(grp, calls, 0);
+	ut_assert(!initcall_group_step(grp));
+	ut_assertok(initcall_group_finish(grp));
+	ut_asserteq(2, initcall_test_count);
+
+	/* The late group has been run before the tests */
+	ut_assert(!initcall_late_idle());
+	ut_assertok(initcall_late_finish());
+
+	return 0;
+}
+LIB_TEST(lib_test_initcall_group, 0);
+
+/* Test that a failing initcall stops the group */
+static int lib_test_initcall_group_fail(struct unit_test_state *uts)
+{
+	static const init_fnc_t calls[] = {
+		initcall_test_a,
+		initcall_test_fail,
+		initcall_test_b,
+	};
+	struct initcall_group *grp = &initcall_test_grp;
+
+	initcall_test_count = 0;
+	initcall_group_start(grp, calls, ARRAY_SIZE(calls));
+	ut_asserteq(-EIO, initcall_group_finish(grp));
+	ut_asserteq(2, initcall_test_count);
+	ut_asserteq(1, initcall_test_order[0]);
+	ut_asserteq(3, initcall_test_order[1]);
+
+	/* The error is kept and nothing more runs */
+	ut_assert(!initcall_group_step(grp));
+	ut_asserteq(-EIO, initcall_group_finish(grp));
+	ut_asserteq(2, initcall_test_count);
+
+	return 0;
+}
+LIB_TEST(lib_test_initcall_group_fail, 0);
@@ -0,0 +1,176 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Unit tests for the IP checksum functions
+ *
+ * compute_ip_checksum() takes different paths depending on the alignment
+ * and length of the data, so these are swept and the result compared with a
+ * straightforward 16-bit implementation.
+ */
+
+#include <display_options.h>
+#include <div64.h>
+#include <malloc.h>
+#include <net.h>
+#include <rand.h>
+#include <time.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+#include <linux/sizes.h>
+
+/* Number of different alignment values */
+#define SWEEP		8
+/* Largest length checked */
+#define MAXLEN		200
+#define BUFLEN		(SWEEP + MAXLEN + 1)
+
+/* Size of the buffer used for the benchmark */
+#define BENCH_SIZE	SZ_1M
+#define BENCH_LOOPS	64
+
+/* Reference implementation, summing one 16-bit word at a time */
+static uint ref_checksum(const u8 *ptr, uint nbytes)
+{
+	u32 sum = 0;
+	u16 word;
+
+	for (; nbytes > 1; nbytes -= 2, ptr += 2) {
+		memcpy(&word, ptr, 2);
+		sum += word;
+	}
+	if (nbytes) {
+		word = 0;
+		memcpy(&word, ptr, 1);
+		sum += word;
+	}
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+
+	return ~sum & 0xffff;
+}
+
+static int lib_test_ip_checksum(struct unit_test_state *uts)
+{
+	u8 buf[BUFLEN];
+	int align, len, i;
+
+	for (i = 0; i < BUFLEN; i++)
+		buf[i] = rand();
+
+	for (align = 0; align < SWEEP; align++) {
+		for (len = 0; len <= MAXLEN; len++) {
+			ut_asserteq(ref_checksum(buf + align, len),
+				    compute_ip_checksum(buf + align, len));
+		}
+	}
+
+	/* All ones must not produce a checksum of 0xffff */
+	memset(buf, 0xff, sizeof(buf));
+	ut_asserteq(0, compute_ip_checksum(buf, 64));
+
+	return 0;
+}
+LIB_TEST(lib_test_ip_checksum, 0);
+
+static int lib_test_ip_checksum_partial(struct unit_test_state *uts)
+{
+	u8 buf[BUFLEN];
+	u64 sum;
+	int split, i;
+
+	for (i = 0; i < BUFLEN; i++)
+		buf[i] = rand();
+
+	/* Summing two pieces must match summing the whole */
+	for (split = 0; split <= MAXLEN; split += 2) {
+		sum = ip_checksum_partial(0, buf, split);
+		sum = ip_checksum_partial(sum, buf + split, MAXLEN + 1 - split);
+		ut_asserteq(compute_ip_checksum(buf, MAXLEN + 1),
+			    ip_checksum_fold(sum));
+	}
+
+	return 0;
+}
+LIB_TEST(lib_test_ip_checksum_partial, 0);
+
+static int lib_test_ip_checksum_update(struct unit_test_state *uts)
+{
+	struct ip_udp_hdr hdr;
+	struct in_addr old_ip;
+	u16 old_id;
+	uint sum;
+	int i;
+
+	for (i = 0; i < 100; i++) {
+		memset(&hdr, '\0', sizeof(hdr));
+		hdr.ip_hl_v = 0x45;
+		hdr.ip_len = htons(rand() & 0xffff);
+		hdr.ip_id = htons(rand() & 0xffff);
+		hdr.ip_ttl = 255;
+		hdr.ip_p = IPPROTO_UDP;
+		hdr.ip_src.s_addr = rand();
+		hdr.ip_dst.s_addr = rand();
+		hdr.ip_sum = compute_ip_checksum(&hdr, IP_HDR_SIZE);
+		ut_assert(ip_checksum_ok(&hdr, IP_HDR_SIZE));
+
+		/* Rewrite a 16-bit field */
+		old_id = hdr.ip_id;
+		hdr.ip_id = htons(rand() & 0xffff);
+		sum = ip_checksum_update16(hdr.ip_sum, old_id, hdr.ip_id);
+		hdr.ip_sum = 0;
+		ut_asserteq(compute_ip_checksum(&hdr, IP_HDR_SIZE), sum);
+		hdr.ip_sum = sum;
+
+		/* Rewrite an address */
+		old_ip = hdr.ip_dst;
+		hdr.ip_dst.s_addr = rand();
+		sum = ip_checksum_update32(hdr.ip_sum, old_ip.s_addr,
+					   hdr.ip_dst.s_addr);
+		hdr.ip_sum = 0;
+		ut_asserteq(compute_ip_checksum(&hdr, IP_HDR_SIZE), sum);
+		hdr.ip_sum = sum;
+		ut_assert(ip_checksum_ok(&hdr, IP_HDR_SIZE));
+	}
+
+	return 0;
+}
+LIB_TEST(lib_test_ip_checksum_update, 0);
+
+static void bench_print(const char *name, ulong us)
+{
+	printf("%-10s %8lu us (", name, us);
+	print_size(lldiv((u64)BENCH_SIZE * BENCH_LOOPS * 1000000, max(us, 1UL)),
+		   "/s)\n");
+}
+
+/* Compare the throughput with the reference implementation */
+static int lib_test_ip_checksum_bench_norun(struct unit_test_state *uts)
+{
+	ulong start, ref_us, us;
+	uint ref = 0, sum = 0;
+	u8 *buf;
+	int i;
+
+	buf = malloc(BENCH_SIZE);
+	ut_assertnonnull(buf);
+	for (i = 0; i < BENCH_SIZE; i++)
+		buf[i] = i * 7;
+
+	start = timer_get_us();
+	for (i = 0; i < BENCH_LOOPS; i++)
+		ref += ref_checksum(buf, BENCH_SIZE);
+	ref_us = timer_get_us() - start;
+
+	start = timer_get_us();
+	for (i = 0; i < BENCH_LOOPS; i++)
+		sum += compute_ip_checksum(buf, BENCH_SIZE);
+	us = timer_get_us() - start;
+
+	free(buf);
+	ut_asserteq(ref, sum);
+	bench_print("reference", ref_us);
+	bench_print("optimised", us);
+
+	return 0;
+}
+LIB_TEST(lib_test_ip_checksum_bench_norun, UTF_MANUAL);
@@ -8,6 +8,7 @@
 #include <lmb.h>
 #include <log.h>
 #include <malloc.h>
+#include <time.h>
 #include <dm/test.h>
 #include <test/lib.h>
 #include <test/test.h>
@@ -822,3 +823,134 @@ static int lib_test_lmb_flags(struct unit_test_state *uts)
 	return 0;
 }
 LIB_TEST(lib_test_lmb_flags, 0);
+
+/* Reserve several regions at once */
+static int lib_test_lmb_reserve_regions(struct unit_test_state *uts)
+{
+	struct lmb_region rgns[] = {
+		{ 0x40030000, 0x10000, LMB_NOMAP },
+		/* adjacent to an existing region, so merged with it */
+		{ 0x40020000, 0x10000, LMB_NOOVERWRITE },
+		/* overlaps an existing region with flags */
+		{ 0x40018000, 0x1000, LMB_NOOVERWRITE },
+		/* overlaps an existing region without flags, so merged */
+		{ 0x400f8000, 0x10000, LMB_NONE },
+		/* overlaps a new region with flags */
+		{ 0x40034000, 0x1000, LMB_NONE },
+	};
+	const phys_addr_t ram = 0x40000000;
+	const phys_size_t ram_size = 0x20000000;
+	struct alist *mem_lst, *used_lst;
+	struct lmb_region *used;
+	struct lmb store;
+	long ret;
+
+	ut_assertok(setup_lmb_test(uts, &store, &mem_lst, &used_lst));
+
+	ut_assertok(lmb_add(ram, ram_size));
+	ut_assertok(lmb_reserve_flags(0x40010000, 0x10000, LMB_NOOVERWRITE));
+	ut_assertok(lmb_reserve(0x40100000, 0x10000));
+
+	ret = lmb_reserve_regions(rgns, ARRAY_SIZE(rgns));
+	ut_asserteq(2, ret);
+	ASSERT_LMB(mem_lst, used_lst, ram, ram_size, 3, 0x40010000, 0x20000,
+		   0x40030000, 0x10000, 0x400f8000, 0x18000);
+	used = used_lst->data;
+	ut_asserteq(LMB_NOOVERWRITE, used[0].flags);
+	ut_asserteq(LMB_NOMAP, used[1].flags);
+	ut_asserteq(LMB_NONE, used[2].flags);
+
+	/* the regions are sorted */
+	ut_asserteq(0x40018000, rgns[0].base);
+
+	/* reserving them all again makes no difference */
+	ret = lmb_reserve_regions(rgns, ARRAY_SIZE(rgns));
+	ut_asserteq(4, ret);
+	ASSERT_LMB(mem_lst, used_lst, ram, ram_size, 3, 0x40010000, 0x20000,
+		   0x40030000, 0x10000, 0x400f8000, 0x18000);
+
+	ut_asserteq(0, lmb_reserve_regions(rgns, 0));
+
+	lmb_pop(&store);
+
+	return 0;
+}
+LIB_TEST(lib_test_lmb_reserve_regions, 0);
+
+/* Number of regions for the benchmark, as from a large reserved-memory node */
+#define BENCH_REGIONS	500
+
+/*
+ * Reserve many separate regions in a scattered order, to compare the time taken
+ * to reserve them one at a time and all at once
+ */
+static int lmb_bench_reserve(struct unit_test_state *uts, bool bulk,
+			     struct lmb_region *result, ulong *usp)
+{
+	const phys_addr_t ram = 0x40000000;
+	const phys_size_t ram_size = 0x20000000;
+	struct alist *mem_lst, *used_lst;
+	struct lmb_region *rgns;
+	struct lmb store;
+	ulong start;
+	int i, idx;
+
+	rgns = malloc(BENCH_REGIONS * sizeof(*rgns));
+	ut_assertnonnull(rgns);
+	for (i = 0; i < BENCH_REGIONS; i++) {
+		idx = i * 7 % BENCH_REGIONS;
+		rgns[i].base = ram + idx * 0x2000;
+		rgns[i].size = 0x1000;
+		rgns[i].flags = i & 1 ? LMB_NOMAP : LMB_NOOVERWRITE;
+	}
+
+	ut_assertok(setup_lmb_test(uts, &store, &mem_lst, &used_lst));
+	ut_assertok(lmb_add(ram, ram_size));
+
+	start = timer_get_us();
+	if (bulk) {
+		ut_assertok(lmb_reserve_regions(rgns, BENCH_REGIONS));
+	} else {
+		for (i = 0; i < BENCH_REGIONS; i++)
+			ut_assertok(lmb_reserve_flags(rgns[i].base,
+						      rgns[i].size,
+						      rgns[i].flags));
+	}
+	*usp = timer_get_us() - start;
+
+	ut_asserteq(BENCH_REGIONS, used_lst->count);
+	memcpy(result, used_lst->data, BENCH_REGIONS * sizeof(*result));
+	lmb_pop(&store);
+	free(rgns);
+
+	return 0;
+}
+
+static int lib_test_lmb_reserve_bench(struct unit_test_state *uts)
+{
+	struct lmb_region *single, *bulk;
+	ulong single_us, bulk_us;
+	int i;
+
+	single = calloc(BENCH_REGIONS, sizeof(*single));
+	bulk = calloc(BENCH_REGIONS, sizeof(*bulk));
+	ut_assertnonnull(single);
+	ut_assertnonnull(bulk);
+
+	ut_assertok(lmb_bench_reserve(uts, false, single, &single_us));
+	ut_assertok(lmb_bench_reserve(uts, true, bulk, &bulk_us));
+
+	for (i = 0; i < BENCH_REGIONS; i++) {
+		ut_asserteq(single[i].base, bulk[i].base);
+		ut_asserteq(single[i].size, bulk[i].size);
+		ut_asserteq(single[i].flags, bulk[i].flags);
+	}
+	printf("%d regions: one at a time %lu us, together %lu us\n",
+	       BENCH_REGIONS, single_us, bulk_us);
+
+	free(bulk);
+	free(single);
+
+	return 0;
+}
+LIB_TEST(lib_test_lmb_reserve_bench, 0);
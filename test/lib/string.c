@@ -2,7 +2,7 @@
 /*
  * Copyright (c) 2019 Heinrich Schuchardt <xypron.glpk@gmx.de>
  *
- * Unit tests for memory functions
+ * Unit tests for memory and string functions
  *
  * The architecture dependent implementations run through different lines of
  * code depending on the alignment and length of memory regions copied or set.
@@ -221,3 +221,246 @@ static int lib_memdup(struct unit_test_state *uts)
 	return 0;
 }
 LIB_TEST(lib_memdup, 0);
+
+/* Character which is not used in the strings and memory regions below */
+#define TEST_CHR	0xff
+
+/**
+ * init_string() - fill part of a buffer with non-NUL characters
+ *
+ * The characters vary and include 0x01 and 0x80, which are special cases for
+ * implementations which check several bytes at once. TEST_CHR is not used.
+ *
+ * @buf:	buffer
+ * @offset:	start of region to fill
+ * @len:	length of region to fill
+ */
+static void init_string(u8 buf[], int offset, int len)
+{
+	int i;
+
+	for (i = 0; i < len; ++i)
+		buf[offset + i] = 1 + (offset + i) * 0x35 % 0xfe;
+}
+
+/** sign() - get the sign of a comparison result, as -1, 0 or 1 */
+static int sign(int val)
+{
+	return (val > 0) - (val < 0);
+}
+
+/** ref_memcmp() - simple memcmp() to compare results with */
+static int ref_memcmp(const u8 *s1, const u8 *s2, size_t len)
+{
+	for (; len; s1++, s2++, len--) {
+		if (*s1 != *s2)
+			return *s1 - *s2;
+	}
+
+	return 0;
+}
+
+/** ref_strcmp() - simple strcmp() to compare results with */
+static int ref_strcmp(const u8 *s1, const u8 *s2)
+{
+	for (; *s1 == *s2; s1++, s2++) {
+		if (!*s1)
+			return 0;
+	}
+
+	return *s1 - *s2;
+}
+
+/**
+ * lib_memcmp() - unit test for memcmp()
+ *
+ * Test memcmp() with varied alignment and length of the compared regions and
+ * with each position of a differing byte.
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_memcmp(struct unit_test_state *uts)
+{
+	u8 buf1[BUFLEN];
+	u8 buf2[BUFLEN];
+	int offset1, offset2, len, pos;
+	u8 *s1, *s2;
+
+	init_buffer(buf1, MASK);
+
+	for (offset1 = 0; offset1 <= SWEEP; ++offset1) {
+		for (offset2 = 0; offset2 <= SWEEP; ++offset2) {
+			for (len = 0; len < BUFLEN - SWEEP; ++len) {
+				s1 = buf1 + offset1;
+				s2 = buf2 + offset2;
+				init_buffer(buf2, 0);
+				memcpy(s2, s1, len);
+				ut_asserteq(0, memcmp(s1, s2, len));
+				for (pos = 0; pos < len; pos++) {
+					s2[pos] ^= 0xff;
+					ut_asserteq(sign(ref_memcmp(s1, s2, len)),
+						    sign(memcmp(s1, s2, len)));
+					s2[pos] ^= 0xff;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_memcmp, 0);
+
+/**
+ * lib_memchr() - unit test for memchr()
+ *
+ * Test memchr() with varied alignment and length of the searched region and
+ * each position of the character. The character is placed just outside the
+ * region too, where it must not be found.
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_memchr(struct unit_test_state *uts)
+{
+	u8 buf[BUFLEN];
+	int offset, len, pos;
+	u8 *s;
+
+	for (offset = 0; offset <= SWEEP; ++offset) {
+		for (len = 0; len < BUFLEN - SWEEP; ++len) {
+			s = buf + offset;
+			memset(buf, TEST_CHR, BUFLEN);
+			for (pos = 0; pos < len; pos++)
+				s[pos] = pos;
+			ut_assertnull(memchr(s, TEST_CHR, len));
+			for (pos = 0; pos < len; pos++) {
+				s[pos] = TEST_CHR;
+				ut_asserteq_ptr(s + pos, memchr(s, TEST_CHR, len));
+				ut_asserteq_ptr(s + pos, memchr(s, (char)TEST_CHR,
+								len));
+				s[pos] = pos;
+			}
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_memchr, 0);
+
+/**
+ * lib_strlen() - unit test for strlen()
+ *
+ * Test strlen() with varied alignment and length of the string. The bytes
+ * before the string are NUL, so must be ignored.
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_strlen(struct unit_test_state *uts)
+{
+	u8 buf[BUFLEN];
+	int offset, len;
+
+	for (offset = 0; offset <= SWEEP; ++offset) {
+		for (len = 0; len < BUFLEN - SWEEP; ++len) {
+			init_buffer(buf, MASK);
+			memset(buf, '\0', offset);
+			init_string(buf, offset, len);
+			buf[offset + len] = '\0';
+			ut_asserteq(len, strlen((char *)buf + offset));
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_strlen, 0);
+
+/**
+ * lib_strcmp() - unit test for strcmp()
+ *
+ * Test strcmp() with varied alignment and length of the strings, with each
+ * position of a differing character and with the second string longer.
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_strcmp(struct unit_test_state *uts)
+{
+	u8 buf1[BUFLEN];
+	u8 buf2[BUFLEN];
+	int offset1, offset2, len, pos;
+	u8 *s1, *s2;
+	u8 old;
+
+	for (offset1 = 0; offset1 <= SWEEP; ++offset1) {
+		for (offset2 = 0; offset2 <= SWEEP; ++offset2) {
+			for (len = 0; len < BUFLEN - SWEEP - 1; ++len) {
+				s1 = buf1 + offset1;
+				s2 = buf2 + offset2;
+				init_buffer(buf1, MASK);
+				init_buffer(buf2, 0);
+				init_string(s1, 0, len);
+				init_string(s2, 0, len);
+				s1[len] = '\0';
+				s2[len] = '\0';
+				s2[len + 1] = '\0';
+				ut_asserteq(0, strcmp((char *)s1, (char *)s2));
+
+				/* pos == len makes the second string longer */
+				for (pos = 0; pos <= len; pos++) {
+					old = s2[pos];
+					s2[pos] ^= 0x80;
+					ut_asserteq(sign(ref_strcmp(s1, s2)),
+						    sign(strcmp((char *)s1,
+								(char *)s2)));
+					ut_asserteq(sign(ref_strcmp(s2, s1)),
+						    sign(strcmp((char *)s2,
+								(char *)s1)));
+					s2[pos] = old;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_strcmp, 0);
+
+/**
+ * lib_strchr() - unit test for strchr()
+ *
+ * Test strchr() with varied alignment and length of the string and each
+ * position of the character. The character is placed before the string and
+ * after its end, where it must not be found.
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_strchr(struct unit_test_state *uts)
+{
+	u8 buf[BUFLEN];
+	int offset, len, pos;
+	char *s;
+
+	for (offset = 0; offset <= SWEEP; ++offset) {
+		for (len = 0; len < BUFLEN - SWEEP - 1; ++len) {
+			s = (char *)buf + offset;
+			memset(buf, TEST_CHR, BUFLEN);
+			init_string(buf, offset, len);
+			s[len] = '\0';
+			ut_assertnull(strchr(s, TEST_CHR));
+			ut_asserteq_ptr(s + len, strchr(s, '\0'));
+			for (pos = 0; pos < len; pos++) {
+				s[pos] = TEST_CHR;
+				ut_asserteq_ptr(s + pos, strchr(s, TEST_CHR));
+				ut_asserteq_ptr(s + pos, strchr(s,
+								(char)TEST_CHR));
+				init_string(buf, offset, len);
+			}
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_strchr, 0);
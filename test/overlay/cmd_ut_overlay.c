@@ -10,6 +10,7 @@
 #include <image.h>
 #include <log.h>
 #include <malloc.h>
+#include <time.h>
 
 #include <linux/sizes.h>
 
@@ -210,6 +211,183 @@ static int fdt_overlay_stacked(struct unit_test_state *uts)
 }
 OVERLAY_TEST(fdt_overlay_stacked, 0);
 
+/* Test that applying overlays as a batch gives the same result */
+static int fdt_overlay_batch(struct unit_test_state *uts)
+{
+	void *fdt_base = &__dtb_test_fdt_base_begin;
+	void *fdt_overlay = &__dtbo_test_fdt_overlay_begin;
+	void *fdt_overlay_stacked = &__dtbo_test_fdt_overlay_stacked_begin;
+	struct fdt_overlay_batch batch;
+	void *base, *ov;
+
+	base = malloc(FDT_COPY_SIZE);
+	ut_assertnonnull(base);
+	ov = malloc(FDT_COPY_SIZE);
+	ut_assertnonnull(ov);
+
+	ut_assertok(fdt_open_into(fdt_base, base, FDT_COPY_SIZE));
+	ut_assertok(fdt_overlay_batch_init(&batch, base));
+
+	ut_assertok(fdt_open_into(fdt_overlay, ov, FDT_COPY_SIZE));
+	ut_assertok(fdt_overlay_batch_apply(&batch, base, ov));
+
+	/* the stacked overlay refers to a symbol from the first one */
+	ut_assertok(fdt_open_into(fdt_overlay_stacked, ov, FDT_COPY_SIZE));
+	ut_assertok(fdt_overlay_batch_apply(&batch, base, ov));
+	fdt_overlay_batch_uninit(&batch);
+
+	ut_asserteq(fdt_totalsize(fdt), fdt_totalsize(base));
+	ut_asserteq_mem(fdt, base, fdt_totalsize(fdt));
+
+	free(ov);
+	free(base);
+
+	return CMD_RET_SUCCESS;
+}
+OVERLAY_TEST(fdt_overlay_batch, 0);
+
+/**
+ * make_perf_base() - Create a base tree with labelled nodes
+ *
+ * Each node /node<n> has phandle n + 1 and the label 'label<n>'
+ */
+static int make_perf_base(void *buf, int size, int count)
+{
+	char name[30], path[30];
+	int i, ret;
+
+	ret = fdt_create(buf, size);
+	ret = ret ?: fdt_finish_reservemap(buf);
+	ret = ret ?: fdt_begin_node(buf, "");
+	for (i = 0; i < count; i++) {
+		snprintf(name, sizeof(name), "node%d", i);
+		ret = ret ?: fdt_begin_node(buf, name);
+		ret = ret ?: fdt_property_u32(buf, "phandle", i + 1);
+		ret = ret ?: fdt_property_u32(buf, "value", i);
+		ret = ret ?: fdt_end_node(buf);
+	}
+	ret = ret ?: fdt_begin_node(buf, "__symbols__");
+	for (i = 0; i < count; i++) {
+		snprintf(name, sizeof(name), "label%d", i);
+		snprintf(path, sizeof(path), "/node%d", i);
+		ret = ret ?: fdt_property_string(buf, name, path);
+	}
+	ret = ret ?: fdt_end_node(buf);
+	ret = ret ?: fdt_end_node(buf);
+	ret = ret ?: fdt_finish(buf);
+
+	return ret ?: fdt_open_into(buf, buf, size);
+}
+
+/**
+ * make_perf_overlay() - Create an overlay for the tree from make_perf_base()
+ *
+ * This has @frags fragments which each add a property to a node in the base
+ * tree, referred to by its label, plus a fragment adding a new labelled node
+ */
+static int make_perf_overlay(void *buf, int size, int seq, int count,
+			     int frags)
+{
+	char name[40], path[40];
+	int i, ret;
+
+	ret = fdt_create(buf, size);
+	ret = ret ?: fdt_finish_reservemap(buf);
+	ret = ret ?: fdt_begin_node(buf, "");
+	for (i = 0; i < frags; i++) {
+		snprintf(name, sizeof(name), "fragment@%d", i);
+		ret = ret ?: fdt_begin_node(buf, name);
+		ret = ret ?: fdt_property_u32(buf, "target", -1U);
+		ret = ret ?: fdt_begin_node(buf, "__overlay__");
+		snprintf(name, sizeof(name), "overlay%d-value", seq);
+		ret = ret ?: fdt_property_u32(buf, name, i);
+		ret = ret ?: fdt_end_node(buf);
+		ret = ret ?: fdt_end_node(buf);
+	}
+
+	snprintf(name, sizeof(name), "fragment@%d", frags);
+	ret = ret ?: fdt_begin_node(buf, name);
+	ret = ret ?: fdt_property_string(buf, "target-path", "/");
+	ret = ret ?: fdt_begin_node(buf, "__overlay__");
+	snprintf(name, sizeof(name), "overlay%d", seq);
+	ret = ret ?: fdt_begin_node(buf, name);
+	ret = ret ?: fdt_property_u32(buf, "phandle", 1);
+	ret = ret ?: fdt_end_node(buf);
+	ret = ret ?: fdt_end_node(buf);
+	ret = ret ?: fdt_end_node(buf);
+
+	ret = ret ?: fdt_begin_node(buf, "__symbols__");
+	snprintf(path, sizeof(path), "/fragment@%d/__overlay__/overlay%d",
+		 frags, seq);
+	ret = ret ?: fdt_property_string(buf, name, path);
+	ret = ret ?: fdt_end_node(buf);
+
+	ret = ret ?: fdt_begin_node(buf, "__fixups__");
+	for (i = 0; i < frags; i++) {
+		snprintf(name, sizeof(name), "label%d",
+			 (seq * frags + i) % count);
+		snprintf(path, sizeof(path), "/fragment@%d:target:0", i);
+		ret = ret ?: fdt_property_string(buf, name, path);
+	}
+	ret = ret ?: fdt_end_node(buf);
+	ret = ret ?: fdt_end_node(buf);
+	ret = ret ?: fdt_finish(buf);
+
+	return ret ?: fdt_open_into(buf, buf, size);
+}
+
+/* Compare the time taken to apply overlays one by one and as a batch */
+static int fdt_overlay_batch_perf(struct unit_test_state *uts)
+{
+	const int count = 500, overlays = 16, frags = 4;
+	struct fdt_overlay_batch batch;
+	ulong start, single_us, batch_us;
+	void *single, *base, *ov;
+	int i;
+
+	single = malloc(SZ_128K);
+	ut_assertnonnull(single);
+	base = malloc(SZ_128K);
+	ut_assertnonnull(base);
+	ov = malloc(FDT_COPY_SIZE);
+	ut_assertnonnull(ov);
+
+	ut_assertok(make_perf_base(single, SZ_128K, count));
+	single_us = 0;
+	for (i = 0; i < overlays; i++) {
+		ut_assertok(make_perf_overlay(ov, FDT_COPY_SIZE, i, count,
+					      frags));
+		start = timer_get_us();
+		ut_assertok(fdt_overlay_apply(single, ov));
+		single_us += timer_get_us() - start;
+	}
+
+	ut_assertok(make_perf_base(base, SZ_128K, count));
+	start = timer_get_us();
+	ut_assertok(fdt_overlay_batch_init(&batch, base));
+	batch_us = timer_get_us() - start;
+	for (i = 0; i < overlays; i++) {
+		ut_assertok(make_perf_overlay(ov, FDT_COPY_SIZE, i, count,
+					      frags));
+		start = timer_get_us();
+		ut_assertok(fdt_overlay_batch_apply(&batch, base, ov));
+		batch_us += timer_get_us() - start;
+	}
+	fdt_overlay_batch_uninit(&batch);
+
+	ut_asserteq(fdt_totalsize(single), fdt_totalsize(base));
+	ut_asserteq_mem(single, base, fdt_totalsize(single));
+	printf("%d overlays on %d nodes: %lu us one by one, %lu us batched\n",
+	       overlays, count, single_us, batch_us);
+
+	free(ov);
+	free(base);
+	free(single);
+
+	return CMD_RET_SUCCESS;
+}
+OVERLAY_TEST(fdt_overlay_batch_perf, 0);
+
 int do_ut_overlay(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 {
 	struct unit_test *tests = UNIT_TEST_SUITE_START(overlay_test);